@@ -0,0 +1,185 @@
+#include <benchmark/benchmark.h>
+#include <BlockValue.h>
+#include <ByteArena.h>
+#include <memory>
+#include "Random.h"
+
+static const char text[10] = { 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a', 'a' };
+
+struct TextEdit
+{
+  size_t offset;
+  uint32_t length;
+};
+
+//mostly typing at the end, sometimes somewhere else
+static std::vector<TextEdit> generateTextEdits(size_t count, uint32_t seed = 123456789)
+{
+  Random random(seed);
+  std::vector<TextEdit> edits;
+  size_t textLength = 0;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    uint32_t length = static_cast<uint32_t>(random.nextIndex(sizeof(text)) + 1);
+    size_t offset = random.next() < 0.9 ? textLength : random.nextIndex(textLength + 1);
+    edits.push_back({ offset, length });
+    textLength += length;
+  }
+
+  return edits;
+}
+
+static void applyTextEdits(BlockValue<char> & value, const std::vector<TextEdit> & edits)
+{
+  BlockValue<char>::ChangedCallback callback = [](size_t, char *, uint32_t){};
+  uint32_t clock = 0;
+
+  for (const auto & edit : edits)
+  {
+    value.computeInsertions(edit.offset, reinterpret_cast<const uint8_t *>(text), edit.length,
+      [&](const Timestamp & blockId, uint32_t offset, const uint8_t * data, uint32_t length)
+      {
+        value.insertAfter(blockId, offset, Timestamp(++clock, 1), length,
+          reinterpret_cast<const char *>(data), callback);
+      });
+  }
+}
+
+static void BM_BlockValueInsertAfter(benchmark::State & state)
+{
+  auto edits = generateTextEdits(state.range(0));
+
+  for (auto _ : state)
+  {
+    BlockValue<char> value;
+    applyTextEdits(value, edits);
+    benchmark::DoNotOptimize(value.getLength());
+  }
+
+  state.SetItemsProcessed(state.iterations() * edits.size());
+}
+BENCHMARK(BM_BlockValueInsertAfter)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+//only destroying the value, which releases its blocks slab by slab
+static void BM_BlockValueTeardown(benchmark::State & state)
+{
+  auto edits = generateTextEdits(state.range(0));
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto value = std::make_unique<BlockValue<char>>();
+    applyTextEdits(*value, edits);
+    state.ResumeTiming();
+
+    value.reset();
+  }
+
+  state.SetItemsProcessed(state.iterations() * edits.size());
+}
+BENCHMARK(BM_BlockValueTeardown)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+//one character per insert, with the data copied into an arena like the core
+//  does, so inserts continuing the last one are coalesced
+static void BM_BlockValueTyping(benchmark::State & state)
+{
+  BlockValue<char>::ChangedCallback callback = [](size_t, char *, uint32_t){};
+  size_t blocks = 0;
+
+  for (auto _ : state)
+  {
+    BlockValue<char> value;
+    ByteArena arena;
+    Random random(123456789);
+    uint32_t clock = 0;
+    size_t cursor = 0;
+
+    for (int64_t i = 0; i < state.range(0); i++)
+    {
+      //move the cursor now and then
+      if (random.next() < 0.02)
+      {
+        cursor = random.nextIndex(value.getLength() + 1);
+      }
+
+      value.computeInsertions(cursor, reinterpret_cast<const uint8_t *>(text), 1,
+        [&](const Timestamp & blockId, uint32_t offset, const uint8_t * data, uint32_t length)
+        {
+          value.insertAfter(blockId, offset, Timestamp(++clock, 1), length,
+            arena.copy(data, length), callback);
+        });
+      cursor++;
+    }
+
+    blocks = 0;
+    for (auto block = value.getChildren(); block != nullptr; block = block->nextSibling)
+    {
+      blocks++;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["blocks"] = static_cast<double>(blocks);
+}
+BENCHMARK(BM_BlockValueTyping)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_BlockValueFindOffset(benchmark::State & state)
+{
+  BlockValue<char> value;
+  applyTextEdits(value, generateTextEdits(state.range(0)));
+
+  Random random;
+  size_t length = value.getLength();
+
+  for (auto _ : state)
+  {
+    uint32_t offset = static_cast<uint32_t>(random.nextIndex(length));
+    benchmark::DoNotOptimize(value.findOffset(offset));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlockValueFindOffset)->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void BM_BlockValueFindUtf16Offset(benchmark::State & state)
+{
+  BlockValue<char> value;
+  applyTextEdits(value, generateTextEdits(state.range(0)));
+
+  Random random;
+  size_t length = value.getLength();
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(value.findUtf16CodeUnitOffset(random.nextIndex(length)));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlockValueFindUtf16Offset)->Arg(1000)->Arg(10000)->Arg(100000);
+
+//typing followed by reading the whole text, as an editor does
+static void BM_BlockValueEditAndGetText(benchmark::State & state)
+{
+  auto edits = generateTextEdits(state.range(0));
+  BlockValue<char> value;
+  applyTextEdits(value, edits);
+
+  BlockValue<char>::ChangedCallback callback = [](size_t, char *, uint32_t){};
+  uint32_t clock = static_cast<uint32_t>(state.range(0)) * sizeof(text);
+  Random random(987654321);
+
+  for (auto _ : state)
+  {
+    size_t offset = random.nextIndex(value.getLength() + 1);
+    value.computeInsertions(offset, reinterpret_cast<const uint8_t *>(text), 1,
+      [&](const Timestamp & blockId, uint32_t offset, const uint8_t * data, uint32_t length)
+      {
+        value.insertAfter(blockId, offset, Timestamp(++clock, 1), length,
+          reinterpret_cast<const char *>(data), callback);
+      });
+    benchmark::DoNotOptimize(value.getText().data());
+  }
+}
+BENCHMARK(BM_BlockValueEditAndGetText)->Arg(1000)->Arg(10000)->Arg(100000);
@@ -0,0 +1,211 @@
+#include <benchmark/benchmark.h>
+#include "Workloads.h"
+#include "Random.h"
+#include <EventRecord.h>
+#include <memory>
+#include <unordered_map>
+
+static const OperationLogStorage & getMixedWorkload()
+{
+  static const OperationLogStorage log = generateMixedWorkload(20000);
+  return log;
+}
+
+static void BM_ApplyOperationSequential(benchmark::State & state)
+{
+  auto ops = referenceOperations(getMixedWorkload());
+
+  for (auto _ : state)
+  {
+    CoreInit coreInit;
+    Core core(coreInit);
+
+    for (const auto & op : ops)
+    {
+      core.applyOperation(op);
+    }
+
+    benchmark::DoNotOptimize(core.clock);
+  }
+
+  state.SetItemsProcessed(state.iterations() * ops.size());
+  releaseOperations(ops);
+}
+BENCHMARK(BM_ApplyOperationSequential)->Unit(benchmark::kMillisecond);
+
+static void BM_ApplyOperationsBatch(benchmark::State & state)
+{
+  auto ops = referenceOperations(getMixedWorkload());
+
+  for (auto _ : state)
+  {
+    CoreInit coreInit;
+    Core core(coreInit);
+
+    core.applyOperations(ops);
+
+    benchmark::DoNotOptimize(core.clock);
+  }
+
+  state.SetItemsProcessed(state.iterations() * ops.size());
+  releaseOperations(ops);
+}
+BENCHMARK(BM_ApplyOperationsBatch)->Unit(benchmark::kMillisecond);
+
+//the same with a listener, so every event is built and raised
+static void BM_ApplyOperationsBatchWithListener(benchmark::State & state)
+{
+  auto ops = referenceOperations(getMixedWorkload());
+
+  for (auto _ : state)
+  {
+    size_t events = 0;
+    CoreInit coreInit([](const std::string & type){}, [&events](const Event & event){ events++; });
+    Core core(coreInit);
+
+    core.applyOperations(ops);
+
+    benchmark::DoNotOptimize(events);
+  }
+
+  state.SetItemsProcessed(state.iterations() * ops.size());
+  releaseOperations(ops);
+}
+BENCHMARK(BM_ApplyOperationsBatchWithListener)->Unit(benchmark::kMillisecond);
+
+//the same with events delivered in one merged batch
+static void BM_ApplyOperationsBatchWithBatchedEvents(benchmark::State & state)
+{
+  auto ops = referenceOperations(getMixedWorkload());
+
+  for (auto _ : state)
+  {
+    size_t events = 0;
+    CoreInit coreInit = CoreInit::Batched([](const std::string & type){},
+      [&events](const EventBatch & batch){ events += batch.size(); });
+    Core core(coreInit);
+
+    core.applyOperations(ops);
+
+    benchmark::DoNotOptimize(events);
+  }
+
+  state.SetItemsProcessed(state.iterations() * ops.size());
+  releaseOperations(ops);
+}
+BENCHMARK(BM_ApplyOperationsBatchWithBatchedEvents)->Unit(benchmark::kMillisecond);
+
+//the same with every event written as a record
+static void BM_ApplyOperationsBatchWithEventRecords(benchmark::State & state)
+{
+  auto ops = referenceOperations(getMixedWorkload());
+  EventRecordBuffer buffer;
+
+  for (auto _ : state)
+  {
+    buffer.clear();
+    CoreInit coreInit([](const std::string & type){}, [&buffer](const Event & event){ buffer.add(event); });
+    Core core(coreInit);
+
+    core.applyOperations(ops);
+
+    benchmark::DoNotOptimize(buffer.size());
+  }
+
+  state.SetItemsProcessed(state.iterations() * ops.size());
+  releaseOperations(ops);
+}
+BENCHMARK(BM_ApplyOperationsBatchWithEventRecords)->Unit(benchmark::kMillisecond);
+
+//per operation type
+
+static void BM_ApplyNodeCreate(benchmark::State & state)
+{
+  static const ApplyWorkload workload = generateNodeCreateWorkload(10000);
+  benchmarkApply(state, workload);
+}
+BENCHMARK(BM_ApplyNodeCreate)->Unit(benchmark::kMillisecond);
+
+static void BM_ApplyMapEdgeCreate(benchmark::State & state)
+{
+  static const ApplyWorkload workload = generateMapEdgeCreateWorkload(10000);
+  benchmarkApply(state, workload);
+}
+BENCHMARK(BM_ApplyMapEdgeCreate)->Unit(benchmark::kMillisecond);
+
+static void BM_ApplyValueSet(benchmark::State & state)
+{
+  static const ApplyWorkload workload = generateValueSetWorkload(10000);
+  benchmarkApply(state, workload);
+}
+BENCHMARK(BM_ApplyValueSet)->Unit(benchmark::kMillisecond);
+
+static void BM_ApplyBlockValueInsert(benchmark::State & state)
+{
+  static const ApplyWorkload workload = generateTextInsertWorkload(10000);
+  benchmarkApply(state, workload);
+}
+BENCHMARK(BM_ApplyBlockValueInsert)->Unit(benchmark::kMillisecond);
+
+static void BM_ApplyBlockValueDelete(benchmark::State & state)
+{
+  static const ApplyWorkload workload = generateTextDeleteWorkload(5000);
+  benchmarkApply(state, workload);
+}
+BENCHMARK(BM_ApplyBlockValueDelete)->Unit(benchmark::kMillisecond);
+
+//node lookups, e.g. reading every value of a large document
+
+struct LookupDocument
+{
+  BenchmarkDocument document;
+  //in a random order so lookups don't follow allocation order
+  std::vector<NodeId> values;
+};
+
+static const LookupDocument & getLookupDocument(size_t count)
+{
+  static std::unordered_map<size_t, std::unique_ptr<LookupDocument>> documents;
+
+  auto & lookupDocument = documents[count];
+  if (lookupDocument == nullptr)
+  {
+    Random random;
+    lookupDocument = std::make_unique<LookupDocument>();
+    auto & values = lookupDocument->values;
+    OperationBuilder & builder = lookupDocument->document.builder;
+
+    for (size_t i = 0; i < count; i++)
+    {
+      NodeId valueId = builder.createNode(PrimitiveNodeTypes::DoubleValue());
+      builder.setValue<double>(valueId, random.next());
+      values.push_back(valueId);
+    }
+
+    for (size_t i = values.size(); i > 1; i--)
+    {
+      std::swap(values[i - 1], values[random.nextIndex(i)]);
+    }
+  }
+
+  return *lookupDocument;
+}
+
+static void BM_CoreGetNodeValue(benchmark::State & state)
+{
+  const LookupDocument & lookupDocument = getLookupDocument(state.range(0));
+  const Core & core = lookupDocument.document.core;
+
+  for (auto _ : state)
+  {
+    double sum = 0;
+    for (const auto & nodeId : lookupDocument.values)
+    {
+      sum += core.getNodeValue(nodeId);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * lookupDocument.values.size());
+}
+BENCHMARK(BM_CoreGetNodeValue)->Arg(10000)->Arg(1000000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <CoreHost.h>
+#include "Workloads.h"
+
+//many independent documents, each with its own log, as replayed at boot
+static const std::vector<OperationLogStorage> & getDocumentLogs()
+{
+  static const std::vector<OperationLogStorage> logs = []()
+  {
+    std::vector<OperationLogStorage> logs;
+    for (uint32_t i = 0; i < 64; i++)
+    {
+      logs.push_back(generateMixedWorkload(1000, 123456789 + i));
+    }
+    return logs;
+  }();
+  return logs;
+}
+
+//replays every document on a host with state.range(0) worker threads; with
+//  enough hardware threads the time should drop roughly linearly
+static void BM_CoreHostReplay(benchmark::State & state)
+{
+  const auto & logs = getDocumentLogs();
+
+  //borrowed, so the workers never touch a shared reference count
+  std::vector<std::vector<RefCounted<const LogOperation>>> ops;
+  size_t numOps = 0;
+  for (const auto & log : logs)
+  {
+    auto & documentOps = ops.emplace_back();
+    for (const auto & op : log)
+    {
+      documentOps.push_back(RefCounted<const LogOperation>::Borrow(reinterpret_cast<const LogOperation *>(op.data())));
+    }
+    numOps += log.size();
+  }
+
+  for (auto _ : state)
+  {
+    CoreHost host(state.range(0));
+
+    for (const auto & documentOps : ops)
+    {
+      host.submit(host.addDocument(), documentOps);
+    }
+
+    host.wait();
+  }
+
+  state.SetItemsProcessed(state.iterations() * numOps);
+}
+BENCHMARK(BM_CoreHostReplay)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+//the same documents replayed one after another on the calling thread
+static void BM_CoreHostReplaySequential(benchmark::State & state)
+{
+  const auto & logs = getDocumentLogs();
+
+  size_t numOps = 0;
+  for (const auto & log : logs)
+  {
+    numOps += log.size();
+  }
+
+  for (auto _ : state)
+  {
+    for (const auto & log : logs)
+    {
+      CoreInit coreInit;
+      Core core(coreInit);
+      applyOperations(core, log);
+      benchmark::DoNotOptimize(core.clock);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * numOps);
+}
+BENCHMARK(BM_CoreHostReplaySequential)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include "Workloads.h"
+#include "Random.h"
+
+//each site appends its own chain to the same empty list, so every edge
+//created after the first chain has to be ordered against all the
+//concurrent chains before it
+static void BM_ListNodeConcurrentChains(benchmark::State & state)
+{
+  auto workload = generateConcurrentListWorkload(state.range(0), state.range(1));
+  benchmarkApply(state, workload);
+}
+BENCHMARK(BM_ListNodeConcurrentChains)
+  ->Args({ 2, 1000 })
+  ->Args({ 16, 250 })
+  ->Args({ 64, 50 })
+  ->Unit(benchmark::kMillisecond);
+
+static EdgeId createListEdgeAt(ListNode & list, size_t index, uint32_t clock)
+{
+  static const AttributeMap attributes;
+  ListEdge * prevEdge = (index > 0) ? list.getChildAt(index - 1) : nullptr;
+
+  EdgeId edgeId = { Timestamp(clock, 1), 0 };
+  list.createEdge(edgeId, { Timestamp(clock, 1), 1 },
+    prevEdge ? prevEdge->edgeId : EdgeId::Null, &attributes, [](EdgeEvent &){});
+  return edgeId;
+}
+
+//builds a list by inserting at random positions (e.g. loading a large
+//timeline), directly on the node so that only the list itself is timed
+static void BM_ListNodeRandomInsert(benchmark::State & state)
+{
+  for (auto _ : state)
+  {
+    ListNode list;
+    Random random;
+
+    for (int64_t i = 0; i < state.range(0); i++)
+    {
+      createListEdgeAt(list, random.nextIndex(list.getChildCount() + 1), static_cast<uint32_t>(i + 1));
+    }
+
+    benchmark::DoNotOptimize(list.getChildCount());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListNodeRandomInsert)->Arg(10000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+//inserting, removing and deleting edges at random positions of a large list
+static void BM_ListNodeEditLargeList(benchmark::State & state)
+{
+  ListNode list;
+  Random random;
+  uint32_t clock = 0;
+  for (int64_t i = 0; i < state.range(0); i++)
+  {
+    createListEdgeAt(list, random.nextIndex(list.getChildCount() + 1), ++clock);
+  }
+
+  for (auto _ : state)
+  {
+    createListEdgeAt(list, random.nextIndex(list.getChildCount() + 1), ++clock);
+
+    EdgeId edgeId = list.getChildAt(random.nextIndex(list.getChildCount()))->edgeId;
+    list.updateEdgeEffect(edgeId, -1, false, [](EdgeEvent &){});
+    list.deleteEdge(edgeId, [](EdgeEvent &){});
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ListNodeEditLargeList)->Arg(10000)->Arg(1000000);
@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <LogSegment.h>
+#include "Random.h"
+#include "Workloads.h"
+
+static const OperationLogStorage & getWorkload()
+{
+  static const OperationLogStorage log = generateMixedWorkload(20000);
+  return log;
+}
+
+static std::string getSegmentPath()
+{
+  return (std::filesystem::temp_directory_path() / "crdbl_benchmark_segment").string();
+}
+
+static void removeSegment(const std::string & path)
+{
+  std::filesystem::remove(path);
+  std::filesystem::remove(path + ".index");
+}
+
+static void appendWorkload(LogSegment & segment, size_t repeat)
+{
+  auto ops = referenceOperations(getWorkload());
+  for (size_t i = 0; i < repeat; i++)
+  {
+    for (const auto & op : ops)
+    {
+      segment.append(op);
+    }
+  }
+  releaseOperations(ops);
+}
+
+static void BM_LogSegmentAppend(benchmark::State & state)
+{
+  std::string path = getSegmentPath();
+  size_t bytes = 0;
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    removeSegment(path);
+    LogSegment segment;
+    segment.open(path);
+    state.ResumeTiming();
+
+    appendWorkload(segment, 1);
+
+    state.PauseTiming();
+    bytes = segment.getData().size();
+    segment.close();
+    state.ResumeTiming();
+  }
+
+  removeSegment(path);
+  state.SetItemsProcessed(state.iterations() * getWorkload().size());
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_LogSegmentAppend)->Unit(benchmark::kMillisecond);
+
+//opening doesn't depend on the size of the log
+static void BM_LogSegmentOpen(benchmark::State & state)
+{
+  std::string path = getSegmentPath();
+  removeSegment(path);
+  {
+    LogSegment segment;
+    segment.open(path);
+    appendWorkload(segment, state.range(0));
+  }
+
+  for (auto _ : state)
+  {
+    LogSegment segment;
+    segment.open(path);
+    benchmark::DoNotOptimize(segment.getOperationCount());
+  }
+
+  removeSegment(path);
+}
+BENCHMARK(BM_LogSegmentOpen)->Arg(1)->Arg(20)->Unit(benchmark::kMicrosecond);
+
+static void BM_LogSegmentRandomAccess(benchmark::State & state)
+{
+  std::string path = getSegmentPath();
+  removeSegment(path);
+  LogSegment segment;
+  segment.open(path);
+  appendWorkload(segment, 1);
+
+  Random random;
+  size_t count = segment.getOperationCount();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(segment.getOperation(random.nextIndex(count))->ts);
+  }
+
+  segment.close();
+  removeSegment(path);
+}
+BENCHMARK(BM_LogSegmentRandomAccess);
+
+static void BM_LogSegmentFindOperation(benchmark::State & state)
+{
+  std::string path = getSegmentPath();
+  removeSegment(path);
+  LogSegment segment;
+  segment.open(path);
+  appendWorkload(segment, 1);
+
+  Random random;
+  uint32_t maxClock = segment.getVectorClock().getMaxClock();
+  for (auto _ : state)
+  {
+    auto clock = static_cast<uint32_t>(random.nextIndex(maxClock)) + 1;
+    benchmark::DoNotOptimize(segment.findOperation(Timestamp(clock, 1)));
+  }
+
+  segment.close();
+  removeSegment(path);
+}
+BENCHMARK(BM_LogSegmentFindOperation);
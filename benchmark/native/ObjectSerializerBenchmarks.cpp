@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+#include "Workloads.h"
+#include <JsonSerializer.h>
+#include <JsonBufferSerializer.h>
+#include <MessagePackSerializer.h>
+
+//a map and a list with values under them, exported one node at a time
+struct ExportDocument
+{
+  BenchmarkDocument document;
+  std::vector<NodeId> nodeIds;
+  std::vector<NodeId> containerIds;
+};
+
+static const ExportDocument & getExportDocument()
+{
+  static const ExportDocument * exportDocument = []()
+  {
+    auto exportDocument = new ExportDocument();
+    OperationBuilder & builder = exportDocument->document.builder;
+
+    NodeId mapId = builder.createNode(PrimitiveNodeTypes::Map());
+    NodeId listId = builder.createNode(PrimitiveNodeTypes::List());
+    builder.addChild(NodeId::SiteRoot, mapId, "map");
+    builder.addChild(mapId, listId, "list");
+    //(container nodes aren't included because JsonSerializer can't resume
+    //  the objects they write)
+    exportDocument->containerIds = { mapId, listId };
+
+    for (size_t i = 0; i < 10000; i++)
+    {
+      NodeId valueId = builder.createNode(PrimitiveNodeTypes::DoubleValue());
+      if (i % 2 == 0)
+      {
+        builder.addChild(mapId, valueId, "key" + std::to_string(i));
+      }
+      else
+      {
+        builder.addChild(listId, valueId, builder.createPositionFromIndex(listId, 0));
+      }
+      exportDocument->nodeIds.push_back(valueId);
+    }
+
+    return exportDocument;
+  }();
+
+  return *exportDocument;
+}
+
+static size_t exportDocument(const ExportDocument & exportDocument, IObjectSerializer & serializer)
+{
+  const Core & core = exportDocument.document.core;
+
+  serializer.startArray();
+  for (const auto & nodeId : exportDocument.nodeIds)
+  {
+    core.serializeNode(serializer, nodeId);
+  }
+  for (const auto & nodeId : exportDocument.containerIds)
+  {
+    core.serializeNodeChildren(serializer, nodeId, false);
+  }
+  serializer.endArray();
+
+  return exportDocument.nodeIds.size();
+}
+
+static void BM_ObjectSerializerJson(benchmark::State & state)
+{
+  const auto & document = getExportDocument();
+  size_t bytes = 0;
+
+  for (auto _ : state)
+  {
+    JsonSerializer serializer;
+    exportDocument(document, serializer);
+    std::string result = serializer.result();
+    bytes += result.size();
+    benchmark::DoNotOptimize(result.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * document.nodeIds.size());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ObjectSerializerJson)->Unit(benchmark::kMillisecond);
+
+template <class T>
+static void BM_ObjectSerializerBuffer(benchmark::State & state)
+{
+  const auto & document = getExportDocument();
+  size_t bytes = 0;
+
+  //the buffer is reused between exports, as a caller exporting repeatedly would
+  T serializer;
+  for (auto _ : state)
+  {
+    serializer.clear();
+    exportDocument(document, serializer);
+    bytes += serializer.result().size();
+    benchmark::DoNotOptimize(serializer.result().data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * document.nodeIds.size());
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK_TEMPLATE(BM_ObjectSerializerBuffer, JsonBufferSerializer)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ObjectSerializerBuffer, MessagePackSerializer)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+#include <OperationFilter.h>
+#include "Workloads.h"
+
+static const OperationLogStorage & getWorkload()
+{
+  static const OperationLogStorage log = generateMixedWorkload(20000);
+  return log;
+}
+
+static void benchmarkFilter(benchmark::State & state, const OperationFilter & filter)
+{
+  const auto & log = getWorkload();
+
+  for (auto _ : state)
+  {
+    size_t count = 0;
+    for (const auto & it : log)
+    {
+      count += filter.filter(*reinterpret_cast<const LogOperation *>(it.data()));
+    }
+    benchmark::DoNotOptimize(count);
+  }
+
+  state.SetItemsProcessed(state.iterations() * log.size());
+}
+
+static void BM_OperationFilterDefault(benchmark::State & state)
+{
+  benchmarkFilter(state, OperationFilter());
+}
+BENCHMARK(BM_OperationFilterDefault)->Unit(benchmark::kMicrosecond);
+
+static void BM_OperationFilterClockRange(benchmark::State & state)
+{
+  const auto & log = getWorkload();
+  VectorTimestamp start;
+  VectorTimestamp end;
+  start.update(Timestamp(static_cast<uint32_t>(log.size() / 4), 1));
+  end.update(Timestamp(static_cast<uint32_t>(log.size() / 2), 1));
+
+  OperationFilter filter;
+  filter.setClockRange(start, end);
+  benchmarkFilter(state, filter);
+}
+BENCHMARK(BM_OperationFilterClockRange)->Unit(benchmark::kMicrosecond);
+
+static void BM_OperationFilterTagClockRange(benchmark::State & state)
+{
+  const auto & log = getWorkload();
+  VectorTimestamp start;
+  VectorTimestamp end;
+  end.update(Timestamp(static_cast<uint32_t>(log.size() / 2), 1));
+
+  OperationFilter filter;
+  filter.setTagClockRange(Tag::Default(), start, end);
+  benchmarkFilter(state, filter);
+}
+BENCHMARK(BM_OperationFilterTagClockRange)->Unit(benchmark::kMicrosecond);
+
+static void BM_OperationFilterSite(benchmark::State & state)
+{
+  OperationFilter filter;
+  filter.setSiteFilter(1).setSiteFilterInvert(true);
+  benchmarkFilter(state, filter);
+}
+BENCHMARK(BM_OperationFilterSite)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+//same generator as benchmark/random.js so that native and web workloads line up
+class Random
+{
+public:
+  Random(uint32_t seed = 123456789) : state(seed) {}
+
+  double next()
+  {
+    uint32_t t = state += 0x6D2B79F5;
+    t = (t ^ (t >> 15)) * (t | 1);
+    t ^= t + (t ^ (t >> 7)) * (t | 61);
+    return static_cast<double>(t ^ (t >> 14)) / 4294967296.0;
+  }
+
+  //uniform integer in [0, max)
+  size_t nextIndex(size_t max)
+  {
+    return static_cast<size_t>(next() * max);
+  }
+
+private:
+  uint32_t state;
+};
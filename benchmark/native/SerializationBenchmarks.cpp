@@ -0,0 +1,155 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <Serialization/LogOperationSerialization.h>
+#include "Workloads.h"
+
+static const OperationLogStorage & getWorkload()
+{
+  static const OperationLogStorage log = generateMixedWorkload(20000);
+  return log;
+}
+
+static size_t getLogSize(const OperationLogStorage & log)
+{
+  size_t size = 0;
+  for (const auto & it : log)
+  {
+    size += it.size();
+  }
+  return size;
+}
+
+static std::string serializeLog(const std::string & format, const OperationLogStorage & log)
+{
+  std::string output;
+  auto serializer = std::unique_ptr<ILogOperationSerializer>(
+    LogOperationSerialization::CreateSerializer(format));
+  CallbackWritableStream<std::string_view> outputStream([&](const std::string_view & data)
+  {
+    output.append(data);
+  });
+
+  serializer->pipeTo(outputStream);
+
+  for (const auto & it : log)
+  {
+    RefCounted<const LogOperation> rc(reinterpret_cast<const LogOperation *>(it.data()));
+    serializer->write(rc);
+    rc.release();
+  }
+
+  serializer->close();
+  return output;
+}
+
+static void BM_Serialize(benchmark::State & state, const char * format)
+{
+  const auto & log = getWorkload();
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(serializeLog(format, log));
+  }
+
+  state.SetItemsProcessed(state.iterations() * log.size());
+  state.SetBytesProcessed(state.iterations() * getLogSize(log));
+}
+BENCHMARK_CAPTURE(BM_Serialize, standard_v1_full, "standard_v1_full")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Serialize, standard_v1_forward, "standard_v1_forward")->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Serialize, standard_v1_untagged, "standard_v1_untagged")->Unit(benchmark::kMicrosecond);
+
+static void BM_Deserialize(benchmark::State & state, const char * format, DeserializeDirection direction)
+{
+  const auto & log = getWorkload();
+  std::string data = serializeLog(format, log);
+
+  for (auto _ : state)
+  {
+    size_t count = 0;
+    auto deserializer = std::unique_ptr<ILogOperationDeserializer>(
+      LogOperationSerialization::CreateDeserializer(format, direction));
+    CallbackWritableStream<RefCounted<const LogOperation>> outputStream(
+      [&](const RefCounted<const LogOperation> & op)
+      {
+        count++;
+      });
+
+    deserializer->pipeTo(outputStream);
+    deserializer->write(std::string_view(data));
+    deserializer->close();
+
+    if (count != log.size())
+    {
+      state.SkipWithError("deserialized operation count does not match");
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * log.size());
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK_CAPTURE(BM_Deserialize, standard_v1_full, "standard_v1_full", DeserializeDirection::Forward)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Deserialize, standard_v1_full_reverse, "standard_v1_full", DeserializeDirection::Reverse)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Deserialize, standard_v1_forward, "standard_v1_forward", DeserializeDirection::Forward)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_Deserialize, standard_v1_untagged, "standard_v1_untagged", DeserializeDirection::Forward)->Unit(benchmark::kMicrosecond);
+
+//input arrives in fixed size chunks, as it would from a file or socket;
+//  reverse scans get the chunks back to front
+static void BM_DeserializeChunked(benchmark::State & state, const char * format,
+  DeserializeDirection direction, bool zeroCopy)
+{
+  const auto & log = getWorkload();
+  std::string data = serializeLog(format, log);
+  const size_t chunkSize = 4096;
+
+  for (auto _ : state)
+  {
+    size_t count = 0;
+    auto deserializer = std::unique_ptr<ILogOperationDeserializer>(
+      LogOperationSerialization::CreateDeserializer(format, direction));
+    deserializer->setZeroCopy(zeroCopy);
+    CallbackWritableStream<RefCounted<const LogOperation>> outputStream(
+      [&](const RefCounted<const LogOperation> & op)
+      {
+        benchmark::DoNotOptimize(op->ts);
+        count++;
+      });
+
+    deserializer->pipeTo(outputStream);
+    for (size_t offset = 0; offset < data.size(); offset += chunkSize)
+    {
+      if (direction == DeserializeDirection::Forward)
+      {
+        deserializer->write(std::string_view(data).substr(offset, chunkSize));
+      }
+      else
+      {
+        size_t end = data.size() - offset;
+        size_t start = (end > chunkSize) ? end - chunkSize : 0;
+        deserializer->write(std::string_view(data).substr(start, end - start));
+      }
+    }
+    deserializer->close();
+
+    if (count != log.size())
+    {
+      state.SkipWithError("deserialized operation count does not match");
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * log.size());
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK_CAPTURE(BM_DeserializeChunked, standard_v1_full, "standard_v1_full",
+  DeserializeDirection::Forward, false)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DeserializeChunked, standard_v1_full_zero_copy, "standard_v1_full",
+  DeserializeDirection::Forward, true)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DeserializeChunked, standard_v1_full_reverse, "standard_v1_full",
+  DeserializeDirection::Reverse, false)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DeserializeChunked, standard_v1_full_reverse_zero_copy, "standard_v1_full",
+  DeserializeDirection::Reverse, true)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DeserializeChunked, standard_v1_untagged, "standard_v1_untagged",
+  DeserializeDirection::Forward, false)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DeserializeChunked, standard_v1_untagged_reverse, "standard_v1_untagged",
+  DeserializeDirection::Reverse, false)->Unit(benchmark::kMicrosecond);
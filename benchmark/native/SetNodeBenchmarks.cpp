@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include "Workloads.h"
+#include "Random.h"
+#include <JsonBufferSerializer.h>
+
+//removing random members of a large set and undoing the removal (e.g. tags
+//on assets), directly on the node so that only the set itself is timed
+static void BM_SetNodeRemoveAndUndo(benchmark::State & state)
+{
+  static const AttributeMap attributes;
+  SetNode set;
+  Random random;
+  std::vector<EdgeId> edgeIds;
+  for (int64_t i = 0; i < state.range(0); i++)
+  {
+    Timestamp ts(static_cast<uint32_t>(i + 1), 1);
+    edgeIds.push_back({ ts, 0 });
+    set.createEdge(edgeIds.back(), { ts, 1 }, &attributes, [](EdgeEvent &){});
+  }
+
+  for (auto _ : state)
+  {
+    const EdgeId & edgeId = edgeIds[random.nextIndex(edgeIds.size())];
+    set.updateEdgeEffect(edgeId, -1, false, [](EdgeEvent &){});
+    set.updateEdgeEffect(edgeId, 1, false, [](EdgeEvent &){});
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SetNodeRemoveAndUndo)->Arg(1000)->Arg(100000);
+
+//a set with a few members after many members were added and removed again
+//  (e.g. tags that came and went), exported; removed edges aren't children,
+//  so the export takes as long however much churn there was
+static void BM_SetNodeChurnSerialize(benchmark::State & state)
+{
+  static const AttributeMap attributes;
+  SetNode set;
+  uint32_t clock = 1;
+  for (int64_t i = 0; i < state.range(0); i++)
+  {
+    Timestamp ts(clock++, 1);
+    set.createEdge({ ts, 0 }, { ts, 1 }, &attributes, nullptr);
+    set.updateEdgeEffect({ ts, 0 }, -1, false, nullptr);
+  }
+  for (int i = 0; i < 100; i++)
+  {
+    Timestamp ts(clock++, 1);
+    set.createEdge({ ts, 0 }, { ts, 1 }, &attributes, nullptr);
+  }
+
+  JsonBufferSerializer serializer;
+  for (auto _ : state)
+  {
+    serializer.clear();
+    set.serializeChildren(serializer, false);
+    benchmark::DoNotOptimize(serializer.result().data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * 100);
+}
+BENCHMARK(BM_SetNodeChurnSerialize)->Arg(0)->Arg(100000);
@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+#include "Workloads.h"
+
+static const OperationLogStorage & getMixedWorkload()
+{
+  static const OperationLogStorage log = generateMixedWorkload(20000);
+  return log;
+}
+
+static const std::basic_string<char> & getSnapshot()
+{
+  static const std::basic_string<char> snapshot = []()
+  {
+    CoreInit coreInit;
+    Core core(coreInit);
+    applyOperations(core, getMixedWorkload());
+
+    std::basic_string<char> output;
+    core.saveSnapshot(output);
+    return output;
+  }();
+  return snapshot;
+}
+
+static void BM_SnapshotSave(benchmark::State & state)
+{
+  CoreInit coreInit;
+  Core core(coreInit);
+  applyOperations(core, getMixedWorkload());
+
+  for (auto _ : state)
+  {
+    std::basic_string<char> output;
+    core.saveSnapshot(output);
+    benchmark::DoNotOptimize(output.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * getSnapshot().size());
+}
+BENCHMARK(BM_SnapshotSave)->Unit(benchmark::kMillisecond);
+
+static void BM_SnapshotLoad(benchmark::State & state)
+{
+  const auto & snapshot = getSnapshot();
+
+  for (auto _ : state)
+  {
+    CoreInit coreInit;
+    Core core(coreInit);
+
+    core.loadSnapshot(snapshot);
+
+    benchmark::DoNotOptimize(core.clock);
+  }
+
+  state.SetBytesProcessed(state.iterations() * snapshot.size());
+}
+BENCHMARK(BM_SnapshotLoad)->Unit(benchmark::kMillisecond);
+
+//the same state rebuilt by replaying the whole log, for comparison
+static void BM_SnapshotReplayLog(benchmark::State & state)
+{
+  auto ops = referenceOperations(getMixedWorkload());
+
+  for (auto _ : state)
+  {
+    CoreInit coreInit;
+    Core core(coreInit);
+
+    core.applyOperations(ops);
+
+    benchmark::DoNotOptimize(core.clock);
+  }
+
+  state.SetItemsProcessed(state.iterations() * ops.size());
+  releaseOperations(ops);
+}
+BENCHMARK(BM_SnapshotReplayLog)->Unit(benchmark::kMillisecond);
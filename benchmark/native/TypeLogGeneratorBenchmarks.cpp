@@ -0,0 +1,29 @@
+#include <benchmark/benchmark.h>
+#include <TypeLogGenerator.h>
+#include "Workloads.h"
+
+static void BM_TypeLogGeneratorGenerate(benchmark::State & state)
+{
+  BenchmarkDocument document;
+  document.applyLog(generateMixedWorkload(state.range(0)));
+
+  size_t count = 0;
+
+  for (auto _ : state)
+  {
+    count = 0;
+    CallbackWritableStream<RefCounted<const LogOperation>> outputStream(
+      [&](const RefCounted<const LogOperation> & op)
+      {
+        count++;
+      });
+
+    TypeLogGenerator generator(&document.core);
+    generator.addAllNodes(NodeId::SiteRoot);
+    generator.generate(outputStream);
+  }
+
+  //items are generated operations
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_TypeLogGeneratorGenerate)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
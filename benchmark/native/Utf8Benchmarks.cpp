@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include <Utf8.h>
+#include <string>
+#include <vector>
+#include "Random.h"
+
+enum Corpus { Ascii, Cjk, Emoji };
+
+//mostly the corpus' own characters, mixed with some ASCII as real text is
+static std::string generateCorpus(Corpus corpus, size_t length)
+{
+  static const std::vector<std::string> ascii = { "e", "t", "a", "o", " ", "\n", "," };
+  static const std::vector<std::string> cjk = { "\xE4\xB8\xAD", "\xE6\x96\x87", "\xE5\xAD\x97", "\xE3\x80\x82" };
+  static const std::vector<std::string> emoji = { "\xF0\x9F\x98\x80", "\xF0\x9F\x91\x8D", "\xE2\x9D\xA4" };
+
+  const auto & characters = corpus == Ascii ? ascii : corpus == Cjk ? cjk : emoji;
+  Random random(42);
+  std::string text;
+  while (text.size() < length)
+  {
+    const auto & pool = random.next() < 0.8 ? characters : ascii;
+    text += pool[random.nextIndex(pool.size())];
+  }
+  return text;
+}
+
+template <bool Vectorized>
+static void BM_Utf8ToUtf16Length(benchmark::State & state)
+{
+  std::string text = generateCorpus(static_cast<Corpus>(state.range(0)), state.range(1));
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(Vectorized
+      ? Utf8ToUtf16Length(text.data(), text.size())
+      : Utf8ToUtf16LengthScalar(text.data(), text.size()));
+  }
+
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK_TEMPLATE(BM_Utf8ToUtf16Length, true)->ArgsProduct({ { Ascii, Cjk, Emoji }, { 64, 4096, 65536 } });
+BENCHMARK_TEMPLATE(BM_Utf8ToUtf16Length, false)->ArgsProduct({ { Ascii, Cjk, Emoji }, { 64, 4096, 65536 } });
+
+template <bool Vectorized>
+static void BM_Utf8FindUtf16Offset(benchmark::State & state)
+{
+  std::string text = generateCorpus(static_cast<Corpus>(state.range(0)), state.range(1));
+  size_t utf16Length = Utf8ToUtf16LengthScalar(text.data(), text.size());
+  Random random(7);
+
+  for (auto _ : state)
+  {
+    size_t codeUnits = random.nextIndex(utf16Length) + 1;
+    benchmark::DoNotOptimize(Vectorized
+      ? Utf8FindUtf16Offset(text.data(), text.size(), codeUnits)
+      : Utf8FindUtf16OffsetScalar(text.data(), text.size(), codeUnits));
+  }
+}
+BENCHMARK_TEMPLATE(BM_Utf8FindUtf16Offset, true)->ArgsProduct({ { Ascii, Cjk, Emoji }, { 64, 4096, 65536 } });
+BENCHMARK_TEMPLATE(BM_Utf8FindUtf16Offset, false)->ArgsProduct({ { Ascii, Cjk, Emoji }, { 64, 4096, 65536 } });
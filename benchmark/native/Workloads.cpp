@@ -0,0 +1,294 @@
+#include "Workloads.h"
+#include "Random.h"
+
+BenchmarkDocument::BenchmarkDocument(uint32_t siteId)
+  :
+    core(coreInit),
+    builder(&core, siteId),
+    builderCallbackStream(new CallbackWritableStream<RefCounted<const LogOperation>>(
+      [&](const RefCounted<const LogOperation> & op)
+      {
+        log.push_back(std::basic_string<char>(reinterpret_cast<const char *>(&(*op)), op->getSize()));
+        core.applyOperation(op);
+      },
+      [](){})
+    )
+{
+  builder.getReadableStream().pipeTo(*builderCallbackStream);
+}
+
+BenchmarkDocument::~BenchmarkDocument()
+{
+  delete builderCallbackStream;
+}
+
+void BenchmarkDocument::applyLog(const OperationLogStorage & log)
+{
+  applyOperations(core, log);
+}
+
+//everything recorded so far becomes setup; everything after is benchmarked
+static ApplyWorkload splitLog(OperationLogStorage & log, size_t setupSize)
+{
+  ApplyWorkload workload;
+  workload.setup.assign(std::make_move_iterator(log.begin()),
+    std::make_move_iterator(log.begin() + setupSize));
+  workload.ops.assign(std::make_move_iterator(log.begin() + setupSize),
+    std::make_move_iterator(log.end()));
+  return workload;
+}
+
+OperationLogStorage generateMixedWorkload(size_t numEdits, uint32_t seed)
+{
+  Random random(seed);
+  BenchmarkDocument document;
+  OperationBuilder & builder = document.builder;
+
+  NodeId mapId = builder.createNode(PrimitiveNodeTypes::Map());
+  NodeId listId = builder.createNode(PrimitiveNodeTypes::List());
+  NodeId stringId = builder.createNode(PrimitiveNodeTypes::StringValue());
+  builder.addChild(NodeId::SiteRoot, mapId, "map");
+  builder.addChild(NodeId::SiteRoot, listId, "list");
+  builder.addChild(NodeId::SiteRoot, stringId, "string");
+
+  std::vector<NodeId> values;
+  size_t listLength = 0;
+  size_t textLength = 0;
+
+  for (size_t i = 0; i < numEdits; i++)
+  {
+    double rand = random.next();
+
+    if (rand < 0.2 || values.empty())
+    {
+      NodeId valueId = builder.createNode(PrimitiveNodeTypes::DoubleValue());
+      builder.setValue<double>(valueId, random.next());
+      builder.addChild(mapId, valueId, "key" + std::to_string(random.nextIndex(numEdits)));
+      values.push_back(valueId);
+    }
+    else if (rand < 0.4)
+    {
+      builder.setValue<double>(values[random.nextIndex(values.size())], random.next());
+    }
+    else if (rand < 0.55)
+    {
+      NodeId valueId = builder.createNode(PrimitiveNodeTypes::DoubleValue());
+      std::string position = builder.createPositionFromIndex(listId, random.nextIndex(listLength + 1));
+      builder.addChild(listId, valueId, position);
+      listLength++;
+    }
+    else if (rand < 0.9 || textLength == 0)
+    {
+      std::string text(random.nextIndex(10) + 1, 'a');
+      //mostly typing at the end, sometimes somewhere else
+      size_t offset = random.next() < 0.9 ? textLength : random.nextIndex(textLength + 1);
+      builder.insertText(stringId, offset, text);
+      textLength += text.length();
+    }
+    else
+    {
+      size_t length = random.nextIndex(std::min<size_t>(10, textLength)) + 1;
+      builder.deleteText(stringId, textLength - length, length);
+      textLength -= length;
+    }
+  }
+
+  return std::move(document.log);
+}
+
+ApplyWorkload generateNodeCreateWorkload(size_t count)
+{
+  BenchmarkDocument document;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    document.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+  }
+
+  return splitLog(document.log, 0);
+}
+
+ApplyWorkload generateMapEdgeCreateWorkload(size_t count, uint32_t seed)
+{
+  Random random(seed);
+  BenchmarkDocument document;
+  OperationBuilder & builder = document.builder;
+
+  NodeId mapId = builder.createNode(PrimitiveNodeTypes::Map());
+  std::vector<NodeId> values;
+  for (size_t i = 0; i < count; i++)
+  {
+    values.push_back(builder.createNode(PrimitiveNodeTypes::DoubleValue()));
+  }
+
+  size_t setupSize = document.log.size();
+
+  for (size_t i = 0; i < count; i++)
+  {
+    //keys collide some of the time so that some edges replace others
+    builder.addChild(mapId, values[i], "key" + std::to_string(random.nextIndex(count)));
+  }
+
+  return splitLog(document.log, setupSize);
+}
+
+ApplyWorkload generateValueSetWorkload(size_t count, uint32_t seed)
+{
+  Random random(seed);
+  BenchmarkDocument document;
+  OperationBuilder & builder = document.builder;
+
+  std::vector<NodeId> values;
+  for (size_t i = 0; i < 100; i++)
+  {
+    values.push_back(builder.createNode(PrimitiveNodeTypes::DoubleValue()));
+  }
+
+  size_t setupSize = document.log.size();
+
+  for (size_t i = 0; i < count; i++)
+  {
+    builder.setValue<double>(values[random.nextIndex(values.size())], random.next());
+  }
+
+  return splitLog(document.log, setupSize);
+}
+
+ApplyWorkload generateTextInsertWorkload(size_t count, uint32_t seed)
+{
+  Random random(seed);
+  BenchmarkDocument document;
+  OperationBuilder & builder = document.builder;
+
+  NodeId stringId = builder.createNode(PrimitiveNodeTypes::StringValue());
+  size_t setupSize = document.log.size();
+  size_t textLength = 0;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    std::string text(random.nextIndex(10) + 1, 'a');
+    size_t offset = random.next() < 0.9 ? textLength : random.nextIndex(textLength + 1);
+    builder.insertText(stringId, offset, text);
+    textLength += text.length();
+  }
+
+  return splitLog(document.log, setupSize);
+}
+
+ApplyWorkload generateTextDeleteWorkload(size_t count, uint32_t seed)
+{
+  Random random(seed);
+  BenchmarkDocument document;
+  OperationBuilder & builder = document.builder;
+
+  NodeId stringId = builder.createNode(PrimitiveNodeTypes::StringValue());
+  size_t textLength = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    std::string text(random.nextIndex(10) + 1, 'a');
+    builder.insertText(stringId, textLength, text);
+    textLength += text.length();
+  }
+
+  size_t setupSize = document.log.size();
+
+  for (size_t i = 0; i < count && textLength > 0; i++)
+  {
+    size_t length = random.nextIndex(std::min<size_t>(10, textLength)) + 1;
+    size_t offset = random.nextIndex(textLength - length + 1);
+    builder.deleteText(stringId, offset, length);
+    textLength -= length;
+  }
+
+  return splitLog(document.log, setupSize);
+}
+
+ApplyWorkload generateConcurrentListWorkload(size_t numSites, size_t chainLength)
+{
+  ApplyWorkload workload;
+  NodeId listId;
+
+  {
+    BenchmarkDocument document;
+    listId = document.builder.createNode(PrimitiveNodeTypes::List());
+    document.builder.addChild(NodeId::SiteRoot, listId, "list");
+    workload.setup = std::move(document.log);
+  }
+
+  //every site only sees the empty list, so all of the chains are concurrent
+  for (size_t site = 0; site < numSites; site++)
+  {
+    BenchmarkDocument document(static_cast<uint32_t>(site + 2));
+    document.applyLog(workload.setup);
+
+    for (size_t i = 0; i < chainLength; i++)
+    {
+      NodeId valueId = document.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+      document.builder.addChild(listId, valueId,
+        document.builder.createPositionFromIndex(listId, i));
+    }
+
+    workload.ops.insert(workload.ops.end(),
+      std::make_move_iterator(document.log.begin()),
+      std::make_move_iterator(document.log.end()));
+  }
+
+  return workload;
+}
+
+std::vector<RefCounted<const LogOperation>> referenceOperations(const OperationLogStorage & log)
+{
+  std::vector<RefCounted<const LogOperation>> ops;
+  ops.reserve(log.size());
+  for (const auto & it : log)
+  {
+    ops.emplace_back(reinterpret_cast<const LogOperation *>(it.data()));
+  }
+  return ops;
+}
+
+void releaseOperations(std::vector<RefCounted<const LogOperation>> & ops)
+{
+  for (auto & op : ops)
+  {
+    op.release();
+  }
+  ops.clear();
+}
+
+void applyOperations(Core & core, const OperationLogStorage & log)
+{
+  for (const auto & it : log)
+  {
+    RefCounted<const LogOperation> rc(reinterpret_cast<const LogOperation *>(it.data()));
+    core.applyOperation(rc);
+    rc.release();
+  }
+}
+
+void benchmarkApply(benchmark::State & state, const ApplyWorkload & workload)
+{
+  auto ops = referenceOperations(workload.ops);
+
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto * coreInit = new CoreInit();
+    auto * core = new Core(*coreInit);
+    applyOperations(*core, workload.setup);
+    state.ResumeTiming();
+
+    for (const auto & op : ops)
+    {
+      core->applyOperation(op);
+    }
+
+    state.PauseTiming();
+    delete core;
+    delete coreInit;
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * ops.size());
+  releaseOperations(ops);
+}
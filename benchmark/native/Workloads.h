@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <Core.h>
+#include <OperationBuilder.h>
+#include <RefCounted.h>
+#include <Streams/CallbackWritableStream.h>
+#include <benchmark/benchmark.h>
+
+using OperationLogStorage = std::vector<std::basic_string<char>>;
+
+//a core with an operation builder whose operations are applied and recorded
+struct BenchmarkDocument
+{
+  BenchmarkDocument(uint32_t siteId = 1);
+  ~BenchmarkDocument();
+
+  void applyLog(const OperationLogStorage & log);
+
+  CoreInit coreInit;
+  Core core;
+  OperationBuilder builder;
+  OperationLogStorage log;
+
+  CallbackWritableStream<RefCounted<const LogOperation>> * builderCallbackStream;
+};
+
+//operations to benchmark along with the operations they depend on, which
+//are applied outside of the timed region
+struct ApplyWorkload
+{
+  OperationLogStorage setup;
+  OperationLogStorage ops;
+};
+
+//all workloads are built from a seeded random sequence so that every run
+//applies exactly the same operations
+
+//map of values, a list and a string being edited
+OperationLogStorage generateMixedWorkload(size_t numEdits, uint32_t seed = 123456789);
+
+ApplyWorkload generateNodeCreateWorkload(size_t count);
+ApplyWorkload generateMapEdgeCreateWorkload(size_t count, uint32_t seed = 123456789);
+ApplyWorkload generateValueSetWorkload(size_t count, uint32_t seed = 123456789);
+//mostly typing at the end of a string, with some random inserts
+ApplyWorkload generateTextInsertWorkload(size_t count, uint32_t seed = 123456789);
+ApplyWorkload generateTextDeleteWorkload(size_t count, uint32_t seed = 123456789);
+//numSites sites each appending a chain of chainLength items to the same empty
+//list concurrently
+ApplyWorkload generateConcurrentListWorkload(size_t numSites, size_t chainLength);
+
+//references to operations stored in a log; the references do not own the
+//operations and must be released with releaseOperations
+std::vector<RefCounted<const LogOperation>> referenceOperations(const OperationLogStorage & log);
+void releaseOperations(std::vector<RefCounted<const LogOperation>> & ops);
+
+void applyOperations(Core & core, const OperationLogStorage & log);
+
+//applies the setup operations to a fresh core untimed, then times applying
+//the workload operations one at a time
+void benchmarkApply(benchmark::State & state, const ApplyWorkload & workload);
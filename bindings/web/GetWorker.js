@@ -51,6 +51,24 @@ function applyWrappers() {
       includePending);
   };
 
+  Module.ProjectDB.prototype.getSubtree = function(nodeId, includePending, maxDepth)
+  {
+    if (includePending === undefined)
+    {
+      includePending = false;
+    }
+
+    if (maxDepth === undefined)
+    {
+      maxDepth = 0xFFFFFFFF;
+    }
+
+    const nodeId_parsed = parseNodeId(nodeId);
+    return this.getSubtree_raw(
+      nodeId_parsed[0], nodeId_parsed[1], nodeId_parsed[2],
+      includePending, maxDepth);
+  };
+
   Module.ProjectDB.prototype.getNode = function(nodeId)
   {
     const nodeId_parsed = parseNodeId(nodeId);
@@ -68,6 +86,25 @@ function applyWrappers() {
     const nodeId_parsed = parseNodeId(nodeId);
     return this.getNodeBlockValue_raw(nodeId_parsed[0], nodeId_parsed[1], nodeId_parsed[2]);
   }
+
+  //decoded from the cached UTF-16 text, so offsets match JS string offsets
+  const utf16Decoder = new TextDecoder("utf-16le");
+  Module.ProjectDB.prototype.getNodeBlockValueRange = function(nodeId, offset, length)
+  {
+    if (offset === undefined)
+    {
+      offset = 0;
+    }
+
+    if (length === undefined)
+    {
+      length = 0xFFFFFFFF;
+    }
+
+    const nodeId_parsed = parseNodeId(nodeId);
+    return utf16Decoder.decode(this.getNodeBlockValueUtf16_raw(
+      nodeId_parsed[0], nodeId_parsed[1], nodeId_parsed[2], offset, length));
+  }
 }
 
 if (Module["ProjectDB"])
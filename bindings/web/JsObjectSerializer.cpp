@@ -77,74 +77,74 @@ void JsObjectSerializer::resumeArray()
   lastPopped = val::null();
 }
 
-void JsObjectSerializer::addPair(const std::string & key, bool value)
+void JsObjectSerializer::addPair(std::string_view key, bool value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, const std::string & value)
+void JsObjectSerializer::addPair(std::string_view key, std::string_view value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(std::string(value)));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, const char * value)
+void JsObjectSerializer::addPair(std::string_view key, const char * value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, const Timestamp & value)
+void JsObjectSerializer::addPair(std::string_view key, const Timestamp & value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, const NodeId & value)
+void JsObjectSerializer::addPair(std::string_view key, const NodeId & value)
 {
-  ctxStack.back().set(key.c_str(), val(value.toString()));
+  ctxStack.back().set(std::string(key).c_str(), val(value.toString()));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, size_t value)
+void JsObjectSerializer::addPair(std::string_view key, size_t value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, uint32_t value)
+void JsObjectSerializer::addPair(std::string_view key, uint32_t value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, double value)
+void JsObjectSerializer::addPair(std::string_view key, double value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, float value)
+void JsObjectSerializer::addPair(std::string_view key, float value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, int32_t value)
+void JsObjectSerializer::addPair(std::string_view key, int32_t value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, int64_t value)
+void JsObjectSerializer::addPair(std::string_view key, int64_t value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addPair(const std::string & key, int8_t value)
+void JsObjectSerializer::addPair(std::string_view key, int8_t value)
 {
-  ctxStack.back().set(key.c_str(), val(value));
+  ctxStack.back().set(std::string(key).c_str(), val(value));
 }
 
-void JsObjectSerializer::addKey(const std::string & key)
+void JsObjectSerializer::addKey(std::string_view key)
 {
-  ctxStack.push_back(val(key.c_str()));
+  ctxStack.push_back(val(std::string(key).c_str()));
 }
 
-void JsObjectSerializer::addValue(const std::string & value)
+void JsObjectSerializer::addValue(std::string_view value)
 {
-  startValue(val(value), false);
+  startValue(val(std::string(value)), false);
 }
 
 void JsObjectSerializer::addNullValue()
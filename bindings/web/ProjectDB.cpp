@@ -7,10 +7,8 @@ ReaderWriterLock ProjectDB::typeCacheLock;
 std::unordered_map<std::string, std::basic_string<uint8_t>> * ProjectDB::typeCache;
 
 ProjectDB::ProjectDB(val getTypeSpecCallback,
-  val eventRaisedCallback)
-  : coreInit(
-      [this](const std::string & type){ return ProjectDB::getTypeSpecHandler(this, type); },
-      [this](const Event & evt){ return ProjectDB::eventRaisedHandler(this, evt); }),
+  val eventRaisedCallback, bool batchEvents)
+  : coreInit(createCoreInit(this, batchEvents)),
     core(coreInit),
     getTypeSpecCallback(getTypeSpecCallback),
     eventRaisedCallback(eventRaisedCallback)
@@ -29,6 +27,21 @@ ProjectDB::~ProjectDB()
   }
 }
 
+//static
+CoreInit ProjectDB::createCoreInit(ProjectDB * ctx, bool batchEvents)
+{
+  auto getTypeSpec = [ctx](const std::string & type){ return ProjectDB::getTypeSpecHandler(ctx, type); };
+
+  if (batchEvents)
+  {
+    return CoreInit::Batched(getTypeSpec,
+      [ctx](const EventBatch & events){ return ProjectDB::eventsRaisedHandler(ctx, events); });
+  }
+
+  return CoreInit(getTypeSpec,
+    [ctx](const Event & evt){ return ProjectDB::eventRaisedHandler(ctx, evt); });
+}
+
 //static
 void ProjectDB::getTypeSpecHandler(ProjectDB * ctx, std::string type)
 {
@@ -63,6 +76,23 @@ void ProjectDB::eventRaisedHandler(ProjectDB * ctx, const Event & event)
   ctx->lock.lock();
 }
 
+//static
+void ProjectDB::eventsRaisedHandler(ProjectDB * ctx, const EventBatch & events)
+{
+  if (emscripten_current_thread_is_wasm_worker())
+  {
+    throw std::runtime_error("eventsRaisedHandler called from worker thread");
+  }
+
+  //one array (and one trip out of the lock) per applied operation
+  JsObjectSerializer serializer;
+  events.serialize(serializer);
+
+  ctx->lock.unlock();
+  ctx->eventRaisedCallback(serializer.result());
+  ctx->lock.lock();
+}
+
 //static
 void ProjectDB::addType(std::string type, std::string format, val data)
 {
@@ -154,6 +184,18 @@ val ProjectDB::getNodeChildren(uint32_t clock, uint32_t site, uint32_t child, bo
   return serializer.result();
 }
 
+val ProjectDB::getSubtree(uint32_t clock, uint32_t site, uint32_t child, bool includePending, uint32_t maxDepth)
+{
+  NodeId _nodeId { Timestamp { clock, site }, child };
+
+  JsObjectSerializer serializer;
+  lock.lock_shared();
+  core.serializeSubtree(serializer, _nodeId, includePending, maxDepth);
+  lock.unlock_shared();
+
+  return serializer.result();
+}
+
 double ProjectDB::getNodeValue(uint32_t clock, uint32_t site, uint32_t child)
 {
   NodeId _nodeId { Timestamp { clock, site }, child };
@@ -177,6 +219,40 @@ std::string ProjectDB::getNodeBlockValue(uint32_t clock, uint32_t site, uint32_t
   return value;
 }
 
+val ProjectDB::getNodeBlockValueUtf16(uint32_t clock, uint32_t site, uint32_t child, uint32_t offset, uint32_t length)
+{
+  NodeId _nodeId { Timestamp { clock, site }, child };
+
+  //the cached text is copied out while the lock is held
+  lock.lock_shared();
+  std::u16string_view value = core.getNodeBlockValueUtf16View(_nodeId);
+  value = value.substr(std::min<size_t>(offset, value.size()), length);
+  val result = val::global("Uint16Array").new_(typed_memory_view(value.size(),
+    reinterpret_cast<const uint16_t *>(value.data())));
+  lock.unlock_shared();
+
+  return result;
+}
+
+ReadViewWrapper * ProjectDB::createReadView()
+{
+  //the core shares views until its state changes; when there have been
+  //  changes only the snapshot is taken under the lock, and the view is
+  //  loaded from it after the lock is released
+  lock.lock_shared();
+  auto request = core.prepareReadView();
+  lock.unlock_shared();
+
+  auto view = core.loadReadView(std::move(request));
+
+  if (view == nullptr)
+  {
+    return nullptr;
+  }
+
+  return new ReadViewWrapper(std::move(view));
+}
+
 OperationBuilder * ProjectDB::createOperationBuilder()
 {
   if (emscripten_current_thread_is_wasm_worker())
@@ -269,4 +345,4 @@ StringNodeId ProjectDB::PENDINGID()
 StringNodeId ProjectDB::INITID()
 {
   return NodeId::SiteRoot.toString();
-}
\ No newline at end of file
+}
\ No newline at end of file
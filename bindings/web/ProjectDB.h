@@ -12,6 +12,7 @@
 #include "JsObjectSerializer.h"
 #include "JsonSerializer.h"
 #include "TypeLogGeneratorWrapper.h"
+#include "ReadViewWrapper.h"
 #include "ConcurrentQueue.h"
 #include "ReaderWriterLock.h"
 #include "Worker.h"
@@ -39,15 +40,23 @@ struct OpQueueItem {
 class ProjectDB
 {
 public:
-  ProjectDB(val getTypeSpecCallback, val eventRaisedCallback);
+  //with batchEvents, the callback gets an array of the events each applied
+  //  operation raised, coalesced (see EventBatch), instead of each event
+  ProjectDB(val getTypeSpecCallback, val eventRaisedCallback, bool batchEvents = false);
   ~ProjectDB();
 
   void resolveTypeSpec(std::string type);
 
   val getNode(uint32_t clock, uint32_t site, uint32_t child);
   val getNodeChildren(uint32_t clock, uint32_t site, uint32_t child, bool includePending = false);
+  val getSubtree(uint32_t clock, uint32_t site, uint32_t child, bool includePending, uint32_t maxDepth);
   double getNodeValue(uint32_t clock, uint32_t site, uint32_t child);
   std::string getNodeBlockValue(uint32_t clock, uint32_t site, uint32_t child);
+  //a copy of the text (offset and length in UTF-16 code units) as a Uint16Array
+  val getNodeBlockValueUtf16(uint32_t clock, uint32_t site, uint32_t child, uint32_t offset, uint32_t length);
+
+  //operations waiting on type specs are left out (see Core::createReadView)
+  ReadViewWrapper * createReadView();
 
   OperationBuilder * createOperationBuilder();
   TypeLogGeneratorWrapper * createTypeLogGenerator();
@@ -82,7 +91,9 @@ private:
   static ReaderWriterLock typeCacheLock;
 
   static void getTypeSpecHandler(ProjectDB * ctx, std::string type);
+  static CoreInit createCoreInit(ProjectDB * ctx, bool batchEvents);
   static void eventRaisedHandler(ProjectDB * ctx, const Event & event);
+  static void eventsRaisedHandler(ProjectDB * ctx, const EventBatch & events);
 
   friend class OperationBuilderWrapper;
   friend class TransformOperationStreamWrapper;
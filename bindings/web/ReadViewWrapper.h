@@ -0,0 +1,59 @@
+#pragma once
+#include <emscripten/bind.h>
+#include <ReadView.h>
+#include "JsObjectSerializer.h"
+#include "StringIds.h"
+#include <memory>
+#include <string>
+
+using namespace emscripten;
+
+//A pinned copy of the database state; reads don't take the database lock,
+//  so they neither wait on nor hold up operations being applied
+class ReadViewWrapper
+{
+public:
+  ReadViewWrapper(std::shared_ptr<const ReadView> view)
+    : view(std::move(view)) {}
+
+  val getNode(const StringNodeId & nodeId)
+  {
+    JsObjectSerializer serializer;
+    view->getCore().serializeNode(serializer, stringToNodeId(nodeId));
+    return serializer.result();
+  }
+
+  val getNodeChildren(const StringNodeId & nodeId, bool includePending)
+  {
+    JsObjectSerializer serializer;
+    view->getCore().serializeNodeChildren(serializer, stringToNodeId(nodeId), includePending);
+    return serializer.result();
+  }
+
+  val getSubtree(const StringNodeId & nodeId, bool includePending, uint32_t maxDepth)
+  {
+    JsObjectSerializer serializer;
+    view->getCore().serializeSubtree(serializer, stringToNodeId(nodeId), includePending, maxDepth);
+    return serializer.result();
+  }
+
+  double getNodeValue(const StringNodeId & nodeId)
+  {
+    return view->getCore().getNodeValue(stringToNodeId(nodeId));
+  }
+
+  std::string getNodeBlockValue(const StringNodeId & nodeId)
+  {
+    std::string value;
+    view->getCore().getNodeBlockValue(value, stringToNodeId(nodeId));
+    return value;
+  }
+
+  std::string getVectorClock()
+  {
+    return view->getClock().toString();
+  }
+
+private:
+  std::shared_ptr<const ReadView> view;
+};
\ No newline at end of file
@@ -36,6 +36,13 @@ type NodeChildrenData =
   key?: string | number; //can be a float (for now)
 }[];
 
+type SubtreeData = NodeData &
+{
+  id: NodeId;
+  value?: number | string;
+  children?: (NodeChildrenData[number] & { node?: SubtreeData })[];
+};
+
 type DBEvent = any;
 // {
 //   eventType: "NodeDeleted";
@@ -155,17 +162,29 @@ export declare class Tag extends EmbindClassHandle
 export declare class ProjectDB extends EmbindClassHandle
 {
   constructor(getTypeSpecCallback: (type: string, needsData: boolean) => void,
-    eventRaisedCallback: (event: DBEvent) => void);
+    eventRaisedCallback: (event: DBEvent) => void, batchEvents?: false);
+  //the events each applied operation raised, in one call and coalesced
+  constructor(getTypeSpecCallback: (type: string, needsData: boolean) => void,
+    eventRaisedCallback: (events: DBEvent[]) => void, batchEvents: true);
 
   resolveTypeSpec(type: string): void;
 
   getNode(nodeId: NodeId): NodeData | null;
   getNodeChildren(nodeId: NodeId, includePending?: boolean): NodeChildrenData | null;
+  //the node and everything under it, down to maxDepth levels of children (64
+  //at most; deeper levels can be fetched from a node at that depth)
+  getSubtree(nodeId: NodeId, includePending?: boolean, maxDepth?: number): SubtreeData | null;
   getNodeValue(nodeId: NodeId): number;
   getNodeBlockValue(nodeId: NodeId): string;
+  //offset and length are in UTF-16 code units, like JS string offsets
+  getNodeBlockValueRange(nodeId: NodeId, offset?: number, length?: number): string;
 
   getRootNodeId(nodeId: NodeId): NodeId;
 
+  //a copy of the current state that can be read while operations keep being
+  //applied; operations waiting on type specs are left out
+  createReadView(): ReadView | null;
+
   createOperationBuilder(): OperationBuilder;
   createTypeLogGenerator(): TypeLogGenerator;
   createWorker(url: string): DBWorker;
@@ -190,6 +209,16 @@ export declare class ProjectDB extends EmbindClassHandle
   static PENDINGID(): NodeId;
 }
 
+export declare class ReadView extends EmbindClassHandle
+{
+  getNode(nodeId: NodeId): NodeData | null;
+  getNodeChildren(nodeId: NodeId, includePending: boolean): NodeChildrenData | null;
+  getSubtree(nodeId: NodeId, includePending: boolean, maxDepth: number): SubtreeData | null;
+  getNodeValue(nodeId: NodeId): number;
+  getNodeBlockValue(nodeId: NodeId): string;
+  getVectorClock(): string;
+}
+
 export declare class TypeLogGenerator extends EmbindClassHandle
 {
   addNode(nodeId: NodeId): void;
@@ -402,6 +431,7 @@ export interface crdblModule
   OperationBuilder: typeof OperationBuilder;
 
   TypeLogGenerator: typeof TypeLogGenerator;
+  ReadView: typeof ReadView;
   LogOperationSerializer: typeof LogOperationSerializer;
   LogOperationDeserializer: typeof LogOperationDeserializer;
   LogOperationSerialization: typeof LogOperationSerialization;
@@ -92,13 +92,18 @@ EMSCRIPTEN_BINDINGS(ProjectDB)
 {
   class_<ProjectDB>("ProjectDB")
     .constructor<val, val>()
+    .constructor<val, val, bool>()
 
     .function("resolveTypeSpec", &ProjectDB::resolveTypeSpec)
 
     .function("getNode_raw", &ProjectDB::getNode)
     .function("getNodeChildren_raw", &ProjectDB::getNodeChildren)
+    .function("getSubtree_raw", &ProjectDB::getSubtree)
     .function("getNodeValue_raw", &ProjectDB::getNodeValue)
     .function("getNodeBlockValue_raw", &ProjectDB::getNodeBlockValue)
+    .function("getNodeBlockValueUtf16_raw", &ProjectDB::getNodeBlockValueUtf16)
+
+    .function("createReadView", &ProjectDB::createReadView, allow_raw_pointers())
 
     .function("getVectorClock", &ProjectDB::getVectorClock, allow_raw_pointers())
 
@@ -120,6 +125,19 @@ EMSCRIPTEN_BINDINGS(ProjectDB)
     ;
 }
 
+EMSCRIPTEN_BINDINGS(ReadView)
+{
+  class_<ReadViewWrapper>("ReadView")
+
+    .function("getNode", &ReadViewWrapper::getNode)
+    .function("getNodeChildren", &ReadViewWrapper::getNodeChildren)
+    .function("getSubtree", &ReadViewWrapper::getSubtree)
+    .function("getNodeValue", &ReadViewWrapper::getNodeValue)
+    .function("getNodeBlockValue", &ReadViewWrapper::getNodeBlockValue)
+    .function("getVectorClock", &ReadViewWrapper::getVectorClock)
+    ;
+}
+
 EMSCRIPTEN_BINDINGS(TypeLogGenerator)
 {
   class_<TypeLogGeneratorWrapper>("TypeLogGenerator")
@@ -1,28 +1,10 @@
 #include "BlockValue.h"
+#include "Snapshot.h"
+#include "Utf8.h"
+#include "VectorTimestamp.h"
+#include <algorithm>
 #include <iostream>
-
-size_t getUtf16CodeUnitLength(char * str, size_t length)
-{
-  size_t utf16Length = 0;
-  size_t i = 0;
-
-  while (i < length)
-  {
-    char c = str[i];
-    if (c >= 0 && c <= 127) i += 1;
-    else if ((c & 0xE0) == 0xC0) i += 2;
-    else if ((c & 0xF0) == 0xE0) i += 3;
-    else if ((c & 0xF8) == 0xF0)
-    {
-      i += 4;
-      utf16Length++;
-    }
-
-    utf16Length++;
-  }
-
-  return utf16Length;
-}
+#include <vector>
 
 template <class T>
 uint32_t BlockData<T>::getDataLength() const
@@ -39,6 +21,18 @@ uint32_t BlockData<T>::getDataLength() const
   return length;
 }
 
+template <class T>
+uint32_t BlockData<T>::getVisibleLength() const
+{
+  return effect.isVisible() ? length : 0;
+}
+
+template <class T>
+uint32_t BlockData<T>::getVisibleUtf16Length() const
+{
+  return effect.isVisible() ? utf16Length : 0;
+}
+
 template struct BlockData<char>;
 
 template <class T>
@@ -50,6 +44,12 @@ BlockValue<T>::~BlockValue()
 template <class T>
 BlockData<T> * BlockValue<T>::splitAt(BlockData<T> * start, uint32_t pos)
 {
+  //the start of the block may have been compacted away
+  if (pos < start->offset)
+  {
+    return nullptr;
+  }
+
   while (start->offset + start->length < pos)
   {
     start = start->nextSplit;
@@ -63,7 +63,7 @@ BlockData<T> * BlockValue<T>::splitAt(BlockData<T> * start, uint32_t pos)
 
   if (start->offset != pos && start->offset + start->length != pos)
   {
-    BlockData<T> * next = new BlockData<T>();
+    BlockData<T> * next = blockAllocator.create();
     uint32_t delta = pos - start->offset;
 
     //split the block at offset
@@ -81,6 +81,17 @@ BlockData<T> * BlockValue<T>::splitAt(BlockData<T> * start, uint32_t pos)
     start->length = pos - start->offset;
     start->nextSibling = next;
     start->nextSplit = next;
+
+    if (start->value != nullptr)
+    {
+      updateDataLength(next);
+      start->utf16Length -= next->utf16Length;
+    }
+
+    if (blockIndex.contains(start))
+    {
+      blockIndex.insertAfter(start, next);
+    }
   }
 
   return start;
@@ -99,7 +110,7 @@ BlockData<T> * BlockValue<T>::getBlockData(const Timestamp & blockId)
 
   if (block == nullptr)
   {
-    block = new BlockData<T>();
+    block = blockAllocator.create();
     block->id = blockId;
     block->offset = 0;
     block->length = BlockData<T>::maxLength;
@@ -148,134 +159,135 @@ void BlockValue<T>::cleanUpFollowingSplits(BlockData<T> * block)
 {
   while (block->nextSplit != nullptr)
   {
-    //remove from the nextSibling list (walking through as necessary)
-    BlockData<T> * prev = block;
-    while (prev != nullptr)
+    BlockData<T> * tmp = block->nextSplit;
+
+    if (blockIndex.contains(tmp))
     {
-      if (prev->nextSibling == block->nextSplit)
+      //the index knows the predecessor, so no need to walk the list
+      BlockData<T> * prev = blockIndex.prev(tmp);
+      if (prev == nullptr)
       {
-        prev->nextSibling = prev->nextSibling->nextSibling;
-        break;
+        children = tmp->nextSibling;
       }
+      else
+      {
+        prev->nextSibling = tmp->nextSibling;
+      }
+
+      if (tmp->effect.isVisible())
+      {
+        updateText(tmp, false);
+      }
+      blockIndex.remove(tmp);
+    }
+    else
+    {
+      //remove from the nextSibling list (walking through as necessary)
+      BlockData<T> * prev = block;
+      while (prev != nullptr)
+      {
+        if (prev->nextSibling == tmp)
+        {
+          prev->nextSibling = prev->nextSibling->nextSibling;
+          break;
+        }
 
-      prev = prev->nextSibling;
+        prev = prev->nextSibling;
+      }
     }
 
     //remove from the nextSplit list and delete
-    BlockData<T> * tmp = block->nextSplit;
     block->nextSplit = tmp->nextSplit;
-    delete tmp;
+    blockAllocator.destroy(tmp);
   }
 }
 
 template <class T>
 void BlockValue<T>::deleteAllBlocks()
 {
-  for (auto it = blocks.begin(); it != blocks.end(); ++it)
-  {
-    BlockData<T> * block = it->second;
-    BlockData<T> * split = block->nextSplit;
-
-    while (split != nullptr)
-    {
-      block->nextSplit = split->nextSplit;
-      delete split;
-      split = block->nextSplit;
-    }
-
-    delete block;
-  }
+  //all blocks and splits come from the allocator so they are released in bulk
+  blockAllocator.clear();
 
+  blocks.clear();
+  coalescedRuns.clear();
+  coalescedHosts.clear();
   children = nullptr;
+  blockIndex.clear();
+  invalidateText();
 }
 
 template <class T>
 std::pair<bool, size_t> BlockValue<T>::findBlockOffset(BlockData<T> * blockPtr) const
 {
-  BlockData<T> * block = children;
-  size_t offset = 0;
-
-  while (block != nullptr)
+  if (!blockIndex.contains(blockPtr))
   {
-    if (block == blockPtr)
-    {
-      return std::make_pair(true, offset);
-    }
+    return std::make_pair(false, getLength());
+  }
 
-    if (block->effect.isVisible())
+  //sum of all visible blocks to the left of the block in the tree
+  size_t offset = blockPtr->left ? blockPtr->left->subtreeLength : 0;
+  const BlockData<T> * block = blockPtr;
+
+  while (block->parent != nullptr)
+  {
+    const BlockData<T> * parent = block->parent;
+    if (parent->right == block)
     {
-      offset += block->length;
+      offset += parent->getVisibleLength();
+      offset += parent->left ? parent->left->subtreeLength : 0;
     }
 
-    block = block->nextSibling;
+    block = parent;
   }
 
-  return std::make_pair(false, offset);
+  return std::make_pair(true, offset);
 }
 
 template <class T>
 std::pair<bool, size_t> BlockValue<T>::findBlockOffsetUtf16(BlockData<T> * blockPtr) const
 {
-  BlockData<T> * block = children;
-  size_t offset = 0;
-
-  while (block != nullptr)
+  if (!blockIndex.contains(blockPtr))
   {
-    if (block == blockPtr)
-    {
-      return std::make_pair(true, offset);
-    }
+    return std::make_pair(false, blockIndex.getRoot() ? blockIndex.getRoot()->subtreeUtf16Length : 0);
+  }
+
+  size_t offset = blockPtr->left ? blockPtr->left->subtreeUtf16Length : 0;
+  const BlockData<T> * block = blockPtr;
 
-    if (block->effect.isVisible())
+  while (block->parent != nullptr)
+  {
+    const BlockData<T> * parent = block->parent;
+    if (parent->right == block)
     {
-      offset += getUtf16CodeUnitLength(block->value, block->length);
+      offset += parent->getVisibleUtf16Length();
+      offset += parent->left ? parent->left->subtreeUtf16Length : 0;
     }
 
-    block = block->nextSibling;
+    block = parent;
   }
 
-  return std::make_pair(false, offset);
+  return std::make_pair(true, offset);
 }
 
 template <class T>
 Timestamp BlockValue<T>::findOffset(uint32_t & offset) const
 {
   Timestamp ts = { 0, 0 };
-  BlockData<T> * block = children;
-  uint32_t pos = 0;
 
-  if (offset == 0)
+  if (offset == 0 || children == nullptr)
   {
     return ts;
   }
 
-  while (true)
-  {
-    if (block->effect.isVisible())
-    {
-      if (pos + block->length >= offset)
-      {
-        ts = block->id;
-        offset = block->offset + offset - pos;
-        return ts;
-      }
-
-      pos += block->length;
-    }
-
-    //NOTE: this isn't ideal if the last block is invisible
-    //  it will probably technically still work but really the last visible block
-    //  should be returned
-    //  also some callers may expect that only visible blocks will be returned
-    if (block->nextSibling == nullptr)
-    {
-      ts = block->id;
-      offset = block->offset + block->length;
-      return ts;
-    }
-
-    block = block->nextSibling;
-  }
+  //NOTE: if the offset is past the end, the last block is returned which
+  //  isn't ideal if the last block is invisible
+  //  it will probably technically still work but really the last visible block
+  //  should be returned
+  //  also some callers may expect that only visible blocks will be returned
+  BlockData<T> * block = findOffsetPtr(offset);
+  auto position = getInsertPosition(block, block->offset + offset);
+  ts = position.first;
+  offset = position.second;
 
   return ts;
 }
@@ -286,7 +298,7 @@ std::pair<Timestamp, uint32_t> BlockValue<T>::findUtf16CodeUnitOffset(size_t off
   auto result = findUtf16CodeUnitOffsetPtr(offsetCodeUnits);
   if (result.first != nullptr && offsetCodeUnits > 0)
   {
-    return std::make_pair(result.first->id, result.first->offset + result.second);
+    return getInsertPosition(result.first, result.first->offset + result.second);
   }
   else
   {
@@ -297,34 +309,41 @@ std::pair<Timestamp, uint32_t> BlockValue<T>::findUtf16CodeUnitOffset(size_t off
 template <class T>
 BlockData<T> * BlockValue<T>::findOffsetPtr(uint32_t & offset) const
 {
-  BlockData<T> * block = children;
-  uint32_t pos = 0;
+  if (offset == 0 || blockIndex.getRoot() == nullptr)
+  {
+    return children;
+  }
 
-  if (offset == 0)
+  if (offset > blockIndex.getRoot()->subtreeLength)
   {
-    return block;
+    BlockData<T> * last = blockIndex.last();
+    offset = last->length;
+    return last;
   }
 
+  //find the first visible block that ends at or after the offset
+  BlockData<T> * block = blockIndex.getRoot();
+  size_t remaining = offset;
+
   while (true)
   {
-    if (block->effect.isVisible())
+    size_t leftLength = block->left ? block->left->subtreeLength : 0;
+    if (remaining <= leftLength)
     {
-      if (pos + block->length >= offset)
-      {
-        offset = offset - pos;
-        return block;
-      }
-
-      pos += block->length;
+      block = block->left;
+      continue;
     }
 
-    if (block->nextSibling == nullptr)
+    remaining -= leftLength;
+    size_t visibleLength = block->getVisibleLength();
+    if (visibleLength > 0 && remaining <= visibleLength)
     {
-      offset = block->length;
+      offset = remaining;
       return block;
     }
 
-    block = block->nextSibling;
+    remaining -= visibleLength;
+    block = block->right;
   }
 }
 
@@ -332,8 +351,6 @@ template <class T>
 std::pair<BlockData<T> *, uint32_t> BlockValue<T>::findUtf16CodeUnitOffsetPtr(size_t offsetCodeUnits) const
 {
   BlockData<T> * block = children;
-  BlockData<T> * lastVisible = nullptr;
-  uint32_t utf16Offset = 0;
 
   if (offsetCodeUnits == 0 || block == nullptr)
   {
@@ -341,43 +358,61 @@ std::pair<BlockData<T> *, uint32_t> BlockValue<T>::findUtf16CodeUnitOffsetPtr(si
       return std::make_pair(block, 0);
   }
 
-  while (block != nullptr)
+  if (offsetCodeUnits > blockIndex.getRoot()->subtreeUtf16Length)
   {
-    if (block->effect.isVisible())
+    //past the end, return the end of the last visible block
+    block = blockIndex.getRoot();
+    if (block->subtreeUtf16Length == 0)
     {
-      lastVisible = block;
-      uint32_t utf8BlockOffset = 0;
-      uint32_t end = block->length;
-      while (utf8BlockOffset < end)
-      {
-        char c = block->value[utf8BlockOffset];
-        if (c >= 0 && c <= 127) utf8BlockOffset += 1;
-        else if ((c & 0xE0) == 0xC0) utf8BlockOffset += 2;
-        else if ((c & 0xF0) == 0xE0) utf8BlockOffset += 3;
-        else if ((c & 0xF8) == 0xF0)
-        {
-          // Surrogate pairs, the only case where we have 2 utf16 code units
-          utf8BlockOffset += 4;
-          utf16Offset++;
-        }
-
-        utf16Offset++;
+      return std::make_pair(nullptr, 0);
+    }
 
-        if (utf16Offset >= offsetCodeUnits)
-        {
-          return std::make_pair(block, utf8BlockOffset);
-        }
+    while (true)
+    {
+      if (block->right != nullptr && block->right->subtreeUtf16Length > 0)
+      {
+        block = block->right;
+      }
+      else if (block->getVisibleUtf16Length() > 0)
+      {
+        return std::make_pair(block, block->length);
+      }
+      else
+      {
+        block = block->left;
       }
     }
-    block = block->nextSibling;
   }
 
-  if (lastVisible != nullptr)
+  //find the first visible block that ends at or after the offset
+  block = blockIndex.getRoot();
+  size_t remaining = offsetCodeUnits;
+
+  while (true)
   {
-    return std::make_pair(lastVisible, lastVisible->length);
+    size_t leftLength = block->left ? block->left->subtreeUtf16Length : 0;
+    if (remaining <= leftLength)
+    {
+      block = block->left;
+      continue;
+    }
+
+    remaining -= leftLength;
+    size_t visibleLength = block->getVisibleUtf16Length();
+    if (visibleLength > 0 && remaining <= visibleLength)
+    {
+      break;
+    }
+
+    remaining -= visibleLength;
+    block = block->right;
   }
 
-  return std::make_pair(nullptr, 0);
+  //find the utf8 offset within the block
+  uint32_t utf8BlockOffset = static_cast<uint32_t>(
+    Utf8FindUtf16Offset(block->value, block->length, remaining));
+
+  return std::make_pair(block, utf8BlockOffset);
 }
 
 template <class T>
@@ -396,10 +431,40 @@ template <class T>
 void BlockValue<T>::insertAfter(const Timestamp & blockId, uint32_t offset,
   const Timestamp & ts, uint32_t length, const T * data, ChangedCallback callback)
 {
+  Timestamp prevId = blockId;
+  uint32_t prevOffset = offset;
+
+  if (!coalescedRuns.empty())
+  {
+    //coalesced inserts stay in the list once inserted, so this can only be a
+    //  reapply after the insert was deinitialized
+    Timestamp hostId = ts;
+    uint32_t start = 0;
+    uint32_t hostLength = length;
+    if (resolveCoalesced(hostId, start, hostLength))
+    {
+      BlockData<T> * block = getBlock(hostId, start, hostLength);
+      if (block != nullptr && !block->effect.isInitialized())
+      {
+        initializeSplits(block, start + hostLength, callback);
+      }
+      return;
+    }
+
+    uint32_t prevLength = 0;
+    resolveCoalesced(prevId, prevOffset, prevLength);
+  }
+
+  if (!prevId.isNull() && blocks.find(ts) == blocks.end()
+    && coalesceInsert(prevId, prevOffset, ts, length, data, callback))
+  {
+    return;
+  }
+
   BlockData<T> * block = getBlock(ts, 0, length);
 
   //if the block is already initialized it must already be inserted
-  if (block->effect.isInitialized())
+  if (block == nullptr || block->effect.isInitialized())
   {
     return;
   }
@@ -413,6 +478,12 @@ void BlockValue<T>::insertAfter(const Timestamp & blockId, uint32_t offset,
       split->value = const_cast<T *>(data) + split->offset;
       // split->effect.initialize();
 
+      updateDataLength(split);
+      if (blockIndex.contains(split))
+      {
+        blockIndex.update(split);
+      }
+
       if (split->offset + split->length == length)
       {
         //this is to account for any potential extra split blocks that have
@@ -430,30 +501,39 @@ void BlockValue<T>::insertAfter(const Timestamp & blockId, uint32_t offset,
   }
 
   BlockData<T> ** insert = nullptr;
-  if (blockId.isNull())
+  BlockData<T> * insertPrev = nullptr;
+  if (prevId.isNull())
   {
     insert = &children;
   }
   else
   {
-    BlockData<T> * prev = getBlockData(blockId);
-    prev = splitAt(prev, offset);
-    //TODO: prev could be nullptr here due to bad argument
+    BlockData<T> * prev = getBlockData(prevId);
+    prev = splitAt(prev, prevOffset);
+    if (prev == nullptr)
+    {
+      //bad argument (or a position in compacted data)
+      return;
+    }
     insert = &prev->nextSibling;
+    insertPrev = prev;
   }
 
   //insert after newer blocks
+  Timestamp insertId;
   while (*insert != nullptr)
   {
-    if ((*insert)->id < block->id || (*insert)->id == block->id)
+    insertId = getInsertRange(*insert, (*insert)->offset).id;
+    if (insertId < block->id || insertId == block->id)
     {
       break;
     }
 
+    insertPrev = *insert;
     insert = &(*insert)->nextSibling;
   }
 
-  if ((*insert) != nullptr && (*insert)->id == block->id)
+  if ((*insert) != nullptr && insertId == block->id)
   {
     //block is already in the list
     initializeBlock(ts, callback);
@@ -468,9 +548,28 @@ void BlockValue<T>::insertAfter(const Timestamp & blockId, uint32_t offset,
   }
 
   //insert block(s) in the main sibling list
+  BlockData<T> * insertNext = *insert;
   *nextSibling = *insert;
   *insert = block;
 
+  //blocks inserted after a block that isn't in the main list yet are indexed
+  //  once that block's own sibling list is inserted
+  if (insertPrev == nullptr || blockIndex.contains(insertPrev))
+  {
+    for (BlockData<T> * inserted = block; inserted != insertNext;
+      inserted = inserted->nextSibling)
+    {
+      blockIndex.insertAfter(insertPrev, inserted);
+      insertPrev = inserted;
+
+      //siblings that were waiting on this block may already be visible
+      if (inserted->effect.isVisible())
+      {
+        updateText(inserted, true);
+      }
+    }
+  }
+
   initializeBlock(ts, callback);
 
   return;
@@ -479,17 +578,29 @@ void BlockValue<T>::insertAfter(const Timestamp & blockId, uint32_t offset,
 template <class T>
 void BlockValue<T>::initializeBlock(const Timestamp & blockId, ChangedCallback callback)
 {
-  BlockData<T> * block = const_cast<BlockData<T> *>(getExistingBlock(blockId));
-  auto blockOffset = findBlockOffsetUtf16(block);
+  initializeSplits(const_cast<BlockData<T> *>(getExistingBlock(blockId)),
+    BlockData<T>::maxLength, callback);
+}
 
-  while (block != nullptr)
+template <class T>
+void BlockValue<T>::initializeSplits(BlockData<T> * block, uint32_t end, ChangedCallback callback)
+{
+  while (block != nullptr && block->offset < end)
   {
+    auto blockOffset = findBlockOffsetUtf16(block);
     bool prevVisibility = false;
+    bool wasVisible = block->effect.isVisible();
 
     block->effect.initialize();
+    blockIndex.update(block);
 
     bool newVisibility = block->effect.isVisible();
 
+    if (wasVisible != newVisibility)
+    {
+      updateText(block, newVisibility);
+    }
+
     if (blockOffset.first && prevVisibility != newVisibility)
     {
       if (newVisibility)
@@ -499,19 +610,11 @@ void BlockValue<T>::initializeBlock(const Timestamp & blockId, ChangedCallback c
       }
       else
       {
-        callback(blockOffset.second, nullptr, getUtf16CodeUnitLength(block->value, block->length));
+        callback(blockOffset.second, nullptr, block->utf16Length);
       }
     }
 
-    BlockData<T> * nextBlock = block->nextSplit;
-    while (block != nextBlock)
-    {
-      if (block->effect.isVisible())
-      {
-        blockOffset.second += getUtf16CodeUnitLength(block->value, block->length);
-      }
-      block = block->nextSibling;
-    }
+    block = block->nextSplit;
   }
 }
 
@@ -519,8 +622,10 @@ template <class T>
 void BlockValue<T>::updateEffect(const Timestamp & blockId, uint32_t offset,
   uint32_t length, int delta, ChangedCallback callback)
 {
-  BlockData<T> * block = getBlock(blockId, offset, length);
-  auto blockOffset = findBlockOffsetUtf16(block);
+  Timestamp hostId = blockId;
+  resolveCoalesced(hostId, offset, length);
+
+  BlockData<T> * block = getBlock(hostId, offset, length);
 
   if (length > BlockData<T>::maxLength - offset)
   {
@@ -529,6 +634,7 @@ void BlockValue<T>::updateEffect(const Timestamp & blockId, uint32_t offset,
 
   while (block != nullptr && block->offset < offset + length)
   {
+    auto blockOffset = findBlockOffsetUtf16(block);
     bool prevVisibility = block->effect.isVisible();
 
     if (delta == 0)
@@ -543,6 +649,12 @@ void BlockValue<T>::updateEffect(const Timestamp & blockId, uint32_t offset,
 
     bool newVisibility = block->effect.isVisible();
 
+    if (prevVisibility != newVisibility)
+    {
+      blockIndex.update(block);
+      updateText(block, newVisibility);
+    }
+
     if (blockOffset.first && prevVisibility != newVisibility)
     {
       if (newVisibility)
@@ -552,19 +664,11 @@ void BlockValue<T>::updateEffect(const Timestamp & blockId, uint32_t offset,
       }
       else
       {
-        callback(blockOffset.second, nullptr, getUtf16CodeUnitLength(block->value, block->length));
+        callback(blockOffset.second, nullptr, block->utf16Length);
       }
     }
 
-    BlockData<T> * nextBlock = block->nextSplit;
-    while (block != nextBlock)
-    {
-      if (block->effect.isVisible())
-      {
-        blockOffset.second += getUtf16CodeUnitLength(block->value, block->length);
-      }
-      block = block->nextSibling;
-    }
+    block = block->nextSplit;
   }
 }
 
@@ -593,14 +697,16 @@ void BlockValue<T>::deleteAfter(const Timestamp & blockId,
   //   cursor = &prevBlock->nextSibling;
   // }
 
+  //the block's splits are unlinked as a whole, so it has to be on its own
+  auto host = coalescedHosts.find(deleteBlockId);
+  splitCoalescedRun(host != coalescedHosts.end() ? host->second : deleteBlockId);
+
   const BlockData<T> * searchBlock = getExistingBlock(deleteBlockId);
   if (searchBlock == nullptr)
   {
     return;
   }
 
-  T * blockValue = searchBlock->value;
-
   size_t offset = 0;
   while (*cursor != nullptr)
   {
@@ -613,8 +719,10 @@ void BlockValue<T>::deleteAfter(const Timestamp & blockId,
       if (deleteBlock->effect.isVisible())
       {
         callback(offset, nullptr, deleteBlock->length);
+        updateText(deleteBlock, false);
       }
-      delete deleteBlock;
+      blockIndex.remove(deleteBlock);
+      blockAllocator.destroy(deleteBlock);
 
       if (searchBlock == nullptr)
       {
@@ -632,50 +740,468 @@ void BlockValue<T>::deleteAfter(const Timestamp & blockId,
     cursor = &(*cursor)->nextSibling;
   }
 
+  //the block's value data is owned by the core's data arena
   blocks.erase(deleteBlockId);
+}
 
-  if (blockValue != nullptr)
+template <class T>
+bool BlockValue<T>::compact(const VectorTimestamp & horizon,
+  const std::unordered_set<NodeId> & pinned)
+{
+  bool complete = true;
+
+  //removed splits stay in the sibling list since inserts are ordered against
+  //  their siblings; a run of them can go once the block after it is stable
+  //  (any later insert is newer than all of them), otherwise the last one is
+  //  kept so concurrent inserts after it still end up in the same place
+  BlockData<T> ** link = &children;
+  while (*link != nullptr)
   {
-    delete blockValue;
+    if (!isGarbage(*link, horizon, pinned))
+    {
+      link = &(*link)->nextSibling;
+      continue;
+    }
+
+    BlockData<T> * end = *link;
+    while (end != nullptr && isGarbage(end, horizon, pinned))
+    {
+      end = end->nextSibling;
+    }
+
+    bool keepLast = end != nullptr && !(horizon >= getInsertRange(end, end->offset).id);
+
+    while (*link != end)
+    {
+      BlockData<T> * block = *link;
+      if (keepLast && block->nextSibling == end)
+      {
+        complete = false;
+        link = &block->nextSibling;
+        break;
+      }
+
+      *link = block->nextSibling;
+      removeSplit(block);
+    }
   }
+
+  //join splits that ended up next to each other with the same effect
+  for (BlockData<T> * block = children; block != nullptr; block = block->nextSibling)
+  {
+    BlockData<T> * next = block->nextSibling;
+    while (next != nullptr && next == block->nextSplit
+      && next->offset == block->offset + block->length
+      && next->effect == block->effect
+      && block->value != nullptr && next->value == block->value + block->length)
+    {
+      blockIndex.remove(next);
+
+      block->length += next->length;
+      block->utf16Length += next->utf16Length;
+      block->nextSplit = next->nextSplit;
+      block->nextSibling = next->nextSibling;
+      blockAllocator.destroy(next);
+
+      blockIndex.update(block);
+      next = block->nextSibling;
+    }
+  }
+
+  return complete;
 }
 
 template <class T>
-size_t BlockValue<T>::getLength() const
+void BlockValue<T>::relocateData(ByteArena & arena)
 {
-  size_t length = 0;
-  BlockData<T> * block = children;
+  for (auto & it : blocks)
+  {
+    BlockData<T> * split = it.second;
+    while (split != nullptr)
+    {
+      if (split->value == nullptr)
+      {
+        split = split->nextSplit;
+        continue;
+      }
 
-  while (block != nullptr)
+      //copy the run of splits with contiguous data at once
+      BlockData<T> * last = split;
+      while (last->nextSplit != nullptr
+        && last->nextSplit->value == last->value + last->length)
+      {
+        last = last->nextSplit;
+      }
+
+      const T * start = split->value;
+      size_t length = static_cast<size_t>(last->value + last->length - start);
+      T * data = reinterpret_cast<T *>(arena.copy(
+        reinterpret_cast<const uint8_t *>(start), length * sizeof(T)));
+
+      BlockData<T> * end = last->nextSplit;
+      for (; split != end; split = split->nextSplit)
+      {
+        split->value = data + (split->value - start);
+      }
+    }
+  }
+}
+
+template <class T>
+bool BlockValue<T>::isGarbage(const BlockData<T> * block, const VectorTimestamp & horizon,
+  const std::unordered_set<NodeId> & pinned) const
+{
+  if (!block->effect.isInitialized() || block->effect.isVisible()
+    || block->value == nullptr || !blockIndex.contains(block))
+  {
+    return false;
+  }
+
+  //every insert the split holds data from has to be removable
+  uint32_t end = block->offset + block->length;
+  uint32_t offset = block->offset;
+  do
   {
-    if (block->effect.isVisible())
+    InsertRange range = getInsertRange(block, offset);
+    if (!(horizon >= range.id)
+      || pinned.find(NodeId::inheritanceRootFor(range.id)) != pinned.end())
     {
-      length += block->length;
+      return false;
     }
+    offset = range.end;
+  }
+  while (offset < end);
 
-    block = block->nextSibling;
+  return true;
+}
+
+template <class T>
+void BlockValue<T>::removeSplit(BlockData<T> * block)
+{
+  blockIndex.remove(block);
+
+  //unlink from the block's split list, the map points at its first split
+  auto it = blocks.find(block->id);
+  if (it->second == block)
+  {
+    if (block->nextSplit != nullptr)
+    {
+      it->second = block->nextSplit;
+    }
+    else
+    {
+      blocks.erase(it);
+      removeCoalescedRun(block->id);
+    }
+  }
+  else
+  {
+    BlockData<T> * prev = it->second;
+    while (prev->nextSplit != block)
+    {
+      prev = prev->nextSplit;
+    }
+    prev->nextSplit = block->nextSplit;
   }
 
-  return length;
+  blockAllocator.destroy(block);
+}
+
+template <class T>
+size_t BlockValue<T>::getLength() const
+{
+  return blockIndex.getRoot() ? blockIndex.getRoot()->subtreeLength : 0;
 }
 
 template <class T>
 std::string BlockValue<T>::toString() const
 {
-  std::string outString;
-  BlockData<T> * block = children;
+  return std::string(getText());
+}
 
-  while (block != nullptr)
+template <class T>
+std::string_view BlockValue<T>::getText() const
+{
+  if (!textValid.load(std::memory_order_acquire))
   {
-    if (block->effect.isVisible())
+    std::lock_guard<std::mutex> lock(textMutex);
+    if (!textValid.load(std::memory_order_relaxed))
     {
-      outString.append(reinterpret_cast<const char *>(block->value), block->length);
+      text.clear();
+      text.reserve(getLength());
+      for (const BlockData<T> * block = children; block != nullptr; block = block->nextSibling)
+      {
+        if (block->effect.isVisible())
+        {
+          text.append(reinterpret_cast<const char *>(block->value), block->length);
+        }
+      }
+      textValid.store(true, std::memory_order_release);
     }
+  }
 
-    block = block->nextSibling;
+  return text;
+}
+
+template <class T>
+std::u16string_view BlockValue<T>::getUtf16Text() const
+{
+  if (!utf16TextValid.load(std::memory_order_acquire))
+  {
+    std::lock_guard<std::mutex> lock(textMutex);
+    if (!utf16TextValid.load(std::memory_order_relaxed))
+    {
+      utf16Text.clear();
+      utf16Text.reserve(blockIndex.getRoot() ? blockIndex.getRoot()->subtreeUtf16Length : 0);
+      for (const BlockData<T> * block = children; block != nullptr; block = block->nextSibling)
+      {
+        if (block->effect.isVisible())
+        {
+          Utf8AppendUtf16(utf16Text, reinterpret_cast<const char *>(block->value), block->length);
+        }
+      }
+      utf16TextValid.store(true, std::memory_order_release);
+    }
   }
 
-  return outString;
+  return utf16Text;
+}
+
+template <class T>
+void BlockValue<T>::updateText(BlockData<T> * block, bool visible)
+{
+  spliceText(block, 0, 0, visible);
+}
+
+template <class T>
+void BlockValue<T>::spliceText(BlockData<T> * block, uint32_t start,
+  uint32_t utf16Start, bool visible)
+{
+  //only blocks in the index are part of the text; the offsets don't depend on
+  //  the block's own visibility, so this can be called before or after it changes
+  if (!blockIndex.contains(block))
+  {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(textMutex);
+
+  if (textValid.load(std::memory_order_relaxed))
+  {
+    size_t offset = findBlockOffset(block).second + start;
+    if (visible)
+    {
+      text.insert(offset, reinterpret_cast<const char *>(block->value) + start,
+        block->length - start);
+    }
+    else
+    {
+      text.erase(offset, block->length - start);
+    }
+  }
+
+  if (utf16TextValid.load(std::memory_order_relaxed))
+  {
+    size_t offset = findBlockOffsetUtf16(block).second + utf16Start;
+    if (visible)
+    {
+      std::u16string inserted;
+      inserted.reserve(block->utf16Length - utf16Start);
+      Utf8AppendUtf16(inserted, reinterpret_cast<const char *>(block->value) + start,
+        block->length - start);
+      utf16Text.insert(offset, inserted);
+    }
+    else
+    {
+      utf16Text.erase(offset, block->utf16Length - utf16Start);
+    }
+  }
+}
+
+template <class T>
+void BlockValue<T>::invalidateText()
+{
+  std::lock_guard<std::mutex> lock(textMutex);
+  textValid.store(false, std::memory_order_relaxed);
+  utf16TextValid.store(false, std::memory_order_relaxed);
+  text = std::string();
+  utf16Text = std::u16string();
+}
+
+template <class T>
+void BlockValue<T>::saveSnapshot(SnapshotWriter & writer) const
+{
+  //every block (split) is numbered in the order it is written, so sibling
+  //  links can be written as indices, with 0 meaning null
+  std::unordered_map<const BlockData<T> *, uint64_t> indices;
+  for (const auto & it : blocks)
+  {
+    for (const BlockData<T> * split = it.second; split != nullptr; split = split->nextSplit)
+    {
+      indices.emplace(split, indices.size() + 1);
+    }
+  }
+
+  auto getIndex = [&indices](const BlockData<T> * block) -> uint64_t
+  {
+    auto it = indices.find(block);
+    return (it != indices.end()) ? it->second : 0;
+  };
+
+  writer.writeUInt(blocks.size());
+  for (const auto & it : blocks)
+  {
+    size_t splitCount = 0;
+    for (const BlockData<T> * split = it.second; split != nullptr; split = split->nextSplit)
+    {
+      splitCount++;
+    }
+
+    writer.writeTimestamp(it.first);
+    writer.writeUInt(splitCount);
+    for (const BlockData<T> * split = it.second; split != nullptr; split = split->nextSplit)
+    {
+      writer.writeUInt(split->offset);
+      writer.writeUInt(split->length);
+      writer.writeEffect(split->effect);
+      writer.writeUInt(getIndex(split->nextSibling));
+
+      //blocks that were split or deleted before being inserted have no data
+      writer.writeUInt(split->value != nullptr);
+      if (split->value != nullptr)
+      {
+        writer.writeString(std::string_view(reinterpret_cast<const char *>(split->value),
+          split->length * sizeof(T)));
+      }
+    }
+  }
+
+  writer.writeUInt(getIndex(children));
+
+  writer.writeUInt(coalescedRuns.size());
+  for (const auto & it : coalescedRuns)
+  {
+    writer.writeTimestamp(it.first);
+    writer.writeUInt(it.second.size());
+    for (const CoalescedInsert & insert : it.second)
+    {
+      writer.writeTimestamp(insert.id);
+      writer.writeUInt(insert.start);
+      writer.writeUInt(insert.length);
+    }
+  }
+}
+
+template <class T>
+void BlockValue<T>::loadSnapshot(SnapshotReader & reader, ByteArena & arena)
+{
+  deleteAllBlocks();
+
+  std::vector<BlockData<T> *> table(1, nullptr);
+  std::vector<uint64_t> siblings(1, 0);
+
+  size_t count = reader.readCount();
+  for (size_t i = 0; i < count && !reader.hasError(); i++)
+  {
+    Timestamp id = reader.readTimestamp();
+    size_t splitCount = reader.readCount();
+
+    BlockData<T> * prev = nullptr;
+    for (size_t j = 0; j < splitCount && !reader.hasError(); j++)
+    {
+      BlockData<T> * block = blockAllocator.create();
+      block->id = id;
+      block->offset = static_cast<uint32_t>(reader.readUInt());
+      block->length = static_cast<uint32_t>(reader.readUInt());
+      block->effect = reader.readEffect();
+      siblings.push_back(reader.readUInt());
+
+      if (reader.readUInt() != 0)
+      {
+        std::string_view value = reader.readString();
+        if (value.size() != block->length * sizeof(T))
+        {
+          reader.setError();
+          break;
+        }
+
+        block->value = reinterpret_cast<T *>(arena.copy(
+          reinterpret_cast<const uint8_t *>(value.data()), value.size()));
+        updateDataLength(block);
+      }
+
+      if (prev == nullptr)
+      {
+        blocks[id] = block;
+      }
+      else
+      {
+        prev->nextSplit = block;
+      }
+
+      prev = block;
+      table.push_back(block);
+    }
+  }
+
+  uint64_t first = reader.readUInt();
+
+  size_t runCount = reader.readCount();
+  for (size_t i = 0; i < runCount && !reader.hasError(); i++)
+  {
+    Timestamp hostId = reader.readTimestamp();
+    auto & run = coalescedRuns[hostId];
+    run.resize(reader.readCount());
+    for (CoalescedInsert & insert : run)
+    {
+      insert.id = reader.readTimestamp();
+      insert.start = static_cast<uint32_t>(reader.readUInt());
+      insert.length = static_cast<uint32_t>(reader.readUInt());
+      coalescedHosts[insert.id] = hostId;
+    }
+
+    if (run.empty() || blocks.find(hostId) == blocks.end())
+    {
+      reader.setError();
+    }
+  }
+
+  if (reader.hasError() || first >= table.size())
+  {
+    reader.setError();
+    deleteAllBlocks();
+    return;
+  }
+
+  for (size_t i = 1; i < table.size(); i++)
+  {
+    if (siblings[i] >= table.size())
+    {
+      reader.setError();
+      deleteAllBlocks();
+      return;
+    }
+
+    table[i]->nextSibling = table[siblings[i]];
+  }
+
+  //rebuild the offset index over the sibling list (bounded in case the
+  //  links form a cycle)
+  children = table[first];
+  BlockData<T> * prev = nullptr;
+  size_t indexed = 0;
+  for (BlockData<T> * block = children; block != nullptr; block = block->nextSibling)
+  {
+    if (++indexed >= table.size())
+    {
+      reader.setError();
+      deleteAllBlocks();
+      return;
+    }
+
+    blockIndex.insertAfter(prev, block);
+    prev = block;
+  }
 }
 
 template <class T>
@@ -686,7 +1212,8 @@ void BlockValue<T>::computeInsertions(size_t offset, const uint8_t * data,
   auto insert = findUtf16CodeUnitOffsetPtr(offset);
   if (insert.first != nullptr && offset > 0)
   {
-    callback(insert.first->id, insert.first->offset + insert.second, data, length);
+    auto position = getInsertPosition(insert.first, insert.first->offset + insert.second);
+    callback(position.first, position.second, data, length);
   }
   else
   {
@@ -706,6 +1233,19 @@ void BlockValue<T>::computeDeletions(size_t offset, size_t length,
   BlockData<T> * data = start.first;
   uint32_t dataOffset = start.second;
 
+  //coalesced blocks are deleted per insert, since that is what ops refer to
+  auto deleteRange = [this, &callback](const BlockData<T> * block, uint32_t offset, uint32_t length)
+  {
+    uint32_t end = offset + length;
+    while (offset < end)
+    {
+      InsertRange range = getInsertRange(block, offset);
+      uint32_t rangeEnd = std::min(end, range.end);
+      callback(range.id, offset - range.start, rangeEnd - offset);
+      offset = rangeEnd;
+    }
+  };
+
   while (data != nullptr)
   {
     if (data->effect.isVisible() == false)
@@ -719,7 +1259,7 @@ void BlockValue<T>::computeDeletions(size_t offset, size_t length,
     {
       if (end.second > dataOffset)
       {
-        callback(data->id, data->offset + dataOffset, end.second - dataOffset);
+        deleteRange(data, data->offset + dataOffset, end.second - dataOffset);
       }
 
       break;
@@ -727,7 +1267,7 @@ void BlockValue<T>::computeDeletions(size_t offset, size_t length,
 
     if (data->length > dataOffset)
     {
-      callback(data->id, data->offset + dataOffset, data->length - dataOffset);
+      deleteRange(data, data->offset + dataOffset, data->length - dataOffset);
     }
 
     data = data->nextSibling;
@@ -735,6 +1275,226 @@ void BlockValue<T>::computeDeletions(size_t offset, size_t length,
   }
 }
 
+template <class T>
+void BlockValue<T>::forEachInsertRange(std::function<void(const Timestamp &, uint32_t,
+  const BlockData<T> *, uint32_t, uint32_t)> callback) const
+{
+  for (const BlockData<T> * block = children; block != nullptr; block = block->nextSibling)
+  {
+    uint32_t end = block->offset + block->length;
+    uint32_t offset = block->offset;
+    do
+    {
+      InsertRange range = getInsertRange(block, offset);
+      uint32_t rangeEnd = std::min(end, range.end);
+      callback(range.id, offset - range.start, block, offset - block->offset, rangeEnd - offset);
+      offset = rangeEnd;
+    }
+    while (offset < end);
+  }
+}
+
+template <class T>
+bool BlockValue<T>::coalesceInsert(const Timestamp & blockId, uint32_t offset,
+  const Timestamp & ts, uint32_t length, const T * data, ChangedCallback callback)
+{
+  auto it = blocks.find(blockId);
+  if (it == blocks.end() || it->second->id.site != ts.site)
+  {
+    return false;
+  }
+
+  //the insert has to continue the block's last split, both in the document
+  //  and in memory, and the split must look exactly like a new insert would
+  BlockData<T> * last = it->second;
+  while (last->nextSplit != nullptr)
+  {
+    last = last->nextSplit;
+  }
+
+  Effect initialized;
+  initialized.initialize();
+
+  if (last->value == nullptr || last->value + last->length != data
+    || last->offset + last->length != offset || length > BlockData<T>::maxLength - offset
+    || !(last->effect == initialized) || !blockIndex.contains(last))
+  {
+    return false;
+  }
+
+  //it has to be newer than everything in the block, and would be inserted
+  //  right after it (there is nothing newer after the block to skip past)
+  auto run = coalescedRuns.find(blockId);
+  const Timestamp & newest = (run != coalescedRuns.end()) ? run->second.back().id : blockId;
+  if (!(newest < ts) || (last->nextSibling != nullptr
+    && !(getInsertRange(last->nextSibling, last->nextSibling->offset).id < ts)))
+  {
+    return false;
+  }
+
+  coalescedRuns[blockId].push_back({ ts, offset, length });
+  coalescedHosts[ts] = blockId;
+
+  uint32_t start = last->length;
+  uint32_t utf16Start = last->utf16Length;
+  last->length += length;
+  last->utf16Length += static_cast<uint32_t>(Utf8ToUtf16Length(data, length));
+  blockIndex.update(last);
+  spliceText(last, start, utf16Start, true);
+
+  auto blockOffset = findBlockOffsetUtf16(last);
+  callback(blockOffset.second + utf16Start, const_cast<T *>(data), length);
+
+  return true;
+}
+
+template <class T>
+bool BlockValue<T>::resolveCoalesced(Timestamp & blockId, uint32_t & offset, uint32_t & length) const
+{
+  if (coalescedRuns.empty())
+  {
+    return false;
+  }
+
+  auto host = coalescedHosts.find(blockId);
+  if (host != coalescedHosts.end())
+  {
+    const auto & run = coalescedRuns.find(host->second)->second;
+    auto insert = std::lower_bound(run.begin(), run.end(), blockId,
+      [](const CoalescedInsert & insert, const Timestamp & id) { return insert.id < id; });
+
+    offset = std::min(offset, insert->length);
+    length = std::min(length, insert->length - offset);
+    offset += insert->start;
+    blockId = host->second;
+    return true;
+  }
+
+  auto run = coalescedRuns.find(blockId);
+  if (run != coalescedRuns.end())
+  {
+    //the block's own data ends where the first insert appended to it starts
+    uint32_t ownLength = run->second.front().start;
+    offset = std::min(offset, ownLength);
+    length = std::min(length, ownLength - offset);
+    return true;
+  }
+
+  return false;
+}
+
+template <class T>
+typename BlockValue<T>::InsertRange BlockValue<T>::getInsertRange(
+  const BlockData<T> * block, uint32_t offset) const
+{
+  auto run = coalescedRuns.empty() ? coalescedRuns.end() : coalescedRuns.find(block->id);
+  if (run == coalescedRuns.end())
+  {
+    return { block->id, 0, BlockData<T>::maxLength };
+  }
+
+  const auto & inserts = run->second;
+  auto next = std::upper_bound(inserts.begin(), inserts.end(), offset,
+    [](uint32_t offset, const CoalescedInsert & insert) { return offset < insert.start; });
+  if (next == inserts.begin())
+  {
+    return { block->id, 0, inserts.front().start };
+  }
+
+  const CoalescedInsert & insert = *(next - 1);
+  return { insert.id, insert.start, insert.start + insert.length };
+}
+
+template <class T>
+std::pair<Timestamp, uint32_t> BlockValue<T>::getInsertPosition(
+  const BlockData<T> * block, uint32_t offset) const
+{
+  //positions are the end of a character, so they belong to the insert
+  //  holding the character before them
+  InsertRange range = getInsertRange(block, offset > 0 ? offset - 1 : 0);
+  return std::make_pair(range.id, offset - range.start);
+}
+
+template <class T>
+void BlockValue<T>::splitCoalescedRun(const Timestamp & hostId)
+{
+  auto run = coalescedRuns.find(hostId);
+  if (run == coalescedRuns.end())
+  {
+    return;
+  }
+
+  std::vector<CoalescedInsert> inserts = std::move(run->second);
+  removeCoalescedRun(hostId);
+
+  auto it = blocks.find(hostId);
+  if (it == blocks.end())
+  {
+    return;
+  }
+
+  //split wherever an insert starts inside a split
+  size_t index = 0;
+  for (BlockData<T> * split = it->second; split != nullptr; split = split->nextSplit)
+  {
+    while (index < inserts.size() && inserts[index].start <= split->offset)
+    {
+      index++;
+    }
+
+    if (index < inserts.size() && inserts[index].start < split->offset + split->length)
+    {
+      splitAt(split, inserts[index].start);
+    }
+  }
+
+  //then give every insert its own splits back
+  BlockData<T> * split = it->second;
+  BlockData<T> * prev = nullptr;
+  blocks.erase(it);
+
+  while (split != nullptr)
+  {
+    BlockData<T> * nextSplit = split->nextSplit;
+
+    auto next = std::upper_bound(inserts.begin(), inserts.end(), split->offset,
+      [](uint32_t offset, const CoalescedInsert & insert) { return offset < insert.start; });
+    if (next != inserts.begin())
+    {
+      split->id = (next - 1)->id;
+      split->offset -= (next - 1)->start;
+    }
+
+    if (prev == nullptr || prev->id != split->id)
+    {
+      if (prev != nullptr)
+      {
+        prev->nextSplit = nullptr;
+      }
+      blocks[split->id] = split;
+    }
+
+    prev = split;
+    split = nextSplit;
+  }
+}
+
+template <class T>
+void BlockValue<T>::removeCoalescedRun(const Timestamp & hostId)
+{
+  auto run = coalescedRuns.find(hostId);
+  if (run == coalescedRuns.end())
+  {
+    return;
+  }
+
+  for (const CoalescedInsert & insert : run->second)
+  {
+    coalescedHosts.erase(insert.id);
+  }
+  coalescedRuns.erase(run);
+}
+
 template <class T>
 void BlockValue<T>::printList() const
 {
@@ -758,4 +1518,43 @@ void BlockValue<T>::printList() const
   std::cout << std::endl;
 }
 
+template <class T>
+uint32_t BlockValue<T>::IndexTraits::priority(const BlockData<T> * block)
+{
+  return OrderStatisticTree<BlockData<T>, IndexTraits>::MixPriority(
+    (static_cast<uint64_t>(block->id.site) << 32) | block->id.clock, block->offset);
+}
+
+template <class T>
+void BlockValue<T>::IndexTraits::recompute(BlockData<T> * block)
+{
+  block->subtreeLength = block->getVisibleLength();
+  block->subtreeUtf16Length = block->getVisibleUtf16Length();
+
+  if (block->left != nullptr)
+  {
+    block->subtreeLength += block->left->subtreeLength;
+    block->subtreeUtf16Length += block->left->subtreeUtf16Length;
+  }
+
+  if (block->right != nullptr)
+  {
+    block->subtreeLength += block->right->subtreeLength;
+    block->subtreeUtf16Length += block->right->subtreeUtf16Length;
+  }
+}
+
+template <class T>
+void BlockValue<T>::updateDataLength(BlockData<T> * block)
+{
+  if (block->value == nullptr)
+  {
+    block->utf16Length = 0;
+  }
+  else
+  {
+    block->utf16Length = static_cast<uint32_t>(Utf8ToUtf16Length(block->value, block->length));
+  }
+}
+
 template class BlockValue<char>;
\ No newline at end of file
@@ -1,13 +1,32 @@
 #pragma once
 #include <cstdint>
 #include <cstring>
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include "Timestamp.h"
 #include "Nodes/Node.h"
+#include "SlabAllocator.h"
+#include "OrderStatisticTree.h"
+#include "ByteArena.h"
 #include <unordered_map>
-
-//Linked list structure could be augmented with a tree lookup structure for O(log(n)) lookup/insert
-//  Incoming operations are fast because of the block map, but local inserts need to linear search for a string position
+#include <unordered_set>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+class VectorTimestamp;
+
+//Blocks are kept in a linked list (nextSibling) in document order
+//  Incoming operations are fast because of the block map, and offset lookups
+//  (local inserts/deletes and change events) use an order statistic tree
+//  (treap) over the same list which tracks visible lengths per subtree
+//Inserts from the same site that continue the end of a block (i.e. typing)
+//  are coalesced into the block's last split when their data directly
+//  follows it in memory; the block keeps the run of inserts appended to it,
+//  and ids and offsets are translated between the two wherever they enter
+//  or leave this class
 
 template <class T>
 struct BlockData
@@ -23,7 +42,18 @@ struct BlockData
   BlockData<T> * nextSibling = nullptr;
   BlockData<T> * nextSplit = nullptr;
 
+  //order statistic index (only valid while the block is in the sibling list)
+  BlockData<T> * parent = nullptr;
+  BlockData<T> * left = nullptr;
+  BlockData<T> * right = nullptr;
+  uint32_t priority = 0;
+  uint32_t utf16Length = 0;
+  size_t subtreeLength = 0;
+  size_t subtreeUtf16Length = 0;
+
   uint32_t getDataLength() const;
+  uint32_t getVisibleLength() const;
+  uint32_t getVisibleUtf16Length() const;
 };
 
 template <class T>
@@ -50,6 +80,12 @@ public:
   void updateEffect(const Timestamp & blockId, uint32_t offset, uint32_t length, int delta, ChangedCallback callback);
   void deinitializeBlock(const Timestamp & blockId, ChangedCallback callback);
   void deleteAfter(const Timestamp & blockId, const Timestamp & deleteBlockId, ChangedCallback callback);
+  //frees removed splits inserted at or below the horizon, except for pinned
+  //  blocks ({ id, 0 }) which may still be undone, and joins neighbouring
+  //  splits of the same block back together
+  //the split data stays in the arena it was allocated from (see relocateData)
+  //returns false if some removed splits were kept anyway
+  bool compact(const VectorTimestamp & horizon, const std::unordered_set<NodeId> & pinned);
 
   size_t getLength() const;
 
@@ -66,12 +102,86 @@ public:
   void computeDeletions(size_t offset, size_t length,
     std::function<void(const Timestamp & blockId, uint32_t offset, uint32_t length)> callback) const;
 
+  //calls back for each part of the sibling list in order, with the id and
+  //  offset of the insert the part came from (coalesced blocks are split back
+  //  into their inserts); start is the part's offset within the block
+  void forEachInsertRange(std::function<void(const Timestamp & blockId, uint32_t offset,
+    const BlockData<T> * block, uint32_t start, uint32_t length)> callback) const;
+
   std::string toString() const;
 
+  //the visible text, built on first use and then kept up to date by splicing
+  //  in blocks as they change visibility
+  //views are valid until the value next changes
+  //any number of threads can read the text of a value nobody changes (e.g. a
+  //  read view's); changing the value isn't safe alongside readers
+  std::string_view getText() const;
+  std::u16string_view getUtf16Text() const;
+
+  void saveSnapshot(SnapshotWriter & writer) const;
+  //block data is copied into the arena, which has to outlive the value
+  void loadSnapshot(SnapshotReader & reader, ByteArena & arena);
+  //copies the data of every split into the arena, which then has to outlive
+  //  the value, so the arena it was in can be freed; splits whose data was
+  //  contiguous stay contiguous
+  void relocateData(ByteArena & arena);
+
   BlockData<T> * children = nullptr;
 private:
   std::unordered_map<Timestamp, BlockData<T> *> blocks;
+  SlabAllocator<BlockData<T>> blockAllocator;
+  struct IndexTraits
+  {
+    static uint32_t priority(const BlockData<T> * block);
+    static void recompute(BlockData<T> * block);
+  };
+
+  OrderStatisticTree<BlockData<T>, IndexTraits> blockIndex;
+
+  mutable std::string text;
+  mutable std::u16string utf16Text;
+  mutable std::atomic<bool> textValid = false;
+  mutable std::atomic<bool> utf16TextValid = false;
+  //guards the cached text, which const readers build on first use
+  mutable std::mutex textMutex;
+
+  struct CoalescedInsert
+  {
+    Timestamp id;
+    uint32_t start;
+    uint32_t length;
+  };
+
+  //the insert holding some data of a block, with its range in block offsets
+  struct InsertRange
+  {
+    Timestamp id;
+    uint32_t start;
+    uint32_t end;
+  };
+
+  //host block id -> inserts appended to it, in order of both start and id
+  std::unordered_map<Timestamp, std::vector<CoalescedInsert>> coalescedRuns;
+  //coalesced insert id -> host block id
+  std::unordered_map<Timestamp, Timestamp> coalescedHosts;
+
+  bool coalesceInsert(const Timestamp & blockId, uint32_t offset, const Timestamp & ts,
+    uint32_t length, const T * data, ChangedCallback callback);
+  bool resolveCoalesced(Timestamp & blockId, uint32_t & offset, uint32_t & length) const;
+  InsertRange getInsertRange(const BlockData<T> * block, uint32_t offset) const;
+  std::pair<Timestamp, uint32_t> getInsertPosition(const BlockData<T> * block, uint32_t offset) const;
+  void splitCoalescedRun(const Timestamp & hostId);
+  void removeCoalescedRun(const Timestamp & hostId);
 
   void initializeBlock(const Timestamp & blockId, ChangedCallback callback);
+  void initializeSplits(BlockData<T> * block, uint32_t end, ChangedCallback callback);
+  bool isGarbage(const BlockData<T> * block, const VectorTimestamp & horizon,
+    const std::unordered_set<NodeId> & pinned) const;
+  void removeSplit(BlockData<T> * block);
   void printList() const;
+
+  void updateDataLength(BlockData<T> * block);
+  void updateText(BlockData<T> * block, bool visible);
+  void spliceText(BlockData<T> * block, uint32_t start, uint32_t utf16Start, bool visible);
+  void invalidateText();
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "ByteArena.h"
+#include <cstring>
+#include <utility>
+
+ByteArena::~ByteArena()
+{
+  clear();
+}
+
+char * ByteArena::allocate(size_t length)
+{
+  if (length > remaining)
+  {
+    if (length > chunkSize / 4)
+    {
+      //large allocations get a dedicated chunk so the current chunk can
+      //  still be filled by following small allocations
+      char * chunk = new char[length];
+      chunks.push_back(chunk);
+      allocatedSize += length;
+      return chunk;
+    }
+
+    current = new char[chunkSize];
+    remaining = chunkSize;
+    chunks.push_back(current);
+    allocatedSize += chunkSize;
+  }
+
+  char * ptr = current;
+  current += length;
+  remaining -= length;
+  return ptr;
+}
+
+char * ByteArena::copy(const uint8_t * data, size_t length)
+{
+  char * ptr = allocate(length);
+  std::memcpy(ptr, data, length);
+  return ptr;
+}
+
+void ByteArena::clear()
+{
+  for (auto chunk : chunks)
+  {
+    delete [] chunk;
+  }
+
+  chunks.clear();
+  current = nullptr;
+  remaining = 0;
+  allocatedSize = 0;
+}
+
+void ByteArena::merge(ByteArena & other)
+{
+  chunks.insert(chunks.end(), other.chunks.begin(), other.chunks.end());
+  allocatedSize += other.allocatedSize;
+
+  //keep filling whichever current chunk has more room
+  if (other.remaining > remaining)
+  {
+    current = other.current;
+    remaining = other.remaining;
+  }
+
+  other.chunks.clear();
+  other.current = nullptr;
+  other.remaining = 0;
+  other.allocatedSize = 0;
+}
+
+void ByteArena::swap(ByteArena & other)
+{
+  std::swap(chunks, other.chunks);
+  std::swap(current, other.current);
+  std::swap(remaining, other.remaining);
+  std::swap(allocatedSize, other.allocatedSize);
+}
+
+size_t ByteArena::getAllocatedSize() const
+{
+  return allocatedSize;
+}
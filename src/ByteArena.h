@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Bump allocator for immutable byte data that lives as long as the arena
+//  Small allocations are packed into shared chunks, large ones get their own
+//  chunk; nothing is freed individually
+class ByteArena
+{
+public:
+  ByteArena() = default;
+  ByteArena(const ByteArena &) = delete;
+  ByteArena & operator=(const ByteArena &) = delete;
+  ~ByteArena();
+
+  char * allocate(size_t length);
+  char * copy(const uint8_t * data, size_t length);
+  void clear();
+  //takes over the other arena's allocations, which stay where they are and
+  //  leave it empty
+  void merge(ByteArena & other);
+  void swap(ByteArena & other);
+
+  size_t getAllocatedSize() const;
+
+private:
+  static const size_t chunkSize = 64 * 1024;
+
+  std::vector<char *> chunks;
+  char * current = nullptr;
+  size_t remaining = 0;
+  size_t allocatedSize = 0;
+};
@@ -1,6 +1,15 @@
 #include "Core.h"
 #include "Serialization/LogOperationSerialization.h"
 #include "Streams/CallbackWritableStream.h"
+#include "Snapshot.h"
+#include "ReadView.h"
+#include "OperationLog.h"
+#include <algorithm>
+#include <cstring>
+
+static constexpr char SnapshotMagic[8] = { 'C', 'R', 'D', 'B', 'L', 'S', 'N', 'P' };
+static constexpr uint32_t SnapshotVersion = 6;
+static constexpr size_t SnapshotHeaderSize = sizeof(SnapshotMagic) + sizeof(SnapshotVersion);
 
 Core::Core()
 {
@@ -15,55 +24,10 @@ Core::Core(CoreInit coreInit)
 
 Core::~Core()
 {
-  for (auto it = nodes.begin(); it != nodes.end(); ++it)
+  nodes.forEach([this](const NodeId &, Node * node)
   {
-    Node * node = it->second;
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
-
-    switch (primitiveType)
-    {
-      case PrimitiveNodeTypes::PrimitiveType::Set:
-        delete static_cast<SetNode *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::List:
-        delete static_cast<ListNode *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::Map:
-        delete static_cast<MapNode *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::Reference:
-        delete static_cast<ReferenceNode *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
-        delete static_cast<OrderedFloat64MapNode *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::Int32Value:
-        delete static_cast<ValueNode<int32_t> *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::Int64Value:
-        delete static_cast<ValueNode<int64_t> *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::FloatValue:
-        delete static_cast<ValueNode<float> *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::DoubleValue:
-        delete static_cast<ValueNode<double> *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::Int8Value:
-        delete static_cast<ValueNode<int8_t> *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::BoolValue:
-        delete static_cast<ValueNode<bool> *>(node);
-        break;
-      case PrimitiveNodeTypes::PrimitiveType::StringValue:
-        delete static_cast<BlockValueNode<char> *>(node);
-        break;
-      default:
-        delete node;
-        break;
-    }
-  }
+    deleteNode(node);
+  });
 
   for (auto it : nodeTypeReadyPromises)
   {
@@ -79,30 +43,25 @@ Core::~Core()
   {
     it.second.reject();
   }
-
-  for (auto it : blockValueData)
-  {
-    delete [] it;
-  }
 }
 
 void Core::setUpBuiltInNodes()
 {
   Node * node;
 
-  node = new Node();
+  node = nodeAllocator.create<Node>();
   node->addType(PrimitiveNodeTypes::Null());
   node->effect.initialize();
-  nodes[NodeId::Null] = node;
+  nodes.set(NodeId::Null, node);
 
-  node = new Node();
+  node = nodeAllocator.create<Node>();
   node->addType(PrimitiveNodeTypes::Abstract());
   node->effect.initialize();
-  nodes[NodeId::Root] = node;
+  nodes.set(NodeId::Root, node);
 
-  node = new Node();
+  node = nodeAllocator.create<Node>();
   node->effect.initialize();
-  nodes[NodeId::Pending] = node;
+  nodes.set(NodeId::Pending, node);
 
   //send an artificial event when the root node is created/ready
   waitForNodeReady(NodeId::SiteRoot).then([this]()
@@ -112,51 +71,125 @@ void Core::setUpBuiltInNodes()
     event->edgeId = EdgeId::Null;
     event->childId = NodeId::SiteRoot;
     event->speculative = false;
-    coreInit.eventRaised(*event);
+    raiseEvent(*event);
     delete event;
   });
 }
 
+Node * Core::createNode(PrimitiveNodeTypes::PrimitiveType primitiveType)
+{
+  switch (primitiveType)
+  {
+    case PrimitiveNodeTypes::PrimitiveType::Set:
+      return nodeAllocator.create<SetNode>();
+    case PrimitiveNodeTypes::PrimitiveType::List:
+      return nodeAllocator.create<ListNode>();
+    case PrimitiveNodeTypes::PrimitiveType::Map:
+      return nodeAllocator.create<MapNode>();
+    case PrimitiveNodeTypes::PrimitiveType::Reference:
+      return nodeAllocator.create<ReferenceNode>();
+    case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
+      return nodeAllocator.create<OrderedFloat64MapNode>();
+    case PrimitiveNodeTypes::PrimitiveType::Int32Value:
+      return nodeAllocator.create<ValueNode<int32_t>>();
+    case PrimitiveNodeTypes::PrimitiveType::Int64Value:
+      return nodeAllocator.create<ValueNode<int64_t>>();
+    case PrimitiveNodeTypes::PrimitiveType::FloatValue:
+      return nodeAllocator.create<ValueNode<float>>();
+    case PrimitiveNodeTypes::PrimitiveType::DoubleValue:
+      return nodeAllocator.create<ValueNode<double>>();
+    case PrimitiveNodeTypes::PrimitiveType::Int8Value:
+      return nodeAllocator.create<ValueNode<int8_t>>();
+    case PrimitiveNodeTypes::PrimitiveType::BoolValue:
+      return nodeAllocator.create<ValueNode<bool>>();
+    case PrimitiveNodeTypes::PrimitiveType::StringValue:
+      return nodeAllocator.create<BlockValueNode<char>>();
+    default:
+      return nodeAllocator.create<Node>();
+  }
+}
+
+void Core::deleteNode(Node * node)
+{
+  deleteNode(node, node->getPrimitiveType());
+}
+
+void Core::deleteNode(Node * node, PrimitiveNodeTypes::PrimitiveType primitiveType)
+{
+  switch (primitiveType)
+  {
+    case PrimitiveNodeTypes::PrimitiveType::Set:
+      nodeAllocator.destroy(static_cast<SetNode *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::List:
+      nodeAllocator.destroy(static_cast<ListNode *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::Map:
+      nodeAllocator.destroy(static_cast<MapNode *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::Reference:
+      nodeAllocator.destroy(static_cast<ReferenceNode *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
+      nodeAllocator.destroy(static_cast<OrderedFloat64MapNode *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::Int32Value:
+      nodeAllocator.destroy(static_cast<ValueNode<int32_t> *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::Int64Value:
+      nodeAllocator.destroy(static_cast<ValueNode<int64_t> *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::FloatValue:
+      nodeAllocator.destroy(static_cast<ValueNode<float> *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::DoubleValue:
+      nodeAllocator.destroy(static_cast<ValueNode<double> *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::Int8Value:
+      nodeAllocator.destroy(static_cast<ValueNode<int8_t> *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::BoolValue:
+      nodeAllocator.destroy(static_cast<ValueNode<bool> *>(node));
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::StringValue:
+      nodeAllocator.destroy(static_cast<BlockValueNode<char> *>(node));
+      break;
+    default:
+      nodeAllocator.destroy(node);
+      break;
+  }
+}
+
 char * Core::createBlockValueData(const uint8_t * data, uint32_t length)
 {
   //all block value data is owned by the db and freed when the db unloads
   //due to the immutable and usually permanent nature of block value data
   //this is usually fine and avoids needlessly tracking long-lived items
-  //however, it could definitely still be improved over this simple approach
+  //the data is packed into a bump allocated arena so each inserted run doesn't
+  //cost a separate heap allocation, and it is all released at once
+  //compaction copies the data that is still used into a new arena
 
-  char * dataCopy = new char[length];
-  std::memcpy(dataCopy, data, length);
-  blockValueData.push_back(dataCopy);
-  return dataCopy;
+  return blockValueData.copy(data, length);
 }
 
-const Node * Core::getExistingNode(const NodeId & nodeId) const
+size_t Core::getBlockValueDataSize() const
 {
-  Node * node = nullptr;
-
-  auto it = nodes.find(nodeId);
-  if (it != nodes.end())
-  {
-    node = it->second;
-  }
+  return blockValueData.getAllocatedSize();
+}
 
-  return node;
+const Node * Core::getExistingNode(const NodeId & nodeId) const
+{
+  return nodes.find(nodeId);
 }
 
 Node * Core::getNode(const NodeId & nodeId)
 {
-  Node * node = nullptr;
-
-  auto it = nodes.find(nodeId);
-  if (it != nodes.end())
-  {
-    node = it->second;
-  }
+  Node * node = nodes.find(nodeId);
 
   if (node == nullptr)
   {
-    node = new Node();
-    nodes[nodeId] = node;
+    node = nodeAllocator.create<Node>();
+    nodes.set(nodeId, node);
   }
 
   return node;
@@ -165,9 +198,10 @@ Node * Core::getNode(const NodeId & nodeId)
 template <class T>
 Node * Core::swapNode(Node * node)
 {
-  Node * newNode = new T();
+  //the node is still a plain Node here even though its type may have been added
+  Node * newNode = nodeAllocator.create<T>();
   *newNode = *node;
-  delete node;
+  nodeAllocator.destroy(node);
   return newNode;
 }
 
@@ -238,7 +272,7 @@ void Core::setNodeType(const NodeId & nodeId, const PrimitiveNodeType & type,
       break;
   }
 
-  nodes[nodeId] = node;
+  nodes.set(nodeId, node);
 }
 
 bool Core::isNodeTypeReady(const Node * node) const
@@ -246,7 +280,8 @@ bool Core::isNodeTypeReady(const Node * node) const
   //a node's type is ready when its full type is known (all inherited node types)
   //and the node's class in memory is initialized to the correct primitive type
 
-  if (PrimitiveNodeTypes::isPrimitiveNodeType(node->getBaseType()) && node->isAbstractType() == false)
+  //(non-primitive base types and untyped nodes have the abstract tag)
+  if (node->getPrimitiveType() != PrimitiveNodeTypes::PrimitiveType::Abstract)
   {
     return true;
   }
@@ -318,10 +353,36 @@ void Core::processTypeRequests()
   }
 }
 
+void Core::raiseEvent(const Event & event)
+{
+  if (coreInit.eventBatchRaised)
+  {
+    eventBatch.add(event);
+    return;
+  }
+
+  coreInit.eventRaised(event);
+}
+
+void Core::flushEvents()
+{
+  if (eventBatch.empty())
+  {
+    return;
+  }
+
+  //the listener may apply more operations, which start a batch of their own
+  EventBatch events = std::move(eventBatch);
+  eventBatch.clear();
+  coreInit.eventBatchRaised(events);
+}
+
 void Core::resolveTypeSpec(const std::string & type, const Operation * ops, size_t length)
 {
   NodeType _type = NodeType(type);
 
+  stateVersion++;
+
   auto it = getTypeSpecPromises.find(_type);
   if (it != getTypeSpecPromises.end())
   {
@@ -332,6 +393,12 @@ void Core::resolveTypeSpec(const std::string & type, const Operation * ops, size
 
     processTypeRequests();
   }
+
+  //type specs resolved while requesting them are part of the caller's batch
+  if (!isProcessingTypeRequests)
+  {
+    flushEvents();
+  }
 }
 
 Promise<void> Core::inheritType(const NodeId & nodeId, NodeType type,
@@ -429,15 +496,55 @@ Promise<void> Core::applyOperations(OperationIterator * it, InheritanceContext *
 
 void Core::applyOperation(const RefCounted<const LogOperation> & op)
 {
+  applyLogOperation(op);
+  processTypeRequests();
+  flushEvents();
+}
+
+void Core::applyOperations(std::span<const RefCounted<const LogOperation>> ops)
+{
+  //type requests are only made once the whole batch has been applied, so a
+  //type used by many operations in the batch is only requested once
+  for (const auto & op : ops)
+  {
+    applyLogOperation(op);
+  }
+
+  processTypeRequests();
+  flushEvents();
+}
+
+void Core::applyLogOperation(const RefCounted<const LogOperation> & op)
+{
+  stateVersion++;
+
+  if (op.isBorrowed())
+  {
+    //pending operations are still referenced after this returns, so a
+    //  borrowed operation is copied before it can end up waiting
+    size_t size = op->getSize();
+    auto copy = RefCounted<LogOperation>::Allocate(size);
+    std::memcpy(&(*copy), &(*op), size);
+    applyLogOperation(RefCounted<const LogOperation>(std::move(copy)));
+    return;
+  }
+
   auto promise = applyOperation(op->ts, &op->op, (InheritanceContext *)nullptr);
   if (!promise.isSettled())
   {
+    //previews don't advance the clock, so read views needn't leave them out
+    if (op->op.type != OperationType::ValuePreviewOperation)
+    {
+      pendingOperations[op->ts] = std::max(op->ts, OperationLog::GetFinalTimestamp(*op));
+    }
+
     //this is a bit of an awkward (but valid) way to hold a reference
-    RefCounted<const LogOperation> holdRef(op);
-    promise.then([op = std::move(op)](){});
+    //only operations waiting on a type or node need to hold one
+    promise.then([this, op]()
+    {
+      pendingOperations.erase(op->ts);
+    });
   }
-
-  processTypeRequests();
 }
 
 IWritableStream<RefCounted<const LogOperation>> * Core::createApplyStream()
@@ -455,9 +562,44 @@ IWritableStream<RefCounted<const LogOperation>> * Core::createApplyStream()
   return callbackStream;
 }
 
+IWritableStream<RefCounted<const LogOperation>> * Core::createBatchApplyStream(size_t batchSize)
+{
+  //operations are applied as they are written, but type requests are only
+  //processed (and batched events delivered) every batchSize operations and
+  //when the stream is closed
+  auto * callbackStream = new CallbackWritableStream<RefCounted<const LogOperation>>(
+    [this, batchSize, count = (size_t)0](const RefCounted<const LogOperation> & op) mutable
+    {
+      applyLogOperation(op);
+
+      if (++count >= batchSize)
+      {
+        count = 0;
+        processTypeRequests();
+        flushEvents();
+      }
+    },
+    [this]()
+    {
+      processTypeRequests();
+      flushEvents();
+    });
+
+  return callbackStream;
+}
+
 void Core::unapplyOperation(const RefCounted<const LogOperation> & op)
 {
+  //operations at or below the compaction horizon are final
+  if (compactionHorizon >= op->ts)
+  {
+    return;
+  }
+
+  stateVersion++;
+
   unapplyOperation(op->ts, &op->op);
+  flushEvents();
 }
 
 IWritableStream<RefCounted<const LogOperation>> * Core::createUnapplyStream()
@@ -524,24 +666,51 @@ Promise<void> Core::applyUndoOperation(const Timestamp & ts, const Timestamp & p
 {
   clock.update(ts);
 
+  //the state operations at or below the compaction horizon affected may be
+  //  gone, so they can't be undone anymore
+  if (compactionHorizon >= prevTs)
+  {
+    return Promise<void>::Resolve();
+  }
+
   switch (op->type)
   {
     case OperationType::EdgeCreateOperation:
     case OperationType::UndoEdgeCreateOperation:
-      return applyUndoOperation(ts, prevTs, static_cast<const UndoEdgeCreateOperation *>(op), isUndo);
+    {
+      auto undoOp = static_cast<const UndoEdgeCreateOperation *>(op);
+      addCompactionRecord(ts, undoOp->parentId, NodeId::inheritanceRootFor(prevTs));
+      return applyUndoOperation(ts, prevTs, undoOp, isUndo);
+    }
     case OperationType::EdgeDeleteOperation:
     case OperationType::UndoEdgeDeleteOperation:
-      return applyUndoOperation(ts, prevTs, static_cast<const UndoEdgeDeleteOperation *>(op), isUndo);
+    {
+      auto undoOp = static_cast<const UndoEdgeDeleteOperation *>(op);
+      addCompactionRecord(ts, undoOp->parentId, undoOp->edgeId);
+      return applyUndoOperation(ts, prevTs, undoOp, isUndo);
+    }
 
     case OperationType::ValueSetOperation:
     case OperationType::UndoValueSetOperation:
-      return applyUndoOperation(ts, prevTs, static_cast<const UndoValueSetOperation *>(op), isUndo);
+    {
+      auto undoOp = static_cast<const UndoValueSetOperation *>(op);
+      addCompactionRecord(ts, undoOp->nodeId, NodeId::inheritanceRootFor(prevTs));
+      return applyUndoOperation(ts, prevTs, undoOp, isUndo);
+    }
     case OperationType::BlockValueInsertAfterOperation:
     case OperationType::UndoBlockValueInsertAfterOperation:
-      return applyUndoOperation(ts, prevTs, static_cast<const UndoBlockValueInsertAfterOperation *>(op), isUndo);
+    {
+      auto undoOp = static_cast<const UndoBlockValueInsertAfterOperation *>(op);
+      addCompactionRecord(ts, undoOp->nodeId, NodeId::inheritanceRootFor(prevTs));
+      return applyUndoOperation(ts, prevTs, undoOp, isUndo);
+    }
     case OperationType::BlockValueDeleteAfterOperation:
     case OperationType::UndoBlockValueDeleteAfterOperation:
-      return applyUndoOperation(ts, prevTs, static_cast<const UndoBlockValueDeleteAfterOperation *>(op), isUndo);
+    {
+      auto undoOp = static_cast<const UndoBlockValueDeleteAfterOperation *>(op);
+      addCompactionRecord(ts, undoOp->nodeId, NodeId::inheritanceRootFor(undoOp->blockId));
+      return applyUndoOperation(ts, prevTs, undoOp, isUndo);
+    }
 
     default:
       return Promise<void>::Resolve();
@@ -583,6 +752,12 @@ void Core::unapplyOperation(const Timestamp & ts, const Operation * op)
 
 void Core::unapplyUndoOperation(const Timestamp & ts, const Timestamp & prevTs, const Operation * op, bool isUndo)
 {
+  //undoing these was ignored when they were applied
+  if (compactionHorizon >= prevTs)
+  {
+    return;
+  }
+
   switch (op->type)
   {
     case OperationType::EdgeCreateOperation:
@@ -672,29 +847,26 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const UndoGroupOperatio
   bool isUndo = op->type == OperationType::UndoGroupOperation;
 
   OperationIterator it(reinterpret_cast<const Operation *>(op->data), op->length);
-  PromiseAll * allResolved = new PromiseAll();
+  PromiseAll * allResolved = nullptr;
 
   Timestamp childTs = ts;
   Timestamp childPrevTs = op->prevTs;
 
   while (*it)
   {
-    allResolved->add(applyUndoOperation(childTs, childPrevTs, *it, isUndo));
+    addPendingPromise(allResolved, applyUndoOperation(childTs, childPrevTs, *it, isUndo));
     ++it;
     ++childTs.clock;
     ++childPrevTs.clock;
   }
 
-  return allResolved->getPromise().finally([allResolved]()
-  {
-    delete allResolved;
-  });
+  return getPendingPromise(allResolved);
 }
 
 Promise<void> Core::applyOperation(const Timestamp & ts, const GroupOperation * op, InheritanceContext * inheritanceContext)
 {
   OperationIterator it(reinterpret_cast<const Operation *>(op->data), op->length);
-  PromiseAll * allResolved = new PromiseAll();
+  PromiseAll * allResolved = nullptr;
 
   Timestamp childTs = ts;
 
@@ -702,7 +874,7 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const GroupOperation *
   {
     while (*it)
     {
-      allResolved->add(applyOperation(childTs, *it, (InheritanceContext *)nullptr));
+      addPendingPromise(allResolved, applyOperation(childTs, *it, (InheritanceContext *)nullptr));
       ++it;
       ++childTs.clock;
     }
@@ -712,6 +884,35 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const GroupOperation *
     // do nothing; groups are not allowed in inheritance contexts
   }
 
+  return getPendingPromise(allResolved);
+}
+
+//static
+void Core::addPendingPromise(PromiseAll *& allResolved, Promise<void> promise)
+{
+  //settled promises are ignored by PromiseAll anyway, so only allocate one
+  //once an operation actually has to wait
+  if (promise.isSettled())
+  {
+    return;
+  }
+
+  if (allResolved == nullptr)
+  {
+    allResolved = new PromiseAll();
+  }
+
+  allResolved->add(promise);
+}
+
+//static
+Promise<void> Core::getPendingPromise(PromiseAll * allResolved)
+{
+  if (allResolved == nullptr)
+  {
+    return Promise<void>::Resolve();
+  }
+
   return allResolved->getPromise().finally([allResolved]()
   {
     delete allResolved;
@@ -912,20 +1113,15 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
   NodeId childId = transformNodeId(inheritanceContext, op->childId);
   EdgeId edgeId = transformEdgeId(inheritanceContext, NodeId::inheritanceRootFor(ts));
 
-  bool inherited = inheritanceContext != nullptr;
-
-  std::function<void(EdgeEvent &)> changedCallback = [this, parentId, inherited](EdgeEvent & event)
+  auto changedCallback = [this, parentId](EdgeEvent & event)
   {
-    if (inherited)
-      return;
-
     if (isNodeReady(getExistingNode({ parentId.ts, 0 })) == false)
     {
       return;
     }
 
     event.parentId = parentId;
-    coreInit.eventRaised(event);
+    raiseEvent(event);
   };
 
   auto parentReadyCallback = [this, parentId, childId, edgeId, inheritanceContext,
@@ -933,9 +1129,10 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
   {
     Node * parent = getNode(parentId);
     Node * child = getNode(childId);
-    NodeType parentBaseType = parent->getBaseType();
+    auto parentPrimitiveType = parent->getPrimitiveType();
+    EdgeEventCallback callback = getEdgeEventCallback(changedCallback, inheritanceContext != nullptr);
 
-    if (PrimitiveNodeTypes::isContainerNodeType(parentBaseType) == false)
+    if (PrimitiveNodeTypes::isContainerPrimitiveType(parentPrimitiveType) == false)
     {
       //parent is not a container
       return Promise<void>::Resolve();
@@ -956,14 +1153,13 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
       //only set value speculatively if the node is not yet ready
 
       Edge * createdEdge = nullptr;
-      auto parentPrimitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(parentBaseType);
 
       switch (parentPrimitiveType)
       {
         case PrimitiveNodeTypes::PrimitiveType::Set:
         {
           auto containerNode = static_cast<SetNode *>(parent);
-          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, attributes, changedCallback);
+          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, attributes, callback);
           break;
         }
         case PrimitiveNodeTypes::PrimitiveType::List:
@@ -979,25 +1175,25 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
           {
             prevEdgeId = { {0, 0}, 0 };
           }
-          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, prevEdgeId, attributes, changedCallback);
+          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, prevEdgeId, attributes, callback);
           break;
         }
         case PrimitiveNodeTypes::PrimitiveType::Map:
         {
           auto containerNode = static_cast<MapNode *>(parent);
-          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, attributes, changedCallback);
+          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, attributes, callback);
           break;
         }
         case PrimitiveNodeTypes::PrimitiveType::Reference:
         {
           auto containerNode = static_cast<ReferenceNode *>(parent);
-          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, attributes, changedCallback);
+          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, attributes, callback);
           break;
         }
         case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
         {
           auto containerNode = static_cast<OrderedFloat64MapNode *>(parent);
-          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, attributes, changedCallback);
+          createdEdge = containerNode->createEdge(edgeId, NodeId::Pending, attributes, callback);
           break;
         }
         default:
@@ -1023,8 +1219,8 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
     {
       Node * parent = getNode(parentId);
       Node * child = getNode(childId);
-      NodeType parentBaseType = parent->getBaseType();
-      auto parentPrimitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(parentBaseType);
+      auto parentPrimitiveType = parent->getPrimitiveType();
+      EdgeEventCallback callback = getEdgeEventCallback(changedCallback, inheritanceContext != nullptr);
 
       auto containerNode = static_cast<ContainerNode *>(parent);
 
@@ -1033,7 +1229,7 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
       {
         auto referenceNode = static_cast<ReferenceNode *>(parent);
         canCreateEdge = child->isDerivedFromType(referenceNode->childType.getValueOrDefault()) ||
-          (referenceNode->nullable && PrimitiveNodeTypes::isNullNodeType(child->getBaseType()));
+          (referenceNode->nullable && child->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::Null);
       }
       else
       {
@@ -1053,31 +1249,31 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
             case PrimitiveNodeTypes::PrimitiveType::Set:
             {
               auto containerNode = static_cast<SetNode *>(parent);
-              containerNode->deleteEdge(edgeId, changedCallback);
+              containerNode->deleteEdge(edgeId, callback);
               break;
             }
             case PrimitiveNodeTypes::PrimitiveType::List:
             {
               auto containerNode = static_cast<ListNode *>(parent);
-              containerNode->deleteEdge(edgeId, changedCallback);
+              containerNode->deleteEdge(edgeId, callback);
               break;
             }
             case PrimitiveNodeTypes::PrimitiveType::Map:
             {
               auto containerNode = static_cast<MapNode *>(parent);
-              containerNode->deleteEdge(edgeId, changedCallback);
+              containerNode->deleteEdge(edgeId, callback);
               break;
             }
             case PrimitiveNodeTypes::PrimitiveType::Reference:
             {
               auto containerNode = static_cast<ReferenceNode *>(parent);
-              containerNode->deleteEdge(edgeId, changedCallback);
+              containerNode->deleteEdge(edgeId, callback);
               break;
             }
             case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
             {
               auto containerNode = static_cast<OrderedFloat64MapNode *>(parent);
-              containerNode->deleteEdge(edgeId, changedCallback);
+              containerNode->deleteEdge(edgeId, callback);
               break;
             }
             default:
@@ -1097,7 +1293,7 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
           case PrimitiveNodeTypes::PrimitiveType::Set:
           {
             auto containerNode = static_cast<SetNode *>(parent);
-            createdEdge = containerNode->createEdge(edgeId, childId, attributes, changedCallback);
+            createdEdge = containerNode->createEdge(edgeId, childId, attributes, callback);
             break;
           }
           case PrimitiveNodeTypes::PrimitiveType::List:
@@ -1113,25 +1309,25 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
             {
               prevEdgeId = { {0, 0}, 0 };
             }
-            createdEdge = containerNode->createEdge(edgeId, childId, prevEdgeId, attributes, changedCallback);
+            createdEdge = containerNode->createEdge(edgeId, childId, prevEdgeId, attributes, callback);
             break;
           }
           case PrimitiveNodeTypes::PrimitiveType::Map:
           {
             auto containerNode = static_cast<MapNode *>(parent);
-            createdEdge = containerNode->createEdge(edgeId, childId, attributes, changedCallback);
+            createdEdge = containerNode->createEdge(edgeId, childId, attributes, callback);
             break;
           }
           case PrimitiveNodeTypes::PrimitiveType::Reference:
           {
             auto containerNode = static_cast<ReferenceNode *>(parent);
-            createdEdge = containerNode->createEdge(edgeId, childId, attributes, changedCallback);
+            createdEdge = containerNode->createEdge(edgeId, childId, attributes, callback);
             break;
           }
           case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
           {
             auto containerNode = static_cast<OrderedFloat64MapNode *>(parent);
-            createdEdge = containerNode->createEdge(edgeId, childId, attributes, changedCallback);
+            createdEdge = containerNode->createEdge(edgeId, childId, attributes, callback);
             break;
           }
           default:
@@ -1160,31 +1356,31 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeCreateOperati
           case PrimitiveNodeTypes::PrimitiveType::Set:
           {
             auto containerNode = static_cast<SetNode *>(parent);
-            containerNode->initEdge(edgeId, childId, changedCallback);
+            containerNode->initEdge(edgeId, childId, callback);
             break;
           }
           case PrimitiveNodeTypes::PrimitiveType::List:
           {
             auto containerNode = static_cast<ListNode *>(parent);
-            containerNode->initEdge(edgeId, childId, changedCallback);
+            containerNode->initEdge(edgeId, childId, callback);
             break;
           }
           case PrimitiveNodeTypes::PrimitiveType::Map:
           {
             auto containerNode = static_cast<MapNode *>(parent);
-            containerNode->initEdge(edgeId, childId, changedCallback);
+            containerNode->initEdge(edgeId, childId, callback);
             break;
           }
           case PrimitiveNodeTypes::PrimitiveType::Reference:
           {
             auto containerNode = static_cast<ReferenceNode *>(parent);
-            containerNode->initEdge(edgeId, childId, changedCallback);
+            containerNode->initEdge(edgeId, childId, callback);
             break;
           }
           case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
           {
             auto containerNode = static_cast<OrderedFloat64MapNode *>(parent);
-            containerNode->initEdge(edgeId, childId, changedCallback);
+            containerNode->initEdge(edgeId, childId, callback);
             break;
           }
           default:
@@ -1214,25 +1410,26 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const EdgeDeleteOperati
   EdgeId edgeId = transformNodeId(inheritanceContext, op->edgeId);
 
   bool inherited = inheritanceContext != nullptr;
+  if (!inherited)
+  {
+    addCompactionRecord(ts, parentId, edgeId);
+  }
 
   return waitForNodeTypeReady(parentId).then([this, parentId, edgeId, inherited]()
   {
     Node * node = getNode(parentId);
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
-    std::function<void(EdgeEvent &)> changedCallback = [this, parentId, inherited](EdgeEvent & event)
+    auto changedCallback = [this, parentId](EdgeEvent & event)
     {
-      if (inherited == true) return;
-
       event.parentId = parentId;
-      coreInit.eventRaised(event);
+      raiseEvent(event);
     };
 
     int effect = -1; //(op->type == OperationType::UndoEdgeDeleteOperation) ? 1 : -1;
 
     auto updateNode = [&](auto * nodeType) {
-      nodeType->updateEdgeEffect(edgeId, effect, inherited, changedCallback);
+      nodeType->updateEdgeEffect(edgeId, effect, inherited, getEdgeEventCallback(changedCallback, inherited));
     };
 
     switch (primitiveType)
@@ -1264,7 +1461,7 @@ template<typename T>
 int Core::valueNodeChangedCallback(Core * core, const NodeId & nodeId,
   bool generateEvent, const T & newValue, const T & oldValue)
 {
-  if (generateEvent == false) return 0;
+  if (generateEvent == false || !core->coreInit.hasEventListener) return 0;
 
   if (!core->isNodeReady(core->getExistingNode({ nodeId.ts, 0 })))
   {
@@ -1275,7 +1472,7 @@ int Core::valueNodeChangedCallback(Core * core, const NodeId & nodeId,
   event.nodeId = nodeId;
   event.newValue = newValue;
   event.oldValue = oldValue;
-  core->coreInit.eventRaised(event);
+  core->raiseEvent(event);
 
   return 0;
 }
@@ -1284,7 +1481,7 @@ int Core::valueNodeChangedCallback(Core * core, const NodeId & nodeId,
 int Core::blockValueNodeChangedCallback(Core * core, const Timestamp & ts,
   const NodeId & nodeId, size_t offset, const char * data, uint32_t length)
 {
-  if (!core->isNodeReady(core->getExistingNode({ nodeId.ts, 0 })))
+  if (!core->coreInit.hasEventListener || !core->isNodeReady(core->getExistingNode({ nodeId.ts, 0 })))
   {
     return 0;
   }
@@ -1296,7 +1493,7 @@ int Core::blockValueNodeChangedCallback(Core * core, const Timestamp & ts,
     event.nodeId = nodeId;
     event.offset = offset;
     event.length = length;
-    core->coreInit.eventRaised(event);
+    core->raiseEvent(event);
   }
   else
   {
@@ -1306,7 +1503,7 @@ int Core::blockValueNodeChangedCallback(Core * core, const Timestamp & ts,
     event.offset = offset;
     event.str = data;
     event.length = length;
-    core->coreInit.eventRaised(event);
+    core->raiseEvent(event);
   }
 
   return 0;
@@ -1318,12 +1515,15 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const ValueSetOperation
   Timestamp tts = transformTimestamp(inheritanceContext, ts);
 
   bool generateEvent = inheritanceContext == nullptr;
+  if (generateEvent && op->type == OperationType::ValueSetOperation)
+  {
+    addCompactionRecord(ts, nodeId, NodeId::Null);
+  }
 
   return waitForNodeTypeReady(nodeId).then([this, nodeId, tts, op, generateEvent]()
   {
     Node * node = getNode(nodeId);
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
     auto updateNode = [&](auto * nodeType) {
       auto callback = [this, nodeId, generateEvent](auto newValue, auto oldValue) {
@@ -1379,13 +1579,12 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const BlockValueInsertA
   return waitForNodeTypeReady(nodeId).then([this, nodeId, blockId, tts, op, inheritanceContext]()
   {
     Node * node = getNode(nodeId);
-    NodeType baseType = node->getBaseType();
 
     auto callback = [this, tts, nodeId](auto offset, auto data, auto length) {
       Core::blockValueNodeChangedCallback(this, tts, nodeId, offset, data, length);
     };
 
-    if (baseType == PrimitiveNodeTypes::StringValue())
+    if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
     {
       if (inheritanceContext != nullptr)
       {
@@ -1440,16 +1639,20 @@ Promise<void> Core::applyOperation(const Timestamp & ts, const BlockValueDeleteA
   NodeId nodeId = transformNodeId(inheritanceContext, op->nodeId);
   Timestamp blockId = transformBlockId(inheritanceContext, op->nodeId, op->blockId);
 
+  if (inheritanceContext == nullptr)
+  {
+    addCompactionRecord(ts, nodeId, NodeId::inheritanceRootFor(blockId));
+  }
+
   return waitForNodeTypeReady(nodeId).then([this, ts, nodeId, blockId, op, inheritanceContext]()
   {
     Node * node = getNode(nodeId);
-    NodeType baseType = node->getBaseType();
 
     auto callback = [this, ts, nodeId](auto offset, auto data, auto length) {
       Core::blockValueNodeChangedCallback(this, ts, nodeId, offset, data, length);
     };
 
-    if (baseType == PrimitiveNodeTypes::StringValue())
+    if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
     {
       if (inheritanceContext != nullptr)
       {
@@ -1487,19 +1690,18 @@ Promise<void> Core::applyUndoOperation(const Timestamp & ts, const Timestamp & p
   return waitForNodeTypeReady(op->parentId).then([this, prevTs, op, isUndo]()
   {
     Node * node = getNode(op->parentId);
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
-    std::function<void(EdgeEvent &)> changedCallback = [this, op](EdgeEvent & event)
+    auto changedCallback = [this, op](EdgeEvent & event)
     {
       event.parentId = op->parentId;
-      coreInit.eventRaised(event);
+      raiseEvent(event);
     };
 
     int effect = (isUndo) ? -1 : 1;
 
     auto updateNode = [&](auto * nodeType) {
-      nodeType->updateEdgeEffect(NodeId::inheritanceRootFor(prevTs), effect, false, changedCallback);
+      nodeType->updateEdgeEffect(NodeId::inheritanceRootFor(prevTs), effect, false, getEdgeEventCallback(changedCallback));
     };
 
     switch (primitiveType)
@@ -1532,19 +1734,18 @@ Promise<void> Core::applyUndoOperation(const Timestamp & ts, const Timestamp & p
   return waitForNodeTypeReady(op->parentId).then([this, op, isUndo]()
   {
     Node * node = getNode(op->parentId);
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
-    std::function<void(EdgeEvent &)> changedCallback = [this, op](EdgeEvent & event)
+    auto changedCallback = [this, op](EdgeEvent & event)
     {
       event.parentId = op->parentId;
-      coreInit.eventRaised(event);
+      raiseEvent(event);
     };
 
     int effect = (isUndo) ? 1 : -1;
 
     auto updateNode = [&](auto * nodeType) {
-      nodeType->updateEdgeEffect(op->edgeId, effect, false, changedCallback);
+      nodeType->updateEdgeEffect(op->edgeId, effect, false, getEdgeEventCallback(changedCallback));
     };
 
     switch (primitiveType)
@@ -1579,8 +1780,7 @@ Promise<void> Core::applyUndoOperation(const Timestamp & ts, const Timestamp & p
     NodeId nodeId = op->nodeId;
     Node * node = getNode(nodeId);
     int effect = (isUndo) ? -1 : 1;
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
     bool generateEvent = /* !(node->isVisible() */ true;
 
@@ -1624,14 +1824,13 @@ Promise<void> Core::applyUndoOperation(const Timestamp & ts, const Timestamp & p
   return waitForNodeTypeReady(op->nodeId).then([this, ts, prevTs, op, isUndo]()
   {
     Node * node = getNode(op->nodeId);
-    NodeType baseType = node->getBaseType();
     int effect = (isUndo) ? -1 : 1;
 
     auto callback = [this, ts, nodeId = op->nodeId](auto offset, auto data, auto length) {
       Core::blockValueNodeChangedCallback(this, ts, nodeId, offset, data, length);
     };
 
-    if (baseType == PrimitiveNodeTypes::StringValue())
+    if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
     {
       auto blockValueNode = static_cast<BlockValueNode<char> *>(node);
       blockValueNode->value.updateEffect(prevTs, 0, BlockData<char>::maxLength,
@@ -1650,14 +1849,13 @@ Promise<void> Core::applyUndoOperation(const Timestamp & ts, const Timestamp & p
   return waitForNodeTypeReady(op->nodeId).then([this, ts, op, isUndo]()
   {
     Node * node = getNode(op->nodeId);
-    NodeType baseType = node->getBaseType();
     int effect = (isUndo) ? 1 : -1;
 
     auto callback = [this, ts, nodeId = op->nodeId](auto offset, auto data, auto length) {
       Core::blockValueNodeChangedCallback(this, ts, nodeId, offset, data, length);
     };
 
-    if (baseType == PrimitiveNodeTypes::StringValue())
+    if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
     {
       auto blockValueNode = static_cast<BlockValueNode<char> *>(node);
       blockValueNode->value.updateEffect(op->blockId, op->offset, op->length, effect, callback);
@@ -1733,17 +1931,16 @@ void Core::unapplyOperation(const Timestamp & ts, const EdgeCreateOperation * op
   waitForNodeTypeReady(op->parentId).then([this, ts, op]()
   {
     Node * node = getNode(op->parentId);
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
-    std::function<void(EdgeEvent &)> changedCallback = [this, op](EdgeEvent & event)
+    auto changedCallback = [this, op](EdgeEvent & event)
     {
       event.parentId = op->parentId;
-      coreInit.eventRaised(event);
+      raiseEvent(event);
     };
 
     auto updateNode = [&](auto * nodeType) {
-      nodeType->updateEdgeEffect(NodeId::inheritanceRootFor(ts), 0, true, changedCallback);
+      nodeType->updateEdgeEffect(NodeId::inheritanceRootFor(ts), 0, true, getEdgeEventCallback(changedCallback));
     };
 
     switch (primitiveType)
@@ -1775,19 +1972,18 @@ void Core::unapplyOperation(const Timestamp & ts, const EdgeDeleteOperation * op
   waitForNodeTypeReady(op->parentId).then([this, op]()
   {
     Node * node = getNode(op->parentId);
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
-    std::function<void(EdgeEvent &)> changedCallback = [this, op](EdgeEvent & event)
+    auto changedCallback = [this, op](EdgeEvent & event)
     {
       event.parentId = op->parentId;
-      coreInit.eventRaised(event);
+      raiseEvent(event);
     };
 
     int effect = 1;
 
     auto updateNode = [&](auto * nodeType) {
-      nodeType->updateEdgeEffect(op->edgeId, effect, false, changedCallback);
+      nodeType->updateEdgeEffect(op->edgeId, effect, false, getEdgeEventCallback(changedCallback));
     };
 
     switch (primitiveType)
@@ -1820,8 +2016,7 @@ void Core::unapplyOperation(const Timestamp & ts, const ValueSetOperation * op)
   {
     NodeId nodeId = op->nodeId;
     Node * node = getNode(nodeId);
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
     bool generateEvent = /* !(node->isVisible() */ true;
 
@@ -1865,13 +2060,12 @@ void Core::unapplyOperation(const Timestamp & ts, const BlockValueInsertAfterOpe
   waitForNodeTypeReady(op->nodeId).then([this, ts, op]()
   {
     Node * node = getNode(op->nodeId);
-    NodeType baseType = node->getBaseType();
 
     auto callback = [this, ts, nodeId = op->nodeId](auto offset, auto data, auto length) {
       Core::blockValueNodeChangedCallback(this, ts, nodeId, offset, data, length);
     };
 
-    if (baseType == PrimitiveNodeTypes::StringValue())
+    if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
     {
       auto blockValueNode = static_cast<BlockValueNode<char> *>(node);
       blockValueNode->value.deinitializeBlock(ts, callback);
@@ -1888,14 +2082,13 @@ void Core::unapplyOperation(const Timestamp & ts, const BlockValueDeleteAfterOpe
   waitForNodeTypeReady(op->nodeId).then([this, ts, op]()
   {
     Node * node = getNode(op->nodeId);
-    NodeType baseType = node->getBaseType();
     int effect = 1;
 
     auto callback = [this, ts, nodeId = op->nodeId](auto offset, auto data, auto length) {
       Core::blockValueNodeChangedCallback(this, ts, nodeId, offset, data, length);
     };
 
-    if (baseType == PrimitiveNodeTypes::StringValue())
+    if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
     {
       auto blockValueNode = static_cast<BlockValueNode<char> *>(node);
       blockValueNode->value.updateEffect(op->blockId, op->offset, op->length, effect, callback);
@@ -1912,19 +2105,18 @@ void Core::unapplyUndoOperation(const Timestamp & ts, const Timestamp & prevTs,
   waitForNodeTypeReady(op->parentId).then([this, prevTs, op, isUndo]()
   {
     Node * node = getNode(op->parentId);
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
-    std::function<void(EdgeEvent &)> changedCallback = [this, op](EdgeEvent & event)
+    auto changedCallback = [this, op](EdgeEvent & event)
     {
       event.parentId = op->parentId;
-      coreInit.eventRaised(event);
+      raiseEvent(event);
     };
 
     int effect = (isUndo) ? 1 : -1;
 
     auto updateNode = [&](auto * nodeType) {
-      nodeType->updateEdgeEffect(NodeId::inheritanceRootFor(prevTs), effect, false, changedCallback);
+      nodeType->updateEdgeEffect(NodeId::inheritanceRootFor(prevTs), effect, false, getEdgeEventCallback(changedCallback));
     };
 
     switch (primitiveType)
@@ -1956,19 +2148,18 @@ void Core::unapplyUndoOperation(const Timestamp & ts, const Timestamp & prevTs,
   waitForNodeTypeReady(op->parentId).then([this, op, isUndo]()
   {
     Node * node = getNode(op->parentId);
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
-    std::function<void(EdgeEvent &)> changedCallback = [this, op](EdgeEvent & event)
+    auto changedCallback = [this, op](EdgeEvent & event)
     {
       event.parentId = op->parentId;
-      coreInit.eventRaised(event);
+      raiseEvent(event);
     };
 
     int effect = (isUndo) ? -1 : 1;
 
     auto updateNode = [&](auto * nodeType) {
-      nodeType->updateEdgeEffect(op->edgeId, effect, false, changedCallback);
+      nodeType->updateEdgeEffect(op->edgeId, effect, false, getEdgeEventCallback(changedCallback));
     };
 
     switch (primitiveType)
@@ -2002,8 +2193,7 @@ void Core::unapplyUndoOperation(const Timestamp & ts, const Timestamp & prevTs,
     NodeId nodeId = op->nodeId;
     Node * node = getNode(nodeId);
     int effect = (isUndo) ? 1 : -1;
-    NodeType baseType = node->getBaseType();
-    auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
+    auto primitiveType = node->getPrimitiveType();
 
     bool generateEvent = /* !(node->isVisible() */ true;
 
@@ -2047,14 +2237,13 @@ void Core::unapplyUndoOperation(const Timestamp & ts, const Timestamp & prevTs,
   waitForNodeTypeReady(op->nodeId).then([this, ts, prevTs, op, isUndo]()
   {
     Node * node = getNode(op->nodeId);
-    NodeType baseType = node->getBaseType();
     int effect = (isUndo) ? 1 : -1;
 
     auto callback = [this, ts, nodeId = op->nodeId](auto offset, auto data, auto length) {
       Core::blockValueNodeChangedCallback(this, ts, nodeId, offset, data, length);
     };
 
-    if (baseType == PrimitiveNodeTypes::StringValue())
+    if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
     {
       auto blockValueNode = static_cast<BlockValueNode<char> *>(node);
       blockValueNode->value.updateEffect(prevTs, 0, BlockData<char>::maxLength, effect, callback);
@@ -2071,14 +2260,13 @@ void Core::unapplyUndoOperation(const Timestamp & ts, const Timestamp & prevTs,
   waitForNodeTypeReady(op->nodeId).then([this, ts, op, isUndo]()
   {
     Node * node = getNode(op->nodeId);
-    NodeType baseType = node->getBaseType();
     int effect = (isUndo) ? -1 : 1;
 
     auto callback = [this, ts, nodeId = op->nodeId](auto offset, auto data, auto length) {
       Core::blockValueNodeChangedCallback(this, ts, nodeId, offset, data, length);
     };
 
-    if (baseType == PrimitiveNodeTypes::StringValue())
+    if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
     {
       auto blockValueNode = static_cast<BlockValueNode<char> *>(node);
       blockValueNode->value.updateEffect(op->blockId, op->offset, op->length, effect, callback);
@@ -2100,8 +2288,12 @@ void Core::serializeNode(IObjectSerializer & serializer, const NodeId & nodeId)
     return;
   }
 
-  NodeType type = node->getBaseType();
-  auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(type);
+  serializeNode(serializer, node);
+}
+
+void Core::serializeNode(IObjectSerializer & serializer, const Node * node) const
+{
+  auto primitiveType = node->getPrimitiveType();
 
   switch (primitiveType)
   {
@@ -2157,25 +2349,30 @@ void Core::serializeNodeChildren(IObjectSerializer & serializer, const NodeId &
     return;
   }
 
-  NodeType type = node->getBaseType();
-  auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(type);
+  serializeNodeChildren(serializer, node, includePending, nullptr);
+}
+
+void Core::serializeNodeChildren(IObjectSerializer & serializer, const Node * node, bool includePending,
+  const SerializeChildCallback & serializeChild) const
+{
+  auto primitiveType = node->getPrimitiveType();
 
   switch (primitiveType)
   {
     case PrimitiveNodeTypes::PrimitiveType::Set:
-      static_cast<const SetNode *>(node)->serializeChildren(serializer, includePending);
+      static_cast<const SetNode *>(node)->serializeChildren(serializer, includePending, serializeChild);
       break;
     case PrimitiveNodeTypes::PrimitiveType::List:
-      static_cast<const ListNode *>(node)->serializeChildren(serializer, includePending);
+      static_cast<const ListNode *>(node)->serializeChildren(serializer, includePending, serializeChild);
       break;
     case PrimitiveNodeTypes::PrimitiveType::Map:
-      static_cast<const MapNode *>(node)->serializeChildren(serializer, includePending);
+      static_cast<const MapNode *>(node)->serializeChildren(serializer, includePending, serializeChild);
       break;
     case PrimitiveNodeTypes::PrimitiveType::Reference:
-      static_cast<const ReferenceNode *>(node)->serializeChildren(serializer, includePending);
+      static_cast<const ReferenceNode *>(node)->serializeChildren(serializer, includePending, serializeChild);
       break;
     case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
-      static_cast<const OrderedFloat64MapNode *>(node)->serializeChildren(serializer, includePending);
+      static_cast<const OrderedFloat64MapNode *>(node)->serializeChildren(serializer, includePending, serializeChild);
       break;
     default:
       serializer.addNullValue();
@@ -2183,48 +2380,139 @@ void Core::serializeNodeChildren(IObjectSerializer & serializer, const NodeId &
   }
 }
 
-double Core::getNodeValue(const NodeId & nodeId) const
+void Core::serializeSubtree(IObjectSerializer & serializer, const NodeId & rootId, bool includePending,
+  uint32_t maxDepth, const SubtreeFilter & filter) const
 {
-  const Node * node = getExistingNode(nodeId);
+  const Node * node = getExistingNode(rootId);
 
   if (node == nullptr)
   {
-    return 0;
+    serializer.addNullValue();
+    return;
   }
 
-  NodeType type = node->getBaseType();
-  auto primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(type);
+  SubtreeContext context = { serializer, includePending, std::min(maxDepth, MaxSubtreeDepth), filter, {} };
+  serializeSubtree(context, rootId, node);
+}
+
+void Core::serializeSubtree(SubtreeContext & context, const NodeId & nodeId, const Node * node) const
+{
+  IObjectSerializer & serializer = context.serializer;
+
+  serializeNode(serializer, node);
+  serializer.resumeObject();
+  serializer.addPair("id", nodeId);
+
+  auto primitiveType = node->getPrimitiveType();
 
   switch (primitiveType)
   {
+    case PrimitiveNodeTypes::PrimitiveType::StringValue:
+      serializer.addPair("value", static_cast<const BlockValueNode<char> *>(node)->value.getText());
+      break;
     case PrimitiveNodeTypes::PrimitiveType::BoolValue:
-    {
-      auto * valueNode = static_cast<const ValueNode<bool> *>(node);
-      return static_cast<double>(valueNode->value.getValue());
+      serializer.addPair("value", static_cast<const ValueNode<bool> *>(node)->value.getValue());
       break;
-    }
     case PrimitiveNodeTypes::PrimitiveType::DoubleValue:
-    {
-      auto * valueNode = static_cast<const ValueNode<double> *>(node);
-      return static_cast<double>(valueNode->value.getValue());
+      serializer.addPair("value", static_cast<const ValueNode<double> *>(node)->value.getValue());
       break;
-    }
     case PrimitiveNodeTypes::PrimitiveType::FloatValue:
-    {
-      auto * valueNode = static_cast<const ValueNode<float> *>(node);
-      return static_cast<double>(valueNode->value.getValue());
+      serializer.addPair("value", static_cast<const ValueNode<float> *>(node)->value.getValue());
       break;
-    }
     case PrimitiveNodeTypes::PrimitiveType::Int32Value:
-    {
-      auto * valueNode = static_cast<const ValueNode<int32_t> *>(node);
-      return static_cast<double>(valueNode->value.getValue());
+      serializer.addPair("value", static_cast<const ValueNode<int32_t> *>(node)->value.getValue());
       break;
-    }
     case PrimitiveNodeTypes::PrimitiveType::Int64Value:
-    {
-      auto * valueNode = static_cast<const ValueNode<int64_t> *>(node);
-      return static_cast<double>(valueNode->value.getValue());
+      serializer.addPair("value", static_cast<const ValueNode<int64_t> *>(node)->value.getValue());
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::Int8Value:
+      serializer.addPair("value", static_cast<const ValueNode<int8_t> *>(node)->value.getValue());
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::Reference:
+      //a reference's target belongs somewhere else in the tree, so it is only listed
+      if (context.path.size() < context.maxDepth)
+      {
+        serializer.addKey("children");
+        serializeNodeChildren(serializer, node, context.includePending, nullptr);
+      }
+      break;
+    case PrimitiveNodeTypes::PrimitiveType::Set:
+    case PrimitiveNodeTypes::PrimitiveType::List:
+    case PrimitiveNodeTypes::PrimitiveType::Map:
+    case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
+      if (context.path.size() < context.maxDepth)
+      {
+        context.path.insert(node);
+
+        serializer.addKey("children");
+        serializeNodeChildren(serializer, node, context.includePending,
+          [this, &context](const NodeId & childId)
+        {
+          const Node * child = getExistingNode(childId);
+
+          //(a node can end up under itself through concurrent edits)
+          if (child == nullptr
+            || (context.filter && !context.filter(childId))
+            || context.path.contains(child))
+          {
+            return;
+          }
+
+          context.serializer.addKey("node");
+          serializeSubtree(context, childId, child);
+        });
+
+        context.path.erase(node);
+      }
+      break;
+    default:
+      break;
+  }
+
+  serializer.endObject();
+}
+
+double Core::getNodeValue(const NodeId & nodeId) const
+{
+  const Node * node = getExistingNode(nodeId);
+
+  if (node == nullptr)
+  {
+    return 0;
+  }
+
+  auto primitiveType = node->getPrimitiveType();
+
+  switch (primitiveType)
+  {
+    case PrimitiveNodeTypes::PrimitiveType::BoolValue:
+    {
+      auto * valueNode = static_cast<const ValueNode<bool> *>(node);
+      return static_cast<double>(valueNode->value.getValue());
+      break;
+    }
+    case PrimitiveNodeTypes::PrimitiveType::DoubleValue:
+    {
+      auto * valueNode = static_cast<const ValueNode<double> *>(node);
+      return static_cast<double>(valueNode->value.getValue());
+      break;
+    }
+    case PrimitiveNodeTypes::PrimitiveType::FloatValue:
+    {
+      auto * valueNode = static_cast<const ValueNode<float> *>(node);
+      return static_cast<double>(valueNode->value.getValue());
+      break;
+    }
+    case PrimitiveNodeTypes::PrimitiveType::Int32Value:
+    {
+      auto * valueNode = static_cast<const ValueNode<int32_t> *>(node);
+      return static_cast<double>(valueNode->value.getValue());
+      break;
+    }
+    case PrimitiveNodeTypes::PrimitiveType::Int64Value:
+    {
+      auto * valueNode = static_cast<const ValueNode<int64_t> *>(node);
+      return static_cast<double>(valueNode->value.getValue());
       break;
     }
     case PrimitiveNodeTypes::PrimitiveType::Int8Value:
@@ -2248,11 +2536,646 @@ void Core::getNodeBlockValue(std::string & outString, const NodeId & nodeId) con
     return;
   }
 
-  NodeType type = node->getBaseType();
-
-  if (type == PrimitiveNodeTypes::StringValue())
+  if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
   {
     auto * blockValueNode = static_cast<const BlockValueNode<char> *>(node);
-    outString += blockValueNode->value.toString();
+    outString += blockValueNode->value.getText();
+  }
+}
+
+void Core::getNodeBlockValue(std::string & outString, const NodeId & nodeId,
+  size_t offset, size_t length) const
+{
+  std::string_view value = getNodeBlockValueView(nodeId);
+  outString += value.substr(std::min(offset, value.size()), length);
+}
+
+void Core::getNodeBlockValueUtf16(std::u16string & outString, const NodeId & nodeId,
+  size_t offset, size_t length) const
+{
+  std::u16string_view value = getNodeBlockValueUtf16View(nodeId);
+  outString += value.substr(std::min(offset, value.size()), length);
+}
+
+std::string_view Core::getNodeBlockValueView(const NodeId & nodeId) const
+{
+  const Node * node = getExistingNode(nodeId);
+
+  if (node == nullptr || node->getPrimitiveType() != PrimitiveNodeTypes::PrimitiveType::StringValue)
+  {
+    return std::string_view();
+  }
+
+  return static_cast<const BlockValueNode<char> *>(node)->value.getText();
+}
+
+std::u16string_view Core::getNodeBlockValueUtf16View(const NodeId & nodeId) const
+{
+  const Node * node = getExistingNode(nodeId);
+
+  if (node == nullptr || node->getPrimitiveType() != PrimitiveNodeTypes::PrimitiveType::StringValue)
+  {
+    return std::u16string_view();
+  }
+
+  return static_cast<const BlockValueNode<char> *>(node)->value.getUtf16Text();
+}
+
+bool Core::hasPendingOperations() const
+{
+  //the site root's ready promise only raises an event once it exists, so it
+  //  doesn't hold back any operations
+  if (!getTypeSpecPromises.empty() || !typeRequests.empty() || !nodeTypeReadyPromises.empty())
+  {
+    return true;
+  }
+  for (const auto & it : nodeReadyPromises)
+  {
+    if (it.first != NodeId::SiteRoot)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Core::isCreatedByPendingOperation(const NodeId & nodeId) const
+{
+  //nodes inherited from a type share the timestamp of the node created with it
+  for (const auto & [first, final] : pendingOperations)
+  {
+    if (nodeId.ts.site == first.site && nodeId.ts.clock >= first.clock
+      && nodeId.ts.clock <= final.clock)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Core::saveSnapshot(std::basic_string<char> & output) const
+{
+  //operations waiting on a type spec or a node can't be written
+  if (hasPendingOperations())
+  {
+    return false;
+  }
+
+  writeSnapshot(output, false);
+  return true;
+}
+
+void Core::saveReadViewSnapshot(std::basic_string<char> & output) const
+{
+  writeSnapshot(output, true);
+}
+
+void Core::writeSnapshot(std::basic_string<char> & output, bool withoutPending) const
+{
+  SnapshotWriter writer;
+
+  std::vector<uint32_t> vector = clock.getVector();
+  std::vector<std::pair<NodeId, const Node *>> writtenNodes;
+  writtenNodes.reserve(nodes.size());
+  if (withoutPending)
+  {
+    //neither the nodes pending operations create nor nodes that were only
+    //  ever waited on are written; the operations are listed as excluded
+    nodes.forEach([&](const NodeId & nodeId, const Node * node)
+    {
+      bool isPlaceholder = node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::Abstract
+        && !node->effect.isInitialized();
+      if (!isPlaceholder && !isCreatedByPendingOperation(nodeId))
+      {
+        writtenNodes.emplace_back(nodeId, node);
+      }
+    });
+  }
+  else
+  {
+    nodes.forEach([&](const NodeId & nodeId, const Node * node)
+    {
+      writtenNodes.emplace_back(nodeId, node);
+    });
+  }
+
+  writer.writeUInt(vector.size());
+  for (uint32_t value : vector)
+  {
+    writer.writeUInt(value);
+  }
+
+  writer.writeUInt(writtenNodes.size());
+  for (const auto & [nodeId, node] : writtenNodes)
+  {
+    auto primitiveType = node->getPrimitiveType();
+
+    writer.writeNodeId(nodeId);
+    writer.writeUInt(static_cast<uint64_t>(primitiveType));
+
+    switch (primitiveType)
+    {
+      case PrimitiveNodeTypes::PrimitiveType::StringValue:
+        static_cast<const BlockValueNode<char> *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::BoolValue:
+        static_cast<const ValueNode<bool> *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::DoubleValue:
+        static_cast<const ValueNode<double> *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::FloatValue:
+        static_cast<const ValueNode<float> *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Int32Value:
+        static_cast<const ValueNode<int32_t> *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Int64Value:
+        static_cast<const ValueNode<int64_t> *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Int8Value:
+        static_cast<const ValueNode<int8_t> *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Set:
+        static_cast<const SetNode *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::List:
+        static_cast<const ListNode *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Map:
+        static_cast<const MapNode *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Reference:
+        static_cast<const ReferenceNode *>(node)->saveSnapshot(writer);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
+        static_cast<const OrderedFloat64MapNode *>(node)->saveSnapshot(writer);
+        break;
+      default:
+        node->saveSnapshot(writer);
+        break;
+    }
+  }
+
+  //compaction state, so operations the source core ignores are ignored by
+  //  the loaded one too
+  vector = compactionHorizon.getVector();
+  writer.writeUInt(vector.size());
+  for (uint32_t value : vector)
+  {
+    writer.writeUInt(value);
+  }
+
+  //records without an item only mark their node for compaction
+  std::unordered_set<NodeId> candidates = compactionCandidates;
+  size_t recordCount = 0;
+  for (const auto & record : compactionRecords)
+  {
+    if (record.itemId.isNull())
+    {
+      candidates.insert(record.nodeId);
+    }
+    else
+    {
+      recordCount++;
+    }
+  }
+
+  writer.writeUInt(recordCount);
+  for (const auto & record : compactionRecords)
+  {
+    if (!record.itemId.isNull())
+    {
+      writer.writeTimestamp(record.ts);
+      writer.writeNodeId(record.nodeId);
+      writer.writeNodeId(record.itemId);
+    }
+  }
+
+  writer.writeUInt(candidates.size());
+  for (const auto & nodeId : candidates)
+  {
+    writer.writeNodeId(nodeId);
+  }
+
+  //operations the clock covers that the state doesn't (only for read views)
+  if (withoutPending)
+  {
+    writer.writeUInt(pendingOperations.size());
+    for (const auto & [first, final] : pendingOperations)
+    {
+      writer.writeTimestamp(first);
+      writer.writeTimestamp(final);
+    }
+  }
+  else
+  {
+    writer.writeUInt(0);
+  }
+
+  output.append(SnapshotMagic, sizeof(SnapshotMagic));
+  output.append(reinterpret_cast<const char *>(&SnapshotVersion), sizeof(SnapshotVersion));
+  writer.finish(output);
+}
+
+bool Core::loadSnapshot(const std::string_view & data)
+{
+  return loadSnapshot(data, false);
+}
+
+bool Core::loadSnapshot(const std::string_view & data, bool isReadView)
+{
+  if (!clock.isEmpty())
+  {
+    return false;
+  }
+
+  stateVersion++;
+
+  uint32_t version = 0;
+  if (data.size() < SnapshotHeaderSize
+    || std::memcmp(data.data(), SnapshotMagic, sizeof(SnapshotMagic)) != 0)
+  {
+    return false;
+  }
+  std::memcpy(&version, data.data() + sizeof(SnapshotMagic), sizeof(version));
+  if (version != SnapshotVersion)
+  {
+    return false;
+  }
+
+  SnapshotReader reader(data.substr(SnapshotHeaderSize));
+
+  std::vector<uint32_t> vector(reader.readCount());
+  for (auto & value : vector)
+  {
+    value = static_cast<uint32_t>(reader.readUInt());
+  }
+
+  //string data is kept apart until the snapshot turns out to be valid, so a
+  //  failed load doesn't leave it behind in the db's arena
+  NodeTable loadedNodes;
+  ByteArena loadedData;
+  size_t count = reader.readCount();
+  for (size_t i = 0; i < count && !reader.hasError(); i++)
+  {
+    NodeId nodeId = reader.readNodeId();
+    uint64_t type = reader.readUInt();
+    if (type > static_cast<uint64_t>(PrimitiveNodeTypes::PrimitiveType::StringValue))
+    {
+      reader.setError();
+      break;
+    }
+
+    auto primitiveType = static_cast<PrimitiveNodeTypes::PrimitiveType>(type);
+    Node * node = createNode(primitiveType);
+
+    switch (primitiveType)
+    {
+      case PrimitiveNodeTypes::PrimitiveType::StringValue:
+        static_cast<BlockValueNode<char> *>(node)->loadSnapshot(reader, loadedData);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::BoolValue:
+        static_cast<ValueNode<bool> *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::DoubleValue:
+        static_cast<ValueNode<double> *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::FloatValue:
+        static_cast<ValueNode<float> *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Int32Value:
+        static_cast<ValueNode<int32_t> *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Int64Value:
+        static_cast<ValueNode<int64_t> *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Int8Value:
+        static_cast<ValueNode<int8_t> *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Set:
+        static_cast<SetNode *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::List:
+        static_cast<ListNode *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Map:
+        static_cast<MapNode *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Reference:
+        static_cast<ReferenceNode *>(node)->loadSnapshot(reader);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
+        static_cast<OrderedFloat64MapNode *>(node)->loadSnapshot(reader);
+        break;
+      default:
+        node->loadSnapshot(reader);
+        break;
+    }
+
+    //nodes are deleted according to their base type, so it has to match
+    //  the class they were loaded as
+    if (node->getPrimitiveType() != primitiveType
+      || loadedNodes.find(nodeId) != nullptr)
+    {
+      deleteNode(node, primitiveType);
+      reader.setError();
+    }
+    else
+    {
+      loadedNodes.set(nodeId, node);
+    }
+  }
+
+  std::vector<uint32_t> horizon(reader.readCount());
+  for (auto & value : horizon)
+  {
+    value = static_cast<uint32_t>(reader.readUInt());
+  }
+
+  std::vector<CompactionRecord> records(reader.readCount(3));
+  for (auto & record : records)
+  {
+    record.ts = reader.readTimestamp();
+    record.nodeId = reader.readNodeId();
+    record.itemId = reader.readNodeId();
+  }
+
+  std::unordered_set<NodeId> candidates;
+  count = reader.readCount();
+  for (size_t i = 0; i < count && !reader.hasError(); i++)
+  {
+    candidates.insert(reader.readNodeId());
+  }
+
+  //a core can't go on from a state that leaves out operations its clock
+  //  covers, so only read views load snapshots with excluded operations
+  std::vector<std::pair<Timestamp, Timestamp>> excluded(reader.readCount(2));
+  for (auto & [first, final] : excluded)
+  {
+    first = reader.readTimestamp();
+    final = reader.readTimestamp();
+  }
+  if (!excluded.empty() && !isReadView)
+  {
+    reader.setError();
+  }
+
+  if (reader.hasError() || !reader.isAtEnd())
+  {
+    loadedNodes.forEach([this](const NodeId &, Node * node)
+    {
+      deleteNode(node);
+    });
+
+    return false;
+  }
+
+  nodes.forEach([this](const NodeId &, Node * node)
+  {
+    deleteNode(node);
+  });
+  nodes = std::move(loadedNodes);
+  blockValueData.merge(loadedData);
+  blockValueCache.clear();
+  clock = VectorTimestamp(vector);
+  compactionHorizon = VectorTimestamp(horizon);
+  //the horizon is kept either way, since operations below it are ignored
+  if (coreInit.compactionEnabled)
+  {
+    compactionRecords = std::move(records);
+    compactionCandidates = std::move(candidates);
+  }
+  excludedOperations = std::move(excluded);
+
+  //anything waiting on nodes from the snapshot (e.g. the site root's event)
+  //  can continue now
+  std::vector<NodeId> readyNodes;
+  for (const auto & it : nodeTypeReadyPromises)
+  {
+    if (isNodeTypeReady(getNode(it.first)))
+    {
+      readyNodes.push_back(it.first);
+    }
+  }
+  for (const auto & nodeId : readyNodes)
+  {
+    auto it = nodeTypeReadyPromises.find(nodeId);
+    Promise<void> promise = it->second;
+    nodeTypeReadyPromises.erase(it);
+    promise.resolve();
+  }
+
+  readyNodes.clear();
+  for (const auto & it : nodeReadyPromises)
+  {
+    if (isNodeReady(getNode(it.first)))
+    {
+      readyNodes.push_back(it.first);
+    }
+  }
+  for (const auto & nodeId : readyNodes)
+  {
+    auto it = nodeReadyPromises.find(nodeId);
+    Promise<void> promise = it->second;
+    nodeReadyPromises.erase(it);
+    promise.resolve();
+  }
+
+  return true;
+}
+
+std::shared_ptr<const ReadView> Core::createReadView() const
+{
+  return loadReadView(prepareReadView());
+}
+
+Core::ReadViewRequest Core::prepareReadView() const
+{
+  ReadViewRequest request;
+  request.version = stateVersion;
+
+  {
+    std::lock_guard<std::mutex> lock(readViewMutex);
+    if (readViewVersion == stateVersion)
+    {
+      request.view = readView.lock();
+    }
+  }
+
+  if (request.view == nullptr)
+  {
+    saveReadViewSnapshot(request.snapshot);
+  }
+
+  return request;
+}
+
+std::shared_ptr<const ReadView> Core::loadReadView(ReadViewRequest && request) const
+{
+  if (request.view != nullptr)
+  {
+    return std::move(request.view);
+  }
+
+  auto view = ReadView::load(request.snapshot);
+  if (view == nullptr)
+  {
+    return nullptr;
+  }
+
+  //the state may have changed while loading, so the view is only shared if
+  //  nothing newer has been shared since
+  std::lock_guard<std::mutex> lock(readViewMutex);
+  if (readViewVersion == request.version)
+  {
+    if (auto sharedView = readView.lock())
+    {
+      return sharedView;
+    }
+  }
+  if (readViewVersion <= request.version)
+  {
+    readView = view;
+    readViewVersion = request.version;
+  }
+
+  return view;
+}
+
+void Core::addCompactionRecord(const Timestamp & ts, const NodeId & nodeId, const NodeId & itemId)
+{
+  if (!coreInit.compactionEnabled)
+  {
+    return;
+  }
+
+  compactionRecords.push_back({ ts, nodeId, itemId });
+}
+
+bool Core::compact(const VectorTimestamp & horizon)
+{
+  if (!coreInit.compactionEnabled || hasPendingOperations())
+  {
+    return false;
+  }
+
+  std::vector<uint32_t> vector = horizon.getVector();
+  for (uint32_t site = 0; site < vector.size(); site++)
+  {
+    if (vector[site] > clock.getClockAtSite(site))
+    {
+      return false;
+    }
+  }
+
+  //the horizon, records and state are all part of snapshots
+  stateVersion++;
+
+  compactionHorizon.merge(horizon);
+
+  //records at or below the horizon point at nodes that may have garbage,
+  //  newer ones keep the item they affect since they can still be undone
+  std::unordered_map<NodeId, std::unordered_set<NodeId>> pinned;
+  size_t kept = 0;
+  for (const auto & record : compactionRecords)
+  {
+    if (compactionHorizon >= record.ts)
+    {
+      compactionCandidates.insert(record.nodeId);
+    }
+    else
+    {
+      pinned[record.nodeId].insert(record.itemId);
+      compactionRecords[kept++] = record;
+    }
   }
-}
\ No newline at end of file
+  compactionRecords.resize(kept);
+  compactionRecords.shrink_to_fit();
+
+  static const std::unordered_set<NodeId> noPinnedItems;
+
+  for (auto it = compactionCandidates.begin(); it != compactionCandidates.end();)
+  {
+    const NodeId & nodeId = *it;
+    Node * node = nodes.find(nodeId);
+    if (node == nullptr)
+    {
+      it = compactionCandidates.erase(it);
+      continue;
+    }
+
+    auto primitiveType = node->getPrimitiveType();
+
+    auto pinnedIt = pinned.find(nodeId);
+    const std::unordered_set<NodeId> & pinnedItems =
+      (pinnedIt != pinned.end()) ? pinnedIt->second : noPinnedItems;
+
+    bool complete = true;
+    switch (primitiveType)
+    {
+      case PrimitiveNodeTypes::PrimitiveType::StringValue:
+        complete = static_cast<BlockValueNode<char> *>(node)->value.compact(compactionHorizon, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::BoolValue:
+        complete = static_cast<ValueNode<bool> *>(node)->value.compact(compactionHorizon, nodeId.ts, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::DoubleValue:
+        complete = static_cast<ValueNode<double> *>(node)->value.compact(compactionHorizon, nodeId.ts, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::FloatValue:
+        complete = static_cast<ValueNode<float> *>(node)->value.compact(compactionHorizon, nodeId.ts, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Int32Value:
+        complete = static_cast<ValueNode<int32_t> *>(node)->value.compact(compactionHorizon, nodeId.ts, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Int64Value:
+        complete = static_cast<ValueNode<int64_t> *>(node)->value.compact(compactionHorizon, nodeId.ts, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Int8Value:
+        complete = static_cast<ValueNode<int8_t> *>(node)->value.compact(compactionHorizon, nodeId.ts, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Set:
+        complete = static_cast<SetNode *>(node)->compact(compactionHorizon, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::List:
+        complete = static_cast<ListNode *>(node)->compact(compactionHorizon, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Map:
+        complete = static_cast<MapNode *>(node)->compact(compactionHorizon, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::Reference:
+        complete = static_cast<ReferenceNode *>(node)->compact(compactionHorizon, pinnedItems);
+        break;
+      case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
+        complete = static_cast<OrderedFloat64MapNode *>(node)->compact(compactionHorizon, pinnedItems);
+        break;
+      default:
+        break;
+    }
+
+    if (complete)
+    {
+      it = compactionCandidates.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  //freed text is still in the arena, so the rest is copied out of it
+  ByteArena liveData;
+  nodes.forEach([&liveData](const NodeId &, Node * node)
+  {
+    if (node->getPrimitiveType() == PrimitiveNodeTypes::PrimitiveType::StringValue)
+    {
+      static_cast<BlockValueNode<char> *>(node)->value.relocateData(liveData);
+    }
+  });
+  blockValueData.swap(liveData);
+
+  return true;
+}
\ No newline at end of file
@@ -2,12 +2,19 @@
 #include <string>
 #include <cstring>
 #include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <set>
 #include <vector>
 #include "CoreInit.h"
 #include "Event.h"
+#include "EventBatch.h"
 #include "Promise.h"
 #include "PromiseAll.h"
 #include "Timestamp.h"
@@ -22,7 +29,10 @@
 #include "Nodes/OrderedFloat64MapNode.h"
 #include "Nodes/ValueNode.h"
 #include "Nodes/BlockValueNode.h"
+#include "Nodes/NodeAllocator.h"
+#include "NodeTable.h"
 #include "BlockValueCacheItem.h"
+#include "ByteArena.h"
 #include "Operation.h"
 #include "LogOperation.h"
 #include "OperationIterator.h"
@@ -33,6 +43,8 @@
 #include "Streams/IWritableStream.h"
 #include "RefCounted.h"
 
+class ReadView;
+
 class Core
 {
 public:
@@ -41,7 +53,9 @@ public:
   ~Core();
 
   void applyOperation(const RefCounted<const LogOperation> & op);
+  void applyOperations(std::span<const RefCounted<const LogOperation>> ops);
   IWritableStream<RefCounted<const LogOperation>> * createApplyStream();
+  IWritableStream<RefCounted<const LogOperation>> * createBatchApplyStream(size_t batchSize = 1024);
   void unapplyOperation(const RefCounted<const LogOperation> & op);
   IWritableStream<RefCounted<const LogOperation>> * createUnapplyStream();
 
@@ -50,30 +64,144 @@ public:
   void serializeNode(IObjectSerializer & serializer, const NodeId & nodeId) const;
   void serializeNodeChildren(IObjectSerializer & serializer, const NodeId & nodeId, bool includePending) const;
 
+  //Writes a node and everything under it in one pass, instead of a call per
+  //  node: each node is written as by serializeNode with its "id" and, for
+  //  value and string nodes, its "value"; containers get a "children" array
+  //  as written by serializeNodeChildren, with each child under "node"
+  //Children below maxDepth levels, children the filter rejects, and the
+  //  targets of references are listed without their node
+  //Writing recurses once per level, so levels below MaxSubtreeDepth are left
+  //  out whatever maxDepth is, to keep deep (or hostile) documents from
+  //  overflowing the stack; they can be written from a node at that depth
+  static constexpr uint32_t MaxSubtreeDepth = 64;
+  using SubtreeFilter = std::function<bool(const NodeId & nodeId)>;
+  void serializeSubtree(IObjectSerializer & serializer, const NodeId & rootId, bool includePending,
+    uint32_t maxDepth = UINT32_MAX, const SubtreeFilter & filter = nullptr) const;
+
   double getNodeValue(const NodeId & nodeId) const;
   void getNodeBlockValue(std::string & outString, const NodeId & nodeId) const;
+  //offset and length are in bytes for UTF-8 and in code units for UTF-16
+  void getNodeBlockValue(std::string & outString, const NodeId & nodeId,
+    size_t offset, size_t length) const;
+  void getNodeBlockValueUtf16(std::u16string & outString, const NodeId & nodeId,
+    size_t offset = 0, size_t length = SIZE_MAX) const;
+  //views of the cached text without copying; valid until the node changes
+  std::string_view getNodeBlockValueView(const NodeId & nodeId) const;
+  std::u16string_view getNodeBlockValueUtf16View(const NodeId & nodeId) const;
+
+  //Snapshots hold the materialized state (nodes, edges, values, block values
+  //  and the clock), so a core can be loaded without replaying its log; only
+  //  operations the snapshot's clock doesn't include need to be applied after
+  //Saving fails while operations are waiting on a type spec or a node, and
+  //  loading fails if any operations have already been applied
+  bool saveSnapshot(std::basic_string<char> & output) const;
+  bool loadSnapshot(const std::string_view & data);
+
+  //Frees state that only operations at or below the horizon needed: removed
+  //  edges and text, overwritten values, and splits of the same text block
+  //The text that is left is copied into a new arena, so the memory of freed
+  //  text is released too
+  //The horizon has to be causally stable (every site has seen it), so later
+  //  operations are all newer than it; undo/redo and unapply of operations
+  //  at or below it are ignored from then on, so such operations must not be
+  //  reapplied either
+  //Fails unless compaction is enabled (see CoreInit::enableCompaction), while
+  //  operations are waiting on a type spec or a node, or if the horizon is
+  //  ahead of the clock
+  bool compact(const VectorTimestamp & horizon);
+
+  //A read-only copy of the current state, which stays as it is while more
+  //  operations are applied (see ReadView); views are shared for as long as
+  //  the state doesn't change and someone still holds them
+  //Operations waiting on a type spec or a node are left out: the nodes they
+  //  create aren't in the view, and the view lists them as excluded from its
+  //  clock (see ReadView::getExcludedOperations)
+  std::shared_ptr<const ReadView> createReadView() const;
+  //createReadView in two steps, for callers that lock the core while reading
+  //  it: prepareReadView needs the lock and only returns the shared view or
+  //  saves a snapshot; loadReadView doesn't touch the core's state, so the
+  //  view can be loaded after the lock is released
+  struct ReadViewRequest
+  {
+    std::shared_ptr<const ReadView> view;
+    std::basic_string<char> snapshot;
+    uint64_t version = 0;
+  };
+  ReadViewRequest prepareReadView() const;
+  std::shared_ptr<const ReadView> loadReadView(ReadViewRequest && request) const;
+  //The snapshot read views are loaded from (with ReadView::load), for callers
+  //  that load views themselves; unlike saveSnapshot it never fails
+  void saveReadViewSnapshot(std::basic_string<char> & output) const;
 
   VectorTimestamp clock;
 
   const Node * getExistingNode(const NodeId & nodeId) const;
+  //bytes allocated for block value text
+  size_t getBlockValueDataSize() const;
 
 private:
   CoreInit coreInit;
   std::unordered_map<NodeType, Promise<std::tuple<const Operation *, size_t>>> getTypeSpecPromises;
   std::unordered_map<NodeId, Promise<void>> nodeTypeReadyPromises;
   std::unordered_map<NodeId, Promise<void>> nodeReadyPromises;
-  std::unordered_map<NodeId, Node *> nodes;
+  NodeTable nodes;
+  NodeAllocator nodeAllocator;
 
   std::unordered_map<std::pair<NodeType, uint32_t>, BlockValueCacheItem, PairHash> blockValueCache;
 
   char * createBlockValueData(const uint8_t * data, uint32_t length);
-  std::vector<char *> blockValueData;
+  ByteArena blockValueData;
 
+  void applyLogOperation(const RefCounted<const LogOperation> & op);
   void processTypeRequests();
   bool isProcessingTypeRequests = false;
   std::vector<NodeType> typeRequests;
 
+  //raises the event, or adds it to the batch when events are batched
+  void raiseEvent(const Event & event);
+  //delivers the batched events, if there are any
+  void flushEvents();
+  EventBatch eventBatch;
+
+  bool hasPendingOperations() const;
+  //the first and final timestamp of each operation still waiting on a type
+  //  spec or a node
+  std::map<Timestamp, Timestamp> pendingOperations;
+  bool isCreatedByPendingOperation(const NodeId & nodeId) const;
+  //the snapshot of the state, optionally without the pending operations
+  //  (which can't be written as they are)
+  void writeSnapshot(std::basic_string<char> & output, bool withoutPending) const;
+  bool loadSnapshot(const std::string_view & data, bool isReadView);
+  //the first and final timestamp of each operation a read view's clock covers
+  //  but its state leaves out
+  std::vector<std::pair<Timestamp, Timestamp>> excludedOperations;
+  friend class ReadView;
+
+  //bumped whenever the state can change, so read views know when to be retaken
+  uint64_t stateVersion = 0;
+  mutable std::mutex readViewMutex;
+  mutable std::weak_ptr<const ReadView> readView;
+  mutable uint64_t readViewVersion = 0;
+
+  //operations that can leave garbage behind, and for newer ones (which may
+  //  still be undone) the item they affect
+  struct CompactionRecord
+  {
+    Timestamp ts;
+    NodeId nodeId;
+    NodeId itemId;
+  };
+
+  void addCompactionRecord(const Timestamp & ts, const NodeId & nodeId, const NodeId & itemId);
+  std::vector<CompactionRecord> compactionRecords;
+  //nodes that couldn't be fully compacted last time
+  std::unordered_set<NodeId> compactionCandidates;
+  VectorTimestamp compactionHorizon;
+
   void setUpBuiltInNodes();
+  Node * createNode(PrimitiveNodeTypes::PrimitiveType primitiveType);
+  void deleteNode(Node * node);
+  void deleteNode(Node * node, PrimitiveNodeTypes::PrimitiveType primitiveType);
 
   Promise<std::tuple<const Operation *, size_t>> getTypeSpec(NodeType nodeType);
 
@@ -84,6 +212,22 @@ private:
 
   Node * getNode(const NodeId & nodeId);
 
+  void serializeNode(IObjectSerializer & serializer, const Node * node) const;
+  void serializeNodeChildren(IObjectSerializer & serializer, const Node * node, bool includePending,
+    const SerializeChildCallback & serializeChild) const;
+
+  struct SubtreeContext
+  {
+    IObjectSerializer & serializer;
+    bool includePending;
+    uint32_t maxDepth;
+    const SubtreeFilter & filter;
+    //the containers being written, from the root down
+    std::unordered_set<const Node *> path;
+  };
+
+  void serializeSubtree(SubtreeContext & context, const NodeId & nodeId, const Node * node) const;
+
   template <class T>
   Node * swapNode(Node * node);
   void assignContainerNodeAttributes(Node * node, const AttributeMap * attributes);
@@ -162,6 +306,22 @@ private:
   void unapplyUndoOperation(const Timestamp & ts, const Timestamp & prevTs,
     const UndoBlockValueDeleteAfterOperation * op, bool isUndo);
 
+  static void addPendingPromise(PromiseAll *& allResolved, Promise<void> promise);
+  static Promise<void> getPendingPromise(PromiseAll * allResolved);
+
+  //what containers raise their edge events through: null for inherited edges
+  //  (whose events are never raised) and when there is no listener
+  template<typename F>
+  EdgeEventCallback getEdgeEventCallback(F & changedCallback, bool inherited = false) const
+  {
+    if (inherited || !coreInit.hasEventListener)
+    {
+      return nullptr;
+    }
+
+    return EdgeEventCallback(changedCallback);
+  }
+
   template<typename T>
   static int valueNodeChangedCallback(Core * core, const NodeId & nodeId,
     bool generateEvent, const T & newValue, const T & oldValue);
@@ -0,0 +1,300 @@
+#include "CoreHost.h"
+#include "Streams/CallbackWritableStream.h"
+#include <algorithm>
+
+//the host and worker the current thread belongs to, so work scheduled from a
+//  worker goes to that worker's own queue
+static thread_local const CoreHost * currentHost = nullptr;
+static thread_local size_t currentWorker = 0;
+
+CoreHost::CoreHost(size_t threadCount)
+{
+  if (threadCount == 0)
+  {
+    threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  workers.reserve(threadCount);
+  for (size_t i = 0; i < threadCount; i++)
+  {
+    workers.push_back(std::make_unique<Worker>());
+  }
+
+  for (size_t i = 0; i < threadCount; i++)
+  {
+    workers[i]->thread = std::thread([this, i]()
+    {
+      run(i);
+    });
+  }
+}
+
+CoreHost::~CoreHost()
+{
+  //workers finish everything that is queued before they stop
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wakeCondition.notify_all();
+
+  for (auto & worker : workers)
+  {
+    worker->thread.join();
+  }
+}
+
+CoreHost::DocumentId CoreHost::addDocument(CoreInit coreInit)
+{
+  std::unique_lock<std::shared_mutex> lock(documentsMutex);
+  documents.push_back(std::make_unique<Document>(coreInit));
+  return documents.size() - 1;
+}
+
+size_t CoreHost::getDocumentCount() const
+{
+  std::shared_lock<std::shared_mutex> lock(documentsMutex);
+  return documents.size();
+}
+
+size_t CoreHost::getThreadCount() const
+{
+  return workers.size();
+}
+
+void CoreHost::submit(DocumentId documentId, const RefCounted<const LogOperation> & op)
+{
+  submit(documentId, std::span<const RefCounted<const LogOperation>>(&op, 1));
+}
+
+void CoreHost::submit(DocumentId documentId, std::span<const RefCounted<const LogOperation>> ops)
+{
+  if (ops.empty())
+  {
+    return;
+  }
+
+  Document & document = getDocument(documentId);
+
+  std::unique_lock<std::mutex> lock(document.mutex);
+  document.pending.reserve(document.pending.size() + ops.size());
+  for (const auto & op : ops)
+  {
+    document.pending.push_back(op);
+  }
+  if (document.scheduled)
+  {
+    return;
+  }
+  document.scheduled = true;
+  lock.unlock();
+
+  schedule(document);
+}
+
+IWritableStream<RefCounted<const LogOperation>> * CoreHost::createApplyStream(DocumentId documentId)
+{
+  auto * callbackStream = new CallbackWritableStream<RefCounted<const LogOperation>>(
+    [this, documentId](const RefCounted<const LogOperation> & op)
+    {
+      submit(documentId, op);
+    },
+    []()
+    {
+
+    });
+
+  return callbackStream;
+}
+
+void CoreHost::post(DocumentId documentId, std::function<void(Core & core)> task)
+{
+  Document & document = getDocument(documentId);
+
+  std::unique_lock<std::mutex> lock(document.mutex);
+  document.tasks.emplace_back(document.pending.size(), std::move(task));
+  if (document.scheduled)
+  {
+    return;
+  }
+  document.scheduled = true;
+  lock.unlock();
+
+  schedule(document);
+}
+
+void CoreHost::wait()
+{
+  std::unique_lock<std::mutex> lock(idleMutex);
+  idleCondition.wait(lock, [this]()
+  {
+    return scheduledCount.load(std::memory_order_acquire) == 0;
+  });
+}
+
+Core & CoreHost::getCore(DocumentId documentId)
+{
+  return getDocument(documentId).core;
+}
+
+const Core & CoreHost::getCore(DocumentId documentId) const
+{
+  return getDocument(documentId).core;
+}
+
+CoreHost::Document & CoreHost::getDocument(DocumentId documentId) const
+{
+  std::shared_lock<std::shared_mutex> lock(documentsMutex);
+  return *documents[documentId];
+}
+
+void CoreHost::schedule(Document & document)
+{
+  scheduledCount.fetch_add(1, std::memory_order_relaxed);
+  enqueue(&document, false);
+}
+
+void CoreHost::enqueue(Document * document, bool toFront)
+{
+  size_t workerIndex = currentHost == this
+    ? currentWorker
+    : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+  Worker & worker = *workers[workerIndex];
+
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (toFront)
+    {
+      worker.queue.push_front(document);
+    }
+    else
+    {
+      worker.queue.push_back(document);
+    }
+  }
+
+  //the count is raised before taking the sleep lock so a worker that is
+  //  about to sleep either sees it or gets the notification
+  queuedCount.fetch_add(1, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+  }
+  wakeCondition.notify_one();
+}
+
+CoreHost::Document * CoreHost::take(size_t workerIndex)
+{
+  {
+    Worker & worker = *workers[workerIndex];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!worker.queue.empty())
+    {
+      Document * document = worker.queue.back();
+      worker.queue.pop_back();
+      queuedCount.fetch_sub(1, std::memory_order_relaxed);
+      return document;
+    }
+  }
+
+  for (size_t i = 1; i < workers.size(); i++)
+  {
+    Worker & victim = *workers[(workerIndex + i) % workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.queue.empty())
+    {
+      Document * document = victim.queue.front();
+      victim.queue.pop_front();
+      queuedCount.fetch_sub(1, std::memory_order_relaxed);
+      return document;
+    }
+  }
+
+  return nullptr;
+}
+
+void CoreHost::run(size_t workerIndex)
+{
+  currentHost = this;
+  currentWorker = workerIndex;
+
+  //reused between documents so their capacity is kept
+  std::vector<RefCounted<const LogOperation>> ops;
+  std::vector<std::pair<size_t, std::function<void(Core & core)>>> tasks;
+
+  while (true)
+  {
+    Document * document = take(workerIndex);
+
+    if (document == nullptr)
+    {
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      wakeCondition.wait(lock, [this]()
+      {
+        return stopping || queuedCount.load(std::memory_order_acquire) > 0;
+      });
+
+      if (stopping && queuedCount.load(std::memory_order_acquire) == 0)
+      {
+        break;
+      }
+      continue;
+    }
+
+    work(*document, ops, tasks);
+  }
+
+  currentHost = nullptr;
+}
+
+void CoreHost::work(Document & document,
+  std::vector<RefCounted<const LogOperation>> & ops,
+  std::vector<std::pair<size_t, std::function<void(Core & core)>>> & tasks)
+{
+  //everything queued so far is taken at once and applied as a batch, so new
+  //  work can be submitted while it is being applied
+  {
+    std::lock_guard<std::mutex> lock(document.mutex);
+    ops.swap(document.pending);
+    tasks.swap(document.tasks);
+  }
+
+  size_t start = 0;
+  for (auto & [position, task] : tasks)
+  {
+    if (position > start)
+    {
+      document.core.applyOperations(std::span(ops.data() + start, position - start));
+      start = position;
+    }
+    task(document.core);
+  }
+
+  if (ops.size() > start)
+  {
+    document.core.applyOperations(std::span(ops.data() + start, ops.size() - start));
+  }
+
+  ops.clear();
+  tasks.clear();
+
+  std::unique_lock<std::mutex> lock(document.mutex);
+  if (!document.pending.empty() || !document.tasks.empty())
+  {
+    lock.unlock();
+
+    //more work came in meanwhile; it goes behind the documents already
+    //  waiting on this worker (and is the first to be stolen)
+    enqueue(&document, true);
+    return;
+  }
+  document.scheduled = false;
+  lock.unlock();
+
+  if (scheduledCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    {
+      std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    idleCondition.notify_all();
+  }
+}
\ No newline at end of file
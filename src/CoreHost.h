@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <thread>
+#include <vector>
+#include "Core.h"
+#include "CoreInit.h"
+#include "LogOperation.h"
+#include "RefCounted.h"
+#include "Streams/IWritableStream.h"
+
+//Owns many independent documents, each with its own core, and applies the
+//  operations submitted to them on a pool of worker threads
+//A document is only ever worked on by one thread at a time, and its
+//  operations are applied in the order they were submitted; different
+//  documents are applied in parallel
+//Operations from RefCounted::Allocate (as made by the deserializers and the
+//  builder) can be copied and released from any thread while the host holds
+//  them; borrowed ones are fine as long as their memory outlives the work
+//Operations adopted through the RefCounted constructor are handed over to
+//  the host: other references to them must not be copied or released while
+//  the host may still be holding them, since their counts aren't atomic
+//Event and type spec callbacks run on the worker threads
+class CoreHost
+{
+public:
+  using DocumentId = size_t;
+
+  //0 threads uses one per hardware thread
+  explicit CoreHost(size_t threadCount = 0);
+  ~CoreHost();
+
+  CoreHost(const CoreHost &) = delete;
+  CoreHost & operator=(const CoreHost &) = delete;
+
+  DocumentId addDocument(CoreInit coreInit = CoreInit());
+  size_t getDocumentCount() const;
+  size_t getThreadCount() const;
+
+  //may be called from any thread, including from the host's own callbacks
+  void submit(DocumentId documentId, const RefCounted<const LogOperation> & op);
+  void submit(DocumentId documentId, std::span<const RefCounted<const LogOperation>> ops);
+  IWritableStream<RefCounted<const LogOperation>> * createApplyStream(DocumentId documentId);
+
+  //runs a task against the document's core once the operations submitted
+  //  before it have been applied (e.g. resolving a type spec or reading)
+  void post(DocumentId documentId, std::function<void(Core & core)> task);
+
+  //blocks until every submitted operation and task has run
+  void wait();
+
+  //only safe when the document has no work queued, e.g. after wait
+  Core & getCore(DocumentId documentId);
+  const Core & getCore(DocumentId documentId) const;
+
+private:
+  struct Document
+  {
+    Document(CoreInit coreInit) : core(coreInit) {}
+
+    Core core;
+
+    std::mutex mutex;
+    std::vector<RefCounted<const LogOperation>> pending;
+    //tasks along with the number of pending operations to apply before them
+    std::vector<std::pair<size_t, std::function<void(Core & core)>>> tasks;
+    //queued or being worked on by a worker
+    bool scheduled = false;
+  };
+
+  //documents are taken from the back of a worker's own queue, and stolen
+  //  from the front of other workers' queues
+  struct Worker
+  {
+    std::mutex mutex;
+    std::deque<Document *> queue;
+    std::thread thread;
+  };
+
+  mutable std::shared_mutex documentsMutex;
+  std::vector<std::unique_ptr<Document>> documents;
+  Document & getDocument(DocumentId documentId) const;
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic<size_t> nextWorker = 0;
+
+  //documents sitting in worker queues; workers sleep while there are none
+  std::atomic<size_t> queuedCount = 0;
+  std::mutex sleepMutex;
+  std::condition_variable wakeCondition;
+  bool stopping = false;
+
+  //documents that are scheduled; wait returns once there are none
+  std::atomic<size_t> scheduledCount = 0;
+  std::mutex idleMutex;
+  std::condition_variable idleCondition;
+
+  void schedule(Document & document);
+  void enqueue(Document * document, bool toFront);
+  Document * take(size_t workerIndex);
+  void run(size_t workerIndex);
+  void work(Document & document,
+    std::vector<RefCounted<const LogOperation>> & ops,
+    std::vector<std::pair<size_t, std::function<void(Core & core)>>> & tasks);
+};
\ No newline at end of file
@@ -2,11 +2,13 @@
 #include "Nodes/Node.h"
 #include "Operation.h"
 #include "Event.h"
+#include "EventBatch.h"
 #include "LogOperation.h"
 #include <string>
 
 using getTypeSpecFn = std::function<void(const std::string & type)>;
 using eventRaisedFn = std::function<void(const Event & event)>;
+using eventBatchRaisedFn = std::function<void(const EventBatch & events)>;
 
 class Core;
 
@@ -17,13 +19,47 @@ public:
   {
     getTypeSpec = [](const std::string & type){};
     eventRaised = [](const Event & event){};
+    hasEventListener = false;
   }
+  //eventRaised may be null if there is no one to raise events to
   CoreInit(getTypeSpecFn getTypeSpec, eventRaisedFn eventRaised)
-    : getTypeSpec(getTypeSpec), eventRaised(eventRaised) {}
+    : getTypeSpec(getTypeSpec), eventRaised(eventRaised), hasEventListener(eventRaised != nullptr)
+  {
+    if (!hasEventListener)
+    {
+      this->eventRaised = [](const Event & event){};
+    }
+  }
+
+  //events are collected (and merged, see EventBatch) instead of raised one at
+  //  a time, and delivered once per call to apply, unapply or resolve a type
+  //  spec (once per batch for batch apply streams)
+  static CoreInit Batched(getTypeSpecFn getTypeSpec, eventBatchRaisedFn eventBatchRaised)
+  {
+    CoreInit coreInit(getTypeSpec, nullptr);
+    coreInit.eventBatchRaised = eventBatchRaised;
+    coreInit.hasEventListener = eventBatchRaised != nullptr;
+    return coreInit;
+  }
+
+  //the core keeps a record of each operation that can leave garbage behind
+  //  for Core::compact, so without compacting they would only add up; cores
+  //  only keep them (and can only compact) once this is enabled
+  CoreInit & enableCompaction()
+  {
+    compactionEnabled = true;
+    return *this;
+  }
 
 protected:
   getTypeSpecFn getTypeSpec;
   eventRaisedFn eventRaised;
+  //null unless events are delivered in batches
+  eventBatchRaisedFn eventBatchRaised;
+  //without a listener, the core skips building events (e.g. when it is only
+  //  replaying a log)
+  bool hasEventListener;
+  bool compactionEnabled = false;
 
   friend class Core;
-};
\ No newline at end of file
+};
\ No newline at end of file
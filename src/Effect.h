@@ -14,9 +14,13 @@ public:
     void reset();
     bool isVisible() const;
     bool isInitialized() const;
+    bool operator==(const Effect & rhs) const = default;
 
     std::string toString() const;
 private:
+    friend class SnapshotWriter;
+    friend class SnapshotReader;
+
     bool initialized = false;
     int32_t effect = 0;
 };
\ No newline at end of file
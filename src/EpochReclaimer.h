@@ -0,0 +1,153 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "RefCounted.h"
+
+//Hands references between the stages of a multi-threaded pipeline without
+//  counting on every read
+//Readers follow shared pointers inside a Guard; a writer that unlinks an
+//  object retires its reference instead of dropping it, and collect drops it
+//  once every reader that could still have seen it has left its guard
+//A standalone utility: nothing in the tree uses it yet, since CoreHost only
+//  hands operations over under its document locks and never has readers
+//  following shared references without holding them
+template <class T>
+class EpochReclaimer
+{
+public:
+  //one per reading thread
+  class Participant
+  {
+  public:
+    Participant(EpochReclaimer<T> & reclaimer) : reclaimer(reclaimer)
+    {
+      std::lock_guard<std::mutex> lock(reclaimer.mutex);
+      reclaimer.participants.push_back(this);
+    }
+    ~Participant()
+    {
+      std::lock_guard<std::mutex> lock(reclaimer.mutex);
+      auto & participants = reclaimer.participants;
+      participants.erase(std::find(participants.begin(), participants.end(), this));
+    }
+
+    Participant(const Participant &) = delete;
+    Participant & operator=(const Participant &) = delete;
+
+    void enter()
+    {
+      //the global epoch is read again after publishing ours; if it moved,
+      //  collect may not have seen us, so we publish the newer one
+      uint64_t current = reclaimer.epoch.load();
+      while (true)
+      {
+        epoch.store(current);
+        uint64_t latest = reclaimer.epoch.load();
+        if (latest == current)
+        {
+          break;
+        }
+        current = latest;
+      }
+    }
+
+    void exit()
+    {
+      epoch.store(Idle, std::memory_order_release);
+    }
+
+  private:
+    EpochReclaimer<T> & reclaimer;
+    //the epoch this participant entered in, or Idle outside of a guard
+    std::atomic<uint64_t> epoch = Idle;
+
+    friend class EpochReclaimer<T>;
+  };
+
+  class Guard
+  {
+  public:
+    Guard(Participant & participant) : participant(participant)
+    {
+      participant.enter();
+    }
+    ~Guard()
+    {
+      participant.exit();
+    }
+
+  private:
+    Participant & participant;
+  };
+
+  EpochReclaimer() = default;
+  //every participant must be gone by now; whatever is still retired is dropped
+  ~EpochReclaimer() = default;
+
+  EpochReclaimer(const EpochReclaimer &) = delete;
+  EpochReclaimer & operator=(const EpochReclaimer &) = delete;
+
+  //the reference must already be unreachable for readers entering from now on
+  void retire(RefCounted<T> && ref)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    retired.push_back({ epoch.load(), std::move(ref) });
+  }
+
+  //advances the epoch if every participant in a guard has caught up to it,
+  //  and drops the references retired at least two epochs ago
+  //returns the number of references dropped
+  size_t collect()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint64_t current = epoch.load();
+    bool caughtUp = true;
+    for (const Participant * participant : participants)
+    {
+      uint64_t participantEpoch = participant->epoch.load();
+      if (participantEpoch != Idle && participantEpoch != current)
+      {
+        caughtUp = false;
+        break;
+      }
+    }
+    if (caughtUp)
+    {
+      epoch.store(++current);
+    }
+
+    //retired in order, so the droppable ones are all at the front
+    size_t count = 0;
+    while (count < retired.size() && retired[count].epoch + 2 <= current)
+    {
+      count++;
+    }
+    retired.erase(retired.begin(), retired.begin() + count);
+
+    return count;
+  }
+
+  size_t getRetiredCount() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return retired.size();
+  }
+
+private:
+  static constexpr uint64_t Idle = UINT64_MAX;
+
+  struct Retired
+  {
+    uint64_t epoch;
+    RefCounted<T> ref;
+  };
+
+  std::atomic<uint64_t> epoch = 0;
+  mutable std::mutex mutex;
+  std::vector<Participant *> participants;
+  std::vector<Retired> retired;
+};
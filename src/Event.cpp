@@ -1,4 +1,53 @@
 #include "Event.h"
+#include "EventRecord.h"
+
+static EdgeEventRecord & addEdgeRecord(EventRecordBuffer & buffer, EventRecordType type,
+  const EdgeEvent & event, EventRecordEdgeKind kind)
+{
+  EdgeEventRecord & record = buffer.addRecord(type).edge;
+  record.parentId = event.parentId;
+  record.edgeId = event.edgeId;
+  record.childId = event.childId;
+  record.speculative = event.speculative;
+  record.kind = kind;
+  return record;
+}
+
+static EventRecordValueType setRecordValue(EventRecordValue & record, bool value)
+{
+  record.boolValue = value;
+  return EventRecordValueType::Bool;
+}
+
+static EventRecordValueType setRecordValue(EventRecordValue & record, double value)
+{
+  record.doubleValue = value;
+  return EventRecordValueType::Double;
+}
+
+static EventRecordValueType setRecordValue(EventRecordValue & record, float value)
+{
+  record.floatValue = value;
+  return EventRecordValueType::Float;
+}
+
+static EventRecordValueType setRecordValue(EventRecordValue & record, int32_t value)
+{
+  record.int32Value = value;
+  return EventRecordValueType::Int32;
+}
+
+static EventRecordValueType setRecordValue(EventRecordValue & record, int64_t value)
+{
+  record.int64Value = value;
+  return EventRecordValueType::Int64;
+}
+
+static EventRecordValueType setRecordValue(EventRecordValue & record, int8_t value)
+{
+  record.int8Value = value;
+  return EventRecordValueType::Int8;
+}
 
 void NodeDeletedEvent::serialize(IObjectSerializer & serializer) const
 {
@@ -19,6 +68,11 @@ void NodeAddedEvent::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
+void NodeAddedEvent::writeRecord(EventRecordBuffer & buffer) const
+{
+  addEdgeRecord(buffer, EventRecordType::NodeAdded, *this, EventRecordEdgeKind::Unordered);
+}
+
 void NodeAddedEventOrdered::serialize(IObjectSerializer & serializer) const
 {
   serializer.startObject();
@@ -32,6 +86,13 @@ void NodeAddedEventOrdered::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
+void NodeAddedEventOrdered::writeRecord(EventRecordBuffer & buffer) const
+{
+  auto & record = addEdgeRecord(buffer, EventRecordType::NodeAdded, *this, EventRecordEdgeKind::Ordered);
+  record.index = index;
+  record.actualIndex = actualIndex;
+}
+
 void NodeAddedEventMapped::serialize(IObjectSerializer & serializer) const
 {
   serializer.startObject();
@@ -44,6 +105,14 @@ void NodeAddedEventMapped::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
+void NodeAddedEventMapped::writeRecord(EventRecordBuffer & buffer) const
+{
+  uint32_t keyOffset = buffer.addText(key);
+  auto & record = addEdgeRecord(buffer, EventRecordType::NodeAdded, *this, EventRecordEdgeKind::Mapped);
+  record.keyOffset = keyOffset;
+  record.keyLength = key.size();
+}
+
 void NodeRemovedEvent::serialize(IObjectSerializer & serializer) const
 {
   serializer.startObject();
@@ -55,6 +124,11 @@ void NodeRemovedEvent::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
+void NodeRemovedEvent::writeRecord(EventRecordBuffer & buffer) const
+{
+  addEdgeRecord(buffer, EventRecordType::NodeRemoved, *this, EventRecordEdgeKind::Unordered);
+}
+
 void NodeRemovedEventOrdered::serialize(IObjectSerializer & serializer) const
 {
   serializer.startObject();
@@ -68,6 +142,13 @@ void NodeRemovedEventOrdered::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
+void NodeRemovedEventOrdered::writeRecord(EventRecordBuffer & buffer) const
+{
+  auto & record = addEdgeRecord(buffer, EventRecordType::NodeRemoved, *this, EventRecordEdgeKind::Ordered);
+  record.index = index;
+  record.actualIndex = actualIndex;
+}
+
 void NodeRemovedEventMapped::serialize(IObjectSerializer & serializer) const
 {
   serializer.startObject();
@@ -80,6 +161,14 @@ void NodeRemovedEventMapped::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
+void NodeRemovedEventMapped::writeRecord(EventRecordBuffer & buffer) const
+{
+  uint32_t keyOffset = buffer.addText(key);
+  auto & record = addEdgeRecord(buffer, EventRecordType::NodeRemoved, *this, EventRecordEdgeKind::Mapped);
+  record.keyOffset = keyOffset;
+  record.keyLength = key.size();
+}
+
 template <class T>
 void NodeValueChangedEvent<T>::serialize(IObjectSerializer & serializer) const
 {
@@ -91,6 +180,15 @@ void NodeValueChangedEvent<T>::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
+template <class T>
+void NodeValueChangedEvent<T>::writeRecord(EventRecordBuffer & buffer) const
+{
+  ValueEventRecord & record = buffer.addRecord(EventRecordType::NodeValueChanged).value;
+  record.nodeId = nodeId;
+  setRecordValue(record.oldValue, oldValue);
+  record.valueType = setRecordValue(record.newValue, newValue);
+}
+
 void NodeBlockValueInsertedEvent::serialize(IObjectSerializer & serializer) const
 {
   serializer.startObject();
@@ -98,10 +196,21 @@ void NodeBlockValueInsertedEvent::serialize(IObjectSerializer & serializer) cons
   serializer.addPair("eventType", "NodeBlockValueInserted");
   serializer.addPair("id", nodeId);
   serializer.addPair("offset", offset);
-  serializer.addPair("value", std::string(str, length));
+  serializer.addPair("value", std::string_view(str, length));
   serializer.endObject();
 }
 
+void NodeBlockValueInsertedEvent::writeRecord(EventRecordBuffer & buffer) const
+{
+  uint32_t textOffset = buffer.addText(std::string_view(str, length));
+  BlockValueEventRecord & record = buffer.addRecord(EventRecordType::NodeBlockValueInserted).blockValue;
+  record.ts = ts;
+  record.nodeId = nodeId;
+  record.offset = offset;
+  record.length = length;
+  record.textOffset = textOffset;
+}
+
 void NodeBlockValueDeletedEvent::serialize(IObjectSerializer & serializer) const
 {
   serializer.startObject();
@@ -113,6 +222,15 @@ void NodeBlockValueDeletedEvent::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
+void NodeBlockValueDeletedEvent::writeRecord(EventRecordBuffer & buffer) const
+{
+  BlockValueEventRecord & record = buffer.addRecord(EventRecordType::NodeBlockValueDeleted).blockValue;
+  record.ts = ts;
+  record.nodeId = nodeId;
+  record.offset = offset;
+  record.length = length;
+}
+
 template class NodeValueChangedEvent<bool>;
 template class NodeValueChangedEvent<double>;
 template class NodeValueChangedEvent<float>;
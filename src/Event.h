@@ -1,16 +1,22 @@
 #pragma once
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include "NodeId.h"
 #include "EdgeId.h"
 #include "IObjectSerializer.h"
 
+class EventRecordBuffer;
+
 class Event
 {
 public:
   virtual ~Event() = default;
 
   virtual void serialize(IObjectSerializer & serializer) const = 0;
+  //adds the event as a fixed size record (see EventRecord.h)
+  virtual void writeRecord(EventRecordBuffer & buffer) const = 0;
   virtual Event * clone() const = 0;
 };
 
@@ -45,13 +51,62 @@ public:
 
   virtual ~EdgeEvent() = default;
   virtual void serialize(IObjectSerializer & serializer) const = 0;
+  virtual void writeRecord(EventRecordBuffer & buffer) const = 0;
   virtual Event * clone() const = 0;
 };
 
+//Receives the edge events of a container operation
+//  It only refers to the callable it is made from (nothing is copied or
+//  allocated), so it is only valid for the call it is passed to
+//  A null callback means no one is listening, and containers skip building
+//  the events altogether
+class EdgeEventCallback
+{
+public:
+  EdgeEventCallback() : context(nullptr), invoke(nullptr) {}
+  EdgeEventCallback(std::nullptr_t) : EdgeEventCallback() {}
+
+  template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, EdgeEventCallback>>>
+  EdgeEventCallback(F && callback) : EdgeEventCallback()
+  {
+    using Callable = std::remove_reference_t<F>;
+
+    //e.g. an empty std::function
+    if constexpr (std::is_constructible_v<bool, Callable &>)
+    {
+      if (!static_cast<bool>(callback))
+      {
+        return;
+      }
+    }
+
+    context = const_cast<void *>(static_cast<const void *>(std::addressof(callback)));
+    invoke = [](void * context, EdgeEvent & event)
+    {
+      (*static_cast<Callable *>(context))(event);
+    };
+  }
+
+  explicit operator bool() const
+  {
+    return invoke != nullptr;
+  }
+
+  void operator()(EdgeEvent & event) const
+  {
+    invoke(context, event);
+  }
+
+private:
+  void * context;
+  void (*invoke)(void * context, EdgeEvent & event);
+};
+
 class NodeAddedEvent : public Cloneable<EdgeEvent, NodeAddedEvent>
 {
 public:
   void serialize(IObjectSerializer & serializer) const;
+  void writeRecord(EventRecordBuffer & buffer) const;
 };
 
 class NodeAddedEventOrdered : public Cloneable<EdgeEvent, NodeAddedEventOrdered>
@@ -61,6 +116,7 @@ public:
   size_t actualIndex;
 
   void serialize(IObjectSerializer & serializer) const;
+  void writeRecord(EventRecordBuffer & buffer) const;
 };
 
 class NodeAddedEventMapped : public Cloneable<EdgeEvent, NodeAddedEventMapped>
@@ -69,12 +125,14 @@ public:
   std::string key;
 
   void serialize(IObjectSerializer & serializer) const;
+  void writeRecord(EventRecordBuffer & buffer) const;
 };
 
 class NodeRemovedEvent : public Cloneable<EdgeEvent, NodeRemovedEvent>
 {
 public:
   void serialize(IObjectSerializer & serializer) const;
+  void writeRecord(EventRecordBuffer & buffer) const;
 };
 
 class NodeRemovedEventOrdered : public Cloneable<EdgeEvent, NodeRemovedEventOrdered>
@@ -84,6 +142,7 @@ public:
   size_t actualIndex;
 
   void serialize(IObjectSerializer & serializer) const;
+  void writeRecord(EventRecordBuffer & buffer) const;
 };
 
 class NodeRemovedEventMapped : public Cloneable<EdgeEvent, NodeRemovedEventMapped>
@@ -92,6 +151,7 @@ public:
   std::string key;
 
   void serialize(IObjectSerializer & serializer) const;
+  void writeRecord(EventRecordBuffer & buffer) const;
 };
 
 template <class T>
@@ -103,6 +163,7 @@ public:
   T newValue;
 
   void serialize(IObjectSerializer & serializer) const;
+  void writeRecord(EventRecordBuffer & buffer) const;
 };
 
 class NodeBlockValueEvent : public Event
@@ -114,6 +175,7 @@ public:
 
   virtual ~NodeBlockValueEvent() = default;
   virtual void serialize(IObjectSerializer & serializer) const = 0;
+  virtual void writeRecord(EventRecordBuffer & buffer) const = 0;
   virtual Event * clone() const = 0;
 };
 
@@ -124,6 +186,7 @@ public:
   uint32_t length;
 
   void serialize(IObjectSerializer & serializer) const;
+  void writeRecord(EventRecordBuffer & buffer) const;
 };
 
 class NodeBlockValueDeletedEvent : public Cloneable<NodeBlockValueEvent, NodeBlockValueDeletedEvent>
@@ -132,4 +195,5 @@ public:
   uint32_t length;
 
   void serialize(IObjectSerializer & serializer) const;
+  void writeRecord(EventRecordBuffer & buffer) const;
 };
@@ -0,0 +1,278 @@
+#include "EventBatch.h"
+#include "Utf8.h"
+#include <string>
+#include <typeinfo>
+
+namespace
+{
+  //an insert that owns its text; the core's copy may move once the event has
+  //  been raised, and merged inserts have no text anywhere else
+  class OwnedInsertedEvent : public NodeBlockValueInsertedEvent
+  {
+  public:
+    std::string text;
+    size_t utf16Length;
+
+    void updateText()
+    {
+      str = text.data();
+      length = static_cast<uint32_t>(text.size());
+    }
+  };
+
+  bool hasSameFields(const NodeAddedEvent &, const NodeRemovedEvent &)
+  {
+    return true;
+  }
+
+  bool hasSameFields(const NodeAddedEventOrdered & added, const NodeRemovedEventOrdered & removed)
+  {
+    return added.index == removed.index && added.actualIndex == removed.actualIndex;
+  }
+
+  bool hasSameFields(const NodeAddedEventMapped & added, const NodeRemovedEventMapped & removed)
+  {
+    return added.key == removed.key;
+  }
+
+  //whether the events add and remove the edge at the same place, in either order
+  template <class First, class Second>
+  bool isSamePlace(const First & first, const Second & second)
+  {
+    if constexpr (requires { hasSameFields(first, second); })
+    {
+      return hasSameFields(first, second);
+    }
+    else
+    {
+      return hasSameFields(second, first);
+    }
+  }
+}
+
+void EventBatch::add(const Event & event)
+{
+  //the concrete type is looked up once, rather than probing with casts
+  const std::type_info & type = typeid(event);
+
+  if (type == typeid(NodeAddedEvent))
+  {
+    addEdgeEvent<NodeAddedEvent, NodeRemovedEvent>(static_cast<const NodeAddedEvent &>(event));
+  }
+  else if (type == typeid(NodeRemovedEvent))
+  {
+    addEdgeEvent<NodeRemovedEvent, NodeAddedEvent>(static_cast<const NodeRemovedEvent &>(event));
+  }
+  else if (type == typeid(NodeAddedEventOrdered))
+  {
+    addEdgeEvent<NodeAddedEventOrdered, NodeRemovedEventOrdered>(
+      static_cast<const NodeAddedEventOrdered &>(event));
+  }
+  else if (type == typeid(NodeRemovedEventOrdered))
+  {
+    addEdgeEvent<NodeRemovedEventOrdered, NodeAddedEventOrdered>(
+      static_cast<const NodeRemovedEventOrdered &>(event));
+  }
+  else if (type == typeid(NodeAddedEventMapped))
+  {
+    addEdgeEvent<NodeAddedEventMapped, NodeRemovedEventMapped>(
+      static_cast<const NodeAddedEventMapped &>(event));
+  }
+  else if (type == typeid(NodeRemovedEventMapped))
+  {
+    addEdgeEvent<NodeRemovedEventMapped, NodeAddedEventMapped>(
+      static_cast<const NodeRemovedEventMapped &>(event));
+  }
+  else if (type == typeid(NodeBlockValueInsertedEvent))
+  {
+    auto & inserted = static_cast<const NodeBlockValueInsertedEvent &>(event);
+    if (!mergeInsert(inserted))
+    {
+      auto owned = std::make_unique<OwnedInsertedEvent>();
+      owned->ts = inserted.ts;
+      owned->nodeId = inserted.nodeId;
+      owned->offset = inserted.offset;
+      owned->text.assign(inserted.str, inserted.length);
+      owned->utf16Length = Utf8ToUtf16Length(inserted.str, inserted.length);
+      owned->updateText();
+      append(inserted.nodeId, std::move(owned));
+    }
+  }
+  else if (type == typeid(NodeBlockValueDeletedEvent))
+  {
+    auto & deleted = static_cast<const NodeBlockValueDeletedEvent &>(event);
+    if (!mergeDelete(deleted))
+    {
+      append(deleted.nodeId, std::unique_ptr<Event>(event.clone()));
+    }
+  }
+  else if (!addValueChange<bool>(event, type) && !addValueChange<double>(event, type)
+    && !addValueChange<float>(event, type) && !addValueChange<int32_t>(event, type)
+    && !addValueChange<int64_t>(event, type) && !addValueChange<int8_t>(event, type))
+  {
+    //nothing to merge it with
+    entries.push_back({ std::unique_ptr<Event>(event.clone()), NoEntry });
+    count++;
+  }
+}
+
+void EventBatch::clear()
+{
+  entries.clear();
+  lastEntries.clear();
+  count = 0;
+}
+
+void EventBatch::serialize(IObjectSerializer & serializer) const
+{
+  serializer.startArray();
+  forEach([&](const Event & event)
+  {
+    event.serialize(serializer);
+  });
+  serializer.endArray();
+}
+
+Event * EventBatch::getLast(const NodeId & nodeId) const
+{
+  auto it = lastEntries.find(nodeId);
+  if (it == lastEntries.end())
+  {
+    return nullptr;
+  }
+  return entries[it->second].event.get();
+}
+
+void EventBatch::append(const NodeId & nodeId, std::unique_ptr<Event> event)
+{
+  auto [it, inserted] = lastEntries.try_emplace(nodeId, entries.size());
+  size_t previous = NoEntry;
+  if (!inserted)
+  {
+    previous = it->second;
+    it->second = entries.size();
+  }
+
+  entries.push_back({ std::move(event), previous });
+  count++;
+}
+
+template <class T, class Counterpart>
+void EventBatch::addEdgeEvent(const T & event)
+{
+  if (!cancelEdgeEvent<T, Counterpart>(event))
+  {
+    append(event.parentId, std::unique_ptr<Event>(event.clone()));
+  }
+}
+
+template <class T, class Counterpart>
+bool EventBatch::cancelEdgeEvent(const T & event)
+{
+  auto it = lastEntries.find(event.parentId);
+  if (it == lastEntries.end())
+  {
+    return false;
+  }
+
+  Entry & entry = entries[it->second];
+  if (typeid(*entry.event) != typeid(Counterpart))
+  {
+    return false;
+  }
+
+  auto & last = static_cast<const Counterpart &>(*entry.event);
+  if (last.edgeId != event.edgeId || last.childId != event.childId
+    || last.speculative != event.speculative || !isSamePlace(last, event))
+  {
+    return false;
+  }
+
+  entry.event.reset();
+  count--;
+
+  if (entry.previous == NoEntry)
+  {
+    lastEntries.erase(it);
+  }
+  else
+  {
+    it->second = entry.previous;
+  }
+
+  return true;
+}
+
+bool EventBatch::mergeInsert(const NodeBlockValueInsertedEvent & event)
+{
+  Event * lastEvent = getLast(event.nodeId);
+  if (lastEvent == nullptr || typeid(*lastEvent) != typeid(OwnedInsertedEvent))
+  {
+    return false;
+  }
+
+  auto * last = static_cast<OwnedInsertedEvent *>(lastEvent);
+  if (event.offset < last->offset
+    || event.offset - last->offset > last->utf16Length)
+  {
+    return false;
+  }
+
+  //typing and pasting append to the end, which needs no search
+  size_t codeUnits = event.offset - last->offset;
+  size_t position = codeUnits == last->utf16Length ? last->text.size()
+    : Utf8FindUtf16Offset(last->text.data(), last->text.size(), codeUnits);
+
+  last->text.insert(position, event.str, event.length);
+  last->utf16Length += Utf8ToUtf16Length(event.str, event.length);
+  last->updateText();
+
+  return true;
+}
+
+bool EventBatch::mergeDelete(const NodeBlockValueDeletedEvent & event)
+{
+  Event * lastEvent = getLast(event.nodeId);
+  if (lastEvent == nullptr || typeid(*lastEvent) != typeid(NodeBlockValueDeletedEvent))
+  {
+    return false;
+  }
+
+  auto * last = static_cast<NodeBlockValueDeletedEvent *>(lastEvent);
+
+  if (event.offset == last->offset)
+  {
+    //forward delete
+    last->length += event.length;
+    return true;
+  }
+  if (event.offset + event.length == last->offset)
+  {
+    //backspace
+    last->offset = event.offset;
+    last->length += event.length;
+    return true;
+  }
+
+  return false;
+}
+
+template <class T>
+bool EventBatch::addValueChange(const Event & event, const std::type_info & type)
+{
+  if (type != typeid(NodeValueChangedEvent<T>))
+  {
+    return false;
+  }
+
+  auto & changed = static_cast<const NodeValueChangedEvent<T> &>(event);
+  Event * last = getLast(changed.nodeId);
+  if (last != nullptr && typeid(*last) == type)
+  {
+    static_cast<NodeValueChangedEvent<T> *>(last)->newValue = changed.newValue;
+    return true;
+  }
+
+  append(changed.nodeId, std::unique_ptr<Event>(changed.clone()));
+  return true;
+}
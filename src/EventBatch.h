@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+#include "Event.h"
+#include "IObjectSerializer.h"
+
+//Copies of the events raised while applying a batch of operations, with
+//  changes that cover each other merged as they are added:
+//  - block value inserts into (or right after) the text of the node's last
+//    insert become part of it, and deletes at the node's last delete (forward
+//    or backward) extend it
+//  - value changes keep the first old value and take the last new value
+//  - an edge added and then removed (or removed and then added) again as the
+//    parent's next event cancels out
+//Events are only merged with the last event about the same node, so each
+//  node's events stay in the order they were raised; merged inserts keep the
+//  timestamp of their first insert
+class EventBatch
+{
+public:
+  EventBatch() = default;
+  EventBatch(EventBatch &&) = default;
+  EventBatch & operator=(EventBatch &&) = default;
+
+  //the text of block value inserts is copied too, so events can be added
+  //  straight from the core's callbacks
+  void add(const Event & event);
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  void clear();
+
+  //events are valid for as long as the batch is
+  template <class F>
+  void forEach(F && callback) const
+  {
+    for (const auto & entry : entries)
+    {
+      if (entry.event != nullptr)
+      {
+        callback(*entry.event);
+      }
+    }
+  }
+
+  //as an array of the events
+  void serialize(IObjectSerializer & serializer) const;
+
+private:
+  static constexpr size_t NoEntry = SIZE_MAX;
+
+  struct Entry
+  {
+    //null once cancelled out
+    std::unique_ptr<Event> event;
+    //the entry of the node's event before this one
+    size_t previous;
+  };
+
+  std::vector<Entry> entries;
+  //the entry of the last live event about each node (the parent for edges)
+  std::unordered_map<NodeId, size_t> lastEntries;
+  size_t count = 0;
+
+  Event * getLast(const NodeId & nodeId) const;
+  void append(const NodeId & nodeId, std::unique_ptr<Event> event);
+
+  //T is the event's type, Counterpart the type that adds (or removes) the
+  //  edge it removes (or adds)
+  template <class T, class Counterpart>
+  void addEdgeEvent(const T & event);
+  template <class T, class Counterpart>
+  bool cancelEdgeEvent(const T & event);
+  bool mergeInsert(const NodeBlockValueInsertedEvent & event);
+  bool mergeDelete(const NodeBlockValueDeletedEvent & event);
+  template <class T>
+  bool addValueChange(const Event & event, const std::type_info & type);
+};
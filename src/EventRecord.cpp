@@ -0,0 +1,37 @@
+#include "EventRecord.h"
+#include "Event.h"
+#include "EventBatch.h"
+
+void EventRecordBuffer::add(const Event & event)
+{
+  event.writeRecord(*this);
+}
+
+void EventRecordBuffer::add(const EventBatch & events)
+{
+  records.reserve(records.size() + events.size());
+  events.forEach([this](const Event & event)
+  {
+    event.writeRecord(*this);
+  });
+}
+
+EventRecord & EventRecordBuffer::addRecord(EventRecordType type)
+{
+  EventRecord & record = records.emplace_back();
+  record.type = type;
+  return record;
+}
+
+uint32_t EventRecordBuffer::addText(std::string_view value)
+{
+  uint32_t offset = static_cast<uint32_t>(text.size());
+  text.append(value);
+  return offset;
+}
+
+void EventRecordBuffer::clear()
+{
+  records.clear();
+  text.clear();
+}
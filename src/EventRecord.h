@@ -0,0 +1,136 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "NodeId.h"
+#include "EdgeId.h"
+
+class Event;
+class EventBatch;
+
+//Fixed size records of events, for passing them on without serializing them
+//  or keeping the events themselves (e.g. copying a batch into a ring buffer)
+//Records are trivially copyable and hold no pointers: text (inserted text and
+//  map keys) is stored in the text buffer they are written with, and records
+//  refer to it by offset
+enum class EventRecordType : uint8_t
+{
+  NodeAdded,
+  NodeRemoved,
+  NodeValueChanged,
+  NodeBlockValueInserted,
+  NodeBlockValueDeleted
+};
+
+enum class EventRecordEdgeKind : uint8_t
+{
+  Unordered,
+  //index and actualIndex are set
+  Ordered,
+  //the key is set
+  Mapped
+};
+
+enum class EventRecordValueType : uint8_t
+{
+  Bool,
+  Double,
+  Float,
+  Int32,
+  Int64,
+  Int8
+};
+
+struct EdgeEventRecord
+{
+  NodeId parentId;
+  EdgeId edgeId;
+  NodeId childId;
+  bool speculative;
+  EventRecordEdgeKind kind;
+  uint32_t index;
+  uint32_t actualIndex;
+  uint32_t keyOffset;
+  uint32_t keyLength;
+};
+
+union EventRecordValue
+{
+  bool boolValue;
+  double doubleValue;
+  float floatValue;
+  int32_t int32Value;
+  int64_t int64Value;
+  int8_t int8Value;
+};
+
+struct ValueEventRecord
+{
+  NodeId nodeId;
+  EventRecordValueType valueType;
+  EventRecordValue oldValue;
+  EventRecordValue newValue;
+};
+
+//offset is in UTF-16 code units, as in the events; length is the length of
+//  the text in bytes for inserts and in UTF-16 code units for deletes
+struct BlockValueEventRecord
+{
+  Timestamp ts;
+  NodeId nodeId;
+  uint32_t offset;
+  uint32_t length;
+  uint32_t textOffset;
+};
+
+struct EventRecord
+{
+  //zeroed, so padding aside records are fully initialized
+  EventRecord() : edge() {}
+
+  EventRecordType type;
+  union
+  {
+    //NodeAdded and NodeRemoved
+    EdgeEventRecord edge;
+    //NodeValueChanged
+    ValueEventRecord value;
+    //NodeBlockValueInserted and NodeBlockValueDeleted
+    BlockValueEventRecord blockValue;
+  };
+};
+
+static_assert(std::is_trivially_copyable_v<EventRecord>);
+
+//Records and their text, written from events as they are raised or from a
+//  whole batch; both can be copied out as they are
+class EventRecordBuffer
+{
+public:
+  void add(const Event & event);
+  void add(const EventBatch & events);
+
+  //for events writing their own records: a new record of the type (zeroed)
+  //  and the offset text was added at
+  EventRecord & addRecord(EventRecordType type);
+  uint32_t addText(std::string_view value);
+
+  const std::vector<EventRecord> & getRecords() const { return records; }
+  const std::string & getText() const { return text; }
+  std::string_view getText(uint32_t offset, uint32_t length) const
+  {
+    return std::string_view(text).substr(offset, length);
+  }
+
+  size_t size() const { return records.size(); }
+  bool empty() const { return records.empty(); }
+  //keeps the memory for the next batch
+  void clear();
+
+private:
+  std::vector<EventRecord> records;
+  std::string text;
+};
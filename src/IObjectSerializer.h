@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <NodeId.h>
 #include <EdgeId.h>
 
@@ -13,21 +14,21 @@ public:
   virtual void endArray() = 0;
   virtual void resumeArray() = 0;
 
-  virtual void addPair(const std::string & key, const std::string & value) = 0;
-  virtual void addPair(const std::string & key, const char * value) = 0;
-  virtual void addPair(const std::string & key, const Timestamp & value) = 0;
-  virtual void addPair(const std::string & key, const NodeId & value) = 0;
-  virtual void addPair(const std::string & key, size_t value) = 0;
-  virtual void addPair(const std::string & key, uint32_t value) = 0;
-  virtual void addPair(const std::string & key, bool value) = 0;
-  virtual void addPair(const std::string & key, double value) = 0;
-  virtual void addPair(const std::string & key, float value) = 0;
-  virtual void addPair(const std::string & key, int32_t value) = 0;
-  virtual void addPair(const std::string & key, int64_t value) = 0;
-  virtual void addPair(const std::string & key, int8_t value) = 0;
+  virtual void addPair(std::string_view key, std::string_view value) = 0;
+  virtual void addPair(std::string_view key, const char * value) = 0;
+  virtual void addPair(std::string_view key, const Timestamp & value) = 0;
+  virtual void addPair(std::string_view key, const NodeId & value) = 0;
+  virtual void addPair(std::string_view key, size_t value) = 0;
+  virtual void addPair(std::string_view key, uint32_t value) = 0;
+  virtual void addPair(std::string_view key, bool value) = 0;
+  virtual void addPair(std::string_view key, double value) = 0;
+  virtual void addPair(std::string_view key, float value) = 0;
+  virtual void addPair(std::string_view key, int32_t value) = 0;
+  virtual void addPair(std::string_view key, int64_t value) = 0;
+  virtual void addPair(std::string_view key, int8_t value) = 0;
 
-  virtual void addKey(const std::string & key) = 0;
-  virtual void addValue(const std::string & key) = 0;
+  virtual void addKey(std::string_view key) = 0;
+  virtual void addValue(std::string_view value) = 0;
   virtual void addNullValue() = 0;
 
   // virtual void addValue(const std::string & value) = 0;
@@ -9,7 +9,7 @@ std::string DoubleToString(double value)
 
 void DoubleToString(double value, std::string & out)
 {
-  static char str[25];
+  char str[25];
   int len = sprintf(str, "%.17g", value);
   out.append(str, len);
 }
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "JsonBufferSerializer.h"
+#include <charconv>
+#include <cmath>
+
+void JsonBufferSerializer::startObject()
+{
+  startContainer(false);
+}
+
+void JsonBufferSerializer::endObject()
+{
+  endContainer(false);
+}
+
+void JsonBufferSerializer::resumeObject()
+{
+  resumeContainer(false);
+}
+
+void JsonBufferSerializer::startArray()
+{
+  startContainer(true);
+}
+
+void JsonBufferSerializer::endArray()
+{
+  endContainer(true);
+}
+
+void JsonBufferSerializer::resumeArray()
+{
+  resumeContainer(true);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, bool value)
+{
+  addKey(key);
+  startValue();
+  buffer.append(value ? "true" : "false");
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, std::string_view value)
+{
+  addKey(key);
+  startValue();
+  writeString(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, const char * value)
+{
+  addKey(key);
+  startValue();
+  writeString(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, const Timestamp & value)
+{
+  addKey(key);
+  startValue();
+  writeTimestamp(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, const NodeId & value)
+{
+  addKey(key);
+  startValue();
+  writeNodeId(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, size_t value)
+{
+  addKey(key);
+  startValue();
+  writeUInt(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, uint32_t value)
+{
+  addKey(key);
+  startValue();
+  writeUInt(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, double value)
+{
+  addKey(key);
+  startValue();
+  writeDouble(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, float value)
+{
+  addKey(key);
+  startValue();
+  writeDouble(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, int32_t value)
+{
+  addKey(key);
+  startValue();
+  writeInt(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, int64_t value)
+{
+  addKey(key);
+  startValue();
+  writeInt(value);
+}
+
+void JsonBufferSerializer::addPair(std::string_view key, int8_t value)
+{
+  addKey(key);
+  startValue();
+  writeInt(value);
+}
+
+void JsonBufferSerializer::addKey(std::string_view key)
+{
+  startValue();
+  writeString(key);
+  buffer.push_back(':');
+  afterKey = true;
+}
+
+void JsonBufferSerializer::addValue(std::string_view value)
+{
+  startValue();
+  writeString(value);
+}
+
+void JsonBufferSerializer::addNullValue()
+{
+  startValue();
+  buffer.append("null");
+}
+
+std::string_view JsonBufferSerializer::result() const
+{
+  return buffer;
+}
+
+void JsonBufferSerializer::clear()
+{
+  buffer.clear();
+  scopes.clear();
+  afterKey = false;
+  lastClosedEnd = SIZE_MAX;
+}
+
+void JsonBufferSerializer::startValue()
+{
+  lastClosedEnd = SIZE_MAX;
+
+  //a value after a key belongs to that key
+  if (afterKey)
+  {
+    afterKey = false;
+    return;
+  }
+
+  if (!scopes.empty())
+  {
+    if (scopes.back().hasValues)
+    {
+      buffer.push_back(',');
+    }
+    scopes.back().hasValues = true;
+  }
+}
+
+void JsonBufferSerializer::startContainer(bool isArray)
+{
+  startValue();
+  buffer.push_back(isArray ? '[' : '{');
+  scopes.push_back({ isArray, false });
+}
+
+void JsonBufferSerializer::endContainer(bool isArray)
+{
+  buffer.push_back(isArray ? ']' : '}');
+  lastClosed = scopes.back();
+  lastClosedEnd = buffer.size();
+  scopes.pop_back();
+}
+
+void JsonBufferSerializer::resumeContainer(bool isArray)
+{
+  if (lastClosedEnd != buffer.size() || lastClosed.isArray != isArray)
+  {
+    return;
+  }
+
+  buffer.pop_back();
+  scopes.push_back(lastClosed);
+  lastClosedEnd = SIZE_MAX;
+}
+
+void JsonBufferSerializer::writeString(std::string_view value)
+{
+  static const char hexDigits[] = "0123456789abcdef";
+
+  buffer.push_back('"');
+
+  size_t start = 0;
+  for (size_t i = 0; i < value.size(); i++)
+  {
+    unsigned char c = static_cast<unsigned char>(value[i]);
+    if (c >= 0x20 && c != '"' && c != '\\')
+    {
+      continue;
+    }
+
+    buffer.append(value.data() + start, i - start);
+    start = i + 1;
+
+    switch (c)
+    {
+      case '"':
+        buffer.append("\\\"");
+        break;
+      case '\\':
+        buffer.append("\\\\");
+        break;
+      case '\n':
+        buffer.append("\\n");
+        break;
+      case '\r':
+        buffer.append("\\r");
+        break;
+      case '\t':
+        buffer.append("\\t");
+        break;
+      default:
+        buffer.append("\\u00");
+        buffer.push_back(hexDigits[c >> 4]);
+        buffer.push_back(hexDigits[c & 0xF]);
+        break;
+    }
+  }
+
+  buffer.append(value.data() + start, value.size() - start);
+  buffer.push_back('"');
+}
+
+void JsonBufferSerializer::writeTimestamp(const Timestamp & value)
+{
+  //same text as Timestamp::toString
+  buffer.push_back('"');
+  writeUInt(value.clock);
+  buffer.push_back(',');
+  writeUInt(value.site);
+  buffer.push_back('"');
+}
+
+void JsonBufferSerializer::writeNodeId(const NodeId & value)
+{
+  //same text as NodeId::toString
+  buffer.push_back('"');
+  writeUInt(value.ts.clock);
+  buffer.push_back(',');
+  writeUInt(value.ts.site);
+  buffer.push_back(',');
+  writeUInt(value.child);
+  buffer.push_back('"');
+}
+
+void JsonBufferSerializer::writeUInt(uint64_t value)
+{
+  char str[24];
+  auto result = std::to_chars(str, str + sizeof(str), value);
+  buffer.append(str, result.ptr);
+}
+
+void JsonBufferSerializer::writeInt(int64_t value)
+{
+  char str[24];
+  auto result = std::to_chars(str, str + sizeof(str), value);
+  buffer.append(str, result.ptr);
+}
+
+void JsonBufferSerializer::writeDouble(double value)
+{
+  //JSON has no representation for infinities or NaN
+  if (!std::isfinite(value))
+  {
+    buffer.append("null");
+    return;
+  }
+
+  //the shortest text that reads back as the same value
+  char str[32];
+  auto result = std::to_chars(str, str + sizeof(str), value);
+  buffer.append(str, result.ptr);
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include "IObjectSerializer.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Writes JSON straight into a growable buffer
+//Unlike JsonSerializer nothing goes through iostreams: numbers are formatted
+//  with std::to_chars, strings are escaped, and separators are tracked per
+//  container rather than patched up after the fact
+class JsonBufferSerializer : public IObjectSerializer
+{
+public:
+  void startObject();
+  void endObject();
+  void resumeObject();
+
+  void startArray();
+  void endArray();
+  void resumeArray();
+
+  void addPair(std::string_view key, bool value);
+  void addPair(std::string_view key, std::string_view value);
+  void addPair(std::string_view key, const char * value);
+  void addPair(std::string_view key, const Timestamp & value);
+  void addPair(std::string_view key, const NodeId & value);
+  void addPair(std::string_view key, size_t value);
+  void addPair(std::string_view key, uint32_t value);
+  void addPair(std::string_view key, double value);
+  void addPair(std::string_view key, float value);
+  void addPair(std::string_view key, int32_t value);
+  void addPair(std::string_view key, int64_t value);
+  void addPair(std::string_view key, int8_t value);
+
+  void addKey(std::string_view key);
+  void addValue(std::string_view value);
+  void addNullValue();
+
+  //everything written so far; the view is invalidated by further writes
+  std::string_view result() const;
+  void clear();
+
+private:
+  struct Scope
+  {
+    bool isArray;
+    bool hasValues;
+  };
+
+  std::string buffer;
+  std::vector<Scope> scopes;
+  bool afterKey = false;
+
+  //the container closed last, which resumeObject/resumeArray reopen as long
+  //  as nothing has been written after it
+  Scope lastClosed = { false, false };
+  size_t lastClosedEnd = SIZE_MAX;
+
+  void startValue();
+  void startContainer(bool isArray);
+  void endContainer(bool isArray);
+  void resumeContainer(bool isArray);
+
+  void writeString(std::string_view value);
+  void writeTimestamp(const Timestamp & value);
+  void writeNodeId(const NodeId & value);
+  void writeUInt(uint64_t value);
+  void writeInt(int64_t value);
+  void writeDouble(double value);
+};
\ No newline at end of file
@@ -45,84 +45,84 @@ void JsonSerializer::resumeArray()
   output << ",";
 }
 
-void JsonSerializer::addPair(const std::string & key, bool value)
+void JsonSerializer::addPair(std::string_view key, bool value)
 {
   addKey(key);
   output << (value ? "true" : "false") << ",";
 }
 
-void JsonSerializer::addPair(const std::string & key, const std::string & value)
+void JsonSerializer::addPair(std::string_view key, std::string_view value)
 {
   addKey(key);
   output << "\"" << value << "\",";
 }
 
-void JsonSerializer::addPair(const std::string & key, const char * value)
+void JsonSerializer::addPair(std::string_view key, const char * value)
 {
   addKey(key);
   output << "\"" << value << "\",";
 }
 
-void JsonSerializer::addPair(const std::string & key, const Timestamp & value)
+void JsonSerializer::addPair(std::string_view key, const Timestamp & value)
 {
   addKey(key);
   output << "\"" << value.toString() << "\",";
 }
 
-void JsonSerializer::addPair(const std::string & key, const NodeId & value)
+void JsonSerializer::addPair(std::string_view key, const NodeId & value)
 {
   addKey(key);
   output << "\"" << value.toString() << "\",";
 }
 
-void JsonSerializer::addPair(const std::string & key, size_t value)
+void JsonSerializer::addPair(std::string_view key, size_t value)
 {
   addKey(key);
   output << value << ",";
 }
 
-void JsonSerializer::addPair(const std::string & key, uint32_t value)
+void JsonSerializer::addPair(std::string_view key, uint32_t value)
 {
   addKey(key);
   output << value << ",";
 }
 
-void JsonSerializer::addPair(const std::string & key, double value)
+void JsonSerializer::addPair(std::string_view key, double value)
 {
   addKey(key);
   output << DoubleToString(value) << ",";
 }
 
-void JsonSerializer::addPair(const std::string & key, float value)
+void JsonSerializer::addPair(std::string_view key, float value)
 {
   addKey(key);
   output << DoubleToString(value) << ",";
 }
 
-void JsonSerializer::addPair(const std::string & key, int32_t value)
+void JsonSerializer::addPair(std::string_view key, int32_t value)
 {
   addKey(key);
   output << value << ",";
 }
 
-void JsonSerializer::addPair(const std::string & key, int64_t value)
+void JsonSerializer::addPair(std::string_view key, int64_t value)
 {
   addKey(key);
   output << value << ",";
 }
 
-void JsonSerializer::addPair(const std::string & key, int8_t value)
+void JsonSerializer::addPair(std::string_view key, int8_t value)
 {
   addKey(key);
   output << value;
 }
 
-void JsonSerializer::addKey(const std::string & key)
+void JsonSerializer::addKey(std::string_view key)
 {
   output << "\"" << key << "\":";
 }
 
-void JsonSerializer::addValue(const std::string & value)
+void JsonSerializer::addValue(std::string_view value)
 {
   output << "\"" << value << "\",";
 }
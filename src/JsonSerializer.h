@@ -18,21 +18,21 @@ public:
   void endArray();
   void resumeArray();
 
-  void addPair(const std::string & key, bool value);
-  void addPair(const std::string & key, const std::string & value);
-  void addPair(const std::string & key, const char * value);
-  void addPair(const std::string & key, const Timestamp & value);
-  void addPair(const std::string & key, const NodeId & value);
-  void addPair(const std::string & key, size_t value);
-  void addPair(const std::string & key, uint32_t value);
-  void addPair(const std::string & key, double value);
-  void addPair(const std::string & key, float value);
-  void addPair(const std::string & key, int32_t value);
-  void addPair(const std::string & key, int64_t value);
-  void addPair(const std::string & key, int8_t value);
+  void addPair(std::string_view key, bool value);
+  void addPair(std::string_view key, std::string_view value);
+  void addPair(std::string_view key, const char * value);
+  void addPair(std::string_view key, const Timestamp & value);
+  void addPair(std::string_view key, const NodeId & value);
+  void addPair(std::string_view key, size_t value);
+  void addPair(std::string_view key, uint32_t value);
+  void addPair(std::string_view key, double value);
+  void addPair(std::string_view key, float value);
+  void addPair(std::string_view key, int32_t value);
+  void addPair(std::string_view key, int64_t value);
+  void addPair(std::string_view key, int8_t value);
 
-  void addKey(const std::string & key);
-  void addValue(const std::string & value);
+  void addKey(std::string_view key);
+  void addValue(std::string_view value);
   void addNullValue();
 
   std::string result();
@@ -0,0 +1,488 @@
+#include "LogSegment.h"
+#include "OperationLog.h"
+#include "Serialization/LogOperationSerialization.h"
+#include "Serialization/standard_v1/LogOperation.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using SerializedLogOperation = Serialization_standard_v1::LogOperationFull;
+
+//operations are handed out as views into the standard_v1_full records, which
+//  only works as long as the in-memory layout is the same as the serialized one
+static_assert(sizeof(Tag) == sizeof(Serialization_standard_v1::Tag));
+static_assert(sizeof(Timestamp) == sizeof(Serialization_standard_v1::Timestamp));
+static_assert(offsetof(LogOperation, op) == SerializedLogOperation::getHeaderSize());
+static_assert(offsetof(LogOperation, ts) == offsetof(SerializedLogOperation, ts));
+
+static constexpr char SegmentMagic[8] = { 'C', 'R', 'D', 'B', 'L', 'S', 'E', 'G' };
+static constexpr uint32_t SegmentVersion = 2;
+static constexpr uint32_t SegmentHeaderSize = 64;
+static constexpr size_t MinGrowSize = 1 << 20;
+
+bool LogSegment::MappedFile::open(const std::string & path, size_t size)
+{
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) > size)
+  {
+    close(0);
+    return false;
+  }
+
+  //map the whole reserved range up front; only pages inside the file are
+  //  touched, and growing the file never moves the mapping
+  void * mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED)
+  {
+    close(0);
+    return false;
+  }
+
+  data = static_cast<uint8_t *>(mapping);
+  fileSize = static_cast<size_t>(st.st_size);
+  reservedSize = size;
+
+  return true;
+}
+
+void LogSegment::MappedFile::close(size_t finalSize)
+{
+  if (data != nullptr)
+  {
+    munmap(data, reservedSize);
+    data = nullptr;
+  }
+
+  if (fd >= 0)
+  {
+    if (finalSize > 0 && finalSize < fileSize)
+    {
+      (void)ftruncate(fd, static_cast<off_t>(finalSize));
+    }
+    ::close(fd);
+    fd = -1;
+  }
+
+  fileSize = 0;
+  reservedSize = 0;
+}
+
+bool LogSegment::MappedFile::reserve(size_t size)
+{
+  if (size <= fileSize)
+  {
+    return true;
+  }
+
+  if (size > reservedSize)
+  {
+    return false;
+  }
+
+  size_t newSize = std::max({ size, fileSize * 2, MinGrowSize });
+  newSize = std::min(newSize, reservedSize);
+
+  if (ftruncate(fd, static_cast<off_t>(newSize)) != 0)
+  {
+    return false;
+  }
+
+  fileSize = newSize;
+  return true;
+}
+
+LogSegment::LogSegment() {}
+
+LogSegment::~LogSegment()
+{
+  close();
+}
+
+bool LogSegment::open(const std::string & path, size_t maxSize)
+{
+  close();
+
+  if (!dataFile.open(path, maxSize) || !indexFile.open(path + ".index", maxSize))
+  {
+    close();
+    return false;
+  }
+
+  if (dataFile.fileSize == 0)
+  {
+    if (!dataFile.reserve(SegmentHeaderSize))
+    {
+      close();
+      return false;
+    }
+
+    Header * header = getHeader();
+    std::memcpy(header->magic, SegmentMagic, sizeof(SegmentMagic));
+    header->version = SegmentVersion;
+    header->headerSize = SegmentHeaderSize;
+    header->dataSize = 0;
+    header->operationCount = 0;
+  }
+
+  Header * header = getHeader();
+  if (dataFile.fileSize < SegmentHeaderSize
+    || std::memcmp(header->magic, SegmentMagic, sizeof(SegmentMagic)) != 0
+    || header->version != SegmentVersion
+    || header->headerSize < sizeof(Header)
+    || header->headerSize + header->dataSize > dataFile.fileSize)
+  {
+    close();
+    return false;
+  }
+
+  //the index is only ever written ahead of the header, so a short index
+  //  means it was lost or truncated rather than the data; a last entry that
+  //  doesn't match the last operation means it was overwritten
+  if (!isIndexValid())
+  {
+    if (!rebuildIndex())
+    {
+      close();
+      return false;
+    }
+  }
+
+  serializer = LogOperationSerialization::CreateSerializer("standard_v1_full");
+  serializerOutput = new CallbackWritableStream<std::string_view>(
+    [this](const std::string_view & data)
+    {
+      writeSerialized(data);
+    });
+  serializer->pipeTo(*serializerOutput);
+
+  return true;
+}
+
+void LogSegment::close()
+{
+  if (serializer != nullptr)
+  {
+    delete serializer;
+    serializer = nullptr;
+  }
+
+  if (serializerOutput != nullptr)
+  {
+    delete serializerOutput;
+    serializerOutput = nullptr;
+  }
+
+  size_t dataSize = 0;
+  size_t indexSize = 0;
+  if (dataFile.data != nullptr && dataFile.fileSize >= SegmentHeaderSize)
+  {
+    Header * header = getHeader();
+    dataSize = header->headerSize + header->dataSize;
+    indexSize = header->operationCount * sizeof(IndexEntry);
+  }
+
+  dataFile.close(dataSize);
+  indexFile.close(indexSize);
+
+  siteIndex.clear();
+  siteIndexedCount = 0;
+  clock.reset();
+}
+
+bool LogSegment::isOpen() const
+{
+  return dataFile.data != nullptr;
+}
+
+void LogSegment::flush()
+{
+  if (!isOpen())
+  {
+    return;
+  }
+
+  msync(indexFile.data, indexFile.fileSize, MS_SYNC);
+  msync(dataFile.data, dataFile.fileSize, MS_SYNC);
+}
+
+bool LogSegment::append(const RefCounted<const LogOperation> & op)
+{
+  if (!isOpen() || op == nullptr)
+  {
+    return false;
+  }
+
+  pendingOp = &(*op);
+  writeFailed = false;
+  serializer->write(op);
+  pendingOp = nullptr;
+
+  return !writeFailed;
+}
+
+IWritableStream<RefCounted<const LogOperation>> * LogSegment::createAppendStream()
+{
+  auto * callbackStream = new CallbackWritableStream<RefCounted<const LogOperation>>(
+    [&](const RefCounted<const LogOperation> & op)
+    {
+      append(op);
+    },
+    [&]()
+    {
+      flush();
+    });
+
+  return callbackStream;
+}
+
+void LogSegment::writeSerialized(const std::string_view & data)
+{
+  Header * header = getHeader();
+  size_t offset = header->dataSize;
+  size_t index = header->operationCount;
+
+  if (!dataFile.reserve(header->headerSize + offset + data.size())
+    || !indexFile.reserve((index + 1) * sizeof(IndexEntry)))
+  {
+    writeFailed = true;
+    return;
+  }
+
+  //reserve may have grown the file, but the mapping (and header) don't move
+  std::memcpy(dataFile.data + header->headerSize + offset, data.data(), data.size());
+
+  setIndexEntry(index, offset, *pendingOp);
+
+  //the header is updated last so a partially written operation is ignored
+  header->dataSize = offset + data.size();
+  header->operationCount = index + 1;
+}
+
+size_t LogSegment::getOperationCount() const
+{
+  if (!isOpen())
+  {
+    return 0;
+  }
+
+  return getHeader()->operationCount;
+}
+
+std::string_view LogSegment::getData() const
+{
+  if (!isOpen())
+  {
+    return std::string_view();
+  }
+
+  Header * header = getHeader();
+  return std::string_view(reinterpret_cast<const char *>(dataFile.data + header->headerSize),
+    header->dataSize);
+}
+
+std::string_view LogSegment::getSerializedOperation(size_t index) const
+{
+  if (index >= getOperationCount())
+  {
+    return std::string_view();
+  }
+
+  Header * header = getHeader();
+  const IndexEntry * entries = getIndex();
+  size_t start = entries[index].offset;
+  size_t end = (index + 1 < header->operationCount) ? entries[index + 1].offset : header->dataSize;
+
+  //only the last entry is checked on open, so the others may be corrupt
+  if (start >= end || end > header->dataSize)
+  {
+    return std::string_view();
+  }
+
+  return std::string_view(reinterpret_cast<const char *>(dataFile.data + header->headerSize + start),
+    end - start);
+}
+
+const LogOperation * LogSegment::getOperation(size_t index) const
+{
+  std::string_view data = getSerializedOperation(index);
+  if (data.size() == 0)
+  {
+    return nullptr;
+  }
+
+  return reinterpret_cast<const LogOperation *>(data.data());
+}
+
+size_t LogSegment::findOperation(const Timestamp & ts)
+{
+  if (!isOpen())
+  {
+    return npos;
+  }
+
+  updateSiteIndex();
+
+  auto it = siteIndex.find(ts.site);
+  if (it == siteIndex.end())
+  {
+    return npos;
+  }
+
+  //last operation starting at or before the clock
+  auto & entries = it->second;
+  auto entry = std::upper_bound(entries.begin(), entries.end(), ts.clock,
+    [](uint32_t clock, const std::pair<uint32_t, uint32_t> & e)
+    {
+      return clock < e.first;
+    });
+
+  if (entry == entries.begin())
+  {
+    return npos;
+  }
+  --entry;
+
+  if (ts.clock <= getIndex()[entry->second].finalClock)
+  {
+    return entry->second;
+  }
+
+  return npos;
+}
+
+const VectorTimestamp & LogSegment::getVectorClock()
+{
+  updateSiteIndex();
+
+  return clock;
+}
+
+LogSegment::Header * LogSegment::getHeader() const
+{
+  return reinterpret_cast<Header *>(dataFile.data);
+}
+
+LogSegment::IndexEntry * LogSegment::getIndex() const
+{
+  return reinterpret_cast<IndexEntry *>(indexFile.data);
+}
+
+void LogSegment::setIndexEntry(size_t index, size_t offset, const LogOperation & op)
+{
+  IndexEntry & entry = getIndex()[index];
+  entry.offset = offset;
+  entry.site = op.ts.site;
+  entry.clock = op.ts.clock;
+  entry.finalClock = OperationLog::GetFinalTimestamp(op).clock;
+  entry.isPreview = (op.op.type == OperationType::ValuePreviewOperation) ? 1 : 0;
+}
+
+bool LogSegment::isIndexValid() const
+{
+  Header * header = getHeader();
+  size_t count = header->operationCount;
+  if (indexFile.fileSize < count * sizeof(IndexEntry))
+  {
+    return false;
+  }
+
+  if (count == 0)
+  {
+    return header->dataSize == 0;
+  }
+
+  //operations are appended in order, so only the last entry can be partly
+  //  written; it has to describe exactly the last operation in the data
+  const IndexEntry * entries = getIndex();
+  const IndexEntry & last = entries[count - 1];
+  if (last.offset >= header->dataSize
+    || (count > 1 && entries[count - 2].offset >= last.offset)
+    || header->dataSize - last.offset < SerializedLogOperation::getStructSize())
+  {
+    return false;
+  }
+
+  auto serializedOp = reinterpret_cast<const SerializedLogOperation *>(
+    dataFile.data + header->headerSize + last.offset);
+  if (serializedOp->op.getStructSize() == 0
+    || serializedOp->getSize() != header->dataSize - last.offset
+    || serializedOp->ts.site != last.site
+    || serializedOp->ts.clock != last.clock)
+  {
+    return false;
+  }
+
+  auto op = reinterpret_cast<const LogOperation *>(serializedOp);
+  return OperationLog::GetFinalTimestamp(*op).clock == last.finalClock;
+}
+
+bool LogSegment::rebuildIndex()
+{
+  Header * header = getHeader();
+  const uint8_t * data = dataFile.data + header->headerSize;
+  size_t offset = 0;
+  size_t count = 0;
+
+  while (offset + SerializedLogOperation::getStructSize() <= header->dataSize)
+  {
+    auto serializedOp = reinterpret_cast<const SerializedLogOperation *>(data + offset);
+    size_t size = serializedOp->getSize();
+    if (serializedOp->op.getStructSize() == 0 || offset + size > header->dataSize)
+    {
+      break;
+    }
+
+    if (!indexFile.reserve((count + 1) * sizeof(IndexEntry)))
+    {
+      return false;
+    }
+
+    setIndexEntry(count, offset, *reinterpret_cast<const LogOperation *>(serializedOp));
+
+    offset += size;
+    count++;
+  }
+
+  //drop anything that couldn't be read back
+  header->dataSize = offset;
+  header->operationCount = count;
+
+  return true;
+}
+
+void LogSegment::updateSiteIndex()
+{
+  size_t count = getOperationCount();
+  const IndexEntry * entries = getIndex();
+
+  for (; siteIndexedCount < count; siteIndexedCount++)
+  {
+    const IndexEntry & entry = entries[siteIndexedCount];
+    auto & siteEntries = siteIndex[entry.site];
+    auto value = std::make_pair(entry.clock, static_cast<uint32_t>(siteIndexedCount));
+
+    //operations from a site normally arrive in clock order
+    if (siteEntries.empty() || siteEntries.back().first < entry.clock)
+    {
+      siteEntries.push_back(value);
+    }
+    else
+    {
+      siteEntries.insert(std::upper_bound(siteEntries.begin(), siteEntries.end(), value), value);
+    }
+
+    if (!entry.isPreview)
+    {
+      clock.update(Timestamp(entry.finalClock, entry.site));
+    }
+  }
+}
\ No newline at end of file
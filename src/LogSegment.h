@@ -0,0 +1,113 @@
+#pragma once
+#include "LogOperation.h"
+#include "VectorTimestamp.h"
+#include "RefCounted.h"
+#include "Streams/IWritableStream.h"
+#include "Serialization/ILogOperationSerializer.h"
+#include "Streams/CallbackWritableStream.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//Persistent, append-only operation log backed by memory-mapped files
+//The data file is a header followed by a standard_v1_full stream, so its
+//  contents can be handed to any standard_v1_full deserializer as-is
+//A second file (path + ".index") holds a fixed size entry per operation,
+//  giving O(1) access by position; opening a segment only maps both files
+//  and checks the last entry against the data
+//Each file is mapped once over a reserved range of maxSize bytes and grown
+//  in place, so pointers into the mapping stay valid until close()
+//The per-site clock index is built lazily on the first lookup by timestamp,
+//  from the index file alone (entries keep each operation's final clock)
+class LogSegment
+{
+public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+  static constexpr size_t DefaultMaxSize = (sizeof(void *) >= 8)
+    ? (static_cast<size_t>(1) << 36) : (static_cast<size_t>(1) << 30);
+
+  LogSegment();
+  ~LogSegment();
+
+  LogSegment(const LogSegment &) = delete;
+  LogSegment & operator=(const LogSegment &) = delete;
+
+  //creates the segment if it doesn't exist
+  bool open(const std::string & path, size_t maxSize = DefaultMaxSize);
+  void close();
+  bool isOpen() const;
+  //writes the mapped pages back to disk
+  void flush();
+
+  bool append(const RefCounted<const LogOperation> & op);
+  IWritableStream<RefCounted<const LogOperation>> * createAppendStream();
+
+  size_t getOperationCount() const;
+  //the whole log as a standard_v1_full stream
+  std::string_view getData() const;
+  //a single operation in standard_v1_full format
+  std::string_view getSerializedOperation(size_t index) const;
+  //view into the mapping; valid until the segment is closed
+  const LogOperation * getOperation(size_t index) const;
+
+  //index of the operation containing the given timestamp (group operations
+  //  contain one timestamp per child operation), or npos
+  size_t findOperation(const Timestamp & ts);
+  const VectorTimestamp & getVectorClock();
+
+private:
+  struct Header
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t dataSize;
+    uint64_t operationCount;
+  };
+
+  struct IndexEntry
+  {
+    uint64_t offset;
+    uint32_t site;
+    uint32_t clock;
+    //clock of the operation's last timestamp (group operations have one per
+    //  child operation)
+    uint32_t finalClock;
+    //value previews aren't part of the vector clock
+    uint32_t isPreview;
+  };
+
+  void setIndexEntry(size_t index, size_t offset, const LogOperation & op);
+
+  struct MappedFile
+  {
+    bool open(const std::string & path, size_t reservedSize);
+    void close(size_t finalSize);
+    bool reserve(size_t size);
+
+    int fd = -1;
+    uint8_t * data = nullptr;
+    size_t fileSize = 0;
+    size_t reservedSize = 0;
+  };
+
+  Header * getHeader() const;
+  IndexEntry * getIndex() const;
+  void writeSerialized(const std::string_view & data);
+  bool isIndexValid() const;
+  bool rebuildIndex();
+  void updateSiteIndex();
+
+  MappedFile dataFile;
+  MappedFile indexFile;
+  ILogOperationSerializer * serializer = nullptr;
+  CallbackWritableStream<std::string_view> * serializerOutput = nullptr;
+  const LogOperation * pendingOp = nullptr;
+  bool writeFailed = false;
+
+  //per site list of (clock, operation index) in clock order
+  std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, uint32_t>>> siteIndex;
+  size_t siteIndexedCount = 0;
+  VectorTimestamp clock;
+};
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include "MessagePackSerializer.h"
+#include <charconv>
+#include <cstring>
+
+void MessagePackSerializer::startObject()
+{
+  startContainer(false);
+}
+
+void MessagePackSerializer::endObject()
+{
+  endContainer();
+}
+
+void MessagePackSerializer::resumeObject()
+{
+  resumeContainer(false);
+}
+
+void MessagePackSerializer::startArray()
+{
+  startContainer(true);
+}
+
+void MessagePackSerializer::endArray()
+{
+  endContainer();
+}
+
+void MessagePackSerializer::resumeArray()
+{
+  resumeContainer(true);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, bool value)
+{
+  addKey(key);
+  startValue();
+  buffer.push_back(static_cast<char>(value ? 0xC3 : 0xC2));
+}
+
+void MessagePackSerializer::addPair(std::string_view key, std::string_view value)
+{
+  addKey(key);
+  startValue();
+  writeString(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, const char * value)
+{
+  addKey(key);
+  startValue();
+  writeString(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, const Timestamp & value)
+{
+  addKey(key);
+  startValue();
+  writeTimestamp(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, const NodeId & value)
+{
+  addKey(key);
+  startValue();
+  writeNodeId(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, size_t value)
+{
+  addKey(key);
+  startValue();
+  writeUInt(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, uint32_t value)
+{
+  addKey(key);
+  startValue();
+  writeUInt(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, double value)
+{
+  addKey(key);
+  startValue();
+  writeDouble(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, float value)
+{
+  addKey(key);
+  startValue();
+  writeFloat(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, int32_t value)
+{
+  addKey(key);
+  startValue();
+  writeInt(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, int64_t value)
+{
+  addKey(key);
+  startValue();
+  writeInt(value);
+}
+
+void MessagePackSerializer::addPair(std::string_view key, int8_t value)
+{
+  addKey(key);
+  startValue();
+  writeInt(value);
+}
+
+void MessagePackSerializer::addKey(std::string_view key)
+{
+  lastClosedEnd = SIZE_MAX;
+
+  //a map's length counts key/value pairs
+  if (!scopes.empty() && !scopes.back().isArray)
+  {
+    scopes.back().length++;
+  }
+
+  writeString(key);
+}
+
+void MessagePackSerializer::addValue(std::string_view value)
+{
+  startValue();
+  writeString(value);
+}
+
+void MessagePackSerializer::addNullValue()
+{
+  startValue();
+  buffer.push_back(static_cast<char>(0xC0));
+}
+
+std::string_view MessagePackSerializer::result() const
+{
+  return buffer;
+}
+
+void MessagePackSerializer::clear()
+{
+  buffer.clear();
+  scopes.clear();
+  lastClosedEnd = SIZE_MAX;
+}
+
+void MessagePackSerializer::startValue()
+{
+  lastClosedEnd = SIZE_MAX;
+
+  if (!scopes.empty() && scopes.back().isArray)
+  {
+    scopes.back().length++;
+  }
+}
+
+void MessagePackSerializer::startContainer(bool isArray)
+{
+  startValue();
+
+  //array 32 or map 32, with the length written at the end
+  buffer.push_back(static_cast<char>(isArray ? 0xDD : 0xDF));
+  scopes.push_back({ isArray, buffer.size(), 0 });
+  buffer.append(4, '\0');
+}
+
+void MessagePackSerializer::endContainer()
+{
+  const Scope & scope = scopes.back();
+  uint32_t length = scope.length;
+  for (size_t i = 0; i < 4; i++)
+  {
+    buffer[scope.offset + i] = static_cast<char>(length >> (24 - i * 8));
+  }
+
+  lastClosed = scope;
+  lastClosedEnd = buffer.size();
+  scopes.pop_back();
+}
+
+void MessagePackSerializer::resumeContainer(bool isArray)
+{
+  if (lastClosedEnd != buffer.size() || lastClosed.isArray != isArray)
+  {
+    return;
+  }
+
+  //new entries go at the end of the buffer, which is still the end of the container
+  scopes.push_back(lastClosed);
+  lastClosedEnd = SIZE_MAX;
+}
+
+void MessagePackSerializer::writeBigEndian(uint64_t value, size_t size)
+{
+  for (size_t i = size; i > 0; i--)
+  {
+    buffer.push_back(static_cast<char>(value >> ((i - 1) * 8)));
+  }
+}
+
+void MessagePackSerializer::writeString(std::string_view value)
+{
+  size_t length = value.size();
+  if (length < 32)
+  {
+    buffer.push_back(static_cast<char>(0xA0 | length));
+  }
+  else if (length <= UINT8_MAX)
+  {
+    buffer.push_back(static_cast<char>(0xD9));
+    writeBigEndian(length, 1);
+  }
+  else if (length <= UINT16_MAX)
+  {
+    buffer.push_back(static_cast<char>(0xDA));
+    writeBigEndian(length, 2);
+  }
+  else
+  {
+    buffer.push_back(static_cast<char>(0xDB));
+    writeBigEndian(length, 4);
+  }
+
+  buffer.append(value);
+}
+
+//the values separated by commas, into a buffer with room for all of them
+//  (10 digits each, and the separators)
+template <size_t N>
+static std::string_view formatIds(char (&str)[N * 11], const uint32_t (&values)[N])
+{
+  char * end = str;
+  char * last = str + sizeof(str);
+  for (size_t i = 0; i < N; i++)
+  {
+    if (i > 0)
+    {
+      if (end == last)
+      {
+        break;
+      }
+      *end++ = ',';
+    }
+
+    auto result = std::to_chars(end, last, values[i]);
+    if (result.ec != std::errc())
+    {
+      break;
+    }
+    end = result.ptr;
+  }
+
+  return std::string_view(str, end - str);
+}
+
+void MessagePackSerializer::writeTimestamp(const Timestamp & value)
+{
+  //same text as Timestamp::toString
+  char str[2 * 11];
+  writeString(formatIds<2>(str, { value.clock, value.site }));
+}
+
+void MessagePackSerializer::writeNodeId(const NodeId & value)
+{
+  //same text as NodeId::toString
+  char str[3 * 11];
+  writeString(formatIds<3>(str, { value.ts.clock, value.ts.site, value.child }));
+}
+
+void MessagePackSerializer::writeUInt(uint64_t value)
+{
+  if (value < 0x80)
+  {
+    buffer.push_back(static_cast<char>(value));
+  }
+  else if (value <= UINT8_MAX)
+  {
+    buffer.push_back(static_cast<char>(0xCC));
+    writeBigEndian(value, 1);
+  }
+  else if (value <= UINT16_MAX)
+  {
+    buffer.push_back(static_cast<char>(0xCD));
+    writeBigEndian(value, 2);
+  }
+  else if (value <= UINT32_MAX)
+  {
+    buffer.push_back(static_cast<char>(0xCE));
+    writeBigEndian(value, 4);
+  }
+  else
+  {
+    buffer.push_back(static_cast<char>(0xCF));
+    writeBigEndian(value, 8);
+  }
+}
+
+void MessagePackSerializer::writeInt(int64_t value)
+{
+  if (value >= 0)
+  {
+    writeUInt(static_cast<uint64_t>(value));
+  }
+  else if (value >= -32)
+  {
+    //negative fixint
+    buffer.push_back(static_cast<char>(value));
+  }
+  else if (value >= INT8_MIN)
+  {
+    buffer.push_back(static_cast<char>(0xD0));
+    writeBigEndian(static_cast<uint64_t>(value), 1);
+  }
+  else if (value >= INT16_MIN)
+  {
+    buffer.push_back(static_cast<char>(0xD1));
+    writeBigEndian(static_cast<uint64_t>(value), 2);
+  }
+  else if (value >= INT32_MIN)
+  {
+    buffer.push_back(static_cast<char>(0xD2));
+    writeBigEndian(static_cast<uint64_t>(value), 4);
+  }
+  else
+  {
+    buffer.push_back(static_cast<char>(0xD3));
+    writeBigEndian(static_cast<uint64_t>(value), 8);
+  }
+}
+
+void MessagePackSerializer::writeDouble(double value)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  buffer.push_back(static_cast<char>(0xCB));
+  writeBigEndian(bits, 8);
+}
+
+void MessagePackSerializer::writeFloat(float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  buffer.push_back(static_cast<char>(0xCA));
+  writeBigEndian(bits, 4);
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+#include "IObjectSerializer.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Writes the same objects as JsonBufferSerializer in MessagePack, a compact
+//  binary format with decoders for most languages
+//Container lengths aren't known up front, so maps and arrays always use the
+//  32 bit length forms and the length is filled in when they end
+//Timestamps and node ids are written as the same strings as in JSON so
+//  both formats decode to the same objects
+class MessagePackSerializer : public IObjectSerializer
+{
+public:
+  void startObject();
+  void endObject();
+  void resumeObject();
+
+  void startArray();
+  void endArray();
+  void resumeArray();
+
+  void addPair(std::string_view key, bool value);
+  void addPair(std::string_view key, std::string_view value);
+  void addPair(std::string_view key, const char * value);
+  void addPair(std::string_view key, const Timestamp & value);
+  void addPair(std::string_view key, const NodeId & value);
+  void addPair(std::string_view key, size_t value);
+  void addPair(std::string_view key, uint32_t value);
+  void addPair(std::string_view key, double value);
+  void addPair(std::string_view key, float value);
+  void addPair(std::string_view key, int32_t value);
+  void addPair(std::string_view key, int64_t value);
+  void addPair(std::string_view key, int8_t value);
+
+  void addKey(std::string_view key);
+  void addValue(std::string_view value);
+  void addNullValue();
+
+  //everything written so far; the view is invalidated by further writes
+  std::string_view result() const;
+  void clear();
+
+private:
+  struct Scope
+  {
+    bool isArray;
+    //where the length goes
+    size_t offset;
+    uint32_t length;
+  };
+
+  std::string buffer;
+  std::vector<Scope> scopes;
+
+  //the container closed last, which resumeObject/resumeArray reopen as long
+  //  as nothing has been written after it
+  Scope lastClosed = { false, 0, 0 };
+  size_t lastClosedEnd = SIZE_MAX;
+
+  void startValue();
+  void startContainer(bool isArray);
+  void endContainer();
+  void resumeContainer(bool isArray);
+
+  void writeBigEndian(uint64_t value, size_t size);
+  void writeString(std::string_view value);
+  void writeTimestamp(const Timestamp & value);
+  void writeNodeId(const NodeId & value);
+  void writeUInt(uint64_t value);
+  void writeInt(int64_t value);
+  void writeDouble(double value);
+  void writeFloat(float value);
+};
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "NodeTable.h"
+#include <bit>
+#include <utility>
+
+static const uint64_t LowBits = 0x0101010101010101ull;
+static const uint64_t HighBits = 0x8080808080808080ull;
+
+//assembled in little endian order so byte i is always bits 8i to 8i+7
+static inline uint64_t loadGroup(const uint8_t * bytes)
+{
+  uint64_t word = 0;
+  for (size_t i = 0; i < 8; i++)
+  {
+    word |= static_cast<uint64_t>(bytes[i]) << (i * 8);
+  }
+  return word;
+}
+
+//sets the high bit of each byte equal to the pattern's bytes
+//  (this can report false positives above a real match, which are filtered
+//  out by comparing keys)
+static inline uint64_t matchByte(uint64_t word, uint64_t pattern)
+{
+  uint64_t x = word ^ pattern;
+  return (x - LowBits) & ~x & HighBits;
+}
+
+//only empty control bytes have the high bit set
+static inline uint64_t matchEmpty(uint64_t word)
+{
+  return word & HighBits;
+}
+
+static inline size_t firstMatch(uint64_t bits)
+{
+  return static_cast<size_t>(std::countr_zero(bits)) / 8;
+}
+
+uint64_t NodeTable::hash(const NodeId & nodeId)
+{
+  uint64_t h = (static_cast<uint64_t>(nodeId.ts.clock) << 32) | nodeId.ts.site;
+  h ^= static_cast<uint64_t>(nodeId.child) * 0x9E3779B97F4A7C15ull;
+  h ^= h >> 30;
+  h *= 0xBF58476D1CE4E5B9ull;
+  h ^= h >> 27;
+  h *= 0x94D049BB133111EBull;
+  h ^= h >> 31;
+  return h;
+}
+
+Node * NodeTable::find(const NodeId & nodeId) const
+{
+  if (nodeId.child == 0)
+  {
+    for (const auto & site : sites)
+    {
+      if (site.site == nodeId.ts.site)
+      {
+        if (nodeId.ts.clock >= site.base)
+        {
+          size_t index = nodeId.ts.clock - site.base;
+          if (index < site.nodes.size() && site.nodes[index] != nullptr)
+          {
+            return site.nodes[index];
+          }
+        }
+        break;
+      }
+    }
+  }
+
+  if (hashedCount == 0)
+  {
+    return nullptr;
+  }
+
+  size_t index = findHashed(nodeId, hash(nodeId));
+  return (index != NotFound) ? slots[index].node : nullptr;
+}
+
+void NodeTable::set(const NodeId & nodeId, Node * node)
+{
+  if (nodeId.child == 0 && setDense(nodeId, node))
+  {
+    return;
+  }
+
+  uint64_t h = hash(nodeId);
+  size_t index = (hashedCount > 0) ? findHashed(nodeId, h) : NotFound;
+  if (index != NotFound)
+  {
+    slots[index].node = node;
+    return;
+  }
+
+  insertHashed(nodeId, node, h);
+}
+
+bool NodeTable::setDense(const NodeId & nodeId, Node * node)
+{
+  uint32_t clock = nodeId.ts.clock;
+  DenseSite * site = nullptr;
+
+  for (auto & it : sites)
+  {
+    if (it.site == nodeId.ts.site)
+    {
+      site = &it;
+      break;
+    }
+  }
+
+  if (site == nullptr)
+  {
+    if (sites.size() >= MaxDenseSites)
+    {
+      return false;
+    }
+
+    sites.push_back({ nodeId.ts.site, clock, 0, {} });
+    site = &sites.back();
+  }
+
+  if (clock < site->base)
+  {
+    return false;
+  }
+
+  size_t index = clock - site->base;
+  if (index >= site->nodes.size())
+  {
+    if (index >= site->count * 4 + MinDenseLength)
+    {
+      return false;
+    }
+
+    site->nodes.resize(index + 1, nullptr);
+  }
+
+  Node *& entry = site->nodes[index];
+  if (entry == nullptr)
+  {
+    //the id may have been hashed before the array reached this far
+    size_t hashedIndex = (hashedCount > 0) ? findHashed(nodeId, hash(nodeId)) : NotFound;
+    if (hashedIndex != NotFound)
+    {
+      slots[hashedIndex].node = node;
+      return true;
+    }
+
+    site->count++;
+    denseCount++;
+  }
+
+  entry = node;
+  return true;
+}
+
+size_t NodeTable::findHashed(const NodeId & nodeId, uint64_t hash) const
+{
+  size_t groupMask = slots.size() / GroupSize - 1;
+  size_t group = (hash >> 7) & groupMask;
+  uint64_t pattern = LowBits * (hash & 0x7F);
+
+  //triangular probing visits every group when the group count is a power of 2
+  for (size_t step = 1; ; step++)
+  {
+    uint64_t word = loadGroup(&control[group * GroupSize]);
+
+    for (uint64_t bits = matchByte(word, pattern); bits != 0; bits &= bits - 1)
+    {
+      size_t index = group * GroupSize + firstMatch(bits);
+      if (slots[index].nodeId == nodeId)
+      {
+        return index;
+      }
+    }
+
+    if (matchEmpty(word) != 0)
+    {
+      return NotFound;
+    }
+
+    group = (group + step) & groupMask;
+  }
+}
+
+void NodeTable::insertHashed(const NodeId & nodeId, Node * node, uint64_t hash)
+{
+  //keep the load factor at or below 7/8 so probes end quickly
+  if ((hashedCount + 1) * 8 > slots.size() * 7)
+  {
+    rehash(slots.empty() ? GroupSize * 2 : slots.size() * 2);
+  }
+
+  size_t groupMask = slots.size() / GroupSize - 1;
+  size_t group = (hash >> 7) & groupMask;
+
+  for (size_t step = 1; ; step++)
+  {
+    uint64_t empty = matchEmpty(loadGroup(&control[group * GroupSize]));
+    if (empty != 0)
+    {
+      size_t index = group * GroupSize + firstMatch(empty);
+      control[index] = static_cast<uint8_t>(hash & 0x7F);
+      slots[index] = { nodeId, node };
+      hashedCount++;
+      return;
+    }
+
+    group = (group + step) & groupMask;
+  }
+}
+
+void NodeTable::rehash(size_t capacity)
+{
+  std::vector<uint8_t> oldControl = std::exchange(control, std::vector<uint8_t>(capacity, Empty));
+  std::vector<Slot> oldSlots = std::exchange(slots, std::vector<Slot>(capacity));
+  hashedCount = 0;
+
+  for (size_t i = 0; i < oldSlots.size(); i++)
+  {
+    if (oldControl[i] != Empty)
+    {
+      insertHashed(oldSlots[i].nodeId, oldSlots[i].node, hash(oldSlots[i].nodeId));
+    }
+  }
+}
+
+size_t NodeTable::size() const
+{
+  return denseCount + hashedCount;
+}
+
+void NodeTable::clear()
+{
+  sites.clear();
+  denseCount = 0;
+  control.clear();
+  slots.clear();
+  hashedCount = 0;
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+#include "NodeId.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Node;
+
+//Maps node ids to nodes
+//Nodes created directly by an operation have the id {ts, 0}, and a site's
+//  clocks are mostly sequential, so those nodes go in a dense array per site
+//  indexed by clock; everything else (inherited nodes, clocks too far past
+//  the array and sites beyond the first few) goes in an open addressing hash
+//  table
+//The hash table keeps a control byte with 7 bits of the hash for each slot
+//  and probes groups of 8 slots at once by matching the control bytes within
+//  a 64 bit word, so most lookups compare a single key
+//Nodes can't be removed individually
+class NodeTable
+{
+public:
+  NodeTable() = default;
+  NodeTable(const NodeTable &) = delete;
+  NodeTable & operator=(const NodeTable &) = delete;
+  NodeTable(NodeTable &&) = default;
+  NodeTable & operator=(NodeTable &&) = default;
+
+  Node * find(const NodeId & nodeId) const;
+  //adds the node, or replaces the node already stored for the id
+  void set(const NodeId & nodeId, Node * node);
+  size_t size() const;
+  void clear();
+
+  template <class F>
+  void forEach(F callback) const
+  {
+    for (const auto & site : sites)
+    {
+      for (size_t i = 0; i < site.nodes.size(); i++)
+      {
+        if (site.nodes[i] != nullptr)
+        {
+          NodeId nodeId = { Timestamp(site.base + static_cast<uint32_t>(i), site.site), 0 };
+          callback(nodeId, site.nodes[i]);
+        }
+      }
+    }
+
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+      if (control[i] != Empty)
+      {
+        callback(slots[i].nodeId, slots[i].node);
+      }
+    }
+  }
+
+private:
+  struct DenseSite
+  {
+    uint32_t site;
+    //the clock of the first entry in nodes
+    uint32_t base;
+    size_t count;
+    std::vector<Node *> nodes;
+  };
+
+  struct Slot
+  {
+    NodeId nodeId;
+    Node * node;
+  };
+
+  static constexpr size_t GroupSize = 8;
+  static constexpr uint8_t Empty = 0x80;
+  static constexpr size_t NotFound = SIZE_MAX;
+  static constexpr size_t MaxDenseSites = 16;
+  //the array can grow as long as at least about a quarter of it is used
+  static constexpr size_t MinDenseLength = 256;
+
+  std::vector<DenseSite> sites;
+  size_t denseCount = 0;
+
+  std::vector<uint8_t> control;
+  std::vector<Slot> slots;
+  size_t hashedCount = 0;
+
+  bool setDense(const NodeId & nodeId, Node * node);
+  size_t findHashed(const NodeId & nodeId, uint64_t hash) const;
+  void insertHashed(const NodeId & nodeId, Node * node, uint64_t hash);
+  void rehash(size_t capacity);
+
+  static uint64_t hash(const NodeId & nodeId);
+};
\ No newline at end of file
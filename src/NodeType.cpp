@@ -1,15 +1,21 @@
 #include "NodeType.h"
 #include "PrimitiveNodeTypes.h"
+#include <mutex>
 
 std::unordered_map<std::string, NodeTypeData> NodeType::nodeTypes =
   PrimitiveNodeTypes::getTypeRegistryInitializer();
 
+//guards the registry; references are counted without it unless they could
+//  be the last one
+static std::mutex nodeTypesMutex;
+
 NodeType::NodeType(const std::string & type)
 {
   if (!type.empty())
   {
+    std::lock_guard<std::mutex> lock(nodeTypesMutex);
     data = &getOrCreateNodeType(type);
-    data->refCount++;
+    data->refCount.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
@@ -18,7 +24,7 @@ NodeType::NodeType(NodeTypeData * data)
 {
   if (data != nullptr)
   {
-    data->refCount++;
+    data->refCount.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
@@ -27,7 +33,7 @@ NodeType::NodeType(const NodeType & other)
 {
   if (data != nullptr)
   {
-    data->refCount++;
+    data->refCount.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
@@ -49,23 +55,18 @@ bool NodeType::operator!=(const NodeType & rhs) const
 
 NodeType & NodeType::operator=(const NodeType & rhs)
 {
-  if (data != nullptr)
+  if (rhs.data != nullptr)
   {
-    data->refCount--;
-
-    if (data->refCount == 0)
-    {
-      nodeTypes.erase(data->type);
-    }
+    rhs.data->refCount.fetch_add(1, std::memory_order_relaxed);
   }
 
-  data = rhs.data;
-
   if (data != nullptr)
   {
-    data->refCount++;
+    release(data);
   }
 
+  data = rhs.data;
+
   return *this;
 }
 
@@ -73,12 +74,7 @@ NodeType::~NodeType()
 {
   if (data != nullptr)
   {
-    data->refCount--;
-
-    if (data->refCount == 0)
-    {
-      nodeTypes.erase(data->type);
-    }
+    release(data);
   }
 }
 
@@ -94,6 +90,27 @@ std::string NodeType::toString() const
 
 NodeTypeData & NodeType::getOrCreateNodeType(const std::string & type)
 {
-  auto [iter, inserted] = nodeTypes.try_emplace(type, NodeTypeData{type});
+  auto [iter, inserted] = nodeTypes.try_emplace(type, type);
   return iter->second;
+}
+
+void NodeType::release(NodeTypeData * data)
+{
+  //other references can't go away under us, so this isn't the last one
+  size_t refCount = data->refCount.load(std::memory_order_relaxed);
+  while (refCount > 1)
+  {
+    if (data->refCount.compare_exchange_weak(refCount, refCount - 1, std::memory_order_acq_rel))
+    {
+      return;
+    }
+  }
+
+  //the last reference can only be revived through the registry, so the
+  //  count is dropped with the registry locked
+  std::lock_guard<std::mutex> lock(nodeTypesMutex);
+  if (data->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    nodeTypes.erase(data->type);
+  }
 }
\ No newline at end of file
@@ -1,11 +1,19 @@
 #pragma once
+#include <atomic>
 #include <string>
 #include <unordered_map>
 
 struct NodeTypeData
 {
+  NodeTypeData(std::string type, size_t refCount = 0)
+    : type(std::move(type)), refCount(refCount) {}
+  //only for filling the registry, before the data can be shared
+  NodeTypeData(const NodeTypeData & other)
+    : type(other.type), refCount(other.refCount.load(std::memory_order_relaxed)) {}
+
   std::string type;
-  size_t refCount = 0;
+  //types are shared by cores on different threads
+  std::atomic<size_t> refCount;
 };
 
 class NodeType
@@ -29,6 +37,7 @@ private:
   static std::unordered_map<std::string, NodeTypeData> nodeTypes;
 
   static NodeTypeData & getOrCreateNodeType(const std::string & type);
+  static void release(NodeTypeData * data);
 
   NodeTypeData * data = nullptr;
 
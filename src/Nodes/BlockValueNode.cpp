@@ -1,4 +1,5 @@
 #include "BlockValueNode.h"
+#include "Snapshot.h"
 
 template <class T>
 void BlockValueNode<T>::serialize(IObjectSerializer & serializer) const
@@ -6,4 +7,18 @@ void BlockValueNode<T>::serialize(IObjectSerializer & serializer) const
   Node::serialize(serializer);
 }
 
+template <class T>
+void BlockValueNode<T>::saveSnapshot(SnapshotWriter & writer) const
+{
+  Node::saveSnapshot(writer);
+  value.saveSnapshot(writer);
+}
+
+template <class T>
+void BlockValueNode<T>::loadSnapshot(SnapshotReader & reader, ByteArena & arena)
+{
+  Node::loadSnapshot(reader);
+  value.loadSnapshot(reader, arena);
+}
+
 template class BlockValueNode<char>;
\ No newline at end of file
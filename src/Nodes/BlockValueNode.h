@@ -1,3 +1,4 @@
+#pragma once
 #include "Node.h"
 #include "BlockValue.h"
 #include "IObjectSerializer.h"
@@ -9,4 +10,6 @@ public:
   BlockValue<T> value;
 
   void serialize(IObjectSerializer & serializer) const;
+  void saveSnapshot(SnapshotWriter & writer) const;
+  void loadSnapshot(SnapshotReader & reader, ByteArena & arena);
 };
\ No newline at end of file
@@ -1,11 +1,32 @@
 #include "ContainerNode.h"
+#include "Snapshot.h"
+#include "VectorTimestamp.h"
+#include <type_traits>
+
+void ContainerNode::saveSnapshot(SnapshotWriter & writer) const
+{
+  Node::saveSnapshot(writer);
+  writer.writeNodeType(childType.definedByType);
+  writer.writeNodeType(childType.value);
+}
+
+void ContainerNode::loadSnapshot(SnapshotReader & reader)
+{
+  Node::loadSnapshot(reader);
+  childType.definedByType = reader.readNodeType();
+  childType.value = reader.readNodeType();
+}
 
 template <class T>
 ContainerNodeImpl<T>::~ContainerNodeImpl()
 {
-  for (auto it = edges.begin(); it != edges.end(); ++it)
+  //the pool frees its slabs without visiting the edges
+  if constexpr (!std::is_trivially_destructible_v<T>)
   {
-    delete it->second;
+    for (auto it = edges.begin(); it != edges.end(); ++it)
+    {
+      edgePool.destroy(it->second);
+    }
   }
 }
 
@@ -22,7 +43,7 @@ T * ContainerNodeImpl<T>::getEdge(const EdgeId & edgeId)
 
   if (edge == nullptr)
   {
-    edge = new T();
+    edge = edgePool.create();
     edges[edgeId] = edge;
   }
 
@@ -49,11 +70,98 @@ void ContainerNodeImpl<T>::deleteEdge(const EdgeId & edgeId)
   auto it = edges.find(edgeId);
   if (it != edges.end())
   {
-    delete it->second;
+    edgePool.destroy(it->second);
     edges.erase(it);
   }
 }
 
+template <class T>
+bool ContainerNodeImpl<T>::isGarbage(const EdgeId & edgeId, const T * edge,
+  const VectorTimestamp & horizon, const std::unordered_set<EdgeId> & pinned) const
+{
+  return edge->effect.isInitialized() && !edge->effect.isVisible()
+    && !edge->childId.isPending() && horizon >= edgeId.ts
+    && pinned.find(edgeId) == pinned.end();
+}
+
+template <class T>
+bool ContainerNodeImpl<T>::compact(const VectorTimestamp & horizon,
+  const std::unordered_set<EdgeId> & pinned)
+{
+  //removed edges are only referenced by the edge map here (sets and
+  //  references only link visible edges into their child lists)
+  for (auto it = edges.begin(); it != edges.end();)
+  {
+    if (isGarbage(it->first, it->second, horizon, pinned))
+    {
+      edgePool.destroy(it->second);
+      it = edges.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  return true;
+}
+
+template <class T>
+void ContainerNodeImpl<T>::saveEdges(SnapshotWriter & writer,
+  std::unordered_map<const T *, uint64_t> & indices) const
+{
+  writer.writeUInt(edges.size());
+  for (const auto & it : edges)
+  {
+    indices.emplace(it.second, indices.size() + 1);
+
+    writer.writeNodeId(it.first);
+    writer.writeNodeId(it.second->childId);
+    writer.writeEffect(it.second->effect);
+    writer.writeUInt(it.second->createdByRootOffset);
+  }
+}
+
+template <class T>
+std::vector<T *> ContainerNodeImpl<T>::loadEdges(SnapshotReader & reader)
+{
+  std::vector<T *> table(1, nullptr);
+
+  size_t count = reader.readCount();
+  table.reserve(count + 1);
+  for (size_t i = 0; i < count && !reader.hasError(); i++)
+  {
+    T * edge = getEdge(reader.readNodeId());
+    edge->childId = reader.readNodeId();
+    edge->effect = reader.readEffect();
+    edge->createdByRootOffset = static_cast<uint32_t>(reader.readUInt());
+    table.push_back(edge);
+  }
+
+  return table;
+}
+
+template <class T>
+void ContainerNodeImpl<T>::writeEdgeRef(SnapshotWriter & writer,
+  const std::unordered_map<const T *, uint64_t> & indices, const T * edge)
+{
+  auto it = indices.find(edge);
+  writer.writeUInt((it != indices.end()) ? it->second : 0);
+}
+
+template <class T>
+T * ContainerNodeImpl<T>::readEdgeRef(SnapshotReader & reader, const std::vector<T *> & table)
+{
+  uint64_t index = reader.readUInt();
+  if (index >= table.size())
+  {
+    reader.setError();
+    return nullptr;
+  }
+
+  return table[index];
+}
+
 #include "SetNode.h"
 #include "MapNode.h"
 #include "ListNode.h"
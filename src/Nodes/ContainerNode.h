@@ -1,7 +1,18 @@
 #pragma once
 #include "Node.h"
 #include "EdgeId.h"
+#include "SlabAllocator.h"
+#include <functional>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class VectorTimestamp;
+
+//called while serializing a container's children for each edge with a
+//  materialized child, before the edge's object is closed, so it can add
+//  more fields to it
+using SerializeChildCallback = std::function<void(const NodeId & childId)>;
 
 class ContainerNode : public Node
 {
@@ -12,6 +23,9 @@ public:
   };
 
   Attribute<NodeType> childType;
+
+  void saveSnapshot(SnapshotWriter & writer) const;
+  void loadSnapshot(SnapshotReader & reader);
 };
 
 template <class T>
@@ -22,5 +36,25 @@ public:
   T * getEdge(const EdgeId & edgeId);
   T * getExistingEdge(const EdgeId & edgeId) const;
   void deleteEdge(const EdgeId & edgeId);
+  //frees removed edges created at or below the horizon, except pinned ones
+  //  (which may still be undone); returns false if some were kept anyway
+  bool compact(const VectorTimestamp & horizon, const std::unordered_set<EdgeId> & pinned);
   std::unordered_map<EdgeId, T *> edges;
+
+protected:
+  //edges are packed into slabs per container, starting small since most
+  //  containers only ever have a few
+  ObjectPool<T, 1> edgePool;
+
+  bool isGarbage(const EdgeId & edgeId, const T * edge, const VectorTimestamp & horizon,
+    const std::unordered_set<EdgeId> & pinned) const;
+
+  //snapshots write the edges once, in map order, and refer to them (e.g. in
+  //  child lists) by their position, starting at 1 with 0 meaning null
+  //further per edge data is written in the same order after the table
+  void saveEdges(SnapshotWriter & writer, std::unordered_map<const T *, uint64_t> & indices) const;
+  std::vector<T *> loadEdges(SnapshotReader & reader);
+  static void writeEdgeRef(SnapshotWriter & writer,
+    const std::unordered_map<const T *, uint64_t> & indices, const T * edge);
+  static T * readEdgeRef(SnapshotReader & reader, const std::vector<T *> & table);
 };
\ No newline at end of file
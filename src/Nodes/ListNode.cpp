@@ -1,9 +1,11 @@
 #include "ListNode.h"
+#include "Snapshot.h"
+#include "VectorTimestamp.h"
 #include <iostream>
 
 ListEdge * ListNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
   const EdgeId & prevEdgeId, const AttributeMap * attributes,
-  std::function<void(EdgeEvent &)> callback)
+  EdgeEventCallback callback)
 {
   if (attributes == nullptr)
   {
@@ -30,6 +32,7 @@ ListEdge * ListNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
   }
 
   ListEdge ** insert;
+  ListEdge * insertPrev = nullptr;
   if (prevEdgeId.isNull())
   {
     insert = &edgeList;
@@ -38,6 +41,7 @@ ListEdge * ListNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
   {
     ListEdge * prevEdge = getEdge(prevEdgeId);
     insert = &prevEdge->next;
+    insertPrev = prevEdge;
   }
 
   //insert after newer edges
@@ -48,6 +52,7 @@ ListEdge * ListNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
       break;
     }
 
+    insertPrev = *insert;
     insert = &(*insert)->next;
   }
 
@@ -75,6 +80,17 @@ ListEdge * ListNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
 
   *insert = nextEdge;
 
+  //edges inserted after an edge that isn't in the main list yet are indexed
+  //  once that edge's own list is inserted
+  if (insertPrev == nullptr || edgeIndex.contains(insertPrev))
+  {
+    for (sibling = edge; sibling != nextEdge; sibling = sibling->next)
+    {
+      edgeIndex.insertAfter(insertPrev, sibling);
+      insertPrev = sibling;
+    }
+  }
+
   //add visible edges to the children list
   sibling = edge;
   do
@@ -92,7 +108,7 @@ ListEdge * ListNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
 }
 
 void ListNode::updateEdgeEffect(const EdgeId & edgeId, int delta,
-  bool deinitialize, std::function<void(EdgeEvent &)> callback)
+  bool deinitialize, EdgeEventCallback callback)
 {
   Edge * edge = getEdge(edgeId);
 
@@ -124,52 +140,56 @@ void ListNode::updateEdgeEffect(const EdgeId & edgeId, int delta,
   }
 }
 
-void ListNode::deleteEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void ListNode::deleteEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
+  //this also takes it out of the children list
   removeEdge(edgeId, callback);
 
   ListEdge * edge = getEdge(edgeId);
 
-  if (edgeList == edge)
-  {
-    edgeList = edge->next;
-  }
-  if (children == edge)
-  {
-    children = edge->nextChild;
-  }
-
-  for (auto & e : edges)
+  if (edgeIndex.contains(edge))
   {
-    if (e.second->next == edge)
+    //the index knows the predecessor, so no need to walk the list
+    ListEdge * prev = edgeIndex.prev(edge);
+    if (prev == nullptr)
     {
-      e.second->next = edge->next;
+      edgeList = edge->next;
     }
-    if (e.second->nextChild == edge)
+    else
     {
-      e.second->nextChild = edge->nextChild;
+      prev->next = edge->next;
     }
-  }
 
-  // ListEdge ** remove = &edgeList;
-  // while (*remove != nullptr)
-  // {
-  //   if (*remove == edge)
-  //   {
-  //     *remove = edge->next;
-  //     break;
-  //   }
-  //   remove = &(*remove)->next;
-  // }
+    edgeIndex.remove(edge);
+  }
+  else
+  {
+    //edges waiting on an edge that isn't in the main list yet are only
+    //  linked from each other, and aren't indexed
+    for (auto & e : edges)
+    {
+      if (e.second->next == edge)
+      {
+        e.second->next = edge->next;
+        break;
+      }
+    }
+  }
 
   ContainerNodeImpl<ListEdge>::deleteEdge(edgeId);
 }
 
-void ListNode::initEdge(const EdgeId & edgeId, const NodeId & childId, std::function<void(EdgeEvent &)> callback)
+void ListNode::initEdge(const EdgeId & edgeId, const NodeId & childId, EdgeEventCallback callback)
 {
-  Edge * edge = getEdge(edgeId);
+  ListEdge * edge = getEdge(edgeId);
   edge->childId = childId;
 
+  //the edge may no longer be pending
+  if (edgeIndex.contains(edge))
+  {
+    edgeIndex.update(edge);
+  }
+
   if (edge->effect.isVisible() == false)
   {
     removeEdge(edgeId, callback);
@@ -180,129 +200,260 @@ void ListNode::initEdge(const EdgeId & edgeId, const NodeId & childId, std::func
   }
 }
 
-void ListNode::addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+bool ListNode::compact(const VectorTimestamp & horizon, const std::unordered_set<EdgeId> & pinned)
 {
-  ListEdge * edge = getEdge(edgeId);
-
-  size_t index = 0;
-  size_t actualIndex = 0;
-
-  ListEdge ** insert = &children;
-  ListEdge * currentEdge = edgeList;
-  ListEdge * nextChild = children;
-
-  while (currentEdge != nullptr)
+  bool complete = true;
+
+  //removed edges stay in the edge list since inserts are ordered against
+  //  their siblings; a run of them can go once the edge after it is stable
+  //  (any later insert is newer than all of them), otherwise the last one is
+  //  kept so concurrent inserts after it still end up in the same place
+  ListEdge ** link = &edgeList;
+  while (*link != nullptr)
   {
-    if (currentEdge == edge)
+    if (!isGarbage((*link)->edgeId, *link, horizon, pinned))
     {
-      break;
+      link = &(*link)->next;
+      continue;
     }
 
-    if (currentEdge == nextChild)
+    ListEdge * end = *link;
+    while (end != nullptr && isGarbage(end->edgeId, end, horizon, pinned))
+    {
+      end = end->next;
+    }
+
+    bool keepLast = end != nullptr && !(horizon >= end->edgeId.ts);
+
+    while (*link != end)
     {
-      if (currentEdge->childId.isPending() == false)
+      ListEdge * edge = *link;
+      if (keepLast && edge->next == end)
       {
-        ++index;
+        complete = false;
+        link = &edge->next;
+        break;
       }
-      ++actualIndex;
-      insert = &currentEdge->nextChild;
-      nextChild = currentEdge->nextChild;
-    }
 
-    currentEdge = currentEdge->next;
+      *link = edge->next;
+      edgeIndex.remove(edge);
+      ContainerNodeImpl<ListEdge>::deleteEdge(edge->edgeId);
+    }
   }
 
-  if (currentEdge == nullptr)
+  return complete;
+}
+
+void ListNode::addEdge(const EdgeId & edgeId, EdgeEventCallback callback)
+{
+  ListEdge * edge = getEdge(edgeId);
+
+  if (!edgeIndex.contains(edge))
   {
     //edge is not in the main edge list (dependent item is not yet created)
     return;
   }
 
-  if (currentEdge != nextChild)
+  size_t index;
+  size_t actualIndex;
+  countChildrenBefore(edge, index, actualIndex);
+
+  //an edge that is already a child gets its event again (e.g. once its
+  //  child is no longer pending)
+  if (!edge->isChild)
   {
-    if (currentEdge == *insert)
-    {
-      //edge is already in the children list
-      return;
-    }
+    ListEdge ** insert = (actualIndex == 0) ? &children : &getChildAt(actualIndex - 1)->nextChild;
+    edge->nextChild = *insert;
+    *insert = edge;
 
-    //child is not in the children list
-    currentEdge->nextChild = *insert;
-    *insert = currentEdge;
+    edge->isChild = true;
+    edgeIndex.update(edge);
+  }
+
+  if (!callback)
+  {
+    return;
   }
 
   //generate added event
-  auto event = new NodeAddedEventOrdered();
-  event->edgeId = currentEdge->edgeId;
-  event->childId = currentEdge->childId;
-  event->speculative = currentEdge->childId.isPending();
-  event->index = index;
-  event->actualIndex = actualIndex;
-  callback(*event);
-  delete event;
-
-  //NOTE: leaving this here if it is eventually used to preserve state
-  //  across multiple calls (which is common, and right now it is inefficient)
-  // insert = &currentEdge->nextChild;
-  // if (currentEdge->childId.isPending() == false)
-  // {
-  //   ++index;
-  // }
-  // ++actualIndex;
+  NodeAddedEventOrdered event;
+  event.edgeId = edge->edgeId;
+  event.childId = edge->childId;
+  event.speculative = edge->childId.isPending();
+  event.index = index;
+  event.actualIndex = actualIndex;
+  callback(event);
 }
 
-void ListNode::removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void ListNode::removeEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   ListEdge * edge = getEdge(edgeId);
 
-  size_t index = 0;
-  size_t actualIndex = 0;
+  if (!edge->isChild)
+  {
+    return;
+  }
+
+  size_t index;
+  size_t actualIndex;
+  countChildrenBefore(edge, index, actualIndex);
+
+  if (actualIndex == 0)
+  {
+    children = edge->nextChild;
+  }
+  else
+  {
+    getChildAt(actualIndex - 1)->nextChild = edge->nextChild;
+  }
+
+  edge->nextChild = nullptr;
+  edge->isChild = false;
+  edgeIndex.update(edge);
 
-  ListEdge * prevEdge = nullptr;
-  ListEdge * currentEdge = children;
+  if (!callback)
+  {
+    return;
+  }
 
-  while (currentEdge != nullptr)
+  //generate removed event
+  NodeRemovedEventOrdered event;
+  event.edgeId = edgeId;
+  event.childId = edge->childId;
+  event.speculative = edge->childId.isPending();
+  event.index = index;
+  event.actualIndex = actualIndex;
+  callback(event);
+}
+
+size_t ListNode::getChildCount() const
+{
+  return edgeIndex.getRoot() ? edgeIndex.getRoot()->subtreeChildren : 0;
+}
+
+ListEdge * ListNode::getChildAt(size_t actualIndex) const
+{
+  ListEdge * edge = edgeIndex.getRoot();
+
+  while (edge != nullptr)
   {
-    if (currentEdge == edge)
+    size_t leftChildren = edge->left ? edge->left->subtreeChildren : 0;
+    if (actualIndex < leftChildren)
     {
-      break;
+      edge = edge->left;
+      continue;
     }
 
-    if (currentEdge->childId.isPending() == false)
+    actualIndex -= leftChildren;
+    if (edge->isChild)
     {
-      ++index;
+      if (actualIndex == 0)
+      {
+        return edge;
+      }
+      actualIndex--;
     }
 
-    ++actualIndex;
-    prevEdge = currentEdge;
-    currentEdge = currentEdge->nextChild;
+    edge = edge->right;
   }
 
-  if (currentEdge == nullptr)
+  return nullptr;
+}
+
+size_t ListNode::getNonNullChildCount() const
+{
+  return edgeIndex.getRoot() ? edgeIndex.getRoot()->subtreeNonNullChildren : 0;
+}
+
+ListEdge * ListNode::getNonNullChildAt(size_t index) const
+{
+  ListEdge * edge = edgeIndex.getRoot();
+
+  while (edge != nullptr)
   {
-    return;
+    size_t leftChildren = edge->left ? edge->left->subtreeNonNullChildren : 0;
+    if (index < leftChildren)
+    {
+      edge = edge->left;
+      continue;
+    }
+
+    index -= leftChildren;
+    if (edge->isChild && !edge->childId.isNull())
+    {
+      if (index == 0)
+      {
+        return edge;
+      }
+      index--;
+    }
+
+    edge = edge->right;
   }
 
-  if (prevEdge == nullptr)
+  return nullptr;
+}
+
+bool ListNode::findChildIndex(const ListEdge * edge, size_t & index, size_t & actualIndex) const
+{
+  if (edge == nullptr || !edge->isChild)
   {
-    children = edge->nextChild;
+    return false;
   }
-  else
+
+  countChildrenBefore(edge, index, actualIndex);
+  return true;
+}
+
+void ListNode::countChildrenBefore(const ListEdge * edge, size_t & index, size_t & actualIndex) const
+{
+  //sum of all children to the left of the edge in the tree
+  index = edge->left ? edge->left->subtreeResolvedChildren : 0;
+  actualIndex = edge->left ? edge->left->subtreeChildren : 0;
+
+  while (edge->parent != nullptr)
   {
-    prevEdge->nextChild = edge->nextChild;
+    const ListEdge * parent = edge->parent;
+    if (parent->right == edge)
+    {
+      if (parent->isChild)
+      {
+        index += parent->childId.isPending() ? 0 : 1;
+        actualIndex++;
+      }
+      index += parent->left ? parent->left->subtreeResolvedChildren : 0;
+      actualIndex += parent->left ? parent->left->subtreeChildren : 0;
+    }
+
+    edge = parent;
   }
+}
 
-  edge->nextChild = nullptr;
+uint32_t ListNode::IndexTraits::priority(const ListEdge * edge)
+{
+  return OrderStatisticTree<ListEdge, IndexTraits>::MixPriority(
+    (static_cast<uint64_t>(edge->edgeId.ts.site) << 32) | edge->edgeId.ts.clock, edge->edgeId.child);
+}
 
-  //generate removed event
-  auto event = new NodeRemovedEventOrdered();
-  event->edgeId = edgeId;
-  event->childId = edge->childId;
-  event->speculative = currentEdge->childId.isPending();
-  event->index = index;
-  event->actualIndex = actualIndex;
-  callback(*event);
-  delete event;
+void ListNode::IndexTraits::recompute(ListEdge * edge)
+{
+  edge->subtreeChildren = edge->isChild ? 1 : 0;
+  edge->subtreeResolvedChildren = (edge->isChild && !edge->childId.isPending()) ? 1 : 0;
+  edge->subtreeNonNullChildren = (edge->isChild && !edge->childId.isNull()) ? 1 : 0;
+
+  if (edge->left != nullptr)
+  {
+    edge->subtreeChildren += edge->left->subtreeChildren;
+    edge->subtreeResolvedChildren += edge->left->subtreeResolvedChildren;
+    edge->subtreeNonNullChildren += edge->left->subtreeNonNullChildren;
+  }
+
+  if (edge->right != nullptr)
+  {
+    edge->subtreeChildren += edge->right->subtreeChildren;
+    edge->subtreeResolvedChildren += edge->right->subtreeResolvedChildren;
+    edge->subtreeNonNullChildren += edge->right->subtreeNonNullChildren;
+  }
 }
 
 void ListNode::serialize(IObjectSerializer & serializer) const
@@ -313,7 +464,8 @@ void ListNode::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
-void ListNode::serializeChildren(IObjectSerializer & serializer, bool includePending) const
+void ListNode::serializeChildren(IObjectSerializer & serializer, bool includePending,
+  const SerializeChildCallback & serializeChild) const
 {
   serializer.startArray();
 
@@ -331,6 +483,10 @@ void ListNode::serializeChildren(IObjectSerializer & serializer, bool includePen
     {
       serializer.addPair("speculative", true);
     }
+    else if (serializeChild)
+    {
+      serializeChild(edge->childId);
+    }
     serializer.endObject();
   }
 
@@ -372,4 +528,66 @@ void ListNode::printDbgLists() const
     std::cout << " ";
   }
   std::cout << std::endl;
+}
+
+void ListNode::saveSnapshot(SnapshotWriter & writer) const
+{
+  ContainerNode::saveSnapshot(writer);
+
+  //edges inserted after an edge that hasn't arrived yet are linked to it but
+  //  not to the main list, so every edge's links are written
+  std::unordered_map<const ListEdge *, uint64_t> indices;
+  saveEdges(writer, indices);
+  for (const auto & it : edges)
+  {
+    writer.writeNodeId(it.second->edgeId);
+    writeEdgeRef(writer, indices, it.second->next);
+    writeEdgeRef(writer, indices, it.second->nextChild);
+  }
+
+  writeEdgeRef(writer, indices, edgeList);
+  writeEdgeRef(writer, indices, children);
+}
+
+void ListNode::loadSnapshot(SnapshotReader & reader)
+{
+  ContainerNode::loadSnapshot(reader);
+
+  auto table = loadEdges(reader);
+  for (size_t i = 1; i < table.size(); i++)
+  {
+    table[i]->edgeId = reader.readNodeId();
+    table[i]->next = readEdgeRef(reader, table);
+    table[i]->nextChild = readEdgeRef(reader, table);
+  }
+
+  edgeList = readEdgeRef(reader, table);
+  children = readEdgeRef(reader, table);
+
+  //rebuild the index over the edge list (bounded in case the links form a
+  //  cycle)
+  size_t count = 0;
+  for (ListEdge * edge = children; edge != nullptr; edge = edge->nextChild)
+  {
+    if (++count >= table.size())
+    {
+      reader.setError();
+      return;
+    }
+    edge->isChild = true;
+  }
+
+  count = 0;
+  ListEdge * prev = nullptr;
+  for (ListEdge * edge = edgeList; edge != nullptr; edge = edge->next)
+  {
+    if (++count >= table.size())
+    {
+      reader.setError();
+      return;
+    }
+
+    edgeIndex.insertAfter(prev, edge);
+    prev = edge;
+  }
 }
\ No newline at end of file
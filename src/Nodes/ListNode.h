@@ -6,6 +6,7 @@
 #include "Attribute.h"
 #include "InheritanceContext.h"
 #include "IObjectSerializer.h"
+#include "OrderStatisticTree.h"
 #include <unordered_map>
 #include <algorithm>
 
@@ -16,26 +17,69 @@ public:
   ListEdge * next = nullptr;
   ListEdge * nextChild = nullptr;
 
+  //order statistic index (only valid while the edge is in the main edge
+  //  list), counting the edges below it that are in the children list, those
+  //  that aren't pending, and those that aren't null
+  ListEdge * parent = nullptr;
+  ListEdge * left = nullptr;
+  ListEdge * right = nullptr;
+  uint32_t priority = 0;
+  bool isChild = false;
+  size_t subtreeChildren = 0;
+  size_t subtreeResolvedChildren = 0;
+  size_t subtreeNonNullChildren = 0;
+
   ListEdge() : next(nullptr), nextChild(nullptr) {}
 };
 
+//Edges are kept in a linked list (next) in insertion order, and the visible
+//  ones also in the children list (nextChild); positions in the children list
+//  are found with an order statistic tree (treap) over the edge list, so
+//  events, index lookups and edge removal don't walk the lists
+
 class ListNode : public ContainerNodeImpl<ListEdge>
 {
 public:
-  ListEdge * createEdge(const EdgeId & edgeId, const NodeId & childId, const EdgeId & prevEdgeId, const AttributeMap * attributes, std::function<void(EdgeEvent &)> callback);
-  void updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, std::function<void(EdgeEvent &)> callback);
-  void deleteEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-  void initEdge(const EdgeId & edgeId, const NodeId & childId, std::function<void(EdgeEvent &)> callback);
+  ListEdge * createEdge(const EdgeId & edgeId, const NodeId & childId, const EdgeId & prevEdgeId, const AttributeMap * attributes, EdgeEventCallback callback);
+  void updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, EdgeEventCallback callback);
+  void deleteEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void initEdge(const EdgeId & edgeId, const NodeId & childId, EdgeEventCallback callback);
+  bool compact(const VectorTimestamp & horizon, const std::unordered_set<EdgeId> & pinned);
 
   void serialize(IObjectSerializer & serializer) const;
-  void serializeChildren(IObjectSerializer & serializer, bool includePending) const;
+  void serializeChildren(IObjectSerializer & serializer, bool includePending,
+    const SerializeChildCallback & serializeChild = nullptr) const;
+  void saveSnapshot(SnapshotWriter & writer) const;
+  void loadSnapshot(SnapshotReader & reader);
+
+  //number of edges in the children list (including pending children)
+  size_t getChildCount() const;
+  //the child at a position in the children list, or nullptr past the end
+  ListEdge * getChildAt(size_t actualIndex) const;
+  //number of children that aren't null
+  size_t getNonNullChildCount() const;
+  //the child at a position counting only children that aren't null, or
+  //  nullptr past the end
+  ListEdge * getNonNullChildAt(size_t index) const;
+  //the position of an edge in the children list, both without (index) and
+  //  with (actualIndex) pending children; returns false if it isn't a child
+  bool findChildIndex(const ListEdge * edge, size_t & index, size_t & actualIndex) const;
 
 // private:
   ListEdge * edgeList = nullptr;
   ListEdge * children = nullptr;
+  struct IndexTraits
+  {
+    static uint32_t priority(const ListEdge * edge);
+    static void recompute(ListEdge * edge);
+  };
+
+  OrderStatisticTree<ListEdge, IndexTraits> edgeIndex;
+
+  void addEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void removeEdge(const EdgeId & edgeId, EdgeEventCallback callback);
 
-  void addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-  void removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
+  void countChildrenBefore(const ListEdge * edge, size_t & index, size_t & actualIndex) const;
 
   void printDbgLists() const;
 };
\ No newline at end of file
@@ -1,7 +1,8 @@
 #include "MapNode.h"
+#include "Snapshot.h"
 
 MapEdge * MapNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
-  const AttributeMap * attributes, std::function<void(EdgeEvent &)> callback)
+  const AttributeMap * attributes, EdgeEventCallback callback)
 {
   if (attributes == nullptr)
   {
@@ -29,7 +30,7 @@ MapEdge * MapNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
   return edge;
 }
 
-void MapNode::updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, std::function<void(EdgeEvent &)> callback)
+void MapNode::updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, EdgeEventCallback callback)
 {
   Edge * edge = getEdge(edgeId);
 
@@ -61,13 +62,13 @@ void MapNode::updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitiali
   }
 }
 
-void MapNode::deleteEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void MapNode::deleteEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   removeEdge(edgeId, callback);
   ContainerNodeImpl<MapEdge>::deleteEdge(edgeId);
 }
 
-void MapNode::initEdge(const EdgeId & edgeId, const NodeId & childId, std::function<void(EdgeEvent &)> callback)
+void MapNode::initEdge(const EdgeId & edgeId, const NodeId & childId, EdgeEventCallback callback)
 {
   Edge * edge = getEdge(edgeId);
   edge->childId = childId;
@@ -82,7 +83,7 @@ void MapNode::initEdge(const EdgeId & edgeId, const NodeId & childId, std::funct
   }
 }
 
-void MapNode::addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void MapNode::addEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   MapEdge * edge = getExistingEdge(edgeId);
 
@@ -134,7 +135,7 @@ void MapNode::addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> ca
     generateAddedEvent = isFirstVisibleItem;
   }
 
-  if (generateAddedEvent)
+  if (generateAddedEvent && callback)
   {
     if (it != list.end() && *it == edge)
     {
@@ -174,44 +175,41 @@ void MapNode::addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> ca
     list.insert_after(prevIt, edge);
   }
 
-  if (generateAddedEvent)
+  if (generateAddedEvent && callback)
   {
     if (removedSpeculativeEdge != nullptr)
     {
-      auto event = new NodeRemovedEventMapped();
-      event->edgeId = removedSpeculativeEdge->edgeId;
-      event->childId = removedSpeculativeEdge->childId;
+      NodeRemovedEventMapped event;
+      event.edgeId = removedSpeculativeEdge->edgeId;
+      event.childId = removedSpeculativeEdge->childId;
       //NOTE: alternatively this could specify whether the new incoming edge is
       //  speculative, but instead for now it indicates whether the existing
       //  edge was speculative, which is probably more useful to clients
-      event->key = edge->key;
-      event->speculative = true;
-      callback(*event);
-      delete event;
+      event.key = edge->key;
+      event.speculative = true;
+      callback(event);
     }
 
     if (removedEdge != nullptr)
     {
-      auto event = new NodeRemovedEventMapped();
-      event->edgeId = removedEdge->edgeId;
-      event->childId = removedEdge->childId;
-      event->key = edge->key;
-      event->speculative = isEdgeSpeculative;
-      callback(*event);
-      delete event;
+      NodeRemovedEventMapped event;
+      event.edgeId = removedEdge->edgeId;
+      event.childId = removedEdge->childId;
+      event.key = edge->key;
+      event.speculative = isEdgeSpeculative;
+      callback(event);
     }
 
-    auto event = new NodeAddedEventMapped();
-    event->edgeId = edgeId;
-    event->childId = edge->childId;
-    event->speculative = isEdgeSpeculative;
-    event->key = edge->key;
-    callback(*event);
-    delete event;
+    NodeAddedEventMapped event;
+    event.edgeId = edgeId;
+    event.childId = edge->childId;
+    event.speculative = isEdgeSpeculative;
+    event.key = edge->key;
+    callback(event);
   }
 }
 
-void MapNode::removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void MapNode::removeEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   MapEdge * edge = getExistingEdge(edgeId);
 
@@ -272,7 +270,7 @@ void MapNode::removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)>
     generateRemovedEvent = isFirstVisibleItem;
   }
 
-  if (generateRemovedEvent && it != list.end())
+  if (generateRemovedEvent && callback && it != list.end())
   {
     it++;
 
@@ -312,39 +310,36 @@ void MapNode::removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)>
     children.erase(mapIt);
   }
 
-  if (generateRemovedEvent)
+  if (generateRemovedEvent && callback)
   {
-    auto event = new NodeRemovedEventMapped();
-    event->edgeId = edgeId;
-    event->childId = edge->childId;
-    event->speculative = isEdgeSpeculative;
-    event->key = edge->key;
-    callback(*event);
-    delete event;
+    NodeRemovedEventMapped event;
+    event.edgeId = edgeId;
+    event.childId = edge->childId;
+    event.speculative = isEdgeSpeculative;
+    event.key = edge->key;
+    callback(event);
 
     if (addedSpeculativeEdge != nullptr)
     {
-      auto event = new NodeAddedEventMapped();
-      event->edgeId = addedSpeculativeEdge->edgeId;
-      event->childId = addedSpeculativeEdge->childId;
+      NodeAddedEventMapped event;
+      event.edgeId = addedSpeculativeEdge->edgeId;
+      event.childId = addedSpeculativeEdge->childId;
       //NOTE: alternatively this could specify whether the deleted edge is
       //  speculative, but instead for now it indicates whether the existing
       //  edge was speculative, which is probably more useful to clients
-      event->speculative = true;
-      event->key = edge->key;
-      callback(*event);
-      delete event;
+      event.speculative = true;
+      event.key = edge->key;
+      callback(event);
     }
 
     if (addedEdge != nullptr)
     {
-      auto event = new NodeAddedEventMapped();
-      event->edgeId = addedEdge->edgeId;
-      event->childId = addedEdge->childId;
-      event->key = edge->key;
-      event->speculative = isEdgeSpeculative;
-      callback(*event);
-      delete event;
+      NodeAddedEventMapped event;
+      event.edgeId = addedEdge->edgeId;
+      event.childId = addedEdge->childId;
+      event.key = edge->key;
+      event.speculative = isEdgeSpeculative;
+      callback(event);
     }
   }
 }
@@ -357,7 +352,8 @@ void MapNode::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
-void MapNode::serializeChildren(IObjectSerializer & serializer, bool includePending) const
+void MapNode::serializeChildren(IObjectSerializer & serializer, bool includePending,
+  const SerializeChildCallback & serializeChild) const
 {
   serializer.startArray();
 
@@ -379,6 +375,10 @@ void MapNode::serializeChildren(IObjectSerializer & serializer, bool includePend
       {
         serializer.addPair("speculative", true);
       }
+      else if (serializeChild)
+      {
+        serializeChild(edge->childId);
+      }
       serializer.endObject();
 
       if (!pending)
@@ -389,4 +389,60 @@ void MapNode::serializeChildren(IObjectSerializer & serializer, bool includePend
   }
 
   serializer.endArray();
+}
+
+void MapNode::saveSnapshot(SnapshotWriter & writer) const
+{
+  ContainerNode::saveSnapshot(writer);
+
+  std::unordered_map<const MapEdge *, uint64_t> indices;
+  saveEdges(writer, indices);
+  for (const auto & it : edges)
+  {
+    writer.writeNodeId(it.second->edgeId);
+    writer.writeString(it.second->key);
+  }
+
+  writer.writeUInt(children.size());
+  for (const auto & it : children)
+  {
+    writer.writeString(it.first);
+    writer.writeUInt(std::distance(it.second.begin(), it.second.end()));
+    for (const MapEdge * edge : it.second)
+    {
+      writeEdgeRef(writer, indices, edge);
+    }
+  }
+}
+
+void MapNode::loadSnapshot(SnapshotReader & reader)
+{
+  ContainerNode::loadSnapshot(reader);
+
+  auto table = loadEdges(reader);
+  for (size_t i = 1; i < table.size(); i++)
+  {
+    table[i]->edgeId = reader.readNodeId();
+    table[i]->key = reader.readString();
+  }
+
+  size_t count = reader.readCount();
+  for (size_t i = 0; i < count && !reader.hasError(); i++)
+  {
+    auto & list = children[std::string(reader.readString())];
+
+    size_t length = reader.readCount();
+    auto insert = list.before_begin();
+    for (size_t j = 0; j < length && !reader.hasError(); j++)
+    {
+      MapEdge * edge = readEdgeRef(reader, table);
+      if (edge == nullptr)
+      {
+        reader.setError();
+        break;
+      }
+
+      insert = list.insert_after(insert, edge);
+    }
+  }
 }
\ No newline at end of file
@@ -18,17 +18,20 @@ public:
 class MapNode : public ContainerNodeImpl<MapEdge>
 {
 public:
-  MapEdge * createEdge(const EdgeId & edgeId, const NodeId & childId, const AttributeMap * attributes, std::function<void(EdgeEvent &)> callback);
-  void updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, std::function<void(EdgeEvent &)> callback);
-  void deleteEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-  void initEdge(const EdgeId & edgeId, const NodeId & childId, std::function<void(EdgeEvent &)> callback);
+  MapEdge * createEdge(const EdgeId & edgeId, const NodeId & childId, const AttributeMap * attributes, EdgeEventCallback callback);
+  void updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, EdgeEventCallback callback);
+  void deleteEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void initEdge(const EdgeId & edgeId, const NodeId & childId, EdgeEventCallback callback);
 
   void serialize(IObjectSerializer & serializer) const;
-  void serializeChildren(IObjectSerializer & serializer, bool includePending) const;
+  void serializeChildren(IObjectSerializer & serializer, bool includePending,
+    const SerializeChildCallback & serializeChild = nullptr) const;
+  void saveSnapshot(SnapshotWriter & writer) const;
+  void loadSnapshot(SnapshotReader & reader);
 
 // private:
   std::unordered_map<std::string, std::forward_list<MapEdge *>> children;
 
-  void addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-  void removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
+  void addEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void removeEdge(const EdgeId & edgeId, EdgeEventCallback callback);
 };
\ No newline at end of file
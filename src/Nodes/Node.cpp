@@ -1,4 +1,5 @@
 #include "Node.h"
+#include "Snapshot.h"
 
 bool Node::isAbstractType() const
 {
@@ -18,6 +19,7 @@ void Node::addType(NodeType newType)
   }
 
   type.push_back(newType);
+  primitiveType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(newType);
 }
 
 NodeType Node::getType() const
@@ -72,4 +74,31 @@ void Node::serialize(IObjectSerializer & serializer) const
   serializer.endArray();
 
   serializer.endObject();
+}
+
+void Node::saveSnapshot(SnapshotWriter & writer) const
+{
+  writer.writeUInt(type.size());
+  for (const auto & it : type)
+  {
+    writer.writeNodeType(it);
+  }
+
+  writer.writeUInt(createdByRootOffset);
+  writer.writeEffect(effect);
+}
+
+void Node::loadSnapshot(SnapshotReader & reader)
+{
+  type.clear();
+  primitiveType = PrimitiveNodeTypes::PrimitiveType::Abstract;
+
+  size_t count = reader.readCount();
+  for (size_t i = 0; i < count; i++)
+  {
+    addType(reader.readNodeType());
+  }
+
+  createdByRootOffset = static_cast<uint32_t>(reader.readUInt());
+  effect = reader.readEffect();
 }
\ No newline at end of file
@@ -9,6 +9,9 @@
 #include <vector>
 #include <algorithm>
 
+class SnapshotWriter;
+class SnapshotReader;
+
 class Node
 {
 public:
@@ -22,6 +25,13 @@ public:
   NodeType getType() const;
   NodeType getBaseType() const;
   bool isDerivedFromType(NodeType type) const;
+  //the primitive type of the base type, kept up to date by addType
+  PrimitiveNodeTypes::PrimitiveType getPrimitiveType() const { return primitiveType; }
 
   void serialize(IObjectSerializer & serializer) const;
+  void saveSnapshot(SnapshotWriter & writer) const;
+  void loadSnapshot(SnapshotReader & reader);
+
+private:
+  PrimitiveNodeTypes::PrimitiveType primitiveType = PrimitiveNodeTypes::PrimitiveType::Abstract;
 };
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include "Node.h"
+#include "SetNode.h"
+#include "ListNode.h"
+#include "MapNode.h"
+#include "ReferenceNode.h"
+#include "OrderedFloat64MapNode.h"
+#include "ValueNode.h"
+#include "BlockValueNode.h"
+#include "SlabAllocator.h"
+#include <new>
+#include <tuple>
+
+//Allocates the nodes of one class out of shared slabs so nodes are packed
+//  together instead of each being a separate heap allocation
+template <class T>
+using NodePool = ObjectPool<T>;
+
+//A pool for each node class
+class NodeAllocator
+{
+public:
+  template <class T>
+  T * create()
+  {
+    return std::get<NodePool<T>>(pools).create();
+  }
+
+  template <class T>
+  void destroy(T * node)
+  {
+    std::get<NodePool<T>>(pools).destroy(node);
+  }
+
+private:
+  std::tuple<
+    NodePool<Node>,
+    NodePool<SetNode>,
+    NodePool<ListNode>,
+    NodePool<MapNode>,
+    NodePool<ReferenceNode>,
+    NodePool<OrderedFloat64MapNode>,
+    NodePool<ValueNode<int32_t>>,
+    NodePool<ValueNode<int64_t>>,
+    NodePool<ValueNode<float>>,
+    NodePool<ValueNode<double>>,
+    NodePool<ValueNode<int8_t>>,
+    NodePool<ValueNode<bool>>,
+    NodePool<BlockValueNode<char>>
+  > pools;
+};
\ No newline at end of file
@@ -1,8 +1,9 @@
 #include "OrderedFloat64MapNode.h"
 #include "Json.h"
+#include "Snapshot.h"
 
 OrderedFloat64MapEdge * OrderedFloat64MapNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
-  const AttributeMap * attributes, std::function<void(EdgeEvent &)> callback)
+  const AttributeMap * attributes, EdgeEventCallback callback)
 {
   if (attributes == nullptr)
   {
@@ -30,7 +31,7 @@ OrderedFloat64MapEdge * OrderedFloat64MapNode::createEdge(const EdgeId & edgeId,
   return edge;
 }
 
-void OrderedFloat64MapNode::updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, std::function<void(EdgeEvent &)> callback)
+void OrderedFloat64MapNode::updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, EdgeEventCallback callback)
 {
   Edge * edge = getEdge(edgeId);
 
@@ -62,13 +63,13 @@ void OrderedFloat64MapNode::updateEdgeEffect(const EdgeId & edgeId, int delta, b
   }
 }
 
-void OrderedFloat64MapNode::deleteEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void OrderedFloat64MapNode::deleteEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   removeEdge(edgeId, callback);
   ContainerNodeImpl<OrderedFloat64MapEdge>::deleteEdge(edgeId);
 }
 
-void OrderedFloat64MapNode::initEdge(const EdgeId & edgeId, const NodeId & childId, std::function<void(EdgeEvent &)> callback)
+void OrderedFloat64MapNode::initEdge(const EdgeId & edgeId, const NodeId & childId, EdgeEventCallback callback)
 {
   Edge * edge = getEdge(edgeId);
   edge->childId = childId;
@@ -83,7 +84,7 @@ void OrderedFloat64MapNode::initEdge(const EdgeId & edgeId, const NodeId & child
   }
 }
 
-void OrderedFloat64MapNode::addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void OrderedFloat64MapNode::addEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   OrderedFloat64MapEdge * edge = getExistingEdge(edgeId);
 
@@ -107,31 +108,29 @@ void OrderedFloat64MapNode::addEdge(const EdgeId & edgeId, std::function<void(Ed
     list.insert_after(prevIt, edgeId);
   }
 
-  if (prevIt == list.before_begin())
+  if (prevIt == list.before_begin() && callback)
   {
     if (it != list.end() && *it != edgeId)
     {
       OrderedFloat64MapEdge * oldEdge = getExistingEdge(*it);
-      auto event = new NodeRemovedEventMapped();
-      event->edgeId = *it;
-      event->childId = oldEdge->childId;
-      event->speculative = oldEdge->childId.isPending();
-      event->key = DoubleToString(oldEdge->key);
-      callback(*event);
-      delete event;
+      NodeRemovedEventMapped event;
+      event.edgeId = *it;
+      event.childId = oldEdge->childId;
+      event.speculative = oldEdge->childId.isPending();
+      event.key = DoubleToString(oldEdge->key);
+      callback(event);
     }
 
-    auto event = new NodeAddedEventMapped();
-    event->edgeId = edgeId;
-    event->childId = edge->childId;
-    event->speculative = edge->childId.isPending();
-    event->key = DoubleToString(edge->key);
-    callback(*event);
-    delete event;
+    NodeAddedEventMapped event;
+    event.edgeId = edgeId;
+    event.childId = edge->childId;
+    event.speculative = edge->childId.isPending();
+    event.key = DoubleToString(edge->key);
+    callback(event);
   }
 }
 
-void OrderedFloat64MapNode::removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void OrderedFloat64MapNode::removeEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   OrderedFloat64MapEdge * edge = getExistingEdge(edgeId);
 
@@ -166,26 +165,24 @@ void OrderedFloat64MapNode::removeEdge(const EdgeId & edgeId, std::function<void
     children.erase(mapIt);
   }
 
-  if (generateRemovedEvent)
+  if (generateRemovedEvent && callback)
   {
-    auto event = new NodeRemovedEventMapped();
-    event->edgeId = edgeId;
-    event->childId = edge->childId;
-    event->speculative = edge->childId.isPending();
-    event->key = DoubleToString(edge->key);
-    callback(*event);
-    delete event;
+    NodeRemovedEventMapped event;
+    event.edgeId = edgeId;
+    event.childId = edge->childId;
+    event.speculative = edge->childId.isPending();
+    event.key = DoubleToString(edge->key);
+    callback(event);
 
     if (generateAddedEvent)
     {
       OrderedFloat64MapEdge * newEdge = getExistingEdge(*it);
-      auto event = new NodeAddedEventMapped();
-      event->edgeId = *it;
-      event->childId = newEdge->childId;
-      event->speculative = newEdge->childId.isPending();
-      event->key = DoubleToString(newEdge->key);
-      callback(*event);
-      delete event;
+      NodeAddedEventMapped event;
+      event.edgeId = *it;
+      event.childId = newEdge->childId;
+      event.speculative = newEdge->childId.isPending();
+      event.key = DoubleToString(newEdge->key);
+      callback(event);
     }
   }
 }
@@ -199,7 +196,8 @@ void OrderedFloat64MapNode::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
-void OrderedFloat64MapNode::serializeChildren(IObjectSerializer & serializer, bool includePending) const
+void OrderedFloat64MapNode::serializeChildren(IObjectSerializer & serializer, bool includePending,
+  const SerializeChildCallback & serializeChild) const
 {
   serializer.startArray();
 
@@ -221,8 +219,59 @@ void OrderedFloat64MapNode::serializeChildren(IObjectSerializer & serializer, bo
     {
       serializer.addPair("speculative", true);
     }
+    else if (serializeChild)
+    {
+      serializeChild(edge->childId);
+    }
     serializer.endObject();
   }
 
   serializer.endArray();
+}
+
+void OrderedFloat64MapNode::saveSnapshot(SnapshotWriter & writer) const
+{
+  ContainerNode::saveSnapshot(writer);
+
+  std::unordered_map<const OrderedFloat64MapEdge *, uint64_t> indices;
+  saveEdges(writer, indices);
+  for (const auto & it : edges)
+  {
+    writer.writeValue(it.second->key);
+  }
+
+  writer.writeUInt(children.size());
+  for (const auto & it : children)
+  {
+    writer.writeValue(it.first);
+    writer.writeUInt(std::distance(it.second.begin(), it.second.end()));
+    for (const EdgeId & edgeId : it.second)
+    {
+      writer.writeNodeId(edgeId);
+    }
+  }
+}
+
+void OrderedFloat64MapNode::loadSnapshot(SnapshotReader & reader)
+{
+  ContainerNode::loadSnapshot(reader);
+
+  auto table = loadEdges(reader);
+  for (size_t i = 1; i < table.size(); i++)
+  {
+    table[i]->key = reader.readValue<double>();
+  }
+
+  size_t count = reader.readCount();
+  for (size_t i = 0; i < count && !reader.hasError(); i++)
+  {
+    auto & list = children[reader.readValue<double>()];
+
+    size_t length = reader.readCount();
+    auto insert = list.before_begin();
+    for (size_t j = 0; j < length && !reader.hasError(); j++)
+    {
+      insert = list.insert_after(insert, reader.readNodeId());
+    }
+  }
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include "ReferenceNode.h"
+#include "Snapshot.h"
+#include "VectorTimestamp.h"
 
 ReferenceEdge * ReferenceNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
-  const AttributeMap * attributes, std::function<void(EdgeEvent &)> callback)
+  const AttributeMap * attributes, EdgeEventCallback callback)
 {
   ReferenceEdge * edge = getEdge(edgeId);
   edge->edgeId = edgeId;
@@ -18,7 +20,7 @@ ReferenceEdge * ReferenceNode::createEdge(const EdgeId & edgeId, const NodeId &
 }
 
 void ReferenceNode::updateEdgeEffect(const EdgeId & edgeId, int delta,
-  bool deinitialize, std::function<void(EdgeEvent &)> callback)
+  bool deinitialize, EdgeEventCallback callback)
 {
   Edge * edge = getEdge(edgeId);
 
@@ -50,36 +52,41 @@ void ReferenceNode::updateEdgeEffect(const EdgeId & edgeId, int delta,
   }
 }
 
-void ReferenceNode::deleteEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void ReferenceNode::deleteEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
-  removeEdge(edgeId, callback);
+  ReferenceEdge * edge = getExistingEdge(edgeId);
+
+  if (edge == nullptr)
+  {
+    return;
+  }
+
+  if (edge->effect.isVisible())
+  {
+    removeEdge(edgeId, callback);
+  }
+
   ContainerNodeImpl<ReferenceEdge>::deleteEdge(edgeId);
 }
 
-void ReferenceNode::initEdge(const EdgeId & edgeId, const NodeId & childId, std::function<void(EdgeEvent &)> callback)
+void ReferenceNode::initEdge(const EdgeId & edgeId, const NodeId & childId, EdgeEventCallback callback)
 {
   Edge * edge = getEdge(edgeId);
   edge->childId = childId;
 
-  if (edge->effect.isVisible() == false)
-  {
-    removeEdge(edgeId, callback);
-  }
-  else
+  //removed edges are not candidates for the value, so there is nothing to remove
+  if (edge->effect.isVisible())
   {
     addEdge(edgeId, callback);
   }
 }
 
-void ReferenceNode::addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void ReferenceNode::addEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   ReferenceEdge * edge = getExistingEdge(edgeId);
 
   bool isEdgeSpeculative = edge->childId.isPending();
 
-  ReferenceEdge ** insert = nullptr;
-  ReferenceEdge ** iter = &children;
-
   bool isFirstVisibleItem = true;
   bool isFirstVisibleSpeculativeItem = true;
 
@@ -88,31 +95,24 @@ void ReferenceNode::addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent
   ReferenceEdge * removedEdge = nullptr;
   ReferenceEdge * removedSpeculativeEdge = nullptr;
 
-  //find insert location
-  while (*iter != nullptr)
+  linkEdge(edge);
+
+  if (!callback)
   {
-    if ((*iter)->edgeId < edgeId || *iter == edge)
-    {
-      break;
-    }
-    else if (isFirstVisibleItem)
-    {
-      if ((*iter)->effect.isVisible())
-      {
-        if ((*iter)->childId.isPending() == false)
-        {
-          isFirstVisibleItem = false;
-        }
+    return;
+  }
 
-        isFirstVisibleSpeculativeItem = false;
-      }
+  //check the newer edges
+  for (ReferenceEdge * iter = edge->prev; iter != nullptr && isFirstVisibleItem; iter = iter->prev)
+  {
+    if (iter->childId.isPending() == false)
+    {
+      isFirstVisibleItem = false;
     }
 
-    iter = &(*iter)->next;
+    isFirstVisibleSpeculativeItem = false;
   }
 
-  insert = iter;
-
   if (isEdgeSpeculative)
   {
     generateAddedEvent = isFirstVisibleSpeculativeItem;
@@ -124,98 +124,76 @@ void ReferenceNode::addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent
 
   if (generateAddedEvent)
   {
-    if (*iter == edge)
-    {
-      iter = &(*iter)->next;
-    }
-
     //find the edge(s) to generate removed events for
     //new edge is speculative: remove pending speculative edge only
     //new edge is not speculative: remove pending speculative edge and
     //  existing non-speculative edge
-    while (*iter != nullptr)
+    for (ReferenceEdge * iter = edge->next; iter != nullptr; iter = iter->next)
     {
-      if ((*iter)->effect.isVisible())
+      if (iter->childId.isPending() == false)
       {
-        if ((*iter)->childId.isPending() == false)
-        {
-          removedEdge = *iter;
-          break;
-        }
+        removedEdge = iter;
+        break;
+      }
 
-        if (removedSpeculativeEdge == nullptr)
+      if (removedSpeculativeEdge == nullptr)
+      {
+        removedSpeculativeEdge = iter;
+        if (isEdgeSpeculative)
         {
-          removedSpeculativeEdge = *iter;
-          if (isEdgeSpeculative)
-          {
-            break;
-          }
+          break;
         }
       }
-
-      iter = &(*iter)->next;
     }
   }
 
-  if (*insert != edge)
-  {
-    edge->next = *insert;
-    *insert = edge;
-  }
-
   if (generateAddedEvent)
   {
     if (removedSpeculativeEdge != nullptr)
     {
-      auto event = new NodeRemovedEvent();
-      event->edgeId = removedSpeculativeEdge->edgeId;
-      event->childId = removedSpeculativeEdge->childId;
+      NodeRemovedEvent event;
+      event.edgeId = removedSpeculativeEdge->edgeId;
+      event.childId = removedSpeculativeEdge->childId;
       //NOTE: alternatively this could specify whether the new incoming edge is
       //  speculative, but instead for now it indicates whether the existing
       //  edge was speculative, which is probably more useful to clients
-      event->speculative = true;
-      callback(*event);
-      delete event;
+      event.speculative = true;
+      callback(event);
     }
 
     //always generate at least one removed event when the value changes, since
     //  references are always considered to have some value (even if it is null)
     if (removedSpeculativeEdge == nullptr || isEdgeSpeculative == false)
     {
-      auto event = new NodeRemovedEvent();
+      NodeRemovedEvent event;
       if (removedEdge != nullptr)
       {
-        event->edgeId = removedEdge->edgeId;
-        event->childId = removedEdge->childId;
+        event.edgeId = removedEdge->edgeId;
+        event.childId = removedEdge->childId;
       }
       else
       {
-        event->edgeId = EdgeId::Null;
-        event->childId = EdgeId::Null;
+        event.edgeId = EdgeId::Null;
+        event.childId = EdgeId::Null;
       }
-      event->speculative = isEdgeSpeculative;
-      callback(*event);
-      delete event;
+      event.speculative = isEdgeSpeculative;
+      callback(event);
     }
 
-    auto event = new NodeAddedEvent();
-    event->edgeId = edgeId;
-    event->childId = edge->childId;
-    event->speculative = isEdgeSpeculative;
-    callback(*event);
-    delete event;
+    NodeAddedEvent event;
+    event.edgeId = edgeId;
+    event.childId = edge->childId;
+    event.speculative = isEdgeSpeculative;
+    callback(event);
   }
 }
 
-void ReferenceNode::removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void ReferenceNode::removeEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   ReferenceEdge * edge = getExistingEdge(edgeId);
 
   bool isEdgeSpeculative = edge->childId.isPending();
 
-  ReferenceEdge ** remove = nullptr;
-  ReferenceEdge ** iter = &children;
-
   bool isFirstVisibleItem = true;
   bool isFirstVisibleSpeculativeItem = true;
 
@@ -224,34 +202,22 @@ void ReferenceNode::removeEdge(const EdgeId & edgeId, std::function<void(EdgeEve
   ReferenceEdge * addedEdge = nullptr;
   ReferenceEdge * addedSpeculativeEdge = nullptr;
 
-  //find remove location
-  while (*iter != nullptr)
+  //the events come from the edge's neighbours, so it is unlinked after
+  if (!callback)
   {
-    if (*iter == edge)
-    {
-      break;
-    }
-    else if (isFirstVisibleItem)
-    {
-      if ((*iter)->effect.isVisible())
-      {
-        if ((*iter)->childId.isPending() == false)
-        {
-          isFirstVisibleItem = false;
-        }
-
-        isFirstVisibleSpeculativeItem = false;
-      }
-    }
-
-    iter = &(*iter)->next;
+    unlinkEdge(edge);
+    return;
   }
 
-  remove = iter;
-
-  if (*remove != edge)
+  //check the newer edges
+  for (ReferenceEdge * iter = edge->prev; iter != nullptr && isFirstVisibleItem; iter = iter->prev)
   {
-    return;
+    if (iter->childId.isPending() == false)
+    {
+      isFirstVisibleItem = false;
+    }
+
+    isFirstVisibleSpeculativeItem = false;
   }
 
   if (isEdgeSpeculative)
@@ -263,85 +229,153 @@ void ReferenceNode::removeEdge(const EdgeId & edgeId, std::function<void(EdgeEve
     generateRemovedEvent = isFirstVisibleItem;
   }
 
-  if (generateRemovedEvent && *iter != nullptr)
+  if (generateRemovedEvent)
   {
-    iter = &(*iter)->next;
-
     //find the edge(s) to generate added events for
     //deleted edge is speculative: re-add newest visible edge only
     //deleted edge is not speculative: re-add newest visible speculative edge
     //  and newest visible non-speculative edge
-    while (*iter != nullptr)
+    for (ReferenceEdge * iter = edge->next; iter != nullptr; iter = iter->next)
     {
-      if ((*iter)->effect.isVisible())
+      if (iter->childId.isPending() == false)
       {
-        if ((*iter)->childId.isPending() == false)
-        {
-          addedEdge = *iter;
-          break;
-        }
+        addedEdge = iter;
+        break;
+      }
 
-        if (addedSpeculativeEdge == nullptr)
+      if (addedSpeculativeEdge == nullptr)
+      {
+        addedSpeculativeEdge = iter;
+        if (isEdgeSpeculative)
         {
-          addedSpeculativeEdge = *iter;
-          if (isEdgeSpeculative)
-          {
-            break;
-          }
+          break;
         }
       }
-
-      iter = &(*iter)->next;
     }
   }
 
-  *remove = edge->next;
-  edge->next = nullptr;
-
   if (generateRemovedEvent)
   {
-    auto event = new NodeRemovedEvent();
-    event->edgeId = edgeId;
-    event->childId = edge->childId;
-    event->speculative = isEdgeSpeculative;
-    callback(*event);
-    delete event;
+    NodeRemovedEvent event;
+    event.edgeId = edgeId;
+    event.childId = edge->childId;
+    event.speculative = isEdgeSpeculative;
+    callback(event);
 
     if (addedSpeculativeEdge != nullptr)
     {
-      auto event = new NodeAddedEvent();
-      event->edgeId = addedSpeculativeEdge->edgeId;
-      event->childId = addedSpeculativeEdge->childId;
+      NodeAddedEvent event;
+      event.edgeId = addedSpeculativeEdge->edgeId;
+      event.childId = addedSpeculativeEdge->childId;
       //NOTE: alternatively this could specify whether the deleted edge is
       //  speculative, but instead for now it indicates whether the existing
       //  edge was speculative, which is probably more useful to clients
-      event->speculative = true;
-      callback(*event);
-      delete event;
+      event.speculative = true;
+      callback(event);
     }
 
     //always generate at least one added event when the value changes, since
     //  references are always considered to have some value (even if it is null)
     if (addedSpeculativeEdge == nullptr || isEdgeSpeculative == false)
     {
-      auto event = new NodeAddedEvent();
+      NodeAddedEvent event;
       if (addedEdge != nullptr)
       {
-        event->edgeId = addedEdge->edgeId;
-        event->childId = addedEdge->childId;
+        event.edgeId = addedEdge->edgeId;
+        event.childId = addedEdge->childId;
       }
       else
       {
-        event->edgeId = EdgeId::Null;
-        event->childId = EdgeId::Null;
+        event.edgeId = EdgeId::Null;
+        event.childId = EdgeId::Null;
       }
-      event->speculative = isEdgeSpeculative;
-      callback(*event);
-      delete event;
+      event.speculative = isEdgeSpeculative;
+      callback(event);
+    }
+  }
+
+  unlinkEdge(edge);
+}
+
+void ReferenceNode::linkEdge(ReferenceEdge * edge)
+{
+  if (isLinked(edge))
+  {
+    return;
+  }
+
+  //see SetNode::linkEdge
+  ReferenceEdge * prev = nullptr;
+  EdgeId prevEdgeId = edge->prevEdgeId;
+  while (!prevEdgeId.isNull())
+  {
+    ReferenceEdge * prevEdge = getExistingEdge(prevEdgeId);
+    if (prevEdge == nullptr)
+    {
+      break;
+    }
+    if (isLinked(prevEdge))
+    {
+      prev = prevEdge;
+      break;
     }
+    prevEdgeId = prevEdge->prevEdgeId;
+  }
+
+  ReferenceEdge * next = (prev != nullptr) ? prev->next : children;
+  while (next != nullptr && edge->edgeId < next->edgeId)
+  {
+    prev = next;
+    next = next->next;
+  }
+
+  edge->prev = prev;
+  edge->next = next;
+  if (next != nullptr)
+  {
+    next->prev = edge;
+  }
+  if (prev != nullptr)
+  {
+    prev->next = edge;
+  }
+  else
+  {
+    children = edge;
   }
 }
 
+void ReferenceNode::unlinkEdge(ReferenceEdge * edge)
+{
+  if (!isLinked(edge))
+  {
+    return;
+  }
+
+  if (edge->next != nullptr)
+  {
+    edge->next->prev = edge->prev;
+  }
+  if (edge->prev != nullptr)
+  {
+    edge->prev->next = edge->next;
+    edge->prevEdgeId = edge->prev->edgeId;
+  }
+  else
+  {
+    children = edge->next;
+    edge->prevEdgeId = EdgeId::Null;
+  }
+
+  edge->prev = nullptr;
+  edge->next = nullptr;
+}
+
+bool ReferenceNode::isLinked(const ReferenceEdge * edge) const
+{
+  return edge->prev != nullptr || children == edge;
+}
+
 void ReferenceNode::serialize(IObjectSerializer & serializer) const
 {
   Node::serialize(serializer);
@@ -352,15 +386,13 @@ void ReferenceNode::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
-void ReferenceNode::serializeChildren(IObjectSerializer & serializer, bool includePending) const
+void ReferenceNode::serializeChildren(IObjectSerializer & serializer, bool includePending,
+  const SerializeChildCallback & serializeChild) const
 {
   serializer.startArray();
 
   for (ReferenceEdge * edge = children; edge != nullptr; edge = edge->next)
   {
-    if (!edge->effect.isVisible())
-      continue;
-
     if (!includePending && edge->childId.isPending())
       continue;
 
@@ -375,6 +407,10 @@ void ReferenceNode::serializeChildren(IObjectSerializer & serializer, bool inclu
     }
     else
     {
+      if (serializeChild)
+      {
+        serializeChild(edge->childId);
+      }
       serializer.endObject();
       serializer.endArray();
       return;
@@ -387,4 +423,43 @@ void ReferenceNode::serializeChildren(IObjectSerializer & serializer, bool inclu
   serializer.endObject();
 
   serializer.endArray();
-}
\ No newline at end of file
+}
+
+void ReferenceNode::saveSnapshot(SnapshotWriter & writer) const
+{
+  ContainerNode::saveSnapshot(writer);
+  writer.writeUInt(nullable);
+
+  std::unordered_map<const ReferenceEdge *, uint64_t> indices;
+  saveEdges(writer, indices);
+  for (const auto & it : edges)
+  {
+    writer.writeNodeId(it.second->edgeId);
+    writeEdgeRef(writer, indices, it.second->next);
+  }
+
+  writeEdgeRef(writer, indices, children);
+}
+
+void ReferenceNode::loadSnapshot(SnapshotReader & reader)
+{
+  ContainerNode::loadSnapshot(reader);
+  nullable = reader.readUInt() != 0;
+
+  auto table = loadEdges(reader);
+  for (size_t i = 1; i < table.size(); i++)
+  {
+    table[i]->edgeId = reader.readNodeId();
+    table[i]->next = readEdgeRef(reader, table);
+  }
+
+  children = readEdgeRef(reader, table);
+
+  for (size_t i = 1; i < table.size(); i++)
+  {
+    if (table[i]->next != nullptr)
+    {
+      table[i]->next->prev = table[i];
+    }
+  }
+}
\ No newline at end of file
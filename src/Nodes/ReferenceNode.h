@@ -12,27 +12,39 @@ class ReferenceEdge : public Edge
 {
 public:
   EdgeId edgeId;
+  ReferenceEdge * prev = nullptr;
   ReferenceEdge * next = nullptr;
+  //like in sets, the newer neighbour the edge had when it was last removed
+  EdgeId prevEdgeId;
 
-  ReferenceEdge() : next(nullptr) {}
+  ReferenceEdge() : prev(nullptr), next(nullptr) {}
 };
 
+//Like in sets, the children list holds the visible edges, newest first; the
+//  value is the first edge in the list that isn't speculative
+
 class ReferenceNode : public ContainerNodeImpl<ReferenceEdge>
 {
 public:
   bool nullable = true;
 
-  ReferenceEdge * createEdge(const EdgeId & edgeId, const NodeId & childId, const AttributeMap * attributes, std::function<void(EdgeEvent &)> callback);
-  void updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, std::function<void(EdgeEvent &)> callback);
-  void deleteEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-  void initEdge(const EdgeId & edgeId, const NodeId & childId, std::function<void(EdgeEvent &)> callback);
+  ReferenceEdge * createEdge(const EdgeId & edgeId, const NodeId & childId, const AttributeMap * attributes, EdgeEventCallback callback);
+  void updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, EdgeEventCallback callback);
+  void deleteEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void initEdge(const EdgeId & edgeId, const NodeId & childId, EdgeEventCallback callback);
 
   void serialize(IObjectSerializer & serializer) const;
-  void serializeChildren(IObjectSerializer & serializer, bool includePending) const;
+  void serializeChildren(IObjectSerializer & serializer, bool includePending,
+    const SerializeChildCallback & serializeChild = nullptr) const;
+  void saveSnapshot(SnapshotWriter & writer) const;
+  void loadSnapshot(SnapshotReader & reader);
 
 // private:
   ReferenceEdge * children = nullptr;
 
-  void addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-  void removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-};
\ No newline at end of file
+  void addEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void removeEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void linkEdge(ReferenceEdge * edge);
+  void unlinkEdge(ReferenceEdge * edge);
+  bool isLinked(const ReferenceEdge * edge) const;
+};
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include "SetNode.h"
+#include "Snapshot.h"
+#include "VectorTimestamp.h"
 
 SetEdge * SetNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
-  const AttributeMap * attributes, std::function<void(EdgeEvent &)> callback)
+  const AttributeMap * attributes, EdgeEventCallback callback)
 {
   SetEdge * edge = getEdge(edgeId);
 
@@ -22,7 +24,7 @@ SetEdge * SetNode::createEdge(const EdgeId & edgeId, const NodeId & childId,
   return edge;
 }
 
-void SetNode::updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, std::function<void(EdgeEvent &)> callback)
+void SetNode::updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, EdgeEventCallback callback)
 {
   Edge * edge = getEdge(edgeId);
 
@@ -54,91 +56,154 @@ void SetNode::updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitiali
   }
 }
 
-void SetNode::deleteEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void SetNode::deleteEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
-  removeEdge(edgeId, callback);
+  SetEdge * edge = getExistingEdge(edgeId);
+
+  if (edge == nullptr)
+  {
+    return;
+  }
+
+  if (edge->effect.isVisible())
+  {
+    removeEdge(edgeId, callback);
+  }
+
   ContainerNodeImpl<SetEdge>::deleteEdge(edgeId);
 }
 
-void SetNode::initEdge(const EdgeId & edgeId, const NodeId & childId, std::function<void(EdgeEvent &)> callback)
+void SetNode::initEdge(const EdgeId & edgeId, const NodeId & childId, EdgeEventCallback callback)
 {
   Edge * edge = getEdge(edgeId);
   edge->childId = childId;
 
-  if (edge->effect.isVisible() == false)
-  {
-    removeEdge(edgeId, callback);
-  }
-  else
+  //removed edges are not children, so there is nothing to remove
+  if (edge->effect.isVisible())
   {
     addEdge(edgeId, callback);
   }
 }
 
-void SetNode::addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void SetNode::addEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   SetEdge * edge = getEdge(edgeId);
 
   bool isEdgeSpeculative = edge->childId.isPending();
 
-  SetEdge ** iter = &children;
-
-  while (*iter != nullptr)
-  {
-    if ((*iter)->edgeId < edgeId || *iter == edge)
-    {
-      break;
-    }
-
-    iter = &(*iter)->next;
-  }
+  linkEdge(edge);
 
-  if (*iter != edge)
+  if (!callback)
   {
-    edge->next = *iter;
-    *iter = edge;
+    return;
   }
 
-  auto event = new NodeAddedEvent();
-  event->edgeId = edgeId;
-  event->childId = edge->childId;
-  event->speculative = isEdgeSpeculative;
-  callback(*event);
-  delete event;
+  NodeAddedEvent event;
+  event.edgeId = edgeId;
+  event.childId = edge->childId;
+  event.speculative = isEdgeSpeculative;
+  callback(event);
 }
 
-void SetNode::removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback)
+void SetNode::removeEdge(const EdgeId & edgeId, EdgeEventCallback callback)
 {
   SetEdge * edge = getEdge(edgeId);
 
   bool isEdgeSpeculative = edge->childId.isPending();
 
-  SetEdge ** iter = &children;
+  unlinkEdge(edge);
+
+  if (!callback)
+  {
+    return;
+  }
+
+  NodeRemovedEvent event;
+  event.edgeId = edgeId;
+  event.childId = edge->childId;
+  event.speculative = isEdgeSpeculative;
+  callback(event);
+}
+
+void SetNode::linkEdge(SetEdge * edge)
+{
+  if (isLinked(edge))
+  {
+    return;
+  }
 
-  while (*iter != nullptr)
+  //a removed edge goes back after its old neighbour, or that neighbour's if
+  //  it was removed too (they are all newer); new edges are usually the
+  //  newest, so starting from the front rarely walks past any
+  SetEdge * prev = nullptr;
+  EdgeId prevEdgeId = edge->prevEdgeId;
+  while (!prevEdgeId.isNull())
   {
-    if (*iter == edge)
+    SetEdge * prevEdge = getExistingEdge(prevEdgeId);
+    if (prevEdge == nullptr)
+    {
+      break;
+    }
+    if (isLinked(prevEdge))
     {
+      prev = prevEdge;
       break;
     }
+    prevEdgeId = prevEdge->prevEdgeId;
+  }
+
+  SetEdge * next = (prev != nullptr) ? prev->next : children;
+  while (next != nullptr && edge->edgeId < next->edgeId)
+  {
+    prev = next;
+    next = next->next;
+  }
 
-    iter = &(*iter)->next;
+  edge->prev = prev;
+  edge->next = next;
+  if (next != nullptr)
+  {
+    next->prev = edge;
+  }
+  if (prev != nullptr)
+  {
+    prev->next = edge;
+  }
+  else
+  {
+    children = edge;
   }
+}
 
-  if (*iter != edge)
+void SetNode::unlinkEdge(SetEdge * edge)
+{
+  if (!isLinked(edge))
   {
     return;
   }
 
-  *iter = edge->next;
+  if (edge->next != nullptr)
+  {
+    edge->next->prev = edge->prev;
+  }
+  if (edge->prev != nullptr)
+  {
+    edge->prev->next = edge->next;
+    edge->prevEdgeId = edge->prev->edgeId;
+  }
+  else
+  {
+    children = edge->next;
+    edge->prevEdgeId = EdgeId::Null;
+  }
+
+  edge->prev = nullptr;
   edge->next = nullptr;
+}
 
-  auto event = new NodeRemovedEvent();
-  event->edgeId = edgeId;
-  event->childId = edge->childId;
-  event->speculative = isEdgeSpeculative;
-  callback(*event);
-  delete event;
+bool SetNode::isLinked(const SetEdge * edge) const
+{
+  return edge->prev != nullptr || children == edge;
 }
 
 void SetNode::serialize(IObjectSerializer & serializer) const
@@ -149,7 +214,8 @@ void SetNode::serialize(IObjectSerializer & serializer) const
   serializer.endObject();
 }
 
-void SetNode::serializeChildren(IObjectSerializer & serializer, bool includePending) const
+void SetNode::serializeChildren(IObjectSerializer & serializer, bool includePending,
+  const SerializeChildCallback & serializeChild) const
 {
   serializer.startArray();
 
@@ -167,8 +233,49 @@ void SetNode::serializeChildren(IObjectSerializer & serializer, bool includePend
     {
       serializer.addPair("speculative", true);
     }
+    else if (serializeChild)
+    {
+      serializeChild(edge->childId);
+    }
     serializer.endObject();
   }
 
   serializer.endArray();
+}
+
+void SetNode::saveSnapshot(SnapshotWriter & writer) const
+{
+  ContainerNode::saveSnapshot(writer);
+
+  std::unordered_map<const SetEdge *, uint64_t> indices;
+  saveEdges(writer, indices);
+  for (const auto & it : edges)
+  {
+    writer.writeNodeId(it.second->edgeId);
+    writeEdgeRef(writer, indices, it.second->next);
+  }
+
+  writeEdgeRef(writer, indices, children);
+}
+
+void SetNode::loadSnapshot(SnapshotReader & reader)
+{
+  ContainerNode::loadSnapshot(reader);
+
+  auto table = loadEdges(reader);
+  for (size_t i = 1; i < table.size(); i++)
+  {
+    table[i]->edgeId = reader.readNodeId();
+    table[i]->next = readEdgeRef(reader, table);
+  }
+
+  children = readEdgeRef(reader, table);
+
+  for (size_t i = 1; i < table.size(); i++)
+  {
+    if (table[i]->next != nullptr)
+    {
+      table[i]->next->prev = table[i];
+    }
+  }
 }
\ No newline at end of file
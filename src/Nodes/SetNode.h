@@ -13,25 +13,37 @@ class SetEdge : public Edge
 {
 public:
   EdgeId edgeId;
+  SetEdge * prev = nullptr;
   SetEdge * next = nullptr;
+  //the newer neighbour the edge had when it was last removed, so re-adding it
+  //  (e.g. undo and redo) doesn't have to find its place from the front
+  EdgeId prevEdgeId;
 
-  SetEdge() : next(nullptr) {}
+  SetEdge() : prev(nullptr), next(nullptr) {}
 };
 
+//The children list holds the visible edges, newest first
+
 class SetNode : public ContainerNodeImpl<SetEdge>
 {
 public:
-  SetEdge * createEdge(const EdgeId & edgeId, const NodeId & childId, const AttributeMap * attributes, std::function<void(EdgeEvent &)> callback);
-  void updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, std::function<void(EdgeEvent &)> callback);
-  void deleteEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-  void initEdge(const EdgeId & edgeId, const NodeId & childId, std::function<void(EdgeEvent &)> callback);
+  SetEdge * createEdge(const EdgeId & edgeId, const NodeId & childId, const AttributeMap * attributes, EdgeEventCallback callback);
+  void updateEdgeEffect(const EdgeId & edgeId, int delta, bool deinitialize, EdgeEventCallback callback);
+  void deleteEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void initEdge(const EdgeId & edgeId, const NodeId & childId, EdgeEventCallback callback);
 
   void serialize(IObjectSerializer & serializer) const;
-  void serializeChildren(IObjectSerializer & serializer, bool includePending) const;
+  void serializeChildren(IObjectSerializer & serializer, bool includePending,
+    const SerializeChildCallback & serializeChild = nullptr) const;
+  void saveSnapshot(SnapshotWriter & writer) const;
+  void loadSnapshot(SnapshotReader & reader);
 
 // private:
   SetEdge * children = nullptr;
 
-  void addEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-  void removeEdge(const EdgeId & edgeId, std::function<void(EdgeEvent &)> callback);
-};
\ No newline at end of file
+  void addEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void removeEdge(const EdgeId & edgeId, EdgeEventCallback callback);
+  void linkEdge(SetEdge * edge);
+  void unlinkEdge(SetEdge * edge);
+  bool isLinked(const SetEdge * edge) const;
+};
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ValueNode.h"
+#include "Snapshot.h"
 
 template <class T>
 void ValueNode<T>::serialize(IObjectSerializer & serializer) const
@@ -6,6 +7,20 @@ void ValueNode<T>::serialize(IObjectSerializer & serializer) const
   Node::serialize(serializer);
 }
 
+template <class T>
+void ValueNode<T>::saveSnapshot(SnapshotWriter & writer) const
+{
+  Node::saveSnapshot(writer);
+  value.saveSnapshot(writer);
+}
+
+template <class T>
+void ValueNode<T>::loadSnapshot(SnapshotReader & reader)
+{
+  Node::loadSnapshot(reader);
+  value.loadSnapshot(reader);
+}
+
 template class ValueNode<int32_t>;
 template class ValueNode<int64_t>;
 template class ValueNode<float>;
@@ -10,4 +10,6 @@ public:
   Value<T> value;
 
   void serialize(IObjectSerializer & serializer) const;
+  void saveSnapshot(SnapshotWriter & writer) const;
+  void loadSnapshot(SnapshotReader & reader);
 };
\ No newline at end of file
@@ -6,7 +6,7 @@
 #include "EdgeId.h"
 #include "OperationType.h"
 
-#pragma pack(1) //ideally in a future iteration we shouldn't need to pack these
+#pragma pack(push, 1) //ideally in a future iteration we shouldn't need to pack these
 
 struct Operation
 {
@@ -235,4 +235,4 @@ struct UndoBlockValueDeleteAfterOperation : public Operation
   }
 };
 
-#pragma options align=reset
\ No newline at end of file
+#pragma pack(pop)
\ No newline at end of file
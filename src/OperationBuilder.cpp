@@ -79,9 +79,9 @@ Timestamp OperationBuilder::commitLogOperation()
 
   if (enabled) //NOTE: this might change later (lazy support for view only)
   {
-    auto opCopy = new uint8_t[opBuffer.size()];
-    memcpy(opCopy, opBuffer.data(), opBuffer.size());
-    RefCounted<const LogOperation> rc(reinterpret_cast<const LogOperation *>(opCopy));
+    auto opCopy = RefCounted<LogOperation>::Allocate(opBuffer.size());
+    memcpy(&(*opCopy), opBuffer.data(), opBuffer.size());
+    RefCounted<const LogOperation> rc(std::move(opCopy));
 
     readableStream.writeToDestination(rc);
   }
@@ -395,23 +395,17 @@ std::string OperationBuilder::createPositionFromIndex(const NodeId & parentId, s
   {
     const ListNode * listNode = static_cast<const ListNode *>(parent);
 
-    size_t i = 0;
+    //null children aren't counted: the new edge goes after the non-null
+    //  child before the index, or after the last child past the end
     ListEdge * prevEdge = nullptr;
-    ListEdge * currentEdge = listNode->children;
-    while (currentEdge != nullptr)
+    if (index > listNode->getNonNullChildCount())
     {
-      if (i == index)
-      {
-        break;
-      }
-
-      if (currentEdge->childId.isNull() == false)
-      {
-        i++;
-      }
-
-      prevEdge = currentEdge;
-      currentEdge = currentEdge->nextChild;
+      size_t childCount = listNode->getChildCount();
+      prevEdge = (childCount > 0) ? listNode->getChildAt(childCount - 1) : nullptr;
+    }
+    else if (index > 0)
+    {
+      prevEdge = listNode->getNonNullChildAt(index - 1);
     }
 
     if (prevEdge != nullptr)
@@ -443,18 +437,11 @@ std::string OperationBuilder::createPositionFromEdge(const NodeId & parentId, co
   {
     const ListNode * listNode = static_cast<const ListNode *>(parent);
 
-    ListEdge * prevEdge = nullptr;
-    ListEdge * currentEdge = listNode->children;
-    while (currentEdge != nullptr)
-    {
-      if (currentEdge->edgeId == sourceEdgeId)
-      {
-        break;
-      }
-
-      prevEdge = currentEdge;
-      currentEdge = currentEdge->nextChild;
-    }
+    //the child before the source edge, or the last child if it isn't one
+    size_t index;
+    size_t actualIndex = listNode->getChildCount();
+    listNode->findChildIndex(listNode->getExistingEdge(sourceEdgeId), index, actualIndex);
+    ListEdge * prevEdge = (actualIndex > 0) ? listNode->getChildAt(actualIndex - 1) : nullptr;
 
     if (prevEdge != nullptr)
     {
@@ -553,7 +540,7 @@ void OperationBuilder::insertText(const NodeId & nodeId, size_t offset, const ui
 {
   const Node * node = core->getExistingNode(nodeId);
   if (node == nullptr ||
-    PrimitiveNodeTypes::isBlockValueNodeType(node->getBaseType()) == false)
+    node->getPrimitiveType() != PrimitiveNodeTypes::PrimitiveType::StringValue)
   {
     return;
   }
@@ -582,7 +569,7 @@ void OperationBuilder::deleteText(const NodeId & nodeId, size_t offset, size_t l
 {
   const Node * node = core->getExistingNode(nodeId);
   if (node == nullptr ||
-    PrimitiveNodeTypes::isBlockValueNodeType(node->getBaseType()) == false)
+    node->getPrimitiveType() != PrimitiveNodeTypes::PrimitiveType::StringValue)
   {
     return;
   }
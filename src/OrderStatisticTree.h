@@ -0,0 +1,230 @@
+#pragma once
+#include <cstdint>
+
+//Intrusive order statistic tree (treap) kept over an existing linked list
+//  Nodes carry parent, left, right and priority members; the tree only links
+//  them, so a node can be in the list without being in the tree
+//  Traits give a node's priority (which should look random but be the same
+//  on every site) and recompute the counts a node keeps for its subtree from
+//  the node itself and its children; lookups by those counts are left to the
+//  owner, which walks down from getRoot()
+template <class N, class Traits>
+class OrderStatisticTree
+{
+public:
+  N * getRoot() const
+  {
+    return root;
+  }
+
+  bool contains(const N * node) const
+  {
+    return node != nullptr && (node->parent != nullptr || node == root);
+  }
+
+  //forgets every node without visiting them
+  void clear()
+  {
+    root = nullptr;
+  }
+
+  //inserts node as the in-order successor of prev (or first if prev is null)
+  void insertAfter(N * prev, N * node)
+  {
+    node->priority = Traits::priority(node);
+    node->parent = nullptr;
+    node->left = nullptr;
+    node->right = nullptr;
+    Traits::recompute(node);
+
+    if (root == nullptr)
+    {
+      root = node;
+      return;
+    }
+
+    N * attach;
+    if (prev == nullptr)
+    {
+      attach = root;
+      while (attach->left != nullptr)
+      {
+        attach = attach->left;
+      }
+      attach->left = node;
+    }
+    else if (prev->right == nullptr)
+    {
+      attach = prev;
+      attach->right = node;
+    }
+    else
+    {
+      attach = prev->right;
+      while (attach->left != nullptr)
+      {
+        attach = attach->left;
+      }
+      attach->left = node;
+    }
+
+    node->parent = attach;
+
+    while (node->parent != nullptr && node->parent->priority < node->priority)
+    {
+      rotateUp(node);
+    }
+
+    update(node);
+  }
+
+  void remove(N * node)
+  {
+    if (!contains(node))
+    {
+      return;
+    }
+
+    //rotate down until the node is a leaf
+    while (node->left != nullptr || node->right != nullptr)
+    {
+      N * child;
+      if (node->left == nullptr)
+      {
+        child = node->right;
+      }
+      else if (node->right == nullptr)
+      {
+        child = node->left;
+      }
+      else
+      {
+        child = (node->left->priority > node->right->priority) ?
+          node->left : node->right;
+      }
+
+      rotateUp(child);
+    }
+
+    N * parent = node->parent;
+    if (parent == nullptr)
+    {
+      root = nullptr;
+    }
+    else
+    {
+      if (parent->left == node)
+      {
+        parent->left = nullptr;
+      }
+      else
+      {
+        parent->right = nullptr;
+      }
+
+      update(parent);
+    }
+
+    node->parent = nullptr;
+  }
+
+  //recomputes the counts of a node that changed and of its ancestors
+  void update(N * node)
+  {
+    while (node != nullptr)
+    {
+      Traits::recompute(node);
+      node = node->parent;
+    }
+  }
+
+  N * prev(N * node) const
+  {
+    if (node->left != nullptr)
+    {
+      node = node->left;
+      while (node->right != nullptr)
+      {
+        node = node->right;
+      }
+      return node;
+    }
+
+    while (node->parent != nullptr && node->parent->left == node)
+    {
+      node = node->parent;
+    }
+
+    return node->parent;
+  }
+
+  N * last() const
+  {
+    N * node = root;
+
+    while (node != nullptr && node->right != nullptr)
+    {
+      node = node->right;
+    }
+
+    return node;
+  }
+
+  //deterministic pseudo-random priority from a node's id (splitmix64)
+  static uint32_t MixPriority(uint64_t key, uint64_t salt)
+  {
+    uint64_t hash = key ^ (salt * 0x9E3779B97F4A7C15ull);
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+    hash ^= hash >> 31;
+
+    return static_cast<uint32_t>(hash);
+  }
+
+private:
+  N * root = nullptr;
+
+  void rotateUp(N * node)
+  {
+    N * parent = node->parent;
+    N * grandparent = parent->parent;
+
+    if (parent->left == node)
+    {
+      parent->left = node->right;
+      if (node->right != nullptr)
+      {
+        node->right->parent = parent;
+      }
+      node->right = parent;
+    }
+    else
+    {
+      parent->right = node->left;
+      if (node->left != nullptr)
+      {
+        node->left->parent = parent;
+      }
+      node->left = parent;
+    }
+
+    parent->parent = node;
+    node->parent = grandparent;
+
+    if (grandparent == nullptr)
+    {
+      root = node;
+    }
+    else if (grandparent->left == parent)
+    {
+      grandparent->left = node;
+    }
+    else
+    {
+      grandparent->right = node;
+    }
+
+    Traits::recompute(parent);
+    Traits::recompute(node);
+  }
+};
@@ -29,42 +29,45 @@ public:
     StringValue
   };
 
-  inline static const NodeType Abstract() { return NodeType(); }
-  inline static const NodeType Null() { return NodeType("Null"); }
+  //the primitive types are interned once, so using them doesn't go through
+  //  the type registry
+  inline static const NodeType & Abstract() { static const NodeType type; return type; }
+  inline static const NodeType & Null() { static const NodeType type("Null"); return type; }
 
-  inline static const NodeType Set() { return NodeType("Set"); }
-  inline static const NodeType List() { return NodeType("List"); }
-  inline static const NodeType Map() { return NodeType("Map"); }
-  inline static const NodeType OrderedFloat64Map() { return NodeType("OrderedFloat64Map"); }
-  inline static const NodeType Reference() { return NodeType("Reference"); }
+  inline static const NodeType & Set() { static const NodeType type("Set"); return type; }
+  inline static const NodeType & List() { static const NodeType type("List"); return type; }
+  inline static const NodeType & Map() { static const NodeType type("Map"); return type; }
+  inline static const NodeType & OrderedFloat64Map() { static const NodeType type("OrderedFloat64Map"); return type; }
+  inline static const NodeType & Reference() { static const NodeType type("Reference"); return type; }
 
-  inline static const NodeType Int32Value() { return NodeType("Int32Value"); }
-  inline static const NodeType Int64Value() { return NodeType("Int64Value"); }
-  inline static const NodeType FloatValue() { return NodeType("FloatValue"); }
-  inline static const NodeType DoubleValue() { return NodeType("DoubleValue"); }
-  inline static const NodeType Int8Value() { return NodeType("Int8Value"); }
-  inline static const NodeType BoolValue() { return NodeType("BoolValue"); }
+  inline static const NodeType & Int32Value() { static const NodeType type("Int32Value"); return type; }
+  inline static const NodeType & Int64Value() { static const NodeType type("Int64Value"); return type; }
+  inline static const NodeType & FloatValue() { static const NodeType type("FloatValue"); return type; }
+  inline static const NodeType & DoubleValue() { static const NodeType type("DoubleValue"); return type; }
+  inline static const NodeType & Int8Value() { static const NodeType type("Int8Value"); return type; }
+  inline static const NodeType & BoolValue() { static const NodeType type("BoolValue"); return type; }
 
-  inline static const NodeType StringValue() { return NodeType("StringValue"); }
+  inline static const NodeType & StringValue() { static const NodeType type("StringValue"); return type; }
 
   static bool isPrimitiveNodeType(const NodeType & type) {
-    return primitiveTypeMap().count(type.toString()) > 0;
+    PrimitiveType primitiveType;
+    return findPrimitiveType(type, primitiveType);
   }
 
-  static bool isNullNodeType(NodeType type) {
+  static bool isNullNodeType(const NodeType & type) {
     return type == Null();
   }
-  static bool isAbstractNodeType(NodeType type) {
+  static bool isAbstractNodeType(const NodeType & type) {
     return type == Abstract();
   }
-  static bool isContainerNodeType(NodeType type) {
+  static bool isContainerNodeType(const NodeType & type) {
     return type == Set() ||
       type == List() ||
       type == Map() ||
       type == OrderedFloat64Map() ||
       type == Reference();
   }
-  static bool isValueNodeType(NodeType type) {
+  static bool isValueNodeType(const NodeType & type) {
     return type == Int32Value() ||
       type == Int64Value() ||
       type == FloatValue() ||
@@ -72,14 +75,30 @@ public:
       type == Int8Value() ||
       type == BoolValue();
   }
-  static bool isBlockValueNodeType(NodeType type) {
+  static bool isBlockValueNodeType(const NodeType & type) {
     return type == StringValue();
   }
 
+  static bool isValuePrimitiveType(PrimitiveType type) {
+    return type == PrimitiveType::Int32Value ||
+      type == PrimitiveType::Int64Value ||
+      type == PrimitiveType::FloatValue ||
+      type == PrimitiveType::DoubleValue ||
+      type == PrimitiveType::Int8Value ||
+      type == PrimitiveType::BoolValue;
+  }
+  static bool isContainerPrimitiveType(PrimitiveType type) {
+    return type == PrimitiveType::Set ||
+      type == PrimitiveType::List ||
+      type == PrimitiveType::Map ||
+      type == PrimitiveType::OrderedFloat64Map ||
+      type == PrimitiveType::Reference;
+  }
+
   static PrimitiveType nodeTypeToPrimitiveType(const NodeType & type) {
-    auto it = primitiveTypeMap().find(type.toString());
-    if (it != primitiveTypeMap().end()) {
-      return it->second;
+    PrimitiveType primitiveType;
+    if (findPrimitiveType(type, primitiveType)) {
+      return primitiveType;
     }
     return PrimitiveType::Abstract;
   }
@@ -87,23 +106,32 @@ public:
   static std::unordered_map<std::string, NodeTypeData> getTypeRegistryInitializer();
 
 private:
-  static const std::unordered_map<std::string, PrimitiveType> & primitiveTypeMap() {
-    static const std::unordered_map<std::string, PrimitiveType> map{
-      {"", PrimitiveType::Abstract},
-      {"Null", PrimitiveType::Null},
-      {"Set", PrimitiveType::Set},
-      {"List", PrimitiveType::List},
-      {"Map", PrimitiveType::Map},
-      {"OrderedFloat64Map", PrimitiveType::OrderedFloat64Map},
-      {"Reference", PrimitiveType::Reference},
-      {"Int32Value", PrimitiveType::Int32Value},
-      {"Int64Value", PrimitiveType::Int64Value},
-      {"FloatValue", PrimitiveType::FloatValue},
-      {"DoubleValue", PrimitiveType::DoubleValue},
-      {"Int8Value", PrimitiveType::Int8Value},
-      {"BoolValue", PrimitiveType::BoolValue},
-      {"StringValue", PrimitiveType::StringValue}
+  //node types compare by their registry entry, so this is a few pointer
+  //  comparisons rather than a string lookup
+  static bool findPrimitiveType(const NodeType & type, PrimitiveType & primitiveType) {
+    static const std::pair<const NodeType &, PrimitiveType> types[] = {
+      {Abstract(), PrimitiveType::Abstract},
+      {Null(), PrimitiveType::Null},
+      {Set(), PrimitiveType::Set},
+      {List(), PrimitiveType::List},
+      {Map(), PrimitiveType::Map},
+      {OrderedFloat64Map(), PrimitiveType::OrderedFloat64Map},
+      {Reference(), PrimitiveType::Reference},
+      {Int32Value(), PrimitiveType::Int32Value},
+      {Int64Value(), PrimitiveType::Int64Value},
+      {FloatValue(), PrimitiveType::FloatValue},
+      {DoubleValue(), PrimitiveType::DoubleValue},
+      {Int8Value(), PrimitiveType::Int8Value},
+      {BoolValue(), PrimitiveType::BoolValue},
+      {StringValue(), PrimitiveType::StringValue}
     };
-    return map;
+
+    for (const auto & it : types) {
+      if (it.first == type) {
+        primitiveType = it.second;
+        return true;
+      }
+    }
+    return false;
   }
 };
\ No newline at end of file
@@ -165,7 +165,7 @@ public:
       auto callbackWrapper = [callback, promise]()
       {
         auto innerPromise = callback();
-        innerPromise.finally([promise]()
+        innerPromise.finally([promise, innerPromise]()
         {
           if (innerPromise.isResolved())
           {
@@ -428,7 +428,7 @@ public:
       auto callbackWrapper = [callback, promise]()
       {
         auto innerPromise = callback();
-        innerPromise.finally([promise]()
+        innerPromise.finally([promise, innerPromise]()
         {
           if (innerPromise.isResolved())
           {
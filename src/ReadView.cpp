@@ -0,0 +1,28 @@
+#include "ReadView.h"
+
+std::shared_ptr<const ReadView> ReadView::load(const std::string_view & snapshot)
+{
+  std::shared_ptr<ReadView> view(new ReadView());
+
+  if (!view->core.loadSnapshot(snapshot, true))
+  {
+    return nullptr;
+  }
+
+  return view;
+}
+
+const VectorTimestamp & ReadView::getClock() const
+{
+  return core.clock;
+}
+
+const std::vector<std::pair<Timestamp, Timestamp>> & ReadView::getExcludedOperations() const
+{
+  return core.excludedOperations;
+}
+
+const Core & ReadView::getCore() const
+{
+  return core;
+}
\ No newline at end of file
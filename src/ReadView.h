@@ -0,0 +1,31 @@
+#pragma once
+#include "Core.h"
+#include "VectorTimestamp.h"
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//An immutable copy of a core's state as of the clock it was taken at, apart
+//  from the excluded operations (those still waiting on a type spec or node)
+//The state is loaded from a snapshot into a core of its own, so reading a
+//  view never touches the core it came from: only saving the snapshot needs
+//  whatever guards that core, while loading it and every read can run
+//  alongside operations being applied (and from any number of threads)
+class ReadView
+{
+public:
+  //null if the snapshot can't be loaded
+  static std::shared_ptr<const ReadView> load(const std::string_view & snapshot);
+
+  const VectorTimestamp & getClock() const;
+  //the first and final timestamp of each operation the clock covers but the
+  //  state leaves out; the nodes they create aren't in the view
+  const std::vector<std::pair<Timestamp, Timestamp>> & getExcludedOperations() const;
+  const Core & getCore() const;
+
+private:
+  ReadView() = default;
+
+  Core core;
+};
\ No newline at end of file
@@ -1,80 +1,79 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
 
+//A counted reference to memory allocated with new[]
+//Memory from Allocate keeps its count in front of the object, in the same
+//  allocation; the count is atomic, so such references can be copied and
+//  released from any thread
+//Memory adopted through the constructor gets its count allocated on the
+//  first copy, which also updates the reference copied from, so it must not
+//  be copied from more than one thread at a time
 template <class T>
 class RefCounted
 {
+  using Count = std::atomic<uint32_t>;
+
 public:
-  RefCounted() : ptr(nullptr), count(nullptr) {}
-  explicit RefCounted(T * ptr) : ptr(ptr), count(nullptr) {}
+  RefCounted() : ptr(nullptr), countBits(0) {}
+  explicit RefCounted(T * ptr) : ptr(ptr), countBits(0) {}
   RefCounted(const RefCounted<T> & rhs)
-    : ptr(rhs.ptr), count(rhs.count)
+    : ptr(rhs.ptr), countBits(rhs.countBits)
   {
-    if (ptr == nullptr)
+    if (ptr == nullptr || count() == BorrowedCount())
     {
       return;
     }
-    if (!count)
+    if (!count())
     {
       //hack: allow mutating the rhs in a const copy constructor
       //  allowable since the behavior is exactly the same as if the count
       //  was not lazily allocated; this just facilitates the optimization
-      count = const_cast<RefCounted<T> *>(&rhs)->count = new uint8_t(1);
+      countBits = const_cast<RefCounted<T> *>(&rhs)->countBits =
+        reinterpret_cast<uintptr_t>(new Count(1));
     }
     else
     {
-      ++*count;
+      count()->fetch_add(1, std::memory_order_relaxed);
     }
   }
   RefCounted(RefCounted<T> && rhs)
-    : ptr(rhs.ptr), count(rhs.count)
+    : ptr(rhs.ptr), countBits(rhs.countBits)
+  {
+    rhs.ptr = nullptr;
+  }
+  //e.g. from a reference to a LogOperation that was just filled in
+  template <class U, class = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+  RefCounted(RefCounted<U> && rhs)
+    : ptr(rhs.ptr), countBits(rhs.countBits)
   {
     rhs.ptr = nullptr;
   }
   ~RefCounted()
   {
-    if (ptr == nullptr)
-    {
-      return;
-    }
-    if (count == nullptr)
-    {
-      //we assume that ptr was allocated with new[] (in our cases, it always is)
-      //not that this is great regardless
-      delete_ptr: delete[] ptr;
-    }
-    else if (*count == 0)
-    {
-      delete count;
-      goto delete_ptr; //code size optimization
-    }
-    else
-    {
-      --*count;
-    }
+    drop();
+  }
+
+  //size bytes for a T (more than sizeof(T) for variable sized types), left
+  //  uninitialized, with the count stored in front of them
+  static RefCounted<T> Allocate(size_t size)
+  {
+    uint8_t * memory = new uint8_t[HeaderSize() + size];
+    RefCounted<T> ref(reinterpret_cast<T *>(memory + HeaderSize()));
+    ref.countBits = reinterpret_cast<uintptr_t>(new (memory) Count(0)) | AllocatedBit;
+    return ref;
   }
 
   RefCounted<T> const & operator=(RefCounted<T> && rhs)
   {
-    if (ptr != nullptr)
-    {
-      if (count == nullptr)
-      {
-        delete[] ptr;
-      }
-      else if (*count == 0)
-      {
-        delete count;
-        delete[] ptr;
-      }
-      else
-      {
-        --*count;
-      }
-    }
+    drop();
 
     ptr = rhs.ptr;
-    count = rhs.count;
+    countBits = rhs.countBits;
     rhs.ptr = nullptr;
     return *this;
   }
@@ -95,16 +94,40 @@ public:
     return ptr == rhs;
   }
 
+  //a reference to memory owned by someone else; it is never freed, and
+  //  copies are only valid for as long as the owner keeps the memory alive
+  static RefCounted<T> Borrow(T * ptr)
+  {
+    RefCounted<T> ref(ptr);
+    ref.countBits = reinterpret_cast<uintptr_t>(BorrowedCount());
+    return ref;
+  }
+
+  bool isBorrowed() const
+  {
+    return ptr != nullptr && count() == BorrowedCount();
+  }
+
+  //whether the memory came from Allocate (and can be shared between threads)
+  bool isAllocated() const
+  {
+    return ptr != nullptr && (countBits & AllocatedBit) != 0;
+  }
+
+  //gives up memory adopted through the constructor without freeing it
   T * release()
   {
-    if (count != nullptr)
+    if (count() != nullptr && count() != BorrowedCount())
     {
-      if (*count != 0)
+      if (count()->load(std::memory_order_acquire) != 0)
       {
         //there are other references that still exist
         throw std::runtime_error("Cannot release a reference with other references still existing");
       }
-      delete count;
+      if (!isAllocated())
+      {
+        delete count();
+      }
     }
 
     ptr = nullptr;
@@ -113,6 +136,59 @@ public:
   }
 
 private:
+  //counts are at least 4 byte aligned, so the low bit is free to mark
+  //  counts that share an allocation with the object
+  static constexpr uintptr_t AllocatedBit = 1;
+
+  static constexpr size_t HeaderSize()
+  {
+    return alignof(T) > sizeof(Count) ? alignof(T) : sizeof(Count);
+  }
+
+  //shared marker used in place of a count for borrowed references
+  static Count * BorrowedCount()
+  {
+    static Count borrowed = 0;
+    return &borrowed;
+  }
+
+  Count * count() const
+  {
+    return reinterpret_cast<Count *>(countBits & ~AllocatedBit);
+  }
+
+  void drop()
+  {
+    if (ptr == nullptr || count() == BorrowedCount())
+    {
+      return;
+    }
+
+    //the count is the number of other references, so a count of 0 means
+    //  nothing else can be touching it
+    if (count() != nullptr
+      && count()->load(std::memory_order_acquire) != 0
+      && count()->fetch_sub(1, std::memory_order_acq_rel) != 0)
+    {
+      return;
+    }
+
+    if (isAllocated())
+    {
+      count()->~Count();
+      delete[] reinterpret_cast<uint8_t *>(count());
+    }
+    else
+    {
+      delete count();
+      //we assume that ptr was allocated with new[] (in our cases, it always is)
+      delete[] reinterpret_cast<const uint8_t *>(ptr);
+    }
+  }
+
   T * ptr;
-  uint8_t * count;
+  uintptr_t countBits;
+
+  template <class U>
+  friend class RefCounted;
 };
\ No newline at end of file
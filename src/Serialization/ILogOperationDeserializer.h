@@ -12,4 +12,10 @@ public:
   // virtual int errorsDetected() = 0;
   // virtual int errorsCorrected() = 0;
   virtual ~ILogOperationDeserializer() = default;
+
+  //when enabled, operations already stored in the native layout are written
+  //  to the destination as borrowed views into the input instead of copies;
+  //  they are only valid for the duration of the destination's write call
+  //returns false if the format doesn't support it
+  virtual bool setZeroCopy(bool enabled) { return !enabled; }
 };
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include "../../Operation.h"
 #include "../../LogOperation.h"
 
-#pragma pack(1)
+#pragma pack(push, 1)
 
 namespace Serialization_standard_v1
 {
@@ -208,4 +208,4 @@ namespace Serialization_standard_v1
   };
 };
 
-#pragma options align=reset
\ No newline at end of file
+#pragma pack(pop)
\ No newline at end of file
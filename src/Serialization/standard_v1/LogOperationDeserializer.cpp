@@ -2,9 +2,31 @@
 #include "LogOperation.h"
 
 #include "Deserialize.cpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 
 namespace Serialization_standard_v1
 {
+  template <Subformat F>
+  struct SerializedLogOperation;
+
+  template <>
+  struct SerializedLogOperation<Subformat::Full> { using Type = LogOperationFull; };
+  template <>
+  struct SerializedLogOperation<Subformat::Untagged> { using Type = LogOperationUntagged; };
+  template <>
+  struct SerializedLogOperation<Subformat::Forward> { using Type = LogOperationForward; };
+  template <>
+  struct SerializedLogOperation<Subformat::Type> { using Type = LogOperationType; };
+
+  //zero-copy hands out full and forward records as-is
+  static_assert(sizeof(::Tag) == sizeof(Tag));
+  static_assert(sizeof(::Timestamp) == sizeof(Timestamp));
+  static_assert(offsetof(::LogOperation, op) == LogOperationFull::getHeaderSize());
+  static_assert(offsetof(::LogOperation, ts) == offsetof(LogOperationFull, ts));
+  static_assert(LogOperationForward::getHeaderSize() == LogOperationFull::getHeaderSize());
+
   template <Subformat F, DeserializeDirection D>
   LogOperationDeserializer<F, D>::LogOperationDeserializer()
   {
@@ -43,25 +65,126 @@ namespace Serialization_standard_v1
       return true;
     }
 
-    streamBuffer.append(data);
+    const char * buffer = data.data();
+    size_t bufferSize = data.size();
+
+    //the buffer only ever holds the partial operation left over from the
+    //  last write, so finish that first using just as much input as it needs
+    while (streamBuffer.size() > 0)
+    {
+      size_t opSize = GetOperationSize(streamBuffer);
+      if (streamBuffer.size() < opSize)
+      {
+        if (bufferSize == 0)
+        {
+          return true;
+        }
+
+        size_t length = std::min(opSize - streamBuffer.size(), bufferSize);
+        streamBuffer.append(buffer, length);
+        buffer += length;
+        bufferSize -= length;
+        continue;
+      }
+
+      size_t readLength = readForward(streamBuffer.data(), streamBuffer.size());
+      if (readLength == 0)
+      {
+        //unreadable data; keep buffering
+        streamBuffer.append(buffer, bufferSize);
+        return true;
+      }
+
+      streamBuffer.erase(0, readLength);
+    }
+
+    //everything else is read straight from the input
+    size_t readLength = readForward(buffer, bufferSize);
+    streamBuffer.assign(buffer + readLength, bufferSize - readLength);
+
+    return true;
+  }
 
+  template <Subformat F, DeserializeDirection D>
+  size_t LogOperationDeserializer<F, D>::readForward(const char * data, size_t size)
+  {
     size_t readLength = 0;
     std::pair<RefCounted<const ::LogOperation>, size_t> result;
 
-    const char * buffer = streamBuffer.data();
-    size_t bufferSize = streamBuffer.size();
-    while ((result = DeserializeLogOperation(std::string_view(buffer, bufferSize),
-      bufferSize)).second > 0)
+    while (true)
     {
+      std::string_view remaining(data + readLength, size - readLength);
+      size_t opSize = GetOperationSize(remaining);
+      if (opSize > remaining.size())
+      {
+        break;
+      }
+
+      if constexpr (SupportsZeroCopy)
+      {
+        if (zeroCopy)
+        {
+          result = std::make_pair(RefCounted<const ::LogOperation>::Borrow(
+            reinterpret_cast<const ::LogOperation *>(remaining.data())), opSize);
+        }
+        else
+        {
+          result = DeserializeLogOperation(remaining, remaining.size());
+        }
+      }
+      else
+      {
+        result = DeserializeLogOperation(remaining, remaining.size());
+      }
+
+      if (result.second == 0)
+      {
+        break;
+      }
+
       writeToDestination(result.first);
-      buffer += result.second;
-      bufferSize -= result.second;
       readLength += result.second;
     }
 
-    streamBuffer.erase(0, readLength);
+    return readLength;
+  }
 
-    return true;
+  template <Subformat F, DeserializeDirection D>
+  size_t LogOperationDeserializer<F, D>::GetOperationSize(const std::string_view & data)
+  {
+    using SerializedOp = typename SerializedLogOperation<F>::Type;
+
+    //each step needs the bytes checked by the one before it, so a partial
+    //  operation yields a lower bound that only grows as more data arrives
+    if (data.size() < SerializedOp::getStructSize())
+    {
+      return SerializedOp::getStructSize();
+    }
+
+    auto serializedOp = reinterpret_cast<const SerializedOp *>(data.data());
+    size_t structSize = SerializedOp::getSizeWithoutOp() + serializedOp->op.getStructSize();
+    if (data.size() < structSize)
+    {
+      return structSize;
+    }
+
+    return serializedOp->getSize();
+  }
+
+  template <Subformat F, DeserializeDirection D>
+  size_t LogOperationDeserializer<F, D>::GetReverseOperationSize(const std::string_view & data)
+  {
+    using SerializedOp = typename SerializedLogOperation<F>::Type;
+
+    //operations end with a footer holding their size
+    if (data.size() < SerializedOp::getStructSize())
+    {
+      return SerializedOp::getStructSize();
+    }
+
+    uint32_t opSize;
+    std::memcpy(&opSize, data.data() + data.size() - sizeof(uint32_t), sizeof(uint32_t));
+    return opSize;
   }
 
   template <Subformat F, DeserializeDirection D>
@@ -72,25 +195,112 @@ namespace Serialization_standard_v1
       return true;
     }
 
-    //NOTE: this isn't great
-    streamBuffer.insert(0, data);
+    size_t bufferSize = data.size();
+
+    //same as writeForward, mirrored: the buffer only holds the end of the
+    //  operation cut off by the last write, and the bytes it still needs
+    //  are taken from the end of the input
+    while (streamBuffer.size() > bufferOffset)
+    {
+      std::string_view buffered(streamBuffer.data() + bufferOffset,
+        streamBuffer.size() - bufferOffset);
+      size_t opSize = GetReverseOperationSize(buffered);
+      if (buffered.size() < opSize)
+      {
+        if (bufferSize == 0)
+        {
+          return true;
+        }
+
+        size_t length = std::min(opSize - buffered.size(), bufferSize);
+        bufferSize -= length;
+        prependToBuffer(data.data() + bufferSize, length);
+        continue;
+      }
+
+      size_t readLength = readReverse(buffered.data(), buffered.size());
+      if (readLength == 0)
+      {
+        //unreadable data; keep buffering
+        prependToBuffer(data.data(), bufferSize);
+        return true;
+      }
+
+      streamBuffer.resize(streamBuffer.size() - readLength);
+    }
+
+    //everything else is read straight from the input
+    size_t readLength = readReverse(data.data(), bufferSize);
+    streamBuffer.assign(data.data(), bufferSize - readLength);
+    bufferOffset = 0;
+
+    return true;
+  }
+
+  template <Subformat F, DeserializeDirection D>
+  size_t LogOperationDeserializer<F, D>::readReverse(const char * data, size_t size)
+  {
+    using SerializedOp = typename SerializedLogOperation<F>::Type;
 
     size_t readLength = 0;
     std::pair<RefCounted<const ::LogOperation>, size_t> result;
 
-    const char * buffer = streamBuffer.data();
-    size_t bufferSize = streamBuffer.size();
-    while ((result = DeserializeLogOperation(std::string_view(buffer, bufferSize),
-      bufferSize)).second > 0)
+    while (true)
     {
+      std::string_view remaining(data, size - readLength);
+      size_t opSize = GetReverseOperationSize(remaining);
+      if (opSize > remaining.size() || opSize < SerializedOp::getStructSize())
+      {
+        break;
+      }
+
+      if constexpr (SupportsZeroCopy)
+      {
+        if (zeroCopy)
+        {
+          result = std::make_pair(RefCounted<const ::LogOperation>::Borrow(
+            reinterpret_cast<const ::LogOperation *>(remaining.data() + remaining.size() - opSize)),
+            opSize);
+        }
+        else
+        {
+          result = DeserializeLogOperation(remaining, remaining.size());
+        }
+      }
+      else
+      {
+        result = DeserializeLogOperation(remaining, remaining.size());
+      }
+
+      if (result.second == 0)
+      {
+        break;
+      }
+
       writeToDestination(result.first);
-      bufferSize -= result.second;
       readLength += result.second;
     }
 
-    streamBuffer.erase(streamBuffer.size() - readLength, readLength);
+    return readLength;
+  }
 
-    return true;
+  template <Subformat F, DeserializeDirection D>
+  void LogOperationDeserializer<F, D>::prependToBuffer(const char * data, size_t size)
+  {
+    if (bufferOffset < size)
+    {
+      //move the data to the end of a buffer with at least as much free
+      //  space in front of it as it holds, so growing it is amortized linear
+      size_t length = streamBuffer.size() - bufferOffset;
+      size_t offset = length + size;
+      std::basic_string<char> buffer(offset + length, '\0');
+      std::memcpy(buffer.data() + offset, streamBuffer.data() + bufferOffset, length);
+      streamBuffer = std::move(buffer);
+      bufferOffset = offset;
+    }
+
+    bufferOffset -= size;
+    std::memcpy(streamBuffer.data() + bufferOffset, data, size);
   }
 
   template <Subformat F, DeserializeDirection D>
@@ -113,6 +323,18 @@ namespace Serialization_standard_v1
     return destination->write(data);
   }
 
+  template <Subformat F, DeserializeDirection D>
+  bool LogOperationDeserializer<F, D>::setZeroCopy(bool enabled)
+  {
+    if (enabled && !SupportsZeroCopy)
+    {
+      return false;
+    }
+
+    zeroCopy = enabled;
+    return true;
+  }
+
   template <Subformat F, DeserializeDirection D>
   void LogOperationDeserializer<F, D>::pipeTo(IWritableStream<RefCounted<const ::LogOperation>> & writableStream)
   {
@@ -139,12 +361,12 @@ namespace Serialization_standard_v1
     Deserialize(opType, serializedOp->op.type);
 
     size_t internalOpSize = ::LogOperation::getSize(opType, serializedOp->op.getDataSize());
-    auto op = reinterpret_cast<::LogOperation *>(new uint8_t[internalOpSize]);
+    auto op = RefCounted<::LogOperation>::Allocate(internalOpSize);
     Deserialize(op->ts, serializedOp->ts);
     Deserialize(op->tag, serializedOp->tag);
     Deserialize(op->op, serializedOp->op);
 
-    return std::make_pair(RefCounted<const ::LogOperation>(op), opDataSize);
+    return std::make_pair(RefCounted<const ::LogOperation>(std::move(op)), opDataSize);
   }
 
   template <>
@@ -167,12 +389,12 @@ namespace Serialization_standard_v1
     Deserialize(opType, serializedOp->op.type);
 
     size_t internalOpSize = ::LogOperation::getSize(opType, serializedOp->op.getDataSize());
-    auto op = reinterpret_cast<::LogOperation *>(new uint8_t[internalOpSize]);
+    auto op = RefCounted<::LogOperation>::Allocate(internalOpSize);
     Deserialize(op->ts, serializedOp->ts);
     Deserialize(op->tag, serializedOp->tag);
     Deserialize(op->op, serializedOp->op);
 
-    return std::make_pair(RefCounted<const ::LogOperation>(op), opDataSize);
+    return std::make_pair(RefCounted<const ::LogOperation>(std::move(op)), opDataSize);
   }
 
   template <>
@@ -195,12 +417,12 @@ namespace Serialization_standard_v1
     Deserialize(opType, serializedOp->op.type);
 
     size_t internalOpSize = ::LogOperation::getSize(opType, serializedOp->op.getDataSize());
-    auto op = reinterpret_cast<::LogOperation *>(new uint8_t[internalOpSize]);
+    auto op = RefCounted<::LogOperation>::Allocate(internalOpSize);
     Deserialize(op->ts, serializedOp->ts);
     Deserialize(op->op, serializedOp->op);
     op->tag = ::Tag::Default();
 
-    return std::make_pair(RefCounted<const ::LogOperation>(op), opDataSize);
+    return std::make_pair(RefCounted<const ::LogOperation>(std::move(op)), opDataSize);
   }
 
   template <>
@@ -223,12 +445,12 @@ namespace Serialization_standard_v1
     Deserialize(opType, serializedOp->op.type);
 
     size_t internalOpSize = ::LogOperation::getSize(opType, serializedOp->op.getDataSize());
-    auto op = reinterpret_cast<::LogOperation *>(new uint8_t[internalOpSize]);
+    auto op = RefCounted<::LogOperation>::Allocate(internalOpSize);
     Deserialize(op->ts, serializedOp->ts);
     Deserialize(op->op, serializedOp->op);
     op->tag = ::Tag::Default();
 
-    return std::make_pair(RefCounted<const ::LogOperation>(op), opDataSize);
+    return std::make_pair(RefCounted<const ::LogOperation>(std::move(op)), opDataSize);
   }
 
   template <>
@@ -251,12 +473,12 @@ namespace Serialization_standard_v1
     Deserialize(opType, serializedOp->op.type);
 
     size_t internalOpSize = ::LogOperation::getSize(opType, serializedOp->op.getDataSize());
-    auto op = reinterpret_cast<::LogOperation *>(new uint8_t[internalOpSize]);
+    auto op = RefCounted<::LogOperation>::Allocate(internalOpSize);
     Deserialize(op->ts, serializedOp->ts);
     Deserialize(op->tag, serializedOp->tag);
     Deserialize(op->op, serializedOp->op);
 
-    return std::make_pair(RefCounted<const ::LogOperation>(op), opDataSize);
+    return std::make_pair(RefCounted<const ::LogOperation>(std::move(op)), opDataSize);
   }
 
   template <>
@@ -279,12 +501,12 @@ namespace Serialization_standard_v1
     Deserialize(opType, serializedOp->op.type);
 
     size_t internalOpSize = ::LogOperation::getSize(opType, serializedOp->op.getDataSize());
-    auto op = reinterpret_cast<::LogOperation *>(new uint8_t[internalOpSize]);
+    auto op = RefCounted<::LogOperation>::Allocate(internalOpSize);
     op->ts = ::Timestamp::Null;
     op->tag = ::Tag::Default();
     Deserialize(op->op, serializedOp->op);
 
-    return std::make_pair(RefCounted<const ::LogOperation>(op), opDataSize);
+    return std::make_pair(RefCounted<const ::LogOperation>(std::move(op)), opDataSize);
   }
 
   template class LogOperationDeserializer<Subformat::Full, DeserializeDirection::Forward>;
@@ -20,16 +20,29 @@ namespace Serialization_standard_v1
     bool write(const std::string_view & data) override;
     void close() override;
     void pipeTo(IWritableStream<RefCounted<const ::LogOperation>> & writableStream) override;
+    bool setZeroCopy(bool enabled) override;
   private:
+    //only records laid out exactly like ::LogOperation can be borrowed
+    static constexpr bool SupportsZeroCopy = F == Subformat::Full || F == Subformat::Forward;
+
     bool writeToDestination(const RefCounted<const ::LogOperation> & data);
 
     bool writeForward(const std::string_view & data);
     bool writeReverse(const std::string_view & data);
+    size_t readForward(const char * data, size_t size);
+    size_t readReverse(const char * data, size_t size);
+    void prependToBuffer(const char * data, size_t size);
 
+    static size_t GetOperationSize(const std::string_view & data);
+    static size_t GetReverseOperationSize(const std::string_view & data);
     static std::pair<RefCounted<const ::LogOperation>, size_t> DeserializeLogOperation(const std::string_view & data, size_t bufLength);
 
     bool closed = false;
+    bool zeroCopy = false;
     std::basic_string<char> streamBuffer;
-    IWritableStream<RefCounted<const ::LogOperation>> * destination;
+    //reverse streams keep their data at the end of streamBuffer so it can
+    //  be grown towards the front
+    size_t bufferOffset = 0;
+    IWritableStream<RefCounted<const ::LogOperation>> * destination = nullptr;
   };
 };
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//Fixed size object allocator that carves objects out of geometrically growing
+//  slabs and recycles freed objects through an intrusive free list
+//  All objects are released at once by clear() (or when the allocator is
+//  destroyed) without visiting them, so T must be trivially destructible
+//  FirstSlabSize can be lowered for allocators that usually hold few objects
+template <class T, size_t FirstSlabSize = 8>
+class SlabAllocator
+{
+  static_assert(std::is_trivially_destructible<T>::value,
+    "SlabAllocator only supports trivially destructible types");
+
+public:
+  SlabAllocator() = default;
+  SlabAllocator(const SlabAllocator &) = delete;
+  SlabAllocator & operator=(const SlabAllocator &) = delete;
+
+  ~SlabAllocator()
+  {
+    clear();
+  }
+
+  template <class... Args>
+  T * create(Args &&... args)
+  {
+    void * ptr;
+
+    if (freeList != nullptr)
+    {
+      ptr = freeList;
+      freeList = freeList->next;
+    }
+    else
+    {
+      if (slabUsed == slabCapacity)
+      {
+        allocateSlab();
+      }
+
+      ptr = &slabs.back()[slabUsed++];
+    }
+
+    return new (ptr) T(std::forward<Args>(args)...);
+  }
+
+  void destroy(T * ptr)
+  {
+    if (ptr == nullptr)
+    {
+      return;
+    }
+
+    ptr->~T();
+
+    Slot * slot = reinterpret_cast<Slot *>(ptr);
+    slot->next = freeList;
+    freeList = slot;
+  }
+
+  void clear()
+  {
+    for (auto slab : slabs)
+    {
+      delete [] slab;
+    }
+
+    slabs.clear();
+    freeList = nullptr;
+    slabUsed = 0;
+    slabCapacity = 0;
+  }
+
+private:
+  static const size_t maxSlabSize = 4096;
+
+  union Slot
+  {
+    Slot * next;
+    alignas(T) unsigned char data[sizeof(T)];
+  };
+
+  std::vector<Slot *> slabs;
+  Slot * freeList = nullptr;
+  size_t slabUsed = 0;
+  size_t slabCapacity = 0;
+
+  void allocateSlab()
+  {
+    if (slabCapacity == 0)
+    {
+      slabCapacity = FirstSlabSize;
+    }
+    else if (slabCapacity < maxSlabSize)
+    {
+      slabCapacity *= 2;
+    }
+
+    slabs.push_back(new Slot[slabCapacity]);
+    slabUsed = 0;
+  }
+};
+
+//Allocates objects that are not trivially destructible (e.g. nodes, which own
+//  memory) out of shared slabs
+//  Objects have to be destroyed individually before the pool goes away
+template <class T, size_t FirstSlabSize = 8>
+class ObjectPool
+{
+public:
+  T * create()
+  {
+    return new (allocator.create(Uninitialized())) T();
+  }
+
+  void destroy(T * object)
+  {
+    object->~T();
+    allocator.destroy(reinterpret_cast<Storage *>(object));
+  }
+
+private:
+  struct Uninitialized {};
+
+  struct Storage
+  {
+    Storage() = default;
+    //leaves the bytes alone since the object is constructed over them
+    explicit Storage(Uninitialized) {}
+    alignas(T) unsigned char data[sizeof(T)];
+  };
+
+  SlabAllocator<Storage, FirstSlabSize> allocator;
+};
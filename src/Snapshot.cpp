@@ -0,0 +1,204 @@
+#include "Snapshot.h"
+#include <cstring>
+
+void SnapshotWriter::writeUInt(uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  data.push_back(static_cast<char>(value));
+}
+
+void SnapshotWriter::writeInt(int64_t value)
+{
+  writeUInt((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void SnapshotWriter::writeBytes(const void * bytes, size_t length)
+{
+  data.append(static_cast<const char *>(bytes), length);
+}
+
+void SnapshotWriter::writeString(const std::string_view & value)
+{
+  writeUInt(value.size());
+  writeBytes(value.data(), value.size());
+}
+
+void SnapshotWriter::writeTimestamp(const Timestamp & ts)
+{
+  writeUInt(ts.clock);
+  writeUInt(ts.site);
+}
+
+void SnapshotWriter::writeNodeId(const NodeId & nodeId)
+{
+  writeTimestamp(nodeId.ts);
+  writeUInt(nodeId.child);
+}
+
+void SnapshotWriter::writeNodeType(const NodeType & type)
+{
+  auto it = typeIndices.find(type);
+  if (it == typeIndices.end())
+  {
+    it = typeIndices.emplace(type, static_cast<uint32_t>(types.size())).first;
+    types.push_back(type);
+  }
+
+  writeUInt(it->second);
+}
+
+void SnapshotWriter::writeEffect(const Effect & effect)
+{
+  //the initialized flag goes in the low bit
+  writeInt(static_cast<int64_t>(effect.effect) * 2 + (effect.initialized ? 1 : 0));
+}
+
+void SnapshotWriter::finish(std::basic_string<char> & output) const
+{
+  SnapshotWriter table;
+  table.writeUInt(types.size());
+  for (const auto & type : types)
+  {
+    table.writeString(type.toString());
+  }
+
+  output.reserve(output.size() + table.data.size() + data.size());
+  output.append(table.data);
+  output.append(data);
+}
+
+SnapshotReader::SnapshotReader(const std::string_view & data)
+  : data(data.data()), length(data.size())
+{
+  size_t count = readCount();
+  types.reserve(count);
+  for (size_t i = 0; i < count && !error; i++)
+  {
+    types.push_back(NodeType(std::string(readString())));
+  }
+}
+
+uint64_t SnapshotReader::readUInt()
+{
+  uint64_t value = 0;
+  for (unsigned int shift = 0; shift < 64; shift += 7)
+  {
+    if (offset >= length)
+    {
+      setError();
+      return 0;
+    }
+
+    uint8_t byte = static_cast<uint8_t>(data[offset++]);
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      return value;
+    }
+  }
+
+  setError();
+  return 0;
+}
+
+int64_t SnapshotReader::readInt()
+{
+  uint64_t value = readUInt();
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+bool SnapshotReader::readBytes(void * bytes, size_t size)
+{
+  if (length - offset < size)
+  {
+    setError();
+    return false;
+  }
+
+  std::memcpy(bytes, data + offset, size);
+  offset += size;
+  return true;
+}
+
+std::string_view SnapshotReader::readString()
+{
+  size_t size = readCount();
+  if (error)
+  {
+    return std::string_view();
+  }
+
+  std::string_view value(data + offset, size);
+  offset += size;
+  return value;
+}
+
+Timestamp SnapshotReader::readTimestamp()
+{
+  Timestamp ts;
+  ts.clock = static_cast<uint32_t>(readUInt());
+  ts.site = static_cast<uint32_t>(readUInt());
+  return ts;
+}
+
+NodeId SnapshotReader::readNodeId()
+{
+  NodeId nodeId;
+  nodeId.ts = readTimestamp();
+  nodeId.child = static_cast<uint32_t>(readUInt());
+  return nodeId;
+}
+
+NodeType SnapshotReader::readNodeType()
+{
+  uint64_t index = readUInt();
+  if (index >= types.size())
+  {
+    setError();
+    return NodeType();
+  }
+
+  return types[index];
+}
+
+Effect SnapshotReader::readEffect()
+{
+  int64_t value = readInt();
+
+  Effect effect;
+  effect.initialized = (value & 1) != 0;
+  effect.effect = static_cast<int32_t>((value - (value & 1)) / 2);
+  return effect;
+}
+
+size_t SnapshotReader::readCount(size_t minElementSize)
+{
+  uint64_t count = readUInt();
+  if (count > (length - offset) / minElementSize)
+  {
+    setError();
+    return 0;
+  }
+
+  return static_cast<size_t>(count);
+}
+
+void SnapshotReader::setError()
+{
+  error = true;
+  offset = length;
+}
+
+bool SnapshotReader::hasError() const
+{
+  return error;
+}
+
+bool SnapshotReader::isAtEnd() const
+{
+  return offset == length;
+}
\ No newline at end of file
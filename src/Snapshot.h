@@ -0,0 +1,81 @@
+#pragma once
+#include "Timestamp.h"
+#include "NodeId.h"
+#include "NodeType.h"
+#include "Effect.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//Compact binary encoding used by Core snapshots
+//Integers are written as LEB128 varints (zigzag encoded when signed), and
+//  node types are collected into a table written ahead of the data so each
+//  use of a type only costs its index
+class SnapshotWriter
+{
+public:
+  void writeUInt(uint64_t value);
+  void writeInt(int64_t value);
+  void writeBytes(const void * data, size_t length);
+  void writeString(const std::string_view & value);
+  void writeTimestamp(const Timestamp & ts);
+  void writeNodeId(const NodeId & nodeId);
+  void writeNodeType(const NodeType & type);
+  void writeEffect(const Effect & effect);
+
+  template <class T>
+  void writeValue(const T & value)
+  {
+    writeBytes(&value, sizeof(T));
+  }
+
+  //appends the type table followed by everything written so far
+  void finish(std::basic_string<char> & output) const;
+
+private:
+  std::basic_string<char> data;
+  std::unordered_map<NodeType, uint32_t> typeIndices;
+  std::vector<NodeType> types;
+};
+
+//Reads data written by SnapshotWriter
+//Reading past the end or reading malformed data sets an error flag and
+//  returns empty values, so a whole structure can be read before checking
+class SnapshotReader
+{
+public:
+  SnapshotReader(const std::string_view & data);
+
+  uint64_t readUInt();
+  int64_t readInt();
+  bool readBytes(void * data, size_t length);
+  std::string_view readString();
+  Timestamp readTimestamp();
+  NodeId readNodeId();
+  NodeType readNodeType();
+  Effect readEffect();
+  //an element count, checked against the remaining data so corrupt counts
+  //  can't cause huge allocations
+  size_t readCount(size_t minElementSize = 1);
+
+  template <class T>
+  T readValue()
+  {
+    T value = T();
+    readBytes(&value, sizeof(T));
+    return value;
+  }
+
+  void setError();
+  bool hasError() const;
+  bool isAtEnd() const;
+
+private:
+  const char * data;
+  size_t length;
+  size_t offset = 0;
+  bool error = false;
+  std::vector<NodeType> types;
+};
\ No newline at end of file
@@ -4,13 +4,13 @@
 bool TransformOperationStream::write(const RefCounted<const LogOperation> & data)
 {
   size_t size = data->getSize();
-  auto clone = reinterpret_cast<LogOperation *>(new uint8_t[size]);
-  memcpy(clone, &(*data), size);
+  auto clone = RefCounted<LogOperation>::Allocate(size);
+  memcpy(&(*clone), &(*data), size);
 
   clone->ts = transformTimestamp(clone->ts);
   transformOperation(&clone->op);
 
-  writeToDestination(RefCounted<const LogOperation>(clone));
+  writeToDestination(RefCounted<const LogOperation>(std::move(clone)));
 
   // writeToDestination(data);
 
@@ -84,92 +84,98 @@ void TypeLogGenerator::findAllNodes(const Core * core, const NodeId & rootId,
     return;
   }
 
-  NodeType baseType = node->getBaseType();
-
-  if (baseType == PrimitiveNodeTypes::Set())
+  switch (node->getPrimitiveType())
   {
-    auto setNode = static_cast<const SetNode *>(node);
-    for (auto edge = setNode->children; edge != nullptr; edge = edge->next)
+    case PrimitiveNodeTypes::PrimitiveType::Set:
     {
-      if (edge->childId.isPending())
+      auto setNode = static_cast<const SetNode *>(node);
+      for (auto edge = setNode->children; edge != nullptr; edge = edge->next)
       {
-        continue;
-      }
+        if (edge->childId.isPending())
+        {
+          continue;
+        }
 
-      TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
+        TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
+      }
+      break;
     }
-  }
-  else if (baseType == PrimitiveNodeTypes::List())
-  {
-    auto listNode = static_cast<const ListNode *>(node);
-    for (auto edge = listNode->children; edge != nullptr; edge = edge->nextChild)
+    case PrimitiveNodeTypes::PrimitiveType::List:
     {
-      if (edge->childId.isPending())
+      auto listNode = static_cast<const ListNode *>(node);
+      for (auto edge = listNode->children; edge != nullptr; edge = edge->nextChild)
       {
-        continue;
-      }
+        if (edge->childId.isPending())
+        {
+          continue;
+        }
 
-      TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
+        TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
+      }
+      break;
     }
-  }
-  else if (baseType == PrimitiveNodeTypes::Map())
-  {
-    auto mapNode = static_cast<const MapNode *>(node);
-    for (auto it = mapNode->children.begin(); it != mapNode->children.end(); ++it)
+    case PrimitiveNodeTypes::PrimitiveType::Map:
     {
-      MapEdge * edge = it->second.front();
-
-      if (edge->childId.isPending())
+      auto mapNode = static_cast<const MapNode *>(node);
+      for (auto it = mapNode->children.begin(); it != mapNode->children.end(); ++it)
       {
-        continue;
-      }
+        MapEdge * edge = it->second.front();
+
+        if (edge->childId.isPending())
+        {
+          continue;
+        }
 
-      TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
+        TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
+      }
+      break;
     }
-  }
-  else if (baseType == PrimitiveNodeTypes::Reference())
-  {
-    auto referenceNode = static_cast<const ReferenceNode *>(node);
-    for (auto edge = referenceNode->children; edge != nullptr; edge = edge->next)
+    case PrimitiveNodeTypes::PrimitiveType::Reference:
     {
-      //in references, deleted items are still in the children list,
-      //  so visibility must be checked (in other containers, this is not true)
-      if (edge->childId.isPending() || !edge->effect.isVisible())
+      auto referenceNode = static_cast<const ReferenceNode *>(node);
+      for (auto edge = referenceNode->children; edge != nullptr; edge = edge->next)
       {
-        continue;
-      }
+        if (edge->childId.isPending())
+        {
+          continue;
+        }
 
-      TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
+        TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
 
-      //only add the first visible item
+        //only add the first visible item
+        break;
+      }
       break;
     }
-  }
-  else if (baseType == PrimitiveNodeTypes::OrderedFloat64Map())
-  {
-    auto mapNode = static_cast<const OrderedFloat64MapNode *>(node);
-    for (auto it = mapNode->children.begin(); it != mapNode->children.end(); ++it)
+    case PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map:
     {
-      EdgeId edgeId = it->second.front();
-      Edge * edge = mapNode->getExistingEdge(edgeId);
-
-      if (edge->childId.isPending())
+      auto mapNode = static_cast<const OrderedFloat64MapNode *>(node);
+      for (auto it = mapNode->children.begin(); it != mapNode->children.end(); ++it)
       {
-        continue;
-      }
+        EdgeId edgeId = it->second.front();
+        Edge * edge = mapNode->getExistingEdge(edgeId);
+
+        if (edge->childId.isPending())
+        {
+          continue;
+        }
 
-      TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
+        TypeLogGenerator::findAllNodes(core, edge->childId, nodeMap, filterFn);
+      }
+      break;
     }
+    default:
+      break;
   }
 }
 
 RefCounted<LogOperation> TypeLogGenerator::getOpBuffer(size_t opSize)
 {
   size_t size = LogOperation::getSizeWithoutOp() + opSize;
-  auto op = reinterpret_cast<LogOperation *>(new uint8_t[size]);
+  auto op = RefCounted<LogOperation>::Allocate(size);
   op->tag = Tag::Default();
   op->ts = Timestamp::Null;
-  return RefCounted<LogOperation>(op);
+  return op;
 }
 
 NodeId TypeLogGenerator::generateTypeLog(const Core * core,
@@ -188,7 +194,7 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
 
   const Node * node = core->getExistingNode(nodeId);
   NodeId nodeIdTransformed;
-  NodeType baseType = node->getBaseType();
+  auto primitiveType = node->getPrimitiveType();
 
   if (!nodeId.isInherited() ||
     addedNodes.find({ nodeId.ts, node->createdByRootOffset }) == addedNodes.end())
@@ -197,7 +203,7 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
 
     NodeType nodeType = node->getType();
 
-    if (PrimitiveNodeTypes::isContainerNodeType(node->getBaseType()) &&
+    if (PrimitiveNodeTypes::isContainerPrimitiveType(primitiveType) &&
       static_cast<const ContainerNode *>(node)->childType.definedByType == PrimitiveNodeTypes::Null())
     {
       auto container = static_cast<const ContainerNode *>(node);
@@ -249,7 +255,7 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
 
   addedNodes[nodeId] = nodeIdTransformed;
 
-  if (PrimitiveNodeTypes::isValueNodeType(baseType))
+  if (PrimitiveNodeTypes::isValuePrimitiveType(primitiveType))
   {
     bool hasAllRootTypeData = !nodeId.isInherited() ||
       addedNodes.find(nodeId.getInheritanceRoot()) != addedNodes.end();
@@ -273,8 +279,7 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
       }
     };
 
-    auto valueType = PrimitiveNodeTypes::nodeTypeToPrimitiveType(baseType);
-    switch (valueType)
+    switch (primitiveType)
     {
       case PrimitiveNodeTypes::PrimitiveType::BoolValue:
         generateValueSetOp(static_cast<const ValueNode<bool> *>(node));
@@ -298,12 +303,11 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
         break;
     }
   }
-  else if (PrimitiveNodeTypes::isBlockValueNodeType(baseType))
+  else if (primitiveType == PrimitiveNodeTypes::PrimitiveType::StringValue)
   {
-    if (baseType == PrimitiveNodeTypes::StringValue())
+    if (primitiveType == PrimitiveNodeTypes::PrimitiveType::StringValue)
     {
       auto blockValueNode = static_cast<const BlockValueNode<char> *>(node);
-      const BlockData<char> * data = blockValueNode->value.getChildren();
       std::string currentBlock;
       uint32_t offset = 0;
 
@@ -354,23 +358,24 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
         }
       }
 
-      while (data != nullptr)
+      blockValueNode->value.forEachInsertRange([&](const Timestamp & blockId, uint32_t blockOffset,
+        const BlockData<char> * data, uint32_t start, uint32_t length)
       {
         if (data->effect.isVisible())
         {
-          if (data->id == nodeId.ts && hasAllRootTypeData)
+          if (blockId == nodeId.ts && hasAllRootTypeData)
           {
             flushBlock();
-            offset += data->length;
+            offset += length;
           }
           else
           {
-            currentBlock.append(data->value, data->length);
+            currentBlock.append(data->value + start, length);
           }
         }
         else
         {
-          if (data->id == nodeId.ts && hasAllRootTypeData)
+          if (blockId == nodeId.ts && hasAllRootTypeData)
           {
             ++ts;
             size_t size = sizeof(BlockValueDeleteAfterOperation);
@@ -379,23 +384,21 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
             op->type = OperationType::BlockValueDeleteAfterOperation;
             op->nodeId = nodeIdTransformed;
             op->blockId = nodeIdTransformed.ts;
-            op->offset = data->offset;
-            op->length = data->length;
+            op->offset = blockOffset;
+            op->length = length;
             logStream.write(*reinterpret_cast<RefCounted<const LogOperation> *>(&tsOp));
 
-            offset += data->length;
+            offset += length;
           }
         }
-
-        data = data->nextSibling;
-      }
+      });
 
       flushBlock();
     }
   }
-  else if (PrimitiveNodeTypes::isContainerNodeType(baseType))
+  else if (PrimitiveNodeTypes::isContainerPrimitiveType(primitiveType))
   {
-    if (baseType == PrimitiveNodeTypes::Set())
+    if (primitiveType == PrimitiveNodeTypes::PrimitiveType::Set)
     {
       auto setNode = static_cast<const SetNode *>(node);
 
@@ -444,7 +447,7 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
         prevEdgeId = NodeId::inheritanceRootFor(ts);
       }
     }
-    else if (baseType == PrimitiveNodeTypes::List())
+    else if (primitiveType == PrimitiveNodeTypes::PrimitiveType::List)
     {
       auto listNode = static_cast<const ListNode *>(node);
 
@@ -497,7 +500,7 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
         prevEdgeId = NodeId::inheritanceRootFor(ts);
       }
     }
-    else if (baseType == PrimitiveNodeTypes::Map())
+    else if (primitiveType == PrimitiveNodeTypes::PrimitiveType::Map)
     {
       auto mapNode = static_cast<const MapNode *>(node);
       for (auto it = mapNode->children.begin(); it != mapNode->children.end(); ++it)
@@ -553,13 +556,13 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
         logStream.write(*reinterpret_cast<RefCounted<const LogOperation> *>(&tsOp));
       }
     }
-    else if (baseType == PrimitiveNodeTypes::Reference())
+    else if (primitiveType == PrimitiveNodeTypes::PrimitiveType::Reference)
     {
       auto referenceNode = static_cast<const ReferenceNode *>(node);
 
       for (auto edge = referenceNode->children; edge != nullptr; edge = edge->next)
       {
-        if (edge->childId.isPending() || !edge->effect.isVisible())
+        if (edge->childId.isPending())
         {
           continue;
         }
@@ -587,7 +590,7 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
         break;
       }
     }
-    else if (baseType == PrimitiveNodeTypes::OrderedFloat64Map())
+    else if (primitiveType == PrimitiveNodeTypes::PrimitiveType::OrderedFloat64Map)
     {
       auto mapNode = static_cast<const OrderedFloat64MapNode *>(node);
       for (auto it = mapNode->children.begin(); it != mapNode->children.end(); ++it)
@@ -665,4 +668,4 @@ NodeId TypeLogGenerator::generateTypeLog(const Core * core,
   }
 
   return nodeIdTransformed;
-}
\ No newline at end of file
+}
\ No newline at end of file
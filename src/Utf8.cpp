@@ -0,0 +1,359 @@
+#include "Utf8.h"
+#include <bit>
+#include <cstdint>
+
+//x86-64 always has SSE2; AVX2 is used when the CPU has it
+#if defined(__x86_64__) && defined(__GNUC__)
+#define UTF8_SSE2
+#define UTF8_AVX2
+#include <immintrin.h>
+#elif defined(__wasm_simd128__)
+#define UTF8_WASM_SIMD
+#include <wasm_simd128.h>
+#endif
+
+static inline size_t getCodeUnits(char c)
+{
+  if ((c & 0xC0) == 0x80)
+  {
+    return 0;
+  }
+  return (c & 0xF8) == 0xF0 ? 2 : 1;
+}
+
+size_t Utf8ToUtf16LengthScalar(const char * str, size_t length)
+{
+  size_t utf16Length = 0;
+
+  for (size_t i = 0; i < length; i++)
+  {
+    utf16Length += getCodeUnits(str[i]);
+  }
+
+  return utf16Length;
+}
+
+size_t Utf8FindUtf16OffsetScalar(const char * str, size_t length, size_t codeUnits)
+{
+  size_t utf16Offset = 0;
+  size_t i = 0;
+
+  if (codeUnits == 0)
+  {
+    return 0;
+  }
+
+  while (i < length)
+  {
+    utf16Offset += getCodeUnits(str[i]);
+    i++;
+
+    if (utf16Offset >= codeUnits)
+    {
+      //the rest of the character
+      while (i < length && (str[i] & 0xC0) == 0x80)
+      {
+        i++;
+      }
+      return i;
+    }
+  }
+
+  return length;
+}
+
+//the vector kernels count code units per byte as 1, minus 1 for continuation
+//  bytes (signed < -64) and plus 1 for 4 byte leads
+//lengths sum these per lane for up to 127 blocks (at most 2 per block) before
+//  widening; offsets skip whole blocks until the one holding the code unit
+
+#ifdef UTF8_SSE2
+static inline __m128i getContinuationMask(__m128i v)
+{
+  return _mm_cmplt_epi8(v, _mm_set1_epi8(-64));
+}
+
+static inline __m128i getLead4Mask(__m128i v)
+{
+  return _mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8(static_cast<char>(0xF8))),
+    _mm_set1_epi8(static_cast<char>(0xF0)));
+}
+
+static size_t lengthSse2(const char * str, size_t length)
+{
+  size_t utf16Length = 0;
+  size_t i = 0;
+
+  while (i + 16 <= length)
+  {
+    __m128i counts = _mm_setzero_si128();
+    for (size_t blocks = 0; blocks < 127 && i + 16 <= length; blocks++, i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+      __m128i units = _mm_sub_epi8(_mm_add_epi8(_mm_set1_epi8(1), getContinuationMask(v)), getLead4Mask(v));
+      counts = _mm_add_epi8(counts, units);
+    }
+
+    __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+    utf16Length += static_cast<size_t>(_mm_cvtsi128_si64(sums)) + _mm_extract_epi16(sums, 4);
+  }
+
+  return utf16Length + Utf8ToUtf16LengthScalar(str + i, length - i);
+}
+
+static size_t findOffsetSse2(const char * str, size_t length, size_t codeUnits)
+{
+  size_t utf16Offset = 0;
+  size_t i = 0;
+
+  while (i + 16 <= length)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+    unsigned continuation = static_cast<unsigned>(_mm_movemask_epi8(getContinuationMask(v)));
+    unsigned lead4 = static_cast<unsigned>(_mm_movemask_epi8(getLead4Mask(v)));
+    size_t units = 16 - std::popcount(continuation) + std::popcount(lead4);
+
+    if (utf16Offset + units >= codeUnits)
+    {
+      break;
+    }
+
+    utf16Offset += units;
+    i += 16;
+  }
+
+  return i + Utf8FindUtf16OffsetScalar(str + i, length - i, codeUnits - utf16Offset);
+}
+#endif
+
+#ifdef UTF8_AVX2
+__attribute__((target("avx2,popcnt")))
+static inline __m256i getContinuationMaskAvx2(__m256i v)
+{
+  return _mm256_cmpgt_epi8(_mm256_set1_epi8(-64), v);
+}
+
+__attribute__((target("avx2,popcnt")))
+static inline __m256i getLead4MaskAvx2(__m256i v)
+{
+  return _mm256_cmpeq_epi8(_mm256_and_si256(v, _mm256_set1_epi8(static_cast<char>(0xF8))),
+    _mm256_set1_epi8(static_cast<char>(0xF0)));
+}
+
+__attribute__((target("avx2,popcnt")))
+static size_t lengthAvx2(const char * str, size_t length)
+{
+  size_t utf16Length = 0;
+  size_t i = 0;
+
+  while (i + 32 <= length)
+  {
+    __m256i counts = _mm256_setzero_si256();
+    for (size_t blocks = 0; blocks < 127 && i + 32 <= length; blocks++, i += 32)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + i));
+      __m256i units = _mm256_sub_epi8(_mm256_add_epi8(_mm256_set1_epi8(1), getContinuationMaskAvx2(v)), getLead4MaskAvx2(v));
+      counts = _mm256_add_epi8(counts, units);
+    }
+
+    __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+    __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    utf16Length += static_cast<size_t>(_mm_cvtsi128_si64(halves)) + _mm_extract_epi16(halves, 4);
+  }
+
+  return utf16Length + lengthSse2(str + i, length - i);
+}
+
+__attribute__((target("avx2,popcnt")))
+static size_t findOffsetAvx2(const char * str, size_t length, size_t codeUnits)
+{
+  size_t utf16Offset = 0;
+  size_t i = 0;
+
+  while (i + 32 <= length)
+  {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + i));
+    unsigned continuation = static_cast<unsigned>(_mm256_movemask_epi8(getContinuationMaskAvx2(v)));
+    unsigned lead4 = static_cast<unsigned>(_mm256_movemask_epi8(getLead4MaskAvx2(v)));
+    size_t units = 32 - __builtin_popcount(continuation) + __builtin_popcount(lead4);
+
+    if (utf16Offset + units >= codeUnits)
+    {
+      break;
+    }
+
+    utf16Offset += units;
+    i += 32;
+  }
+
+  return i + findOffsetSse2(str + i, length - i, codeUnits - utf16Offset);
+}
+
+static bool hasAvx2()
+{
+  static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+  return supported;
+}
+#endif
+
+#ifdef UTF8_WASM_SIMD
+static inline v128_t getContinuationMask(v128_t v)
+{
+  return wasm_i8x16_lt(v, wasm_i8x16_splat(-64));
+}
+
+static inline v128_t getLead4Mask(v128_t v)
+{
+  return wasm_i8x16_eq(wasm_v128_and(v, wasm_i8x16_splat(static_cast<int8_t>(0xF8))),
+    wasm_i8x16_splat(static_cast<int8_t>(0xF0)));
+}
+
+static size_t lengthWasm(const char * str, size_t length)
+{
+  size_t utf16Length = 0;
+  size_t i = 0;
+
+  while (i + 16 <= length)
+  {
+    v128_t counts = wasm_i8x16_splat(0);
+    for (size_t blocks = 0; blocks < 127 && i + 16 <= length; blocks++, i += 16)
+    {
+      v128_t v = wasm_v128_load(str + i);
+      v128_t units = wasm_i8x16_sub(wasm_i8x16_add(wasm_i8x16_splat(1), getContinuationMask(v)), getLead4Mask(v));
+      counts = wasm_i8x16_add(counts, units);
+    }
+
+    v128_t sums = wasm_u32x4_extadd_pairwise_u16x8(wasm_u16x8_extadd_pairwise_u8x16(counts));
+    utf16Length += wasm_u32x4_extract_lane(sums, 0) + wasm_u32x4_extract_lane(sums, 1)
+      + wasm_u32x4_extract_lane(sums, 2) + wasm_u32x4_extract_lane(sums, 3);
+  }
+
+  return utf16Length + Utf8ToUtf16LengthScalar(str + i, length - i);
+}
+
+static size_t findOffsetWasm(const char * str, size_t length, size_t codeUnits)
+{
+  size_t utf16Offset = 0;
+  size_t i = 0;
+
+  while (i + 16 <= length)
+  {
+    v128_t v = wasm_v128_load(str + i);
+    unsigned continuation = wasm_i8x16_bitmask(getContinuationMask(v));
+    unsigned lead4 = wasm_i8x16_bitmask(getLead4Mask(v));
+    size_t units = 16 - std::popcount(continuation) + std::popcount(lead4);
+
+    if (utf16Offset + units >= codeUnits)
+    {
+      break;
+    }
+
+    utf16Offset += units;
+    i += 16;
+  }
+
+  return i + Utf8FindUtf16OffsetScalar(str + i, length - i, codeUnits - utf16Offset);
+}
+#endif
+
+size_t Utf8ToUtf16Length(const char * str, size_t length)
+{
+#if defined(UTF8_AVX2)
+  if (hasAvx2())
+  {
+    return lengthAvx2(str, length);
+  }
+#endif
+#if defined(UTF8_SSE2)
+  return lengthSse2(str, length);
+#elif defined(UTF8_WASM_SIMD)
+  return lengthWasm(str, length);
+#else
+  return Utf8ToUtf16LengthScalar(str, length);
+#endif
+}
+
+size_t Utf8FindUtf16Offset(const char * str, size_t length, size_t codeUnits)
+{
+  if (codeUnits == 0)
+  {
+    return 0;
+  }
+
+#if defined(UTF8_AVX2)
+  if (hasAvx2())
+  {
+    return findOffsetAvx2(str, length, codeUnits);
+  }
+#endif
+#if defined(UTF8_SSE2)
+  return findOffsetSse2(str, length, codeUnits);
+#elif defined(UTF8_WASM_SIMD)
+  return findOffsetWasm(str, length, codeUnits);
+#else
+  return Utf8FindUtf16OffsetScalar(str, length, codeUnits);
+#endif
+}
+
+void Utf8AppendUtf16(std::u16string & out, const char * str, size_t length)
+{
+  size_t i = 0;
+
+  while (i < length)
+  {
+    unsigned char c = static_cast<unsigned char>(str[i]);
+
+    if (c <= 127)
+    {
+      out.push_back(c);
+      i++;
+      continue;
+    }
+
+    uint32_t codePoint;
+    size_t size;
+    if ((c & 0xC0) == 0x80)
+    {
+      //continuation byte without a lead byte
+      i++;
+      continue;
+    }
+    else if ((c & 0xE0) == 0xC0) { codePoint = c & 0x1F; size = 2; }
+    else if ((c & 0xF0) == 0xE0) { codePoint = c & 0x0F; size = 3; }
+    else if ((c & 0xF8) == 0xF0) { codePoint = c & 0x07; size = 4; }
+    else
+    {
+      out.push_back(0xFFFD);
+      i++;
+      continue;
+    }
+
+    size_t read = 1;
+    while (read < size && i + read < length && (str[i + read] & 0xC0) == 0x80)
+    {
+      codePoint = (codePoint << 6) | (str[i + read] & 0x3F);
+      read++;
+    }
+    i += read;
+
+    if (read < size)
+    {
+      //truncated, but still the same number of code units
+      out.push_back(0xFFFD);
+      if (size == 4)
+      {
+        out.push_back(0xFFFD);
+      }
+    }
+    else if (size == 4)
+    {
+      codePoint -= 0x10000;
+      out.push_back(static_cast<char16_t>(0xD800 + ((codePoint >> 10) & 0x3FF)));
+      out.push_back(static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF)));
+    }
+    else
+    {
+      out.push_back(static_cast<char16_t>(codePoint));
+    }
+  }
+}
\ No newline at end of file
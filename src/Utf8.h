@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+//UTF-8 to UTF-16 conversion for block values
+//All of these treat invalid input the same way, so lengths always match the
+//  converted text: continuation bytes without a lead byte are skipped, and
+//  every other byte starts a character of 2 code units for a 4 byte lead
+//  (F0-F7) and 1 otherwise
+
+//number of UTF-16 code units in the text
+size_t Utf8ToUtf16Length(const char * str, size_t length);
+//byte offset just past the character holding code unit number codeUnits
+//  (counting from 1), or length if the text is shorter
+size_t Utf8FindUtf16Offset(const char * str, size_t length, size_t codeUnits);
+void Utf8AppendUtf16(std::u16string & out, const char * str, size_t length);
+
+//byte at a time versions of the above (the vectorized ones use them for the
+//  tails of the text)
+size_t Utf8ToUtf16LengthScalar(const char * str, size_t length);
+size_t Utf8FindUtf16OffsetScalar(const char * str, size_t length, size_t codeUnits);
\ No newline at end of file
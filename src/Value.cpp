@@ -1,6 +1,8 @@
 #include "Value.h"
 #include "NodeId.h"
 #include "Json.h"
+#include "Snapshot.h"
+#include "VectorTimestamp.h"
 
 template <class T>
 const Data<T> * Value<T>::getData() const
@@ -202,6 +204,56 @@ void Value<T>::deleteValue(const Timestamp & timestamp, ChangedCallback callback
   }
 }
 
+template <class T>
+bool Value<T>::compact(const VectorTimestamp & horizon, const Timestamp & baseTs,
+  const std::unordered_set<NodeId> & pinned)
+{
+  bool complete = true;
+  bool superseded = false;
+  bool keptBase = false;
+
+  auto it = children.before_begin();
+  for (auto next = children.begin(); next != children.end();)
+  {
+    bool isStable = horizon >= next->id
+      && pinned.find(NodeId::inheritanceRootFor(next->id)) == pinned.end();
+    bool isBase = !(baseTs < next->id);
+
+    bool keep;
+    if (!isStable)
+    {
+      keep = true;
+      complete = false;
+    }
+    else if (!next->effect.isVisible())
+    {
+      //an uninitialized entry still has to meet its set operation
+      keep = !next->effect.isInitialized();
+    }
+    else
+    {
+      keep = !superseded || (isBase && !keptBase);
+    }
+
+    if (!keep)
+    {
+      next = children.erase_after(it);
+      continue;
+    }
+
+    if (isStable && next->effect.isVisible())
+    {
+      superseded = true;
+      keptBase = keptBase || isBase;
+    }
+
+    it = next;
+    ++next;
+  }
+
+  return complete;
+}
+
 template <class T>
 Data<T> * Value<T>::getChild(const Timestamp & timestamp)
 {
@@ -260,6 +312,34 @@ void Value<T>::compareAndCallIfChanged(const Data<T> * newData,
   }
 }
 
+template <class T>
+void Value<T>::saveSnapshot(SnapshotWriter & writer) const
+{
+  writer.writeUInt(std::distance(children.begin(), children.end()));
+  for (const auto & data : children)
+  {
+    writer.writeTimestamp(data.id);
+    writer.writeEffect(data.effect);
+    writer.writeValue(data.value);
+  }
+}
+
+template <class T>
+void Value<T>::loadSnapshot(SnapshotReader & reader)
+{
+  children.clear();
+
+  size_t count = reader.readCount();
+  auto it = children.before_begin();
+  for (size_t i = 0; i < count && !reader.hasError(); i++)
+  {
+    Timestamp id = reader.readTimestamp();
+    Effect effect = reader.readEffect();
+    T value = reader.readValue<T>();
+    it = children.insert_after(it, { id, effect, value });
+  }
+}
+
 template <class T>
 std::string Value<T>::toString() const
 {
@@ -1,7 +1,13 @@
 #pragma once
 #include "Timestamp.h"
+#include "NodeId.h"
 #include "Effect.h"
 #include <forward_list>
+#include <unordered_set>
+
+class SnapshotWriter;
+class SnapshotReader;
+class VectorTimestamp;
 
 template <class T>
 struct Data
@@ -32,9 +38,19 @@ public:
   void updateEffect(const Timestamp & timestamp, int delta, ChangedCallback callback);
   void deinitializeValue(const Timestamp & timestamp, ChangedCallback callback);
   void deleteValue(const Timestamp & timestamp, ChangedCallback callback);
+  //drops entries at or below the horizon that can no longer affect the value
+  //  (removed ones, and visible ones hidden behind a newer stable entry)
+  //  while keeping what getValue(baseTs) reads; pinned entries ({ id, 0 })
+  //  may still be undone so they are kept
+  //returns false if some entries couldn't be checked yet
+  bool compact(const VectorTimestamp & horizon, const Timestamp & baseTs,
+    const std::unordered_set<NodeId> & pinned);
 
   std::string toString() const;
   std::string toString(const T & value) const;
+
+  void saveSnapshot(SnapshotWriter & writer) const;
+  void loadSnapshot(SnapshotReader & reader);
 private:
   std::forward_list<Data<T>> children;
 
@@ -1,223 +1,482 @@
 #include "VectorTimestamp.h"
+#include <thread>
 
-VectorTimestamp::VectorTimestamp()
+static std::string vectorToString(const uint32_t * values, size_t length)
+{
+  std::string outString;
+
+  for (size_t i = 0; i < length; i++)
+  {
+    outString += std::to_string(values[i]);
+    if (i + 1 != length)
+    {
+      outString += ",";
+    }
+  }
+
+  return outString;
+}
+
+VectorTimestampSnapshot::VectorTimestampSnapshot()
+{
+  static const std::shared_ptr<const Data> empty = std::make_shared<const Data>();
+  data = empty;
+}
+
+VectorTimestampSnapshot::VectorTimestampSnapshot(std::shared_ptr<const Data> data)
+  : data(std::move(data)) {}
+
+bool VectorTimestampSnapshot::isEmpty() const
+{
+  return data->value.size() == 0;
+}
+
+bool VectorTimestampSnapshot::operator==(const VectorTimestampSnapshot & rhs) const
+{
+  return data == rhs.data || data->value == rhs.data->value;
+}
+
+bool VectorTimestampSnapshot::operator<(const Timestamp & rhs) const
+{
+  return getClockAtSite(rhs.site) < rhs.clock;
+}
+
+bool VectorTimestampSnapshot::operator>=(const Timestamp & rhs) const
+{
+  return getClockAtSite(rhs.site) >= rhs.clock;
+}
+
+uint32_t VectorTimestampSnapshot::getClockAtSite(uint32_t site) const
+{
+  if (site < data->value.size())
+  {
+    return data->value[site];
+  }
+
+  return 0;
+}
+
+uint32_t VectorTimestampSnapshot::getMaxClock() const
+{
+  return data->max;
+}
+
+const std::vector<uint32_t> & VectorTimestampSnapshot::getVector() const
 {
-  value = std::vector<uint32_t>();
-  max = 0;
+  return data->value;
 }
 
+std::string VectorTimestampSnapshot::toString() const
+{
+  return vectorToString(data->value.data(), data->value.size());
+}
+
+VectorTimestamp::Buffer::Buffer(uint32_t capacity, Buffer * previous)
+  : capacity(capacity), values(new std::atomic<uint32_t>[capacity]), previous(previous) {}
+
+VectorTimestamp::Buffer::~Buffer()
+{
+  delete[] values;
+}
+
+VectorTimestamp::VectorTimestamp()
+  : buffer(nullptr), size(0), max(0), sequence(0), snapshotSequence(1) {}
+
 VectorTimestamp::VectorTimestamp(const VectorTimestamp & other)
-  : VectorTimestamp(other.getVector()) {}
+  : VectorTimestamp()
+{
+  other.read([&](const std::atomic<uint32_t> * values, uint32_t length)
+  {
+    reserve(length);
+    Buffer * current = buffer.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < length; i++)
+    {
+      current->values[i].store(values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    size.store(length, std::memory_order_relaxed);
+    max.store(other.max.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  });
+}
+
+VectorTimestamp::VectorTimestamp(const VectorTimestampSnapshot & snapshot)
+  : VectorTimestamp()
+{
+  const std::vector<uint32_t> & vector = snapshot.getVector();
+  assign(vector.data(), static_cast<uint32_t>(vector.size()));
+}
 
 VectorTimestamp::VectorTimestamp(const std::vector<uint32_t> & vector)
-  : VectorTimestamp(reinterpret_cast<const uint8_t *>(vector.data()), vector.size() * sizeof(uint32_t)) {}
+  : VectorTimestamp()
+{
+  assign(vector.data(), static_cast<uint32_t>(vector.size()));
+}
 
 VectorTimestamp::VectorTimestamp(const uint8_t * data, size_t length)
+  : VectorTimestamp()
 {
-  const uint32_t * array = reinterpret_cast<const uint32_t *>(data);
-  size_t arrayLength = length / sizeof(uint32_t);
-  value.assign(array, array + arrayLength);
+  assign(reinterpret_cast<const uint32_t *>(data), static_cast<uint32_t>(length / sizeof(uint32_t)));
+}
 
-  uint32_t dataMax = 0;
-  for (auto it = value.rbegin(); it != value.rend(); ++it)
+VectorTimestamp::~VectorTimestamp()
+{
+  Buffer * current = buffer.load(std::memory_order_relaxed);
+  while (current != nullptr)
   {
-    if (*it > dataMax)
-    {
-      if (dataMax == 0 && it != value.rbegin())
-      {
-        //prune extraneous 0 values
-        value.resize(value.size() - (it - value.rbegin()));
-      }
-      dataMax = *it;
-    }
+    Buffer * previous = current->previous;
+    delete current;
+    current = previous;
   }
+}
 
-  if (dataMax == 0)
+//calls callback with a consistent view of the values, retrying if a write
+//  happened in the meantime; callback must only read and may run more than once
+template <class F>
+void VectorTimestamp::read(F callback) const
+{
+  while (true)
   {
-    value.clear();
-  }
+    uint32_t start = sequence.load(std::memory_order_acquire);
+    if (start & 1)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    uint32_t length = size.load(std::memory_order_acquire);
+    Buffer * current = buffer.load(std::memory_order_acquire);
+    callback(current != nullptr ? current->values : nullptr, length);
 
-  max = dataMax;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence.load(std::memory_order_relaxed) == start)
+    {
+      return;
+    }
+  }
 }
 
-bool VectorTimestamp::isEmpty() const
+//there is only one writer, so the sequence doesn't need a read-modify-write
+void VectorTimestamp::beginWrite()
 {
-  std::unique_lock<std::mutex> lock(mutex);
+  sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
 
-  return value.size() == 0;
+void VectorTimestamp::endWrite()
+{
+  sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
 }
 
-VectorTimestamp & VectorTimestamp::operator=(const VectorTimestamp & other)
+void VectorTimestamp::reserve(uint32_t length)
 {
-  std::scoped_lock<std::mutex, std::mutex> lock(mutex, other.mutex);
+  Buffer * current = buffer.load(std::memory_order_relaxed);
+  uint32_t capacity = (current != nullptr) ? current->capacity : 0;
+  if (length <= capacity)
+  {
+    return;
+  }
 
-  value = other.value;
-  max = other.max;
+  uint32_t newCapacity = capacity * 2;
+  if (newCapacity < length)
+  {
+    newCapacity = length;
+  }
+  if (newCapacity < 4)
+  {
+    newCapacity = 4;
+  }
 
-  return *this;
+  Buffer * newBuffer = new Buffer(newCapacity, current);
+  uint32_t currentSize = size.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < currentSize; i++)
+  {
+    newBuffer->values[i].store(current->values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+
+  //published before the size grows, so a reader that sees the new size
+  //  also sees the new buffer
+  buffer.store(newBuffer, std::memory_order_release);
 }
 
-bool VectorTimestamp::operator<(const VectorTimestamp & rhs) const
+void VectorTimestamp::assign(const uint32_t * array, uint32_t arrayLength)
 {
-  std::scoped_lock<std::mutex, std::mutex> lock(mutex, rhs.mutex);
-
-  if (value.size() < rhs.value.size())
+  //prune extraneous 0 values
+  uint32_t length = arrayLength;
+  while (length > 0 && array[length - 1] == 0)
   {
-    return true;
+    length--;
   }
 
-  for (uint32_t i = 0; i < rhs.value.size(); i++)
+  uint32_t dataMax = 0;
+  reserve(length);
+  Buffer * current = buffer.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < length; i++)
   {
-    if (value[i] < rhs.value[i])
+    current->values[i].store(array[i], std::memory_order_relaxed);
+    if (array[i] > dataMax)
     {
-      return true;
+      dataMax = array[i];
     }
   }
 
-  return false;
+  size.store(length, std::memory_order_release);
+  max.store(dataMax, std::memory_order_relaxed);
 }
 
-bool VectorTimestamp::operator==(const VectorTimestamp & rhs) const
+bool VectorTimestamp::isEmpty() const
 {
-  std::scoped_lock<std::mutex, std::mutex> lock(mutex, rhs.mutex);
+  return size.load(std::memory_order_acquire) == 0;
+}
 
-  if (value.size() != rhs.value.size())
+VectorTimestamp & VectorTimestamp::operator=(const VectorTimestamp & other)
+{
+  if (&other == this)
   {
-    return false;
+    return *this;
   }
 
-  for (uint32_t i = 0; i < rhs.value.size(); i++)
+  beginWrite();
+
+  //every attempt overwrites everything, so the last (consistent) one wins
+  other.read([&](const std::atomic<uint32_t> * values, uint32_t length)
   {
-    if (value[i] != rhs.value[i])
+    reserve(length);
+    Buffer * current = buffer.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < length; i++)
     {
-      return false;
+      current->values[i].store(values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
     }
-  }
+    size.store(length, std::memory_order_release);
+    max.store(other.max.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  });
 
-  return true;
+  endWrite();
+
+  return *this;
 }
 
-bool VectorTimestamp::operator<(const Timestamp & rhs) const
+bool VectorTimestamp::operator<(const VectorTimestamp & rhs) const
 {
-  std::unique_lock<std::mutex> lock(mutex);
+  bool result = false;
 
-  uint32_t clock = 0;
-  if (rhs.site < value.size())
+  read([&](const std::atomic<uint32_t> * values, uint32_t length)
   {
-    clock = value[rhs.site];
-  }
+    rhs.read([&](const std::atomic<uint32_t> * rhsValues, uint32_t rhsLength)
+    {
+      result = false;
+
+      if (length < rhsLength)
+      {
+        result = true;
+        return;
+      }
+
+      for (uint32_t i = 0; i < rhsLength; i++)
+      {
+        if (values[i].load(std::memory_order_relaxed) < rhsValues[i].load(std::memory_order_relaxed))
+        {
+          result = true;
+          return;
+        }
+      }
+    });
+  });
 
-  return clock < rhs.clock;
+  return result;
 }
 
-bool VectorTimestamp::operator>=(const Timestamp & rhs) const
+bool VectorTimestamp::operator==(const VectorTimestamp & rhs) const
 {
-  std::unique_lock<std::mutex> lock(mutex);
+  bool result = false;
 
-  uint32_t clock = 0;
-  if (rhs.site < value.size())
+  read([&](const std::atomic<uint32_t> * values, uint32_t length)
   {
-    clock = value[rhs.site];
-  }
+    rhs.read([&](const std::atomic<uint32_t> * rhsValues, uint32_t rhsLength)
+    {
+      result = false;
+
+      if (length != rhsLength)
+      {
+        return;
+      }
+
+      for (uint32_t i = 0; i < rhsLength; i++)
+      {
+        if (values[i].load(std::memory_order_relaxed) != rhsValues[i].load(std::memory_order_relaxed))
+        {
+          return;
+        }
+      }
+
+      result = true;
+    });
+  });
 
-  return clock >= rhs.clock;
+  return result;
 }
 
-void VectorTimestamp::update(const Timestamp & ts)
+bool VectorTimestamp::operator<(const Timestamp & rhs) const
 {
-  std::unique_lock<std::mutex> lock(mutex);
+  return getClockAtSite(rhs.site) < rhs.clock;
+}
 
+bool VectorTimestamp::operator>=(const Timestamp & rhs) const
+{
+  return getClockAtSite(rhs.site) >= rhs.clock;
+}
+
+void VectorTimestamp::update(const Timestamp & ts)
+{
+  uint32_t length = size.load(std::memory_order_relaxed);
   uint32_t clock = 0;
-  if (ts.site < value.size())
+  if (ts.site < length)
   {
-    clock = value[ts.site];
+    clock = buffer.load(std::memory_order_relaxed)->values[ts.site].load(std::memory_order_relaxed);
   }
-  else if (ts.clock > 0)
+
+  if (clock >= ts.clock)
   {
-    value.resize(ts.site + 1, 0);
+    return;
   }
 
-  if (clock < ts.clock)
-  {
-    value[ts.site] = ts.clock;
+  beginWrite();
 
-    if (max < ts.clock)
+  if (ts.site >= length)
+  {
+    reserve(ts.site + 1);
+    Buffer * current = buffer.load(std::memory_order_relaxed);
+    for (uint32_t i = length; i < ts.site; i++)
     {
-      max = ts.clock;
+      current->values[i].store(0, std::memory_order_relaxed);
     }
+    current->values[ts.site].store(ts.clock, std::memory_order_relaxed);
+    size.store(ts.site + 1, std::memory_order_release);
+  }
+  else
+  {
+    buffer.load(std::memory_order_relaxed)->values[ts.site].store(ts.clock, std::memory_order_relaxed);
   }
+
+  if (max.load(std::memory_order_relaxed) < ts.clock)
+  {
+    max.store(ts.clock, std::memory_order_relaxed);
+  }
+
+  endWrite();
 }
 
 void VectorTimestamp::set(const Timestamp & ts)
 {
-  std::unique_lock<std::mutex> lock(mutex);
+  uint32_t length = size.load(std::memory_order_relaxed);
+  if (ts.site >= length && ts.clock == 0)
+  {
+    //already 0
+    return;
+  }
+
+  beginWrite();
 
   uint32_t clock = 0;
-  if (ts.site < value.size())
+  if (ts.site < length)
   {
-    clock = value[ts.site];
+    clock = buffer.load(std::memory_order_relaxed)->values[ts.site].load(std::memory_order_relaxed);
+    buffer.load(std::memory_order_relaxed)->values[ts.site].store(ts.clock, std::memory_order_relaxed);
   }
-  else if (ts.clock > 0)
+  else
   {
-    value.resize(ts.site + 1, 0);
+    reserve(ts.site + 1);
+    Buffer * current = buffer.load(std::memory_order_relaxed);
+    for (uint32_t i = length; i < ts.site; i++)
+    {
+      current->values[i].store(0, std::memory_order_relaxed);
+    }
+    current->values[ts.site].store(ts.clock, std::memory_order_relaxed);
+    size.store(ts.site + 1, std::memory_order_release);
+    length = ts.site + 1;
   }
 
-  value[ts.site] = ts.clock;
-
-  if (clock == max && ts.clock < clock)
+  uint32_t currentMax = max.load(std::memory_order_relaxed);
+  if (clock == currentMax && ts.clock < clock)
   {
-    max = 0;
-    for (auto e : value)
+    Buffer * current = buffer.load(std::memory_order_relaxed);
+    currentMax = 0;
+    for (uint32_t i = 0; i < length; i++)
     {
-      if (e > max)
+      uint32_t e = current->values[i].load(std::memory_order_relaxed);
+      if (e > currentMax)
       {
-        max = e;
+        currentMax = e;
       }
     }
+    max.store(currentMax, std::memory_order_relaxed);
   }
-  else if (max < ts.clock)
+  else if (currentMax < ts.clock)
   {
-    max = ts.clock;
+    max.store(ts.clock, std::memory_order_relaxed);
   }
+
+  endWrite();
 }
 
 void VectorTimestamp::merge(const VectorTimestamp & other)
 {
-  std::scoped_lock<std::mutex, std::mutex> lock(mutex, other.mutex);
+  if (&other == this)
+  {
+    return;
+  }
+
+  //merging isn't idempotent across retries, so take a consistent copy first
+  std::vector<uint32_t> otherValues = other.getVector();
+  uint32_t otherLength = static_cast<uint32_t>(otherValues.size());
 
-  if (other.value.size() > value.size())
+  beginWrite();
+
+  uint32_t length = size.load(std::memory_order_relaxed);
+  if (otherLength > length)
   {
-    value.resize(other.value.size());
+    reserve(otherLength);
+    Buffer * current = buffer.load(std::memory_order_relaxed);
+    for (uint32_t i = length; i < otherLength; i++)
+    {
+      current->values[i].store(0, std::memory_order_relaxed);
+    }
+    size.store(otherLength, std::memory_order_release);
   }
 
-  for (int i = 0; i < other.value.size(); i++)
+  Buffer * current = buffer.load(std::memory_order_relaxed);
+  uint32_t currentMax = max.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < otherLength; i++)
   {
-    if (other.value[i] > value[i])
+    if (otherValues[i] > current->values[i].load(std::memory_order_relaxed))
     {
-      value[i] = other.value[i];
-      if (value[i] > max)
+      current->values[i].store(otherValues[i], std::memory_order_relaxed);
+      if (otherValues[i] > currentMax)
       {
-        max = value[i];
+        currentMax = otherValues[i];
       }
     }
   }
+  max.store(currentMax, std::memory_order_relaxed);
+
+  endWrite();
 }
 
 void VectorTimestamp::reset()
 {
-  std::unique_lock<std::mutex> lock(mutex);
+  beginWrite();
+
+  size.store(0, std::memory_order_release);
+  max.store(0, std::memory_order_relaxed);
 
-  value.clear();
-  max = 0;
+  endWrite();
 }
 
 uint32_t VectorTimestamp::getClockAtSite(uint32_t site) const
 {
-  std::unique_lock<std::mutex> lock(mutex);
-
-  if (site < value.size())
+  //the size is published after the buffer and the value, so this never reads
+  //  past the end of the buffer it loads
+  if (site < size.load(std::memory_order_acquire))
   {
-    return value[site];
+    return buffer.load(std::memory_order_acquire)->values[site].load(std::memory_order_relaxed);
   }
 
   return 0;
@@ -225,11 +484,9 @@ uint32_t VectorTimestamp::getClockAtSite(uint32_t site) const
 
 Timestamp VectorTimestamp::getTimestampAtSite(uint32_t site) const
 {
-  std::unique_lock<std::mutex> lock(mutex);
-
-  if (site < value.size())
+  if (site < size.load(std::memory_order_acquire))
   {
-    return Timestamp(value[site], site);
+    return Timestamp(getClockAtSite(site), site);
   }
 
   return Timestamp::Null;
@@ -237,37 +494,56 @@ Timestamp VectorTimestamp::getTimestampAtSite(uint32_t site) const
 
 uint32_t VectorTimestamp::getMaxClock() const
 {
-  std::unique_lock<std::mutex> lock(mutex);
-
-  return max;
+  return max.load(std::memory_order_relaxed);
 }
 
 std::vector<uint32_t> VectorTimestamp::getVector() const
 {
-  std::unique_lock<std::mutex> lock(mutex);
+  std::vector<uint32_t> result;
 
-  return value;
+  read([&](const std::atomic<uint32_t> * values, uint32_t length)
+  {
+    result.resize(length);
+    for (uint32_t i = 0; i < length; i++)
+    {
+      result[i] = values[i].load(std::memory_order_relaxed);
+    }
+  });
+
+  return result;
 }
 
-std::string VectorTimestamp::toString() const
+VectorTimestampSnapshot VectorTimestamp::getSnapshot() const
 {
-  std::unique_lock<std::mutex> lock(mutex);
-  std::string outString;
+  std::unique_lock<std::mutex> lock(snapshotMutex);
 
-  if (value.size() == 0)
+  uint32_t currentSequence = sequence.load(std::memory_order_acquire);
+  if ((currentSequence & 1) == 0 && currentSequence == snapshotSequence)
   {
-    return outString;
+    return snapshot;
   }
 
-  auto lastElement = std::prev(value.end());
-  for (auto it = value.begin(); it != value.end(); ++it)
+  auto data = std::make_shared<VectorTimestampSnapshot::Data>();
+  read([&](const std::atomic<uint32_t> * values, uint32_t length)
   {
-    outString += std::to_string(*it);
-    if (it != lastElement)
+    data->value.resize(length);
+    for (uint32_t i = 0; i < length; i++)
     {
-      outString += ",";
+      data->value[i] = values[i].load(std::memory_order_relaxed);
     }
-  }
+    data->max = max.load(std::memory_order_relaxed);
+    currentSequence = sequence.load(std::memory_order_relaxed);
+  });
 
-  return outString;
+  snapshot = VectorTimestampSnapshot(std::move(data));
+  snapshotSequence = currentSequence;
+
+  return snapshot;
+}
+
+std::string VectorTimestamp::toString() const
+{
+  std::vector<uint32_t> value = getVector();
+
+  return vectorToString(value.data(), value.size());
 }
\ No newline at end of file
@@ -1,17 +1,56 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
-#include <mutex>
 #include "Timestamp.h"
 
+//immutable copy of a vector clock; copies share the same storage
+class VectorTimestampSnapshot
+{
+public:
+  VectorTimestampSnapshot();
+
+  bool isEmpty() const;
+  bool operator==(const VectorTimestampSnapshot & rhs) const;
+  bool operator<(const Timestamp & rhs) const;
+  bool operator>=(const Timestamp & rhs) const;
+  uint32_t getClockAtSite(uint32_t site) const;
+  uint32_t getMaxClock() const;
+  const std::vector<uint32_t> & getVector() const;
+  std::string toString() const;
+
+private:
+  struct Data
+  {
+    std::vector<uint32_t> value;
+    uint32_t max = 0;
+  };
+
+  VectorTimestampSnapshot(std::shared_ptr<const Data> data);
+
+  std::shared_ptr<const Data> data;
+
+  friend class VectorTimestamp;
+};
+
+//Vector clock safe for one writer and any number of concurrent readers
+//Single site reads (getClockAtSite, comparison with a Timestamp, etc.) are
+//  lock-free and allocation-free; whole-vector reads use a sequence lock and
+//  retry if they overlap a write
+//Storage is only ever grown; replaced buffers are kept until destruction so
+//  readers never see freed memory
 class VectorTimestamp
 {
 public:
   VectorTimestamp();
   VectorTimestamp(const VectorTimestamp & other);
+  VectorTimestamp(const VectorTimestampSnapshot & snapshot);
   VectorTimestamp(const std::vector<uint32_t> & vector);
   VectorTimestamp(const uint8_t * data, size_t length);
+  ~VectorTimestamp();
 
   bool isEmpty() const;
   VectorTimestamp & operator=(const VectorTimestamp & other);
@@ -27,10 +66,34 @@ public:
   Timestamp getTimestampAtSite(uint32_t site) const;
   uint32_t getMaxClock() const;
   std::vector<uint32_t> getVector() const;
+  VectorTimestampSnapshot getSnapshot() const;
   std::string toString() const;
 
 private:
-  mutable std::mutex mutex;
-  std::vector<uint32_t> value;
-  uint32_t max;
+  struct Buffer
+  {
+    Buffer(uint32_t capacity, Buffer * previous);
+    ~Buffer();
+
+    uint32_t capacity;
+    std::atomic<uint32_t> * values;
+    Buffer * previous;
+  };
+
+  template <class F>
+  void read(F callback) const;
+  void beginWrite();
+  void endWrite();
+  void reserve(uint32_t size);
+  void assign(const uint32_t * array, uint32_t arrayLength);
+
+  std::atomic<Buffer *> buffer;
+  std::atomic<uint32_t> size;
+  std::atomic<uint32_t> max;
+  std::atomic<uint32_t> sequence;
+
+  //the last snapshot taken, reused until the clock changes
+  mutable std::mutex snapshotMutex;
+  mutable VectorTimestampSnapshot snapshot;
+  mutable uint32_t snapshotSequence;
 };
\ No newline at end of file
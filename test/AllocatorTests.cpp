@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <SlabAllocator.h>
+#include <ByteArena.h>
+#include <BlockValue.h>
+#include <cstring>
+#include <set>
+#include <string>
+
+struct SlabItem
+{
+  uint64_t value;
+  double weight;
+};
+
+TEST(AllocatorTest, SlabAllocatorReusesFreedObjects)
+{
+  SlabAllocator<SlabItem, 2> allocator;
+
+  SlabItem * first = allocator.create(SlabItem{ 1, 1.0 });
+  SlabItem * second = allocator.create(SlabItem{ 2, 2.0 });
+  allocator.destroy(first);
+  allocator.destroy(second);
+
+  //freed objects come back last in, first out, before any new slab is used
+  EXPECT_EQ(allocator.create(SlabItem{ 3, 3.0 }), second);
+  SlabItem * reused = allocator.create(SlabItem{ 4, 4.0 });
+  EXPECT_EQ(reused, first);
+  EXPECT_EQ(reused->value, 4u);
+
+  allocator.destroy(nullptr);
+}
+
+TEST(AllocatorTest, SlabAllocatorGrowsAndClears)
+{
+  SlabAllocator<SlabItem, 2> allocator;
+  std::set<SlabItem *> items;
+
+  //enough objects for several slabs of growing size
+  for (uint64_t i = 0; i < 1000; i++)
+  {
+    SlabItem * item = allocator.create(SlabItem{ i, 0.0 });
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(item) % alignof(SlabItem), 0u);
+    items.insert(item);
+  }
+  EXPECT_EQ(items.size(), 1000u);
+
+  //every object is still intact after the others were allocated
+  uint64_t sum = 0;
+  for (SlabItem * item : items)
+  {
+    sum += item->value;
+  }
+  EXPECT_EQ(sum, 999u * 1000u / 2);
+
+  //everything is released at once, and the allocator can be used again
+  allocator.clear();
+  SlabItem * item = allocator.create(SlabItem{ 5, 0.0 });
+  EXPECT_EQ(item->value, 5u);
+}
+
+TEST(AllocatorTest, ObjectPoolConstructsAndDestroysObjects)
+{
+  ObjectPool<std::string, 1> pool;
+
+  std::string * first = pool.create();
+  EXPECT_TRUE(first->empty());
+  first->assign(100, 'a');
+
+  std::string * second = pool.create();
+  second->assign("b");
+  EXPECT_NE(first, second);
+
+  //the freed storage holds a newly constructed object when reused
+  pool.destroy(first);
+  std::string * third = pool.create();
+  EXPECT_EQ(third, first);
+  EXPECT_TRUE(third->empty());
+
+  pool.destroy(second);
+  pool.destroy(third);
+}
+
+TEST(AllocatorTest, ByteArenaPacksSmallAllocations)
+{
+  ByteArena arena;
+
+  const uint8_t data[] = { 'a', 'b', 'c' };
+  char * first = arena.copy(data, sizeof(data));
+  char * second = arena.allocate(5);
+  EXPECT_EQ(std::string(first, sizeof(data)), "abc");
+  EXPECT_EQ(second, first + sizeof(data));
+  size_t chunkSize = arena.getAllocatedSize();
+
+  //a large allocation gets a chunk of its own, and small ones keep filling
+  //  the current chunk
+  char * large = arena.allocate(chunkSize);
+  std::memset(large, 'x', chunkSize);
+  EXPECT_EQ(arena.getAllocatedSize(), chunkSize * 2);
+  EXPECT_EQ(arena.allocate(1), second + 5);
+
+  //filling the current chunk starts a new one
+  arena.allocate(chunkSize - sizeof(data) - 6);
+  arena.allocate(1);
+  EXPECT_EQ(arena.getAllocatedSize(), chunkSize * 3);
+
+  arena.clear();
+  EXPECT_EQ(arena.getAllocatedSize(), 0u);
+  EXPECT_EQ(std::string(arena.copy(data, sizeof(data)), sizeof(data)), "abc");
+}
+
+TEST(AllocatorTest, ByteArenaMergeKeepsAllocations)
+{
+  ByteArena arena;
+  ByteArena other;
+
+  const uint8_t data[] = { 'a', 'b', 'c' };
+  char * first = arena.copy(data, sizeof(data));
+  char * second = other.copy(data, sizeof(data));
+  size_t allocatedSize = arena.getAllocatedSize() + other.getAllocatedSize();
+
+  //the other arena's data moves along with its chunks
+  arena.merge(other);
+  EXPECT_EQ(other.getAllocatedSize(), 0u);
+  EXPECT_EQ(arena.getAllocatedSize(), allocatedSize);
+  EXPECT_EQ(std::string(first, sizeof(data)), "abc");
+  EXPECT_EQ(std::string(second, sizeof(data)), "abc");
+
+  //both can still be used
+  EXPECT_NE(arena.allocate(1), nullptr);
+  EXPECT_EQ(std::string(other.copy(data, sizeof(data)), sizeof(data)), "abc");
+}
+
+//blocks refer to the inserted data, so the text has to outlive the value
+static void insertText(BlockValue<char> & value, size_t offset, const Timestamp & ts, const char * text)
+{
+  BlockValue<char>::ChangedCallback callback = [](size_t, char *, uint32_t){};
+  value.computeInsertions(offset, reinterpret_cast<const uint8_t *>(text), std::strlen(text),
+    [&](const Timestamp & blockId, uint32_t blockOffset, const uint8_t * data, uint32_t length)
+    {
+      value.insertAfter(blockId, blockOffset, ts, length, reinterpret_cast<const char *>(data), callback);
+    });
+}
+
+TEST(AllocatorTest, BlockValueReleasesAllBlocks)
+{
+  BlockValue<char> value;
+
+  //inserts in the middle, so there are blocks and splits to release
+  insertText(value, 0, Timestamp(1, 1), "Hello");
+  insertText(value, 2, Timestamp(2, 1), "Hello");
+  insertText(value, 1, Timestamp(3, 1), "Hello");
+  EXPECT_EQ(value.getLength(), 15u);
+
+  value.deleteAllBlocks();
+  EXPECT_EQ(value.getChildren(), nullptr);
+  EXPECT_EQ(value.getLength(), 0u);
+  EXPECT_EQ(value.getExistingBlock(Timestamp(1, 1)), nullptr);
+  EXPECT_EQ(value.getText(), "");
+
+  //the value can be filled again afterwards
+  insertText(value, 0, Timestamp(4, 1), "World");
+  EXPECT_EQ(value.getText(), "World");
+}
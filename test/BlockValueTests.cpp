@@ -864,4 +864,234 @@ TEST(BlockValueTest, GeneralFuzz)
 
     ASSERT_EQ(state_stack[i].second, result);
   }
-}
\ No newline at end of file
+}
+TEST(BlockValueTest, Utf16OffsetFuzz)
+{
+  CoreTestWrapper wrapper;
+
+  NodeId stringNodeId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+
+  //model the string as a list of characters so utf16 offsets can be computed
+  const std::vector<std::string> characters = { "a", "b", "\xCB\x9F", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+  std::vector<std::string> expected;
+
+  auto utf16Offset = [&](size_t index)
+  {
+    size_t offset = 0;
+    for (size_t i = 0; i < index; i++)
+    {
+      offset += (expected[i].length() == 4) ? 2 : 1;
+    }
+    return offset;
+  };
+
+  auto toString = [&]()
+  {
+    std::string out;
+    for (auto & character : expected)
+    {
+      out += character;
+    }
+    return out;
+  };
+
+  std::srand(200);
+  for (int i = 0; i < 2000; i++)
+  {
+    if (std::rand() % 3 != 0 || expected.size() == 0)
+    {
+      //mostly single character inserts, similar to typing
+      size_t index = std::rand() % (expected.size() + 1);
+      size_t count = (std::rand() % 8 == 0) ? 1 + std::rand() % 5 : 1;
+      std::string insert;
+      std::vector<std::string> inserted;
+      for (size_t j = 0; j < count; j++)
+      {
+        inserted.push_back(characters[std::rand() % characters.size()]);
+        insert += inserted.back();
+      }
+
+      wrapper.builder.insertText(stringNodeId, utf16Offset(index), insert);
+      expected.insert(expected.begin() + index, inserted.begin(), inserted.end());
+    }
+    else
+    {
+      size_t index = std::rand() % expected.size();
+      size_t count = 1 + std::rand() % std::min<size_t>(expected.size() - index, 4);
+
+      size_t start = utf16Offset(index);
+      wrapper.builder.deleteText(stringNodeId, start, utf16Offset(index + count) - start);
+      expected.erase(expected.begin() + index, expected.begin() + index + count);
+    }
+
+    auto & value = static_cast<const BlockValueNode<char> *>(
+      wrapper.core->getExistingNode(stringNodeId))->value;
+    std::string expectedString = toString();
+    ASSERT_EQ(expectedString, value.toString());
+    ASSERT_EQ(expectedString.length(), value.getLength());
+  }
+}
+
+TEST(BlockValueTest, CachedTextFollowsChanges)
+{
+  CoreTestWrapper wrapper;
+
+  NodeId stringNodeId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+
+  const std::vector<std::string> characters = { "a", "b", "\xCB\x9F", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+  const std::vector<std::u16string> utf16Characters = { u"a", u"b", u"˟", u"€", u"\U0001F600" };
+  std::vector<size_t> expected;
+
+  auto utf16Offset = [&](size_t index)
+  {
+    size_t offset = 0;
+    for (size_t i = 0; i < index; i++)
+    {
+      offset += utf16Characters[expected[i]].length();
+    }
+    return offset;
+  };
+
+  std::srand(300);
+  std::vector<Timestamp> timestamps;
+  for (int i = 0; i < 1000; i++)
+  {
+    if (std::rand() % 3 != 0 || expected.size() == 0)
+    {
+      size_t index = std::rand() % (expected.size() + 1);
+      size_t count = 1 + std::rand() % 3;
+      std::string insert;
+      std::vector<size_t> inserted;
+      for (size_t j = 0; j < count; j++)
+      {
+        inserted.push_back(std::rand() % characters.size());
+        insert += characters[inserted.back()];
+      }
+
+      timestamps.push_back(wrapper.group([&](OperationBuilder & builder) {
+        builder.insertText(stringNodeId, utf16Offset(index), insert);
+      }));
+      expected.insert(expected.begin() + index, inserted.begin(), inserted.end());
+    }
+    else
+    {
+      size_t index = std::rand() % expected.size();
+      size_t count = 1 + std::rand() % std::min<size_t>(expected.size() - index, 4);
+
+      size_t start = utf16Offset(index);
+      timestamps.push_back(wrapper.group([&](OperationBuilder & builder) {
+        builder.deleteText(stringNodeId, start, utf16Offset(index + count) - start);
+      }));
+      expected.erase(expected.begin() + index, expected.begin() + index + count);
+    }
+
+    //both caches stay warm, so every change is spliced into them
+    std::string expectedString;
+    std::u16string expectedUtf16;
+    for (size_t character : expected)
+    {
+      expectedString += characters[character];
+      expectedUtf16 += utf16Characters[character];
+    }
+    ASSERT_EQ(wrapper.core->getNodeBlockValueView(stringNodeId), expectedString);
+    ASSERT_EQ(wrapper.core->getNodeBlockValueUtf16View(stringNodeId), expectedUtf16);
+
+    std::u16string range;
+    size_t offset = expectedUtf16.size() / 3;
+    wrapper.core->getNodeBlockValueUtf16(range, stringNodeId, offset, 5);
+    ASSERT_EQ(range, expectedUtf16.substr(offset, 5));
+  }
+
+  //unapplying everything takes the cached text back to empty
+  for (auto it = timestamps.rbegin(); it != timestamps.rend(); it++)
+  {
+    unapplyOperation(wrapper, wrapper.log, *it);
+  }
+  EXPECT_EQ(wrapper.core->getNodeBlockValueView(stringNodeId), "");
+  EXPECT_EQ(wrapper.core->getNodeBlockValueUtf16View(stringNodeId), u"");
+
+  std::string range;
+  wrapper.core->getNodeBlockValue(range, stringNodeId, 10, 10);
+  EXPECT_EQ(range, "");
+}
+
+TEST(BlockValueTest, TypedTextIsCoalesced)
+{
+  CoreTestWrapper wrapper1;
+  CoreTestWrapper wrapper2;
+  wrapper2.builder.setSiteId(2);
+
+  NodeId stringNodeId = wrapper1.builder.createNode(PrimitiveNodeTypes::StringValue());
+  wrapper2.applyOpsFrom(wrapper1);
+
+  auto getBlockCount = [stringNodeId](const CoreTestWrapper & wrapper)
+  {
+    auto node = static_cast<const BlockValueNode<char> *>(wrapper.core->getExistingNode(stringNodeId));
+    size_t count = 0;
+    for (auto block = node->value.getChildren(); block != nullptr; block = block->nextSibling)
+    {
+      count++;
+    }
+    return count;
+  };
+
+  //one op per character, each continuing the last
+  std::string typed = "The quick brown fox jumps over the lazy dog";
+  std::vector<Timestamp> keystrokes;
+  for (size_t i = 0; i < typed.size(); i++)
+  {
+    keystrokes.push_back(wrapper1.group([&](OperationBuilder & builder) {
+      builder.insertText(stringNodeId, i, typed.substr(i, 1));
+    }));
+  }
+  wrapper2.applyOpsFrom(wrapper1);
+
+  EXPECT_EQ(getBlockCount(wrapper1), 1u);
+  EXPECT_EQ(getBlockCount(wrapper2), 1u);
+  ASSERT_EQ(wrapper2.getNodeBlockValue(stringNodeId), typed);
+
+  //ops from both sites still refer to the individual keystrokes
+  wrapper1.builder.insertText(stringNodeId, 4, "very ");
+  wrapper2.builder.insertText(stringNodeId, 10, "red ");
+  wrapper2.builder.deleteText(stringNodeId, 39, 5);
+
+  wrapper1.applyOpsFrom(wrapper2);
+  wrapper2.applyOpsFrom(wrapper1);
+
+  ASSERT_EQ(wrapper1.getNodeBlockValue(stringNodeId), "The very quick red brown fox jumps over the dog");
+  ASSERT_EQ(wrapper2.getNodeBlockValue(stringNodeId), "The very quick red brown fox jumps over the dog");
+
+  undoOperation(wrapper1, wrapper1.log, keystrokes[0]);
+  wrapper2.applyOpsFrom(wrapper1);
+  ASSERT_EQ(wrapper1.getNodeBlockValue(stringNodeId), "he very quick red brown fox jumps over the dog");
+  ASSERT_EQ(wrapper2.getNodeBlockValue(stringNodeId), "he very quick red brown fox jumps over the dog");
+
+  //a snapshot keeps the coalesced blocks, and later ops still apply to them
+  std::basic_string<char> snapshot;
+  ASSERT_TRUE(wrapper1.core->saveSnapshot(snapshot));
+  CoreTestWrapper wrapper3;
+  ASSERT_TRUE(wrapper3.core->loadSnapshot(snapshot));
+  EXPECT_EQ(getBlockCount(wrapper3), getBlockCount(wrapper1));
+
+  wrapper1.builder.deleteText(stringNodeId, 0, 8);
+  wrapper1.builder.insertText(stringNodeId, 39, " and cat");
+  wrapper3.applyOpsFrom(wrapper1);
+  ASSERT_EQ(wrapper1.getNodeBlockValue(stringNodeId), "quick red brown fox jumps over the dog and cat");
+  ASSERT_EQ(wrapper3.getNodeBlockValue(stringNodeId), "quick red brown fox jumps over the dog and cat");
+
+  //unapplying keystrokes takes them out one at a time
+  CoreTestWrapper wrapper4;
+  NodeId otherNodeId = wrapper4.builder.createNode(PrimitiveNodeTypes::StringValue());
+  keystrokes.clear();
+  for (size_t i = 0; i < 6; i++)
+  {
+    keystrokes.push_back(wrapper4.group([&](OperationBuilder & builder) {
+      builder.insertText(otherNodeId, i, std::string(1, 'a' + i));
+    }));
+  }
+  for (size_t i = keystrokes.size(); i > 0; i--)
+  {
+    unapplyOperation(wrapper4, wrapper4.log, keystrokes[i - 1]);
+    ASSERT_EQ(wrapper4.getNodeBlockValue(otherNodeId), std::string("abcdef").substr(0, i - 1));
+  }
+}
@@ -0,0 +1,289 @@
+#include <gtest/gtest.h>
+#include "helpers.h"
+
+static size_t getSnapshotSize(const CoreTestWrapper & wrapper)
+{
+  std::basic_string<char> snapshot;
+  EXPECT_TRUE(wrapper.core->saveSnapshot(snapshot));
+  return snapshot.size();
+}
+
+static size_t getBlockCount(const CoreTestWrapper & wrapper, const NodeId & nodeId)
+{
+  auto node = static_cast<const BlockValueNode<char> *>(wrapper.core->getExistingNode(nodeId));
+
+  size_t count = 0;
+  for (auto block = node->value.getChildren(); block != nullptr; block = block->nextSibling)
+  {
+    count++;
+  }
+  return count;
+}
+
+static size_t getEdgeCount(const CoreTestWrapper & wrapper, const NodeId & nodeId)
+{
+  return static_cast<const ListNode *>(wrapper.core->getExistingNode(nodeId))->edges.size();
+}
+
+TEST(CompactionTest, CompactionFreesRemovedState)
+{
+  CoreTestWrapper wrapper(nullptr, true);
+
+  NodeId listId = wrapper.builder.createNode(PrimitiveNodeTypes::List());
+  NodeId stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+  NodeId valueId = wrapper.builder.createNode(PrimitiveNodeTypes::Int32Value());
+
+  for (int i = 0; i < 20; i++)
+  {
+    NodeId childId = wrapper.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+    wrapper.builder.addChild(listId, childId, wrapper.builder.createPositionFromIndex(listId, i));
+    wrapper.builder.insertText(stringId, 0, "text ");
+    wrapper.builder.setValue<int32_t>(valueId, i);
+  }
+  for (int i = 0; i < 15; i++)
+  {
+    wrapper.builder.removeChild(listId, wrapper.getListNodeChildren(listId)[0].first);
+    wrapper.builder.deleteText(stringId, 0, 5);
+  }
+
+  auto children = wrapper.getListNodeChildren(listId);
+  std::string text = wrapper.getNodeBlockValue(stringId);
+  size_t size = getSnapshotSize(wrapper);
+
+  ASSERT_TRUE(wrapper.core->compact(wrapper.core->clock));
+
+  EXPECT_EQ(wrapper.getListNodeChildren(listId), children);
+  EXPECT_EQ(wrapper.getNodeBlockValue(stringId), text);
+  EXPECT_EQ(wrapper.getNodeValue<int32_t>(valueId), 19);
+  EXPECT_EQ(getEdgeCount(wrapper, listId), 5);
+  EXPECT_EQ(getBlockCount(wrapper, stringId), 5);
+  EXPECT_LT(getSnapshotSize(wrapper), size / 2);
+}
+
+TEST(CompactionTest, CompactedReplicaConverges)
+{
+  CoreTestWrapper wrapper(nullptr, true);
+  CoreTestWrapper replica(nullptr, true);
+
+  NodeId listId = wrapper.builder.createNode(PrimitiveNodeTypes::List());
+  NodeId mapId = wrapper.builder.createNode(PrimitiveNodeTypes::Map());
+  NodeId stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+  NodeId valueId = wrapper.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+
+  for (int round = 0; round < 10; round++)
+  {
+    for (int i = 0; i < 5; i++)
+    {
+      size_t count = wrapper.getListNodeChildren(listId).size();
+      NodeId childId = wrapper.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+      wrapper.builder.addChild(listId, childId,
+        wrapper.builder.createPositionFromIndex(listId, (round * 7 + i) % (count + 1)));
+      wrapper.builder.addChild(mapId, childId, std::to_string(i));
+
+      size_t length = wrapper.getNodeBlockValue(stringId).size();
+      wrapper.builder.insertText(stringId, (round * 13 + i) % (length + 1), "abcd");
+      wrapper.builder.setValue<double>(valueId, round * 10 + i);
+    }
+
+    auto children = wrapper.getListNodeChildren(listId);
+    wrapper.builder.removeChild(listId, children[round % children.size()].first);
+    wrapper.builder.removeChild(listId, children[(round * 3) % children.size()].first);
+    size_t length = wrapper.getNodeBlockValue(stringId).size();
+    wrapper.builder.deleteText(stringId, (round * 5) % (length - 6), 6);
+
+    //the replica has seen everything the next operations depend on
+    replica.applyOpsFrom(wrapper);
+    ASSERT_TRUE(replica.core->compact(replica.core->clock));
+
+    EXPECT_EQ(replica.getListNodeChildren(listId), wrapper.getListNodeChildren(listId));
+    EXPECT_EQ(replica.getMapNodeChildren(mapId), wrapper.getMapNodeChildren(mapId));
+    EXPECT_EQ(replica.getNodeBlockValue(stringId), wrapper.getNodeBlockValue(stringId));
+    EXPECT_EQ(replica.getNodeValue<double>(valueId), wrapper.getNodeValue<double>(valueId));
+  }
+
+  EXPECT_LT(getSnapshotSize(replica), getSnapshotSize(wrapper));
+}
+
+TEST(CompactionTest, UndoAboveHorizonWorks)
+{
+  CoreTestWrapper wrapper(nullptr, true);
+
+  NodeId listId = wrapper.builder.createNode(PrimitiveNodeTypes::List());
+  NodeId stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+  NodeId valueId = wrapper.builder.createNode(PrimitiveNodeTypes::Int32Value());
+  NodeId childId = wrapper.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+  EdgeId edgeId = wrapper.builder.addChild(listId, childId, wrapper.builder.createPositionFromIndex(listId, 0));
+  wrapper.builder.insertText(stringId, 0, "hello world");
+  wrapper.builder.setValue<int32_t>(valueId, 1);
+
+  VectorTimestamp horizon = wrapper.core->clock;
+
+  Timestamp removeTs = wrapper.group([&](OperationBuilder & builder) {
+    builder.removeChild(listId, edgeId);
+  });
+  Timestamp deleteTs = wrapper.group([&](OperationBuilder & builder) {
+    builder.deleteText(stringId, 5, 6);
+  });
+  Timestamp setTs = wrapper.builder.setValue<int32_t>(valueId, 2);
+
+  ASSERT_TRUE(wrapper.core->compact(horizon));
+
+  //the operations are newer than the horizon, so their targets were kept
+  undoOperation(wrapper, wrapper.log, removeTs);
+  undoOperation(wrapper, wrapper.log, deleteTs);
+  undoOperation(wrapper, wrapper.log, setTs);
+
+  EXPECT_EQ(wrapper.getListNodeChildren(listId).size(), 1);
+  EXPECT_EQ(wrapper.getNodeBlockValue(stringId), "hello world");
+  EXPECT_EQ(wrapper.getNodeValue<int32_t>(valueId), 1);
+}
+
+TEST(CompactionTest, UndoBelowHorizonIsIgnored)
+{
+  CoreTestWrapper wrapper(nullptr, true);
+
+  NodeId valueId = wrapper.builder.createNode(PrimitiveNodeTypes::Int32Value());
+  NodeId stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+  wrapper.builder.setValue<int32_t>(valueId, 1);
+  Timestamp setTs = wrapper.builder.setValue<int32_t>(valueId, 2);
+  wrapper.builder.insertText(stringId, 0, "hello world");
+  Timestamp deleteTs = wrapper.group([&](OperationBuilder & builder) {
+    builder.deleteText(stringId, 0, 6);
+  });
+
+  ASSERT_TRUE(wrapper.core->compact(wrapper.core->clock));
+
+  undoOperation(wrapper, wrapper.log, setTs);
+  undoOperation(wrapper, wrapper.log, deleteTs);
+
+  EXPECT_EQ(wrapper.getNodeValue<int32_t>(valueId), 2);
+  EXPECT_EQ(wrapper.getNodeBlockValue(stringId), "world");
+}
+
+TEST(CompactionTest, SplitsAreMerged)
+{
+  CoreTestWrapper wrapper(nullptr, true);
+
+  NodeId stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+  wrapper.builder.insertText(stringId, 0, "hello world");
+  Timestamp deleteTs = wrapper.group([&](OperationBuilder & builder) {
+    builder.deleteText(stringId, 2, 3);
+    builder.deleteText(stringId, 4, 2);
+  });
+  undoOperation(wrapper, wrapper.log, deleteTs);
+  ASSERT_EQ(getBlockCount(wrapper, stringId), 5);
+
+  ASSERT_TRUE(wrapper.core->compact(wrapper.core->clock));
+  EXPECT_EQ(getBlockCount(wrapper, stringId), 1);
+  EXPECT_EQ(wrapper.getNodeBlockValue(stringId), "hello world");
+
+  //positions inside the merged block still work
+  wrapper.builder.insertText(stringId, 3, "-");
+  wrapper.builder.deleteText(stringId, 7, 2);
+  EXPECT_EQ(wrapper.getNodeBlockValue(stringId), "hel-lo rld");
+}
+
+TEST(CompactionTest, CompactFailsWhenNotReady)
+{
+  CoreTestWrapper wrapper(nullptr, true);
+  wrapper.types["type0"] = createTypeSpec([](OperationBuilder & builder)
+  {
+    builder.createNode(PrimitiveNodeTypes::Map());
+  }, wrapper.types);
+
+  wrapper.builder.createNode("type0");
+  EXPECT_FALSE(wrapper.core->compact(wrapper.core->clock));
+
+  wrapper.resolveTypes();
+  EXPECT_TRUE(wrapper.core->compact(wrapper.core->clock));
+
+  //the horizon can't be ahead of the clock
+  VectorTimestamp horizon = wrapper.core->clock;
+  horizon.update({ wrapper.core->clock.getClockAtSite(0) + 1, 0 });
+  EXPECT_FALSE(wrapper.core->compact(horizon));
+}
+
+TEST(CompactionTest, RecordsAreOnlyKeptWhenEnabled)
+{
+  CoreTestWrapper wrapper;
+  CoreTestWrapper compactable(nullptr, true);
+
+  for (auto target : { &wrapper, &compactable })
+  {
+    NodeId valueId = target->builder.createNode(PrimitiveNodeTypes::Int32Value());
+    for (int i = 0; i < 20; i++)
+    {
+      target->builder.setValue<int32_t>(valueId, i);
+    }
+  }
+
+  //only the compactable core's snapshot has the records
+  EXPECT_LT(getSnapshotSize(wrapper), getSnapshotSize(compactable));
+  EXPECT_FALSE(wrapper.core->compact(wrapper.core->clock));
+  EXPECT_TRUE(compactable.core->compact(compactable.core->clock));
+}
+
+TEST(CompactionTest, SnapshotKeepsCompactionState)
+{
+  CoreTestWrapper wrapper(nullptr, true);
+
+  NodeId valueId = wrapper.builder.createNode(PrimitiveNodeTypes::Int32Value());
+  wrapper.builder.setValue<int32_t>(valueId, 1);
+  Timestamp setTs = wrapper.builder.setValue<int32_t>(valueId, 2);
+  ASSERT_TRUE(wrapper.core->compact(wrapper.core->clock));
+
+  std::basic_string<char> snapshot;
+  ASSERT_TRUE(wrapper.core->saveSnapshot(snapshot));
+
+  CoreTestWrapper loaded(nullptr, true);
+  ASSERT_TRUE(loaded.core->loadSnapshot(snapshot));
+
+  //the undo is ignored by the loaded core just like the original one
+  undoOperation(wrapper, wrapper.log, setTs);
+  loaded.applyOpsFrom(wrapper);
+  EXPECT_EQ(loaded.getNodeValue<int32_t>(valueId), 2);
+  EXPECT_EQ(wrapper.getNodeValue<int32_t>(valueId), 2);
+}
+
+TEST(CompactionTest, ReadViewsAreRetakenAfterCompaction)
+{
+  CoreTestWrapper wrapper(nullptr, true);
+
+  NodeId valueId = wrapper.builder.createNode(PrimitiveNodeTypes::Int32Value());
+  wrapper.builder.setValue<int32_t>(valueId, 1);
+
+  auto view = wrapper.core->createReadView();
+  ASSERT_NE(view, nullptr);
+  EXPECT_EQ(wrapper.core->createReadView(), view);
+
+  //the horizon is part of the view's state, so a shared view would be stale
+  ASSERT_TRUE(wrapper.core->compact(wrapper.core->clock));
+  EXPECT_NE(wrapper.core->createReadView(), view);
+}
+
+TEST(CompactionTest, CompactionFreesRemovedText)
+{
+  CoreTestWrapper wrapper(nullptr, true);
+
+  NodeId stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+
+  std::string chunk(1000, 'a');
+  for (int i = 0; i < 300; i++)
+  {
+    wrapper.builder.insertText(stringId, i * chunk.size(), chunk);
+  }
+  wrapper.builder.deleteText(stringId, 0, 290 * chunk.size());
+
+  std::string text = wrapper.getNodeBlockValue(stringId);
+  size_t size = wrapper.core->getBlockValueDataSize();
+
+  ASSERT_TRUE(wrapper.core->compact(wrapper.core->clock));
+
+  EXPECT_LT(wrapper.core->getBlockValueDataSize(), size / 2);
+  EXPECT_EQ(wrapper.getNodeBlockValue(stringId), text);
+
+  //the copied text can still be edited
+  wrapper.builder.insertText(stringId, text.size(), "end");
+  wrapper.builder.deleteText(stringId, 0, 1);
+  EXPECT_EQ(wrapper.getNodeBlockValue(stringId), text.substr(1) + "end");
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include "helpers.h"
+#include <CoreHost.h>
+#include <JsonBufferSerializer.h>
+#include <cstring>
+
+static std::vector<RefCounted<const LogOperation>> borrowOperations(const OperationLogStorage & log)
+{
+  std::vector<RefCounted<const LogOperation>> ops;
+  for (const auto & op : log)
+  {
+    ops.push_back(RefCounted<const LogOperation>::Borrow(reinterpret_cast<const LogOperation *>(op.data())));
+  }
+  return ops;
+}
+
+static std::vector<RefCounted<const LogOperation>> allocateOperations(const OperationLogStorage & log)
+{
+  std::vector<RefCounted<const LogOperation>> ops;
+  for (const auto & op : log)
+  {
+    auto copy = RefCounted<LogOperation>::Allocate(op.size());
+    std::memcpy(&*copy, op.data(), op.size());
+    ops.push_back(RefCounted<const LogOperation>(std::move(copy)));
+  }
+  return ops;
+}
+
+static std::string serializeSubtree(const Core & core, const NodeId & nodeId)
+{
+  JsonBufferSerializer json;
+  core.serializeSubtree(json, nodeId, true);
+  return std::string(json.result());
+}
+
+TEST(CoreHostTest, AppliesDocumentsIndependently)
+{
+  const size_t documentCount = 8;
+
+  std::vector<std::unique_ptr<CoreTestWrapper>> wrappers;
+  std::vector<NodeId> rootIds;
+  for (size_t i = 0; i < documentCount; i++)
+  {
+    auto wrapper = std::make_unique<CoreTestWrapper>();
+    NodeId mapId = wrapper->builder.createNode(PrimitiveNodeTypes::Map());
+    NodeId listId = wrapper->builder.createNode(PrimitiveNodeTypes::List());
+    NodeId stringId = wrapper->builder.createNode(PrimitiveNodeTypes::StringValue());
+    NodeId valueId = wrapper->builder.createNode(PrimitiveNodeTypes::Int32Value());
+    wrapper->builder.addChild(mapId, listId, "list");
+    wrapper->builder.addChild(mapId, stringId, "string");
+    wrapper->builder.addChild(mapId, valueId, "value");
+    for (size_t j = 0; j < 50 + i * 10; j++)
+    {
+      wrapper->builder.insertText(stringId, j, std::to_string(i % 10));
+      wrapper->builder.setValue<int32_t>(valueId, static_cast<int32_t>(i * 1000 + j));
+      NodeId itemId = wrapper->builder.createNode(PrimitiveNodeTypes::DoubleValue());
+      wrapper->builder.addChild(listId, itemId, wrapper->builder.createPositionFromIndex(listId, j / 2));
+    }
+    rootIds.push_back(mapId);
+    wrappers.push_back(std::move(wrapper));
+  }
+
+  std::vector<std::vector<RefCounted<const LogOperation>>> logs;
+  for (const auto & wrapper : wrappers)
+  {
+    logs.push_back(borrowOperations(wrapper->log));
+  }
+
+  CoreHost host(4);
+  EXPECT_EQ(host.getThreadCount(), 4);
+
+  std::vector<CoreHost::DocumentId> documentIds;
+  for (size_t i = 0; i < documentCount; i++)
+  {
+    documentIds.push_back(host.addDocument());
+  }
+  EXPECT_EQ(host.getDocumentCount(), documentCount);
+
+  //interleaved in small chunks, so documents are rescheduled while being applied
+  for (size_t offset = 0; ; offset += 7)
+  {
+    bool submitted = false;
+    for (size_t i = 0; i < documentCount; i++)
+    {
+      if (offset < logs[i].size())
+      {
+        size_t count = std::min<size_t>(7, logs[i].size() - offset);
+        host.submit(documentIds[i], std::span(logs[i].data() + offset, count));
+        submitted = true;
+      }
+    }
+    if (!submitted)
+    {
+      break;
+    }
+  }
+
+  host.wait();
+
+  for (size_t i = 0; i < documentCount; i++)
+  {
+    EXPECT_EQ(serializeSubtree(host.getCore(documentIds[i]), rootIds[i]),
+      serializeSubtree(*wrappers[i]->core, rootIds[i]));
+  }
+}
+
+TEST(CoreHostTest, PostRunsAfterEarlierOperations)
+{
+  CoreTestWrapper wrapper;
+
+  wrapper.types["type0"] = createTypeSpec([](OperationBuilder & builder)
+  {
+    NodeId rootId = builder.createNode(PrimitiveNodeTypes::Map());
+    NodeId stringId = builder.createNode(PrimitiveNodeTypes::StringValue());
+    builder.addChild(rootId, stringId, "text");
+    builder.insertText(stringId, 0, "inherited");
+  }, wrapper.types);
+
+  NodeId nodeId = wrapper.builder.createNode("type0");
+  wrapper.resolveTypes();
+  NodeId valueId = wrapper.builder.createNode(PrimitiveNodeTypes::Int32Value());
+  wrapper.builder.addChild(nodeId, valueId, "value");
+  wrapper.builder.setValue<int32_t>(valueId, 5);
+
+  auto ops = borrowOperations(wrapper.log);
+
+  CoreHost host(2);
+  CoreHost::DocumentId documentId = 0;
+  std::vector<std::string> requestedTypes;
+
+  //type specs are requested on a worker thread and resolved by a task
+  documentId = host.addDocument(CoreInit(
+    [&](const std::string & type)
+    {
+      requestedTypes.push_back(type);
+      host.post(documentId, [&, type](Core & core)
+      {
+        const auto & spec = wrapper.types[type];
+        core.resolveTypeSpec(type, reinterpret_cast<const Operation *>(spec.data()), spec.size());
+      });
+    },
+    [](const Event & event) {}));
+
+  std::vector<int32_t> seenValues;
+  host.submit(documentId, std::span(ops.data(), 1));
+  host.post(documentId, [&](Core & core)
+  {
+    seenValues.push_back(core.getExistingNode(valueId) == nullptr ? -1 : 0);
+  });
+  host.submit(documentId, std::span(ops.data() + 1, ops.size() - 1));
+  host.post(documentId, [&](Core & core)
+  {
+    seenValues.push_back(static_cast<int32_t>(core.getNodeValue(valueId)));
+  });
+
+  host.wait();
+
+  EXPECT_EQ(requestedTypes, std::vector<std::string>{ "type0" });
+  EXPECT_EQ(seenValues, (std::vector<int32_t>{ -1, 5 }));
+  std::string text;
+  host.getCore(documentId).getNodeBlockValue(text, NodeId{ nodeId.ts, 1 });
+  EXPECT_EQ(text, "inherited");
+}
+
+TEST(CoreHostTest, AllocatedOperationsCanBeSharedWithWorkers)
+{
+  CoreTestWrapper wrapper;
+
+  NodeId listId = wrapper.builder.createNode(PrimitiveNodeTypes::List());
+  NodeId stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+  for (size_t i = 0; i < 200; i++)
+  {
+    wrapper.builder.insertText(stringId, i, "a");
+    NodeId itemId = wrapper.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+    wrapper.builder.addChild(listId, itemId, wrapper.builder.createPositionFromIndex(listId, i / 2));
+  }
+
+  auto ops = allocateOperations(wrapper.log);
+
+  CoreHost host(4);
+  CoreHost::DocumentId documentId = host.addDocument();
+
+  //the submitting thread keeps copying and dropping the operations the
+  //  workers are holding and applying
+  std::vector<RefCounted<const LogOperation>> copies;
+  for (size_t i = 0; i < ops.size(); i++)
+  {
+    host.submit(documentId, ops[i]);
+    for (size_t j = 0; j <= i; j++)
+    {
+      copies.push_back(ops[j]);
+    }
+    copies.clear();
+  }
+
+  //the host holds the last references to the operations it hasn't applied
+  ops.clear();
+  host.wait();
+
+  EXPECT_EQ(serializeSubtree(host.getCore(documentId), listId), serializeSubtree(*wrapper.core, listId));
+  std::string text;
+  host.getCore(documentId).getNodeBlockValue(text, stringId);
+  EXPECT_EQ(text, wrapper.getNodeBlockValue(stringId));
+}
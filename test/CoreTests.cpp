@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <concepts> //might need g++-10 or another more recent-ish stdlib
 #include <Core.h>
+#include <Serialization/LogOperationSerialization.h>
 #include "helpers.h"
 
 TEST(CoreTest, InheritanceWorks)
@@ -167,4 +168,145 @@ TEST(CoreTest, GroupOperationsUpdateVectorClock)
   });
 
   EXPECT_EQ(wrapper.core->clock.getClockAtSite(1), 3);
-}
\ No newline at end of file
+}
+
+static std::vector<RefCounted<const LogOperation>> copyLog(const OperationLogStorage & log)
+{
+  std::vector<RefCounted<const LogOperation>> ops;
+  for (const auto & it : log)
+  {
+    auto opBuffer = new uint8_t[it.length()];
+    std::memcpy(opBuffer, it.data(), it.length());
+    ops.emplace_back(reinterpret_cast<const LogOperation *>(opBuffer));
+  }
+  return ops;
+}
+
+TEST(CoreTest, BatchApplyMatchesSequentialApply)
+{
+  CoreTestWrapper wrapper1;
+  CoreTestWrapper wrapper2;
+  CoreTestWrapper wrapper3;
+
+  wrapper1.types["type0"] = createTypeSpec([](OperationBuilder & builder)
+  {
+    NodeId rootId = builder.createNode(PrimitiveNodeTypes::Map());
+    builder.addChild(rootId, builder.createNode(PrimitiveNodeTypes::DoubleValue()), "key1");
+  }, wrapper1.types);
+  wrapper2.types = wrapper1.types;
+  wrapper3.types = wrapper1.types;
+
+  NodeId rootId = wrapper1.builder.createNode(PrimitiveNodeTypes::Map());
+  wrapper1.builder.addChild(NodeId::SiteRoot, rootId, "root");
+  wrapper1.group([&](OperationBuilder & builder)
+  {
+    builder.addChild(rootId, builder.createNode("type0"), "typed1");
+    builder.addChild(rootId, builder.createNode("type0"), "typed2");
+    NodeId valueId = builder.createNode(PrimitiveNodeTypes::DoubleValue());
+    builder.setValue<double>(valueId, 3.5);
+    builder.addChild(rootId, valueId, "value");
+  });
+  wrapper1.resolveTypes();
+
+  auto ops = copyLog(wrapper1.log);
+  for (const auto & op : ops)
+  {
+    wrapper2.core->applyOperation(op);
+  }
+  wrapper2.resolveTypes();
+
+  wrapper3.core->applyOperations(ops);
+  //type requests for the whole batch are made once
+  EXPECT_EQ(wrapper3.typeSpecsWaiting.size(), 1);
+  wrapper3.resolveTypes();
+
+  EXPECT_EQ(wrapper2.core->clock, wrapper1.core->clock);
+  EXPECT_EQ(wrapper3.core->clock, wrapper1.core->clock);
+
+  auto expected = wrapper1.getMapNodeChildren(rootId);
+  EXPECT_EQ(wrapper2.getMapNodeChildren(rootId), expected);
+  EXPECT_EQ(wrapper3.getMapNodeChildren(rootId), expected);
+  ASSERT_EQ(expected.count("value"), 1);
+  ASSERT_EQ(expected.count("typed1"), 1);
+  EXPECT_EQ(wrapper3.getNodeValue<double>(expected["value"].second), 3.5);
+  EXPECT_TRUE(wrapper3.core->getExistingNode(expected["typed1"].second)->effect.isVisible());
+}
+
+TEST(CoreTest, BatchApplyStreamDefersTypeRequests)
+{
+  CoreTestWrapper wrapper1;
+  CoreTestWrapper wrapper2;
+
+  wrapper1.types["type0"] = createTypeSpec([](OperationBuilder & builder)
+  {
+    builder.createNode(PrimitiveNodeTypes::Map());
+  }, wrapper1.types);
+  wrapper2.types = wrapper1.types;
+
+  NodeId id = wrapper1.builder.createNode("type0");
+  wrapper1.builder.createNode(PrimitiveNodeTypes::Map());
+  wrapper1.resolveTypes();
+
+  auto stream = wrapper2.core->createBatchApplyStream();
+  for (const auto & op : copyLog(wrapper1.log))
+  {
+    stream->write(op);
+  }
+  EXPECT_TRUE(wrapper2.typeSpecsWaiting.empty());
+
+  stream->close();
+  delete stream;
+  EXPECT_EQ(wrapper2.typeSpecsWaiting.size(), 1);
+
+  wrapper2.resolveTypes();
+  EXPECT_EQ(wrapper2.core->clock, wrapper1.core->clock);
+  EXPECT_TRUE(wrapper2.core->getExistingNode(id)->effect.isVisible());
+}
+
+TEST(CoreTest, BorrowedOperationsOutliveTheirBuffer)
+{
+  CoreTestWrapper wrapper1;
+  CoreTestWrapper wrapper2;
+
+  wrapper1.types["type0"] = createTypeSpec([](OperationBuilder & builder)
+  {
+    builder.createNode(PrimitiveNodeTypes::Map());
+  }, wrapper1.types);
+  wrapper2.types = wrapper1.types;
+
+  NodeId rootId = wrapper1.builder.createNode(PrimitiveNodeTypes::Map());
+  wrapper1.builder.addChild(NodeId::SiteRoot, rootId, "root");
+  NodeId typedId = wrapper1.builder.createNode("type0");
+  //waits on the type, so it's still pending once the input is gone
+  wrapper1.builder.addChild(rootId, typedId, "typed");
+  wrapper1.resolveTypes();
+
+  auto deserializer = std::unique_ptr<ILogOperationDeserializer>(
+    LogOperationSerialization::CreateDeserializer("standard_v1_full", DeserializeDirection::Forward));
+  ASSERT_TRUE(deserializer->setZeroCopy(true));
+  auto stream = std::unique_ptr<IWritableStream<RefCounted<const LogOperation>>>(
+    wrapper2.core->createBatchApplyStream());
+  deserializer->pipeTo(*stream);
+
+  auto serializer = std::unique_ptr<ILogOperationSerializer>(
+    LogOperationSerialization::CreateSerializer("standard_v1_full"));
+  std::string serialized;
+  CallbackWritableStream<std::string_view> output([&](const std::string_view & chunk)
+  {
+    serialized.append(chunk);
+  });
+  serializer->pipeTo(output);
+  for (const auto & op : copyLog(wrapper1.log))
+  {
+    serializer->write(op);
+  }
+
+  deserializer->write(serialized);
+  stream->close();
+  std::fill(serialized.begin(), serialized.end(), '\0');
+
+  wrapper2.resolveTypes();
+  EXPECT_EQ(wrapper2.core->clock, wrapper1.core->clock);
+  EXPECT_EQ(wrapper2.getMapNodeChildren(rootId), wrapper1.getMapNodeChildren(rootId));
+  EXPECT_TRUE(wrapper2.core->getExistingNode(typedId)->effect.isVisible());
+}
@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include <EventBatch.h>
+#include <JsonSerializer.h>
+#include "helpers.h"
+
+static NodeBlockValueInsertedEvent createInsert(const NodeId & nodeId, uint32_t offset, const std::string & text)
+{
+  NodeBlockValueInsertedEvent event;
+  event.ts = Timestamp(offset + 1, 1);
+  event.nodeId = nodeId;
+  event.offset = offset;
+  event.str = text.data();
+  event.length = text.size();
+  return event;
+}
+
+static NodeBlockValueDeletedEvent createDelete(const NodeId & nodeId, uint32_t offset, uint32_t length)
+{
+  NodeBlockValueDeletedEvent event;
+  event.ts = Timestamp(1, 1);
+  event.nodeId = nodeId;
+  event.offset = offset;
+  event.length = length;
+  return event;
+}
+
+template <class T>
+static T createEdgeEvent(const NodeId & parentId, const EdgeId & edgeId, const NodeId & childId, size_t index)
+{
+  T event;
+  event.parentId = parentId;
+  event.edgeId = edgeId;
+  event.childId = childId;
+  event.speculative = false;
+  event.index = index;
+  event.actualIndex = index;
+  return event;
+}
+
+static std::vector<const Event *> getEvents(const EventBatch & batch)
+{
+  std::vector<const Event *> events;
+  batch.forEach([&](const Event & event)
+  {
+    events.push_back(&event);
+  });
+  return events;
+}
+
+TEST(EventBatchTest, AdjacentInsertsAreMerged)
+{
+  NodeId nodeId(Timestamp(1, 1), 0);
+  EventBatch batch;
+
+  //typed one character at a time, then a character in the middle
+  for (const auto & [offset, text] : std::vector<std::pair<uint32_t, std::string>>{
+    { 3, "a" }, { 4, "\xF0\x9F\x98\x80" }, { 6, "b" }, { 4, "c" } })
+  {
+    batch.add(createInsert(nodeId, offset, text));
+  }
+
+  auto events = getEvents(batch);
+  ASSERT_EQ(events.size(), 1u);
+  auto * inserted = dynamic_cast<const NodeBlockValueInsertedEvent *>(events[0]);
+  ASSERT_NE(inserted, nullptr);
+  EXPECT_EQ(inserted->offset, 3u);
+  EXPECT_EQ(inserted->ts, Timestamp(4, 1));
+  EXPECT_EQ(std::string(inserted->str, inserted->length), "ac\xF0\x9F\x98\x80" "b");
+
+  //not touching the inserted text
+  batch.add(createInsert(nodeId, 9, "d"));
+  batch.add(createInsert(nodeId, 1, "e"));
+  EXPECT_EQ(batch.size(), 3u);
+}
+
+TEST(EventBatchTest, AdjacentDeletesAreMerged)
+{
+  NodeId nodeId(Timestamp(1, 1), 0);
+  EventBatch batch;
+
+  //backspace twice, then forward delete
+  batch.add(createDelete(nodeId, 5, 1));
+  batch.add(createDelete(nodeId, 4, 1));
+  batch.add(createDelete(nodeId, 4, 2));
+
+  auto events = getEvents(batch);
+  ASSERT_EQ(events.size(), 1u);
+  auto * deleted = dynamic_cast<const NodeBlockValueDeletedEvent *>(events[0]);
+  ASSERT_NE(deleted, nullptr);
+  EXPECT_EQ(deleted->offset, 4u);
+  EXPECT_EQ(deleted->length, 4u);
+
+  //an insert in between ends the run
+  batch.add(createInsert(nodeId, 4, "a"));
+  batch.add(createDelete(nodeId, 3, 1));
+  EXPECT_EQ(batch.size(), 3u);
+}
+
+TEST(EventBatchTest, ValueChangesAreCollapsed)
+{
+  NodeId first(Timestamp(1, 1), 0);
+  NodeId second(Timestamp(2, 1), 0);
+  EventBatch batch;
+
+  for (int32_t value = 0; value < 5; value++)
+  {
+    NodeValueChangedEvent<int32_t> event;
+    event.nodeId = first;
+    event.oldValue = value;
+    event.newValue = value + 1;
+    batch.add(event);
+  }
+
+  NodeValueChangedEvent<double> event;
+  event.nodeId = second;
+  event.oldValue = 1.0;
+  event.newValue = 2.0;
+  batch.add(event);
+
+  auto events = getEvents(batch);
+  ASSERT_EQ(events.size(), 2u);
+  auto * changed = dynamic_cast<const NodeValueChangedEvent<int32_t> *>(events[0]);
+  ASSERT_NE(changed, nullptr);
+  EXPECT_EQ(changed->nodeId, first);
+  EXPECT_EQ(changed->oldValue, 0);
+  EXPECT_EQ(changed->newValue, 5);
+  EXPECT_NE(dynamic_cast<const NodeValueChangedEvent<double> *>(events[1]), nullptr);
+}
+
+template <class T>
+static void expectValueChangesCollapsed(T first, T second, T third)
+{
+  NodeId nodeId(Timestamp(1, 1), 0);
+  EventBatch batch;
+
+  NodeValueChangedEvent<T> event;
+  event.nodeId = nodeId;
+  event.oldValue = first;
+  event.newValue = second;
+  batch.add(event);
+  event.oldValue = second;
+  event.newValue = third;
+  batch.add(event);
+
+  auto events = getEvents(batch);
+  ASSERT_EQ(events.size(), 1u);
+  auto * changed = dynamic_cast<const NodeValueChangedEvent<T> *>(events[0]);
+  ASSERT_NE(changed, nullptr);
+  EXPECT_EQ(changed->oldValue, first);
+  EXPECT_EQ(changed->newValue, third);
+}
+
+TEST(EventBatchTest, ValueChangesOfEveryTypeAreCollapsed)
+{
+  expectValueChangesCollapsed<bool>(false, true, false);
+  expectValueChangesCollapsed<double>(1.5, 2.5, 3.5);
+  expectValueChangesCollapsed<float>(1.5f, 2.5f, 3.5f);
+  expectValueChangesCollapsed<int32_t>(1, 2, 3);
+  expectValueChangesCollapsed<int64_t>(1, 2, INT64_MAX);
+  expectValueChangesCollapsed<int8_t>(1, -2, 3);
+}
+
+TEST(EventBatchTest, AddRemovePairsCancelOut)
+{
+  NodeId parentId(Timestamp(1, 1), 0);
+  NodeId childId(Timestamp(2, 1), 0);
+  EdgeId keptEdgeId(Timestamp(3, 1), 0);
+  EdgeId edgeId(Timestamp(4, 1), 0);
+  EventBatch batch;
+
+  batch.add(createEdgeEvent<NodeAddedEventOrdered>(parentId, keptEdgeId, childId, 0));
+  auto added = createEdgeEvent<NodeAddedEventOrdered>(parentId, edgeId, childId, 1);
+  auto removed = createEdgeEvent<NodeRemovedEventOrdered>(parentId, edgeId, childId, 1);
+
+  //added and removed, then removed (undone) and added again
+  batch.add(added);
+  batch.add(removed);
+  EXPECT_EQ(batch.size(), 1u);
+  batch.add(removed);
+  batch.add(added);
+  EXPECT_EQ(batch.size(), 1u);
+
+  //the first edge is the parent's last event again, so it can cancel too
+  batch.add(createEdgeEvent<NodeRemovedEventOrdered>(parentId, keptEdgeId, childId, 0));
+  EXPECT_TRUE(batch.empty());
+
+  //a pair that moved the edge doesn't cancel
+  batch.add(added);
+  batch.add(createEdgeEvent<NodeRemovedEventOrdered>(parentId, edgeId, childId, 0));
+  EXPECT_EQ(batch.size(), 2u);
+
+  JsonSerializer serializer;
+  batch.serialize(serializer);
+  EXPECT_EQ(serializer.result().substr(0, 25), "[{\"eventType\":\"NodeAdded\"");
+}
+
+TEST(EventBatchTest, CoreDeliversBatches)
+{
+  //typed into a string one character at a time
+  CoreTestWrapper wrapper;
+  NodeId stringNodeId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue().toString());
+  std::string text = "Hello, World!";
+  for (size_t i = 0; i < text.size(); i++)
+  {
+    wrapper.group([&](OperationBuilder & builder)
+    {
+      builder.insertText(stringNodeId, i, text.substr(i, 1));
+    });
+  }
+
+  std::vector<std::string> inserts;
+  size_t batches = 0;
+  CoreInit coreInit = CoreInit::Batched([](const std::string & type){},
+    [&](const EventBatch & events)
+    {
+      batches++;
+      events.forEach([&](const Event & event)
+      {
+        if (auto * inserted = dynamic_cast<const NodeBlockValueInsertedEvent *>(&event))
+        {
+          inserts.push_back(std::string(inserted->str, inserted->length));
+        }
+      });
+    });
+  Core core(coreInit);
+
+  std::vector<RefCounted<const LogOperation>> ops;
+  forEachOp(wrapper.log, [&](const std::basic_string<char> & op)
+  {
+    ops.push_back(RefCounted<const LogOperation>::Borrow(reinterpret_cast<const LogOperation *>(op.data())));
+  });
+  core.applyOperations(ops);
+
+  EXPECT_EQ(batches, 1u);
+  ASSERT_EQ(inserts.size(), 1u);
+  EXPECT_EQ(inserts[0], text);
+}
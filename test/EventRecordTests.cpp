@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <EventRecord.h>
+#include <EventBatch.h>
+
+TEST(EventRecordTest, EventsAreWrittenAsRecords)
+{
+  NodeId parentId(Timestamp(1, 1), 0);
+  NodeId childId(Timestamp(2, 1), 0);
+  EdgeId edgeId(Timestamp(3, 1), 0);
+  EventRecordBuffer buffer;
+
+  NodeAddedEventMapped added;
+  added.parentId = parentId;
+  added.edgeId = edgeId;
+  added.childId = childId;
+  added.speculative = true;
+  added.key = "name";
+  buffer.add(added);
+
+  NodeRemovedEventOrdered removed;
+  removed.parentId = parentId;
+  removed.edgeId = edgeId;
+  removed.childId = childId;
+  removed.speculative = false;
+  removed.index = 4;
+  removed.actualIndex = 5;
+  buffer.add(removed);
+
+  NodeValueChangedEvent<double> changed;
+  changed.nodeId = childId;
+  changed.oldValue = 1.5;
+  changed.newValue = -2.0;
+  buffer.add(changed);
+
+  std::string text = "Hello";
+  NodeBlockValueInsertedEvent inserted;
+  inserted.ts = Timestamp(6, 1);
+  inserted.nodeId = childId;
+  inserted.offset = 3;
+  inserted.str = text.data();
+  inserted.length = text.size();
+  buffer.add(inserted);
+
+  NodeBlockValueDeletedEvent deleted;
+  deleted.ts = Timestamp(7, 1);
+  deleted.nodeId = childId;
+  deleted.offset = 1;
+  deleted.length = 2;
+  buffer.add(deleted);
+
+  //the records don't point into the buffer, so they can be copied anywhere
+  ASSERT_EQ(buffer.size(), 5u);
+  std::vector<EventRecord> records(buffer.size());
+  std::memcpy(records.data(), buffer.getRecords().data(), buffer.size() * sizeof(EventRecord));
+  std::string recordText = buffer.getText();
+  text = "Overwritten";
+  buffer.clear();
+
+  ASSERT_EQ(records[0].type, EventRecordType::NodeAdded);
+  EXPECT_EQ(records[0].edge.parentId, parentId);
+  EXPECT_EQ(records[0].edge.edgeId, edgeId);
+  EXPECT_EQ(records[0].edge.childId, childId);
+  EXPECT_TRUE(records[0].edge.speculative);
+  EXPECT_EQ(records[0].edge.kind, EventRecordEdgeKind::Mapped);
+  EXPECT_EQ(recordText.substr(records[0].edge.keyOffset, records[0].edge.keyLength), "name");
+
+  ASSERT_EQ(records[1].type, EventRecordType::NodeRemoved);
+  EXPECT_FALSE(records[1].edge.speculative);
+  EXPECT_EQ(records[1].edge.kind, EventRecordEdgeKind::Ordered);
+  EXPECT_EQ(records[1].edge.index, 4u);
+  EXPECT_EQ(records[1].edge.actualIndex, 5u);
+
+  ASSERT_EQ(records[2].type, EventRecordType::NodeValueChanged);
+  EXPECT_EQ(records[2].value.nodeId, childId);
+  EXPECT_EQ(records[2].value.valueType, EventRecordValueType::Double);
+  EXPECT_EQ(records[2].value.oldValue.doubleValue, 1.5);
+  EXPECT_EQ(records[2].value.newValue.doubleValue, -2.0);
+
+  ASSERT_EQ(records[3].type, EventRecordType::NodeBlockValueInserted);
+  EXPECT_EQ(records[3].blockValue.ts, Timestamp(6, 1));
+  EXPECT_EQ(records[3].blockValue.offset, 3u);
+  EXPECT_EQ(recordText.substr(records[3].blockValue.textOffset, records[3].blockValue.length), "Hello");
+
+  ASSERT_EQ(records[4].type, EventRecordType::NodeBlockValueDeleted);
+  EXPECT_EQ(records[4].blockValue.offset, 1u);
+  EXPECT_EQ(records[4].blockValue.length, 2u);
+}
+
+TEST(EventRecordTest, BatchesAreWrittenInOrder)
+{
+  NodeId nodeId(Timestamp(1, 1), 0);
+  std::string text = "ab";
+  EventBatch batch;
+
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    NodeBlockValueInsertedEvent inserted;
+    inserted.nodeId = nodeId;
+    inserted.offset = i;
+    inserted.str = text.data() + i;
+    inserted.length = 1;
+    batch.add(inserted);
+  }
+
+  NodeValueChangedEvent<int8_t> changed;
+  changed.nodeId = NodeId(Timestamp(2, 1), 0);
+  changed.oldValue = 1;
+  changed.newValue = 2;
+  batch.add(changed);
+
+  EventRecordBuffer buffer;
+  buffer.add(batch);
+
+  ASSERT_EQ(buffer.size(), 2u);
+  const auto & record = buffer.getRecords()[0].blockValue;
+  EXPECT_EQ(buffer.getText(record.textOffset, record.length), "ab");
+  EXPECT_EQ(buffer.getRecords()[1].value.valueType, EventRecordValueType::Int8);
+  EXPECT_EQ(buffer.getRecords()[1].value.newValue.int8Value, 2);
+}
@@ -448,4 +448,114 @@ TEST(ListNodeTest, GeneralFuzz)
   auto result = wrapper.getListNodeChildren(listNodeId);
   ASSERT_EQ(result, expected);
   ASSERT_EQ(eventResult, expected);
-}
\ No newline at end of file
+}
+
+static void expectIndexMatchesChildren(const CoreTestWrapper & wrapper, const NodeId & listId)
+{
+  auto listNode = static_cast<const ListNode *>(wrapper.core->getExistingNode(listId));
+
+  size_t actualIndex = 0;
+  for (auto edge = listNode->children; edge != nullptr; edge = edge->nextChild)
+  {
+    size_t foundIndex;
+    size_t foundActualIndex;
+    ASSERT_EQ(listNode->getChildAt(actualIndex), edge);
+    ASSERT_TRUE(listNode->findChildIndex(edge, foundIndex, foundActualIndex));
+    ASSERT_EQ(foundActualIndex, actualIndex);
+    actualIndex++;
+  }
+
+  ASSERT_EQ(listNode->getChildCount(), actualIndex);
+  ASSERT_EQ(listNode->getChildAt(actualIndex), nullptr);
+}
+
+TEST(ListNodeTest, PositionFromIndexSkipsNullChildren)
+{
+  CoreTestWrapper wrapper;
+
+  auto listNodeId = wrapper.builder.createNode(PrimitiveNodeTypes::List());
+  auto childId0 = wrapper.builder.createNode(PrimitiveNodeTypes::Abstract());
+  auto edgeId0 = wrapper.builder.addChild(listNodeId, childId0,
+    wrapper.builder.createPositionFromIndex(listNodeId, 0));
+  auto nullEdgeId = wrapper.builder.addChild(listNodeId, NodeId::Null,
+    wrapper.builder.createPositionFromIndex(listNodeId, 1));
+
+  //past the end goes after the last child, even a null one
+  auto childId1 = wrapper.builder.createNode(PrimitiveNodeTypes::Abstract());
+  auto edgeId1 = wrapper.builder.addChild(listNodeId, childId1,
+    wrapper.builder.createPositionFromIndex(listNodeId, 2));
+
+  //index 2 is after the second non-null child
+  auto childId2 = wrapper.builder.createNode(PrimitiveNodeTypes::Abstract());
+  auto edgeId2 = wrapper.builder.addChild(listNodeId, childId2,
+    wrapper.builder.createPositionFromIndex(listNodeId, 2));
+
+  //index 1 is after the first non-null child, before the null one
+  auto childId3 = wrapper.builder.createNode(PrimitiveNodeTypes::Abstract());
+  auto edgeId3 = wrapper.builder.addChild(listNodeId, childId3,
+    wrapper.builder.createPositionFromIndex(listNodeId, 1));
+
+  auto result = wrapper.getListNodeChildren(listNodeId);
+  ASSERT_EQ(result.size(), 5);
+  ASSERT_EQ(result[0].first, edgeId0);
+  ASSERT_EQ(result[1].first, edgeId3);
+  ASSERT_EQ(result[2].first, nullEdgeId);
+  ASSERT_EQ(result[2].second, NodeId::Null);
+  ASSERT_EQ(result[3].first, edgeId1);
+  ASSERT_EQ(result[4].first, edgeId2);
+}
+
+TEST(ListNodeTest, IndexFollowsConcurrentEdits)
+{
+  CoreTestWrapper wrapper1;
+  CoreTestWrapper wrapper2;
+  wrapper2.builder.setSiteId(2);
+
+  auto listId = wrapper1.builder.createNode(PrimitiveNodeTypes::List());
+  wrapper2.applyOpsFrom(wrapper1);
+
+  std::srand(1);
+  std::vector<Timestamp> added;
+  for (int i = 0; i < 2000; i++)
+  {
+    CoreTestWrapper & wrapper = (std::rand() & 1) ? wrapper1 : wrapper2;
+    auto children = wrapper.getListNodeChildren(listId);
+
+    int action = std::rand() % 8;
+    if (action < 5 || children.empty())
+    {
+      auto childId = wrapper.builder.createNode(PrimitiveNodeTypes::Abstract());
+      added.push_back(wrapper.builder.addChild(listId, childId,
+        wrapper.builder.createPositionFromIndex(listId, std::rand() % (children.size() + 1))).ts);
+    }
+    else if (action < 7)
+    {
+      wrapper.builder.removeChild(listId, children[std::rand() % children.size()].first);
+    }
+    else
+    {
+      wrapper1.applyOpsFrom(wrapper2);
+      wrapper2.applyOpsFrom(wrapper1);
+    }
+
+    expectIndexMatchesChildren(wrapper, listId);
+  }
+
+  wrapper1.applyOpsFrom(wrapper2);
+  wrapper2.applyOpsFrom(wrapper1);
+  ASSERT_EQ(wrapper1.getListNodeChildren(listId), wrapper2.getListNodeChildren(listId));
+
+  //positions are still found after unapplying and after loading a snapshot
+  for (size_t i = 0; i < added.size(); i += 7)
+  {
+    unapplyOperation(wrapper1, wrapper1.log, added[i]);
+  }
+  expectIndexMatchesChildren(wrapper1, listId);
+
+  std::basic_string<char> snapshot;
+  ASSERT_TRUE(wrapper1.core->saveSnapshot(snapshot));
+  CoreTestWrapper wrapper3;
+  ASSERT_TRUE(wrapper3.core->loadSnapshot(snapshot));
+  expectIndexMatchesChildren(wrapper3, listId);
+  ASSERT_EQ(wrapper3.getListNodeChildren(listId), wrapper1.getListNodeChildren(listId));
+}
@@ -0,0 +1,328 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <unistd.h>
+#include <LogSegment.h>
+#include <OperationLog.h>
+#include <Serialization/LogOperationSerialization.h>
+#include "helpers.h"
+
+static std::string getSegmentPath(const std::string & name)
+{
+  auto path = std::filesystem::temp_directory_path() / ("crdbl_" + name + "_" + std::to_string(::getpid()));
+  std::filesystem::remove(path);
+  std::filesystem::remove(path.string() + ".index");
+  return path.string();
+}
+
+static void removeSegment(const std::string & path)
+{
+  std::filesystem::remove(path);
+  std::filesystem::remove(path + ".index");
+}
+
+static void buildLog(CoreTestWrapper & wrapper)
+{
+  NodeId mapId = wrapper.builder.createNode(PrimitiveNodeTypes::Map());
+  NodeId stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+  wrapper.builder.addChild(mapId, stringId, "string");
+
+  for (int i = 0; i < 200; i++)
+  {
+    wrapper.builder.insertText(stringId, 0, "text " + std::to_string(i));
+    wrapper.group([&](OperationBuilder & builder)
+    {
+      NodeId valueId = builder.createNode(PrimitiveNodeTypes::DoubleValue());
+      builder.setValue<double>(valueId, i);
+      builder.addChild(mapId, valueId, std::to_string(i));
+    });
+  }
+}
+
+static void appendLog(LogSegment & segment, const OperationLogStorage & log)
+{
+  for (const auto & it : log)
+  {
+    RefCounted<const LogOperation> rc(reinterpret_cast<const LogOperation *>(it.data()));
+    ASSERT_TRUE(segment.append(rc));
+    rc.release();
+  }
+}
+
+TEST(LogSegmentTest, AppendAndReadWorks)
+{
+  CoreTestWrapper wrapper;
+  buildLog(wrapper);
+
+  std::string path = getSegmentPath("append");
+  LogSegment segment;
+  ASSERT_TRUE(segment.open(path));
+  appendLog(segment, wrapper.log);
+
+  ASSERT_EQ(segment.getOperationCount(), wrapper.log.size());
+
+  size_t i = 0;
+  for (const auto & it : wrapper.log)
+  {
+    auto expectedOp = reinterpret_cast<const LogOperation *>(it.data());
+    auto op = segment.getOperation(i);
+    ASSERT_NE(op, nullptr);
+    ASSERT_EQ(op->getSize(), expectedOp->getSize());
+    ASSERT_EQ(*op, *expectedOp);
+    i++;
+  }
+
+  ASSERT_EQ(segment.getOperation(i), nullptr);
+
+  segment.close();
+  removeSegment(path);
+}
+
+TEST(LogSegmentTest, ReopenWorks)
+{
+  CoreTestWrapper wrapper;
+  buildLog(wrapper);
+
+  std::string path = getSegmentPath("reopen");
+  {
+    LogSegment segment;
+    ASSERT_TRUE(segment.open(path));
+    appendLog(segment, wrapper.log);
+  }
+
+  LogSegment segment;
+  ASSERT_TRUE(segment.open(path));
+  ASSERT_EQ(segment.getOperationCount(), wrapper.log.size());
+  EXPECT_EQ(segment.getVectorClock(), wrapper.core->clock);
+
+  auto lastOp = reinterpret_cast<const LogOperation *>(wrapper.log.back().data());
+  EXPECT_EQ(*segment.getOperation(wrapper.log.size() - 1), *lastOp);
+
+  //appending after reopening continues the log
+  wrapper.builder.createNode(PrimitiveNodeTypes::Map());
+  RefCounted<const LogOperation> rc(reinterpret_cast<const LogOperation *>(wrapper.log.back().data()));
+  ASSERT_TRUE(segment.append(rc));
+  rc.release();
+  EXPECT_EQ(segment.getOperationCount(), wrapper.log.size());
+  EXPECT_EQ(segment.getVectorClock(), wrapper.core->clock);
+
+  segment.close();
+  removeSegment(path);
+}
+
+TEST(LogSegmentTest, LookupsOnlyReadTheIndex)
+{
+  CoreTestWrapper wrapper;
+  buildLog(wrapper);
+
+  std::string path = getSegmentPath("lookup");
+  {
+    LogSegment segment;
+    ASSERT_TRUE(segment.open(path));
+    appendLog(segment, wrapper.log);
+  }
+
+  //the data before the last operation is never read to open the segment or
+  //  to find operations, so clearing it doesn't change either
+  size_t lastOffset;
+  {
+    LogSegment segment;
+    ASSERT_TRUE(segment.open(path));
+    lastOffset = segment.getSerializedOperation(wrapper.log.size() - 1).data() - segment.getData().data();
+  }
+  {
+    std::fstream data(path, std::ios::in | std::ios::out | std::ios::binary);
+    data.seekp(64);
+    data.write(std::string(lastOffset, '\0').data(), lastOffset);
+  }
+
+  LogSegment segment;
+  ASSERT_TRUE(segment.open(path));
+  ASSERT_EQ(segment.getOperationCount(), wrapper.log.size());
+  EXPECT_EQ(segment.getVectorClock(), wrapper.core->clock);
+
+  size_t i = 0;
+  for (const auto & it : wrapper.log)
+  {
+    Timestamp finalTs = OperationLog::GetFinalTimestamp(*reinterpret_cast<const LogOperation *>(it.data()));
+    EXPECT_EQ(segment.findOperation(finalTs), i);
+    i++;
+  }
+
+  segment.close();
+  removeSegment(path);
+}
+
+TEST(LogSegmentTest, MissingIndexIsRebuilt)
+{
+  CoreTestWrapper wrapper;
+  buildLog(wrapper);
+
+  std::string path = getSegmentPath("rebuild");
+  {
+    LogSegment segment;
+    ASSERT_TRUE(segment.open(path));
+    appendLog(segment, wrapper.log);
+  }
+
+  std::filesystem::remove(path + ".index");
+
+  LogSegment segment;
+  ASSERT_TRUE(segment.open(path));
+  ASSERT_EQ(segment.getOperationCount(), wrapper.log.size());
+
+  size_t i = 0;
+  for (const auto & it : wrapper.log)
+  {
+    ASSERT_EQ(*segment.getOperation(i), *reinterpret_cast<const LogOperation *>(it.data()));
+    i++;
+  }
+
+  segment.close();
+  removeSegment(path);
+}
+
+//entries are an offset, the first timestamp, the final clock and a flag
+static constexpr size_t IndexEntrySize = 24;
+
+static void overwriteIndexOffset(const std::string & path, size_t index, uint64_t offset)
+{
+  std::fstream file(path + ".index", std::ios::in | std::ios::out | std::ios::binary);
+  file.seekp(index * IndexEntrySize);
+  file.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+}
+
+TEST(LogSegmentTest, CorruptIndexIsRebuilt)
+{
+  CoreTestWrapper wrapper;
+  buildLog(wrapper);
+
+  std::string path = getSegmentPath("corrupt");
+  {
+    LogSegment segment;
+    ASSERT_TRUE(segment.open(path));
+    appendLog(segment, wrapper.log);
+  }
+
+  //an offset that doesn't point at the last operation, in the last entry
+  overwriteIndexOffset(path, wrapper.log.size() - 1, 0);
+
+  LogSegment segment;
+  ASSERT_TRUE(segment.open(path));
+  ASSERT_EQ(segment.getOperationCount(), wrapper.log.size());
+
+  size_t i = 0;
+  for (const auto & it : wrapper.log)
+  {
+    ASSERT_EQ(*segment.getOperation(i), *reinterpret_cast<const LogOperation *>(it.data()));
+    i++;
+  }
+  EXPECT_EQ(segment.findOperation(reinterpret_cast<const LogOperation *>(wrapper.log.back().data())->ts),
+    wrapper.log.size() - 1);
+  EXPECT_EQ(segment.getVectorClock(), wrapper.core->clock);
+
+  segment.close();
+  removeSegment(path);
+}
+
+TEST(LogSegmentTest, CorruptIndexEntriesStayInsideTheData)
+{
+  CoreTestWrapper wrapper;
+  buildLog(wrapper);
+
+  std::string path = getSegmentPath("corrupt_entry");
+  {
+    LogSegment segment;
+    ASSERT_TRUE(segment.open(path));
+    appendLog(segment, wrapper.log);
+  }
+
+  //only the last entry is checked when opening, so an offset past the end
+  //  of the data in the second entry is kept, but never read through
+  overwriteIndexOffset(path, 1, UINT64_MAX);
+
+  LogSegment segment;
+  ASSERT_TRUE(segment.open(path));
+  ASSERT_EQ(segment.getOperationCount(), wrapper.log.size());
+  EXPECT_EQ(segment.getOperation(0), nullptr);
+  EXPECT_EQ(segment.getOperation(1), nullptr);
+
+  auto it = std::next(wrapper.log.begin(), 2);
+  for (size_t i = 2; i < wrapper.log.size(); i++, ++it)
+  {
+    ASSERT_EQ(*segment.getOperation(i), *reinterpret_cast<const LogOperation *>(it->data()));
+  }
+
+  segment.close();
+  removeSegment(path);
+}
+
+TEST(LogSegmentTest, FindOperationWorks)
+{
+  CoreTestWrapper wrapper;
+  buildLog(wrapper);
+
+  std::string path = getSegmentPath("find");
+  LogSegment segment;
+  ASSERT_TRUE(segment.open(path));
+  appendLog(segment, wrapper.log);
+
+  size_t i = 0;
+  for (const auto & it : wrapper.log)
+  {
+    auto op = reinterpret_cast<const LogOperation *>(it.data());
+    EXPECT_EQ(segment.findOperation(op->ts), i);
+
+    //every timestamp inside a group is found in the group
+    Timestamp finalTs = OperationLog::GetFinalTimestamp(*op);
+    if (finalTs.clock > op->ts.clock)
+    {
+      EXPECT_EQ(segment.findOperation(finalTs), i);
+    }
+    i++;
+  }
+
+  EXPECT_EQ(segment.findOperation(Timestamp(1, 2)), LogSegment::npos);
+  EXPECT_EQ(segment.findOperation(wrapper.core->clock.getTimestampAtSite(1) + 1), LogSegment::npos);
+
+  segment.close();
+  removeSegment(path);
+}
+
+TEST(LogSegmentTest, DataIsAStandardStream)
+{
+  CoreTestWrapper wrapper;
+  buildLog(wrapper);
+
+  std::string path = getSegmentPath("stream");
+  LogSegment segment;
+  ASSERT_TRUE(segment.open(path));
+  appendLog(segment, wrapper.log);
+
+  auto deserializer = std::unique_ptr<ILogOperationDeserializer>(
+    LogOperationSerialization::CreateDeserializer("standard_v1_full", DeserializeDirection::Forward));
+
+  auto expectedIt = wrapper.log.begin();
+  CallbackWritableStream<RefCounted<const LogOperation>> callbackStream(
+    [&](const RefCounted<const LogOperation> & op)
+    {
+      ASSERT_NE(expectedIt, wrapper.log.end());
+      ASSERT_EQ(*op, *reinterpret_cast<const LogOperation *>((*expectedIt).data()));
+      ++expectedIt;
+    });
+  deserializer->pipeTo(callbackStream);
+
+  //split the stream across writes, including partial operations
+  std::string_view data = segment.getData();
+  for (size_t offset = 0; offset < data.size(); offset += 1000)
+  {
+    deserializer->write(data.substr(offset, 1000));
+  }
+  deserializer->close();
+
+  EXPECT_EQ(expectedIt, wrapper.log.end());
+
+  segment.close();
+  removeSegment(path);
+}
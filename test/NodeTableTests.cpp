@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <NodeTable.h>
+#include <Nodes/Node.h>
+
+//fake node pointers; the table never dereferences them
+static Node * fakeNode(size_t i)
+{
+  return reinterpret_cast<Node *>((i + 1) * 16);
+}
+
+static void expectContents(const NodeTable & table, const std::map<NodeId, Node *> & expected)
+{
+  EXPECT_EQ(table.size(), expected.size());
+
+  for (const auto & it : expected)
+  {
+    EXPECT_EQ(table.find(it.first), it.second) << it.first.toString();
+  }
+
+  std::map<NodeId, Node *> visited;
+  table.forEach([&](const NodeId & nodeId, Node * node)
+  {
+    EXPECT_TRUE(visited.emplace(nodeId, node).second) << nodeId.toString();
+  });
+  EXPECT_EQ(visited, expected);
+}
+
+TEST(NodeTableTest, SetAndFindWork)
+{
+  NodeTable table;
+  std::map<NodeId, Node *> expected;
+
+  EXPECT_EQ(table.find(NodeId::Null), nullptr);
+
+  size_t i = 0;
+  for (uint32_t site = 0; site < 40; site++)
+  {
+    for (uint32_t clock = 0; clock < 300; clock += (site % 3) + 1)
+    {
+      //direct nodes, inherited nodes, and clocks far apart
+      NodeId direct = { Timestamp(clock, site), 0 };
+      NodeId inherited = { Timestamp(clock, site), clock % 5 + 1 };
+      NodeId sparse = { Timestamp(clock * 100000, site), 0 };
+
+      for (const auto & nodeId : { direct, inherited, sparse })
+      {
+        table.set(nodeId, fakeNode(i));
+        expected[nodeId] = fakeNode(i);
+        i++;
+      }
+    }
+  }
+
+  expectContents(table, expected);
+
+  EXPECT_EQ(table.find({ Timestamp(1, 1000), 0 }), nullptr);
+  EXPECT_EQ(table.find({ Timestamp(1, 1), 7 }), nullptr);
+  EXPECT_EQ(table.find({ Timestamp(301, 0), 0 }), nullptr);
+}
+
+TEST(NodeTableTest, SetReplacesExistingNodes)
+{
+  NodeTable table;
+  std::map<NodeId, Node *> expected;
+
+  //clocks past the end of the dense array are hashed, and then the array
+  //  grows over them
+  std::vector<NodeId> nodeIds = { { Timestamp(0, 1), 0 } };
+  for (uint32_t clock = 100; clock > 0; clock--)
+  {
+    nodeIds.push_back({ Timestamp(clock * 50, 1), 0 });
+  }
+  for (uint32_t clock = 1; clock < 5000; clock++)
+  {
+    nodeIds.push_back({ Timestamp(clock, 1), 0 });
+  }
+
+  for (size_t i = 0; i < nodeIds.size(); i++)
+  {
+    table.set(nodeIds[i], fakeNode(i));
+    expected[nodeIds[i]] = fakeNode(i);
+  }
+  expectContents(table, expected);
+
+  for (size_t i = 0; i < nodeIds.size(); i += 3)
+  {
+    table.set(nodeIds[i], fakeNode(i + 100000));
+    expected[nodeIds[i]] = fakeNode(i + 100000);
+  }
+  expectContents(table, expected);
+
+  NodeTable moved = std::move(table);
+  expectContents(moved, expected);
+
+  moved.clear();
+  expectContents(moved, {});
+}
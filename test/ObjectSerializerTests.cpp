@@ -0,0 +1,331 @@
+#include <gtest/gtest.h>
+#include <charconv>
+#include <cstring>
+#include <JsonBufferSerializer.h>
+#include <MessagePackSerializer.h>
+#include "helpers.h"
+
+//converts MessagePack written by MessagePackSerializer back to the JSON
+//  JsonBufferSerializer would write, so the two can be compared
+class MessagePackToJson
+{
+public:
+  MessagePackToJson(std::string_view data) : data(data) {}
+
+  std::string convert()
+  {
+    std::string output;
+    while (offset < data.size())
+    {
+      convertValue(output);
+    }
+    return output;
+  }
+
+private:
+  std::string_view data;
+  size_t offset = 0;
+
+  uint64_t readBigEndian(size_t size)
+  {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+      value = (value << 8) | static_cast<uint8_t>(data.at(offset++));
+    }
+    return value;
+  }
+
+  void appendNumber(std::string & output, double value)
+  {
+    char str[32];
+    output.append(str, std::to_chars(str, str + sizeof(str), value).ptr);
+  }
+
+  void appendString(std::string & output, size_t length)
+  {
+    //(the test strings don't need escaping)
+    output += '"';
+    output.append(data.substr(offset, length));
+    output += '"';
+    offset += length;
+  }
+
+  void convertValue(std::string & output)
+  {
+    uint8_t type = static_cast<uint8_t>(data.at(offset++));
+
+    if (type < 0x80)
+    {
+      output += std::to_string(type);
+    }
+    else if (type >= 0xE0)
+    {
+      output += std::to_string(static_cast<int8_t>(type));
+    }
+    else if ((type & 0xE0) == 0xA0)
+    {
+      appendString(output, type & 0x1F);
+    }
+    else if (type == 0xDD || type == 0xDF)
+    {
+      bool isArray = type == 0xDD;
+      size_t length = readBigEndian(4);
+      output += isArray ? '[' : '{';
+      for (size_t i = 0; i < length; i++)
+      {
+        if (i > 0)
+        {
+          output += ',';
+        }
+        if (!isArray)
+        {
+          convertValue(output);
+          output += ':';
+        }
+        convertValue(output);
+      }
+      output += isArray ? ']' : '}';
+    }
+    else
+    {
+      switch (type)
+      {
+        case 0xC0: output += "null"; break;
+        case 0xC2: output += "false"; break;
+        case 0xC3: output += "true"; break;
+        case 0xCC: output += std::to_string(readBigEndian(1)); break;
+        case 0xCD: output += std::to_string(readBigEndian(2)); break;
+        case 0xCE: output += std::to_string(readBigEndian(4)); break;
+        case 0xCF: output += std::to_string(readBigEndian(8)); break;
+        case 0xD0: output += std::to_string(static_cast<int8_t>(readBigEndian(1))); break;
+        case 0xD1: output += std::to_string(static_cast<int16_t>(readBigEndian(2))); break;
+        case 0xD2: output += std::to_string(static_cast<int32_t>(readBigEndian(4))); break;
+        case 0xD3: output += std::to_string(static_cast<int64_t>(readBigEndian(8))); break;
+        case 0xD9: appendString(output, readBigEndian(1)); break;
+        case 0xDA: appendString(output, readBigEndian(2)); break;
+        case 0xDB: appendString(output, readBigEndian(4)); break;
+        case 0xCA:
+        {
+          uint32_t bits = static_cast<uint32_t>(readBigEndian(4));
+          float value;
+          std::memcpy(&value, &bits, sizeof(value));
+          appendNumber(output, value);
+          break;
+        }
+        case 0xCB:
+        {
+          uint64_t bits = readBigEndian(8);
+          double value;
+          std::memcpy(&value, &bits, sizeof(value));
+          appendNumber(output, value);
+          break;
+        }
+        default:
+          ADD_FAILURE() << "unexpected type " << static_cast<int>(type);
+          offset = data.size();
+          break;
+      }
+    }
+  }
+};
+
+static void writeAllTypes(IObjectSerializer & serializer)
+{
+  serializer.startObject();
+  serializer.addPair("bool", false);
+  serializer.addPair("string", std::string(300, 'a'));
+  serializer.addPair("chars", "text");
+  serializer.addPair("ts", Timestamp(12, 3));
+  serializer.addPair("id", NodeId{ Timestamp(100000, 2), 1 });
+  serializer.addPair("size", static_cast<size_t>(1) << 40);
+  serializer.addPair("uint", static_cast<uint32_t>(70000));
+  serializer.addPair("double", 0.1);
+  serializer.addPair("float", 1.5f);
+  serializer.addPair("int32", static_cast<int32_t>(-200));
+  serializer.addPair("int64", static_cast<int64_t>(-5000000000));
+  serializer.addPair("int8", static_cast<int8_t>(-5));
+  serializer.addKey("array");
+  serializer.startArray();
+  serializer.addValue("a");
+  serializer.addNullValue();
+  serializer.startObject();
+  serializer.endObject();
+  serializer.startArray();
+  serializer.endArray();
+  serializer.endArray();
+  serializer.endObject();
+
+  //adds to the object that was just closed
+  serializer.resumeObject();
+  serializer.addPair("resumed", true);
+  serializer.endObject();
+}
+
+TEST(ObjectSerializerTest, JsonBufferWritesValues)
+{
+  JsonBufferSerializer serializer;
+  writeAllTypes(serializer);
+
+  EXPECT_EQ(serializer.result(), "{\"bool\":false,\"string\":\"" + std::string(300, 'a') + "\","
+    "\"chars\":\"text\",\"ts\":\"12,3\",\"id\":\"100000,2,1\",\"size\":1099511627776,"
+    "\"uint\":70000,\"double\":0.1,\"float\":1.5,\"int32\":-200,\"int64\":-5000000000,"
+    "\"int8\":-5,\"array\":[\"a\",null,{},[]],\"resumed\":true}");
+
+  serializer.clear();
+  serializer.startArray();
+  serializer.addValue("quote\" backslash\\ newline\n tab\t bell\x07");
+  serializer.addPair("", std::numeric_limits<double>::infinity());
+  serializer.endArray();
+  EXPECT_EQ(serializer.result(), "[\"quote\\\" backslash\\\\ newline\\n tab\\t bell\\u0007\",\"\":null]");
+}
+
+TEST(ObjectSerializerTest, MessagePackMatchesJson)
+{
+  JsonBufferSerializer json;
+  MessagePackSerializer messagePack;
+  writeAllTypes(json);
+  writeAllTypes(messagePack);
+
+  EXPECT_EQ(MessagePackToJson(messagePack.result()).convert(), json.result());
+  EXPECT_LT(messagePack.result().size(), json.result().size());
+}
+
+TEST(ObjectSerializerTest, NodesSerializeToValidJson)
+{
+  CoreTestWrapper wrapper;
+
+  NodeId mapId = wrapper.builder.createNode(PrimitiveNodeTypes::Map());
+  NodeId listId = wrapper.builder.createNode(PrimitiveNodeTypes::List());
+  EdgeId edgeId0 = wrapper.builder.addChild(mapId, listId, "list");
+  NodeId valueId = wrapper.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+  EdgeId edgeId1 = wrapper.builder.addChild(listId, valueId, wrapper.builder.createPositionFromIndex(listId, 0));
+  EdgeId edgeId2 = wrapper.builder.addChild(listId, mapId, wrapper.builder.createPositionFromIndex(listId, 1));
+
+  JsonBufferSerializer json;
+  MessagePackSerializer messagePack;
+  for (IObjectSerializer * serializer : { static_cast<IObjectSerializer *>(&json),
+    static_cast<IObjectSerializer *>(&messagePack) })
+  {
+    serializer->startArray();
+    wrapper.core->serializeNode(*serializer, mapId);
+    wrapper.core->serializeNode(*serializer, valueId);
+    wrapper.core->serializeNodeChildren(*serializer, mapId, false);
+    wrapper.core->serializeNodeChildren(*serializer, listId, false);
+    serializer->endArray();
+  }
+
+  EXPECT_EQ(json.result(), "["
+    "{\"ready\":true,\"type\":[\"Map\"],\"childType\":\"\"},"
+    "{\"ready\":true,\"type\":[\"DoubleValue\"]},"
+    "[{\"edgeId\":\"" + edgeId0.toString() + "\",\"childId\":\"" + listId.toString() + "\",\"key\":\"list\"}],"
+    "[{\"edgeId\":\"" + edgeId1.toString() + "\",\"childId\":\"" + valueId.toString() + "\"},"
+    "{\"edgeId\":\"" + edgeId2.toString() + "\",\"childId\":\"" + mapId.toString() + "\"}]"
+    "]");
+  EXPECT_EQ(MessagePackToJson(messagePack.result()).convert(), json.result());
+}
+
+TEST(ObjectSerializerTest, SerializeSubtreeWorks)
+{
+  CoreTestWrapper wrapper;
+
+  NodeId mapId = wrapper.builder.createNode(PrimitiveNodeTypes::Map());
+  NodeId listId = wrapper.builder.createNode(PrimitiveNodeTypes::List());
+  NodeId stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+  NodeId valueId = wrapper.builder.createNode(PrimitiveNodeTypes::Int32Value());
+  NodeId referenceId = wrapper.builder.createNode(PrimitiveNodeTypes::Reference());
+  EdgeId listEdgeId = wrapper.builder.addChild(mapId, listId, "list");
+  EdgeId stringEdgeId = wrapper.builder.addChild(listId, stringId, wrapper.builder.createPositionFromIndex(listId, 0));
+  EdgeId valueEdgeId = wrapper.builder.addChild(listId, valueId, wrapper.builder.createPositionFromIndex(listId, 1));
+  EdgeId referenceEdgeId = wrapper.builder.addChild(listId, referenceId, wrapper.builder.createPositionFromIndex(listId, 2));
+  EdgeId targetEdgeId = wrapper.builder.addChild(referenceId, listId);
+  //the map also ends up under itself
+  EdgeId cycleEdgeId = wrapper.builder.addChild(listId, mapId, wrapper.builder.createPositionFromIndex(listId, 3));
+  wrapper.builder.insertText(stringId, 0, "text");
+  wrapper.builder.setValue<int32_t>(valueId, -3);
+
+  auto edge = [](const EdgeId & edgeId, const NodeId & childId, const std::string & rest)
+  {
+    return "{\"edgeId\":\"" + edgeId.toString() + "\",\"childId\":\"" + childId.toString() + "\"" + rest + "}";
+  };
+
+  std::string string = "{\"ready\":true,\"type\":[\"StringValue\"],\"id\":\"" + stringId.toString() + "\",\"value\":\"text\"}";
+  std::string value = "{\"ready\":true,\"type\":[\"Int32Value\"],\"id\":\"" + valueId.toString() + "\",\"value\":-3}";
+  //the reference's target is listed but not expanded
+  std::string reference = "{\"ready\":true,\"type\":[\"Reference\"],\"childType\":\"\",\"nullable\":true,"
+    "\"id\":\"" + referenceId.toString() + "\",\"children\":[" + edge(targetEdgeId, listId, "") + "]}";
+  std::string listStart = "{\"ready\":true,\"type\":[\"List\"],\"childType\":\"\",\"id\":\"" + listId.toString() + "\"";
+  std::string list = listStart + ",\"children\":["
+    + edge(stringEdgeId, stringId, ",\"node\":" + string) + ","
+    + edge(valueEdgeId, valueId, ",\"node\":" + value) + ","
+    + edge(referenceEdgeId, referenceId, ",\"node\":" + reference) + ","
+    + edge(cycleEdgeId, mapId, "") + "]}";
+  std::string mapStart = "{\"ready\":true,\"type\":[\"Map\"],\"childType\":\"\",\"id\":\"" + mapId.toString() + "\"";
+
+  JsonBufferSerializer json;
+  wrapper.core->serializeSubtree(json, mapId, false);
+  std::string expected = mapStart + ",\"children\":["
+    + edge(listEdgeId, listId, ",\"key\":\"list\",\"node\":" + list) + "]}";
+  EXPECT_EQ(json.result(), expected);
+
+  //the depth limit
+  json.clear();
+  wrapper.core->serializeSubtree(json, mapId, false, 1);
+  expected = mapStart + ",\"children\":["
+    + edge(listEdgeId, listId, ",\"key\":\"list\",\"node\":" + listStart + "}") + "]}";
+  EXPECT_EQ(json.result(), expected);
+
+  json.clear();
+  wrapper.core->serializeSubtree(json, mapId, false, 0);
+  EXPECT_EQ(json.result(), mapStart + "}");
+
+  //filtered out children are only listed
+  json.clear();
+  wrapper.core->serializeSubtree(json, listId, false, UINT32_MAX, [&](const NodeId & nodeId)
+  {
+    return nodeId != valueId && nodeId != mapId;
+  });
+  expected = listStart + ",\"children\":["
+    + edge(stringEdgeId, stringId, ",\"node\":" + string) + ","
+    + edge(valueEdgeId, valueId, "") + ","
+    + edge(referenceEdgeId, referenceId, ",\"node\":" + reference) + ","
+    + edge(cycleEdgeId, mapId, "") + "]}";
+  EXPECT_EQ(json.result(), expected);
+
+  json.clear();
+  wrapper.core->serializeSubtree(json, NodeId{ Timestamp(1000, 1), 0 }, false);
+  EXPECT_EQ(json.result(), "null");
+}
+
+TEST(ObjectSerializerTest, SubtreeDepthIsCapped)
+{
+  CoreTestWrapper wrapper;
+
+  //a chain of maps deeper than the cap
+  NodeId rootId = wrapper.builder.createNode(PrimitiveNodeTypes::Map());
+  NodeId parentId = rootId;
+  for (uint32_t i = 0; i < Core::MaxSubtreeDepth + 10; i++)
+  {
+    NodeId childId = wrapper.builder.createNode(PrimitiveNodeTypes::Map());
+    wrapper.builder.addChild(parentId, childId, "child");
+    parentId = childId;
+  }
+
+  auto countNodes = [](std::string_view json)
+  {
+    size_t count = 0;
+    for (size_t pos = json.find("\"node\":"); pos != std::string_view::npos; pos = json.find("\"node\":", pos + 1))
+    {
+      count++;
+    }
+    return count;
+  };
+
+  JsonBufferSerializer json;
+  wrapper.core->serializeSubtree(json, rootId, false);
+  EXPECT_EQ(countNodes(json.result()), Core::MaxSubtreeDepth);
+
+  json.clear();
+  wrapper.core->serializeSubtree(json, rootId, false, 5);
+  EXPECT_EQ(countNodes(json.result()), 5u);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <RefCounted.h>
+#include <EpochReclaimer.h>
+#include <LogOperation.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static RefCounted<const LogOperation> createOperation(uint32_t clock)
+{
+  size_t size = LogOperation::getSizeWithoutOp() + sizeof(Operation);
+  auto op = RefCounted<LogOperation>::Allocate(size);
+  op->tag = Tag::Default();
+  op->ts = Timestamp(clock, 1);
+  op->op.type = OperationType::NoOpOperation;
+  return RefCounted<const LogOperation>(std::move(op));
+}
+
+TEST(RefCountedTest, AllocatedReferencesAreSharedBetweenThreads)
+{
+  auto op = createOperation(5);
+  EXPECT_TRUE(op.isAllocated());
+  EXPECT_FALSE(op.isBorrowed());
+
+  //every thread copies and drops the same operation many times
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; i++)
+  {
+    threads.emplace_back([&op]()
+    {
+      std::vector<RefCounted<const LogOperation>> copies;
+      for (size_t j = 0; j < 10000; j++)
+      {
+        copies.push_back(op);
+        if (copies.size() == 16)
+        {
+          copies.clear();
+        }
+      }
+    });
+  }
+  for (auto & thread : threads)
+  {
+    thread.join();
+  }
+
+  //the copies kept after the original is gone still point at live memory
+  RefCounted<const LogOperation> copy(op);
+  op = RefCounted<const LogOperation>();
+  EXPECT_EQ(copy->ts, Timestamp(5, 1));
+}
+
+TEST(RefCountedTest, AdoptedAndBorrowedReferencesStillWork)
+{
+  size_t size = LogOperation::getSizeWithoutOp() + sizeof(Operation);
+
+  auto memory = reinterpret_cast<LogOperation *>(new uint8_t[size]);
+  memory->ts = Timestamp(7, 2);
+  RefCounted<const LogOperation> adopted(memory);
+  {
+    RefCounted<const LogOperation> copy(adopted);
+    EXPECT_FALSE(copy.isAllocated());
+    EXPECT_EQ(copy->ts, Timestamp(7, 2));
+  }
+
+  //released memory is not freed, so it can be handed back to its owner
+  std::string buffer(size, '\0');
+  RefCounted<const LogOperation> released(reinterpret_cast<const LogOperation *>(buffer.data()));
+  released.release();
+
+  auto borrowed = RefCounted<const LogOperation>::Borrow(reinterpret_cast<const LogOperation *>(buffer.data()));
+  RefCounted<const LogOperation> borrowedCopy(borrowed);
+  EXPECT_TRUE(borrowedCopy.isBorrowed());
+  EXPECT_FALSE(borrowedCopy.isAllocated());
+}
+
+TEST(RefCountedTest, EpochReclaimerWaitsForReaders)
+{
+  EpochReclaimer<const LogOperation> reclaimer;
+
+  auto first = createOperation(1);
+  std::atomic<const LogOperation *> current = &(*first);
+  RefCounted<const LogOperation> currentRef(std::move(first));
+
+  std::atomic<bool> stopping = false;
+  std::atomic<size_t> reads = 0;
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < 3; i++)
+  {
+    readers.emplace_back([&]()
+    {
+      EpochReclaimer<const LogOperation>::Participant participant(reclaimer);
+      while (!stopping.load())
+      {
+        EpochReclaimer<const LogOperation>::Guard guard(participant);
+        const LogOperation * op = current.load();
+        //freed memory would be caught by the sanitizers here
+        EXPECT_EQ(op->ts.site, 1u);
+        EXPECT_EQ(op->op.type, OperationType::NoOpOperation);
+        reads.fetch_add(1);
+      }
+    });
+  }
+
+  for (uint32_t clock = 2; clock < 2000; clock++)
+  {
+    auto next = createOperation(clock);
+    current.store(&(*next));
+    reclaimer.retire(std::move(currentRef));
+    currentRef = std::move(next);
+    reclaimer.collect();
+  }
+
+  //make sure the readers got to run at least once
+  while (reads.load() == 0)
+  {
+    std::this_thread::yield();
+  }
+  stopping.store(true);
+  for (auto & reader : readers)
+  {
+    reader.join();
+  }
+  EXPECT_GT(reads.load(), 0u);
+
+  //with no readers left, everything is dropped within two collections
+  reclaimer.collect();
+  reclaimer.collect();
+  EXPECT_EQ(reclaimer.getRetiredCount(), 0u);
+}
@@ -334,6 +334,88 @@ TEST(SerializationTest, SerializationBetweenSameFormatsWorks)
   }
 }
 
+TEST(SerializationTest, ZeroCopyDeserializationWorks)
+{
+  CoreTestWrapper wrapper;
+
+  std::srand(0);
+  applyRandomOperations(wrapper);
+
+  for (int i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+  {
+    if (!formats[i].hasTs || !formats[i].hasTag)
+    {
+      continue;
+    }
+
+    auto serializer = std::unique_ptr<ILogOperationSerializer>(
+      LogOperationSerialization::CreateSerializer(formats[i].format));
+    auto deserializer = std::unique_ptr<ILogOperationDeserializer>(
+      LogOperationSerialization::CreateDeserializer(formats[i].format,
+        (formats[i].reverse) ? DeserializeDirection::Reverse : DeserializeDirection::Forward));
+    ASSERT_TRUE(deserializer->setZeroCopy(true));
+
+    std::string serialized;
+    CallbackWritableStream<std::string_view> output([&](const std::string_view & data)
+    {
+      serialized.append(data);
+    });
+    serializer->pipeTo(output);
+
+    for (auto & op : wrapper.log)
+    {
+      RefCounted<const LogOperation> rc(reinterpret_cast<const LogOperation *>(op.data()));
+      serializer->write(rc);
+      rc.release();
+    }
+
+    std::vector<const std::basic_string<char> *> expected;
+    for (auto & op : wrapper.log)
+    {
+      expected.push_back(&op);
+    }
+    if (formats[i].reverse)
+    {
+      std::reverse(expected.begin(), expected.end());
+    }
+
+    auto expectedIt = expected.begin();
+    auto callbackStream = std::unique_ptr<CallbackWritableStream<RefCounted<const LogOperation>>>(
+      new CallbackWritableStream<RefCounted<const LogOperation>>(
+        [&](const RefCounted<const LogOperation> & op)
+        {
+          ASSERT_TRUE(op.isBorrowed());
+          ASSERT_EQ((*expectedIt)->size(), op->getSize());
+          ASSERT_EQ(*reinterpret_cast<const LogOperation *>((*expectedIt)->data()), *op);
+          ++expectedIt;
+        }
+    ));
+    deserializer->pipeTo(*callbackStream);
+
+    //operations split across writes are completed in the deserializer's buffer
+    size_t offset = 0;
+    while (offset < serialized.size())
+    {
+      size_t length = std::min(static_cast<size_t>(randomInt(1, 256)), serialized.size() - offset);
+      if (formats[i].reverse)
+      {
+        deserializer->write(std::string_view(serialized.data() + serialized.size() - offset - length, length));
+      }
+      else
+      {
+        deserializer->write(std::string_view(serialized.data() + offset, length));
+      }
+      offset += length;
+    }
+
+    EXPECT_EQ(expectedIt, expected.end());
+  }
+
+  auto untagged = std::unique_ptr<ILogOperationDeserializer>(
+    LogOperationSerialization::CreateDeserializer("standard_v1_untagged", DeserializeDirection::Forward));
+  EXPECT_FALSE(untagged->setZeroCopy(true));
+}
+
 TEST(SerializationTest, DeserializationOfRandomDataIsWellBehaved)
 {
   std::srand(0);
@@ -298,4 +298,90 @@ TEST(SetNodeTest, InheritanceWorks)
     result2.push_back(wrapper.getNodeValue<int32_t>(result2Children[i].second));
   }
   ASSERT_EQ(result2, expected2);
-}
\ No newline at end of file
+}
+
+TEST(SetNodeTest, UndoneRemoveKeepsOrder)
+{
+  std::vector<std::pair<EdgeId, NodeId>> added;
+
+  CoreTestWrapper wrapper([&](const CoreTestWrapper & wrapper, const Event & event)
+  {
+    auto addedEvent = dynamic_cast<const NodeAddedEvent *>(&event);
+    if (addedEvent != nullptr && addedEvent->parentId != NodeId::Root)
+    {
+      added.push_back(std::make_pair(addedEvent->edgeId, addedEvent->childId));
+    }
+  }, true);
+
+  auto setNodeId = wrapper.builder.createNode(PrimitiveNodeTypes::Set());
+
+  std::vector<std::pair<EdgeId, NodeId>> expected;
+  for (int i = 0; i < 3; i++)
+  {
+    auto childId = wrapper.builder.createNode(PrimitiveNodeTypes::Abstract());
+    auto edgeId = wrapper.builder.addChild(setNodeId, childId);
+    expected.insert(expected.begin(), std::make_pair(edgeId, childId));
+  }
+
+  Timestamp removeTs = wrapper.group([&](OperationBuilder & builder) {
+    builder.removeChild(setNodeId, expected[1].first);
+  });
+  ASSERT_EQ(wrapper.getSetNodeChildren(setNodeId).size(), 2);
+
+  //the removed edge comes back in the same place, with an added event
+  added.clear();
+  Timestamp undoTs = undoOperation(wrapper, wrapper.log, removeTs);
+  ASSERT_EQ(wrapper.getSetNodeChildren(setNodeId), expected);
+  ASSERT_EQ(added.size(), 1);
+  ASSERT_EQ(added[0], expected[1]);
+
+  //a removed edge isn't in the children list, and compacting frees it
+  undoOperation(wrapper, wrapper.log, undoTs);
+
+  auto setNode = static_cast<const SetNode *>(wrapper.core->getExistingNode(setNodeId));
+  size_t linked = 0;
+  for (auto edge = setNode->children; edge != nullptr; edge = edge->next)
+  {
+    ASSERT_TRUE(edge->next == nullptr || edge->next->prev == edge);
+    linked++;
+  }
+  ASSERT_EQ(linked, 2);
+  ASSERT_EQ(setNode->edges.size(), 3);
+
+  ASSERT_TRUE(wrapper.core->compact(wrapper.core->clock));
+  ASSERT_EQ(setNode->edges.size(), 2);
+  expected.erase(expected.begin() + 1);
+  ASSERT_EQ(wrapper.getSetNodeChildren(setNodeId), expected);
+}
+
+TEST(SetNodeTest, ReaddedEdgesKeepOrder)
+{
+  CoreTestWrapper wrapper;
+
+  auto setNodeId = wrapper.builder.createNode(PrimitiveNodeTypes::Set());
+
+  std::vector<std::pair<EdgeId, NodeId>> expected;
+  for (int i = 0; i < 6; i++)
+  {
+    auto childId = wrapper.builder.createNode(PrimitiveNodeTypes::Abstract());
+    auto edgeId = wrapper.builder.addChild(setNodeId, childId);
+    expected.insert(expected.begin(), std::make_pair(edgeId, childId));
+  }
+
+  //neighbours removed after each other, so some edges go back after an edge
+  //  that was removed too, or after the front
+  std::vector<Timestamp> removeTs;
+  for (size_t i : { 2, 1, 3, 0 })
+  {
+    removeTs.push_back(wrapper.group([&](OperationBuilder & builder) {
+      builder.removeChild(setNodeId, expected[i].first);
+    }));
+  }
+  ASSERT_EQ(wrapper.getSetNodeChildren(setNodeId).size(), 2);
+
+  for (size_t i : { 0, 3, 1, 2 })
+  {
+    undoOperation(wrapper, wrapper.log, removeTs[i]);
+  }
+  ASSERT_EQ(wrapper.getSetNodeChildren(setNodeId), expected);
+}
\ No newline at end of file
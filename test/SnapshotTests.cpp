@@ -0,0 +1,378 @@
+#include <gtest/gtest.h>
+#include "helpers.h"
+#include <ReadView.h>
+#include <atomic>
+#include <thread>
+
+struct SnapshotDocument
+{
+  NodeId mapId;
+  NodeId listId;
+  NodeId setId;
+  NodeId referenceId;
+  NodeId stringId;
+  NodeId valueId;
+  NodeId typedId;
+};
+
+static SnapshotDocument buildDocument(CoreTestWrapper & wrapper)
+{
+  SnapshotDocument doc;
+
+  wrapper.types["type0"] = createTypeSpec([](OperationBuilder & builder)
+  {
+    NodeId rootId = builder.createNode(PrimitiveNodeTypes::Map());
+    NodeId stringId = builder.createNode(PrimitiveNodeTypes::StringValue());
+    builder.addChild(rootId, stringId, "text");
+    builder.insertText(stringId, 0, "inherited");
+    builder.addChild(rootId, builder.createNode(PrimitiveNodeTypes::DoubleValue()), "value");
+  }, wrapper.types);
+
+  doc.mapId = wrapper.builder.createNode(PrimitiveNodeTypes::Map());
+  doc.listId = wrapper.builder.createNode(PrimitiveNodeTypes::List());
+  doc.setId = wrapper.builder.createNode(PrimitiveNodeTypes::Set());
+  doc.referenceId = wrapper.builder.createNode(PrimitiveNodeTypes::Reference());
+  doc.stringId = wrapper.builder.createNode(PrimitiveNodeTypes::StringValue());
+  doc.valueId = wrapper.builder.createNode(PrimitiveNodeTypes::Int32Value());
+  doc.typedId = wrapper.builder.createNode("type0");
+  wrapper.resolveTypes();
+
+  wrapper.builder.addChild(doc.mapId, doc.listId, "list");
+  wrapper.builder.addChild(doc.mapId, doc.setId, "set");
+  wrapper.builder.addChild(doc.mapId, doc.stringId, "string");
+  wrapper.builder.addChild(doc.mapId, doc.valueId, "value");
+  wrapper.builder.addChild(doc.mapId, doc.typedId, "typed");
+  EdgeId removedEdgeId = wrapper.builder.addChild(doc.mapId, doc.referenceId, "removed");
+  wrapper.builder.removeChild(doc.mapId, removedEdgeId);
+
+  for (int i = 0; i < 10; i++)
+  {
+    NodeId childId = wrapper.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+    wrapper.builder.setValue<double>(childId, i);
+    wrapper.builder.addChild(doc.listId, childId,
+      wrapper.builder.createPositionFromIndex(doc.listId, i / 2));
+    wrapper.builder.addChild(doc.setId, childId);
+  }
+  wrapper.builder.addChild(doc.referenceId, doc.stringId);
+
+  wrapper.builder.insertText(doc.stringId, 0, "hello world");
+  wrapper.builder.insertText(doc.stringId, 5, ",");
+  wrapper.builder.deleteText(doc.stringId, 7, 3);
+  wrapper.builder.setValue<int32_t>(doc.valueId, 42);
+
+  return doc;
+}
+
+static void expectSameState(const CoreTestWrapper & expected, const CoreTestWrapper & actual,
+  const SnapshotDocument & doc)
+{
+  ASSERT_EQ(actual.core->clock, expected.core->clock);
+  EXPECT_EQ(actual.getMapNodeChildren(doc.mapId), expected.getMapNodeChildren(doc.mapId));
+  EXPECT_EQ(actual.getListNodeChildren(doc.listId), expected.getListNodeChildren(doc.listId));
+  EXPECT_EQ(actual.getSetNodeChildren(doc.setId), expected.getSetNodeChildren(doc.setId));
+  EXPECT_EQ(actual.getReferenceNodeChildren(doc.referenceId),
+    expected.getReferenceNodeChildren(doc.referenceId));
+  EXPECT_EQ(actual.getNodeBlockValue(doc.stringId), expected.getNodeBlockValue(doc.stringId));
+  EXPECT_EQ(actual.getNodeValue<int32_t>(doc.valueId), expected.getNodeValue<int32_t>(doc.valueId));
+
+  for (const auto & it : expected.getListNodeChildren(doc.listId))
+  {
+    EXPECT_EQ(actual.getNodeValue<double>(it.second), expected.getNodeValue<double>(it.second));
+  }
+
+  auto typedChildren = expected.getMapNodeChildren(doc.typedId);
+  ASSERT_EQ(actual.getMapNodeChildren(doc.typedId), typedChildren);
+  NodeId textId = typedChildren["text"].second;
+  EXPECT_EQ(actual.getNodeBlockValue(textId), expected.getNodeBlockValue(textId));
+
+  std::string expectedText, actualText;
+  expected.core->getNodeBlockValue(expectedText, textId);
+  actual.core->getNodeBlockValue(actualText, textId);
+  EXPECT_EQ(actualText, expectedText);
+  EXPECT_EQ(actualText, "inherited");
+
+  const Node * typedNode = actual.core->getExistingNode(doc.typedId);
+  ASSERT_NE(typedNode, nullptr);
+  EXPECT_EQ(typedNode->type, expected.core->getExistingNode(doc.typedId)->type);
+  EXPECT_EQ(actual.core->getExistingNode(doc.referenceId)->effect.isVisible(),
+    expected.core->getExistingNode(doc.referenceId)->effect.isVisible());
+}
+
+TEST(SnapshotTest, SaveAndLoadWorks)
+{
+  CoreTestWrapper wrapper;
+  auto doc = buildDocument(wrapper);
+
+  std::basic_string<char> snapshot;
+  ASSERT_TRUE(wrapper.core->saveSnapshot(snapshot));
+
+  CoreTestWrapper wrapper2;
+  ASSERT_TRUE(wrapper2.core->loadSnapshot(snapshot));
+  expectSameState(wrapper, wrapper2, doc);
+
+  //saving the loaded state gives the same snapshot back
+  std::basic_string<char> snapshot2;
+  ASSERT_TRUE(wrapper2.core->saveSnapshot(snapshot2));
+  EXPECT_EQ(snapshot2.size(), snapshot.size());
+}
+
+TEST(SnapshotTest, OperationsAfterSnapshotApply)
+{
+  CoreTestWrapper wrapper;
+  auto doc = buildDocument(wrapper);
+
+  std::basic_string<char> snapshot;
+  ASSERT_TRUE(wrapper.core->saveSnapshot(snapshot));
+
+  //more edits after the snapshot was taken, including edits to existing items
+  wrapper.builder.insertText(doc.stringId, 3, "abc");
+  wrapper.builder.deleteText(doc.stringId, 0, 2);
+  wrapper.builder.setValue<int32_t>(doc.valueId, 7);
+  auto listChildren = wrapper.getListNodeChildren(doc.listId);
+  wrapper.builder.removeChild(doc.listId, listChildren[3].first);
+  NodeId childId = wrapper.builder.createNode(PrimitiveNodeTypes::DoubleValue());
+  wrapper.builder.addChild(doc.listId, childId, wrapper.builder.createPositionFromIndex(doc.listId, 2));
+  wrapper.builder.addChild(doc.setId, childId);
+  wrapper.builder.setValue<double>(childId, 100);
+
+  CoreTestWrapper wrapper2;
+  ASSERT_TRUE(wrapper2.core->loadSnapshot(snapshot));
+  //ops the snapshot already includes are filtered out by the clock
+  wrapper2.applyOpsFrom(wrapper);
+
+  expectSameState(wrapper, wrapper2, doc);
+  EXPECT_EQ(wrapper2.getNodeBlockValue(doc.stringId), wrapper.getNodeBlockValue(doc.stringId));
+}
+
+TEST(SnapshotTest, InvalidSnapshotsFail)
+{
+  CoreTestWrapper wrapper;
+  buildDocument(wrapper);
+
+  std::basic_string<char> snapshot;
+  ASSERT_TRUE(wrapper.core->saveSnapshot(snapshot));
+
+  CoreTestWrapper empty;
+  EXPECT_FALSE(empty.core->loadSnapshot(std::string_view()));
+
+  //every truncation fails and leaves the core untouched
+  for (size_t length = 0; length < snapshot.size(); length += 7)
+  {
+    EXPECT_FALSE(empty.core->loadSnapshot(std::string_view(snapshot.data(), length)));
+  }
+  std::basic_string<char> extended = snapshot + '\0';
+  EXPECT_FALSE(empty.core->loadSnapshot(extended));
+
+  std::basic_string<char> badVersion = snapshot;
+  badVersion[8]++;
+  EXPECT_FALSE(empty.core->loadSnapshot(badVersion));
+
+  //corrupt bytes either fail cleanly or load something
+  for (size_t i = 12; i < snapshot.size(); i += 5)
+  {
+    CoreTestWrapper target;
+    std::basic_string<char> corrupt = snapshot;
+    corrupt[i] = static_cast<char>(corrupt[i] ^ 0x5A);
+    target.core->loadSnapshot(corrupt);
+  }
+
+  EXPECT_TRUE(empty.core->loadSnapshot(snapshot));
+  //loading isn't allowed once operations have been applied
+  EXPECT_FALSE(wrapper.core->loadSnapshot(snapshot));
+}
+
+TEST(SnapshotTest, SaveFailsWhileWaitingOnTypes)
+{
+  CoreTestWrapper wrapper;
+  wrapper.types["type0"] = createTypeSpec([](OperationBuilder & builder)
+  {
+    builder.createNode(PrimitiveNodeTypes::Map());
+  }, wrapper.types);
+
+  wrapper.builder.createNode("type0");
+
+  std::basic_string<char> snapshot;
+  EXPECT_FALSE(wrapper.core->saveSnapshot(snapshot));
+
+  wrapper.resolveTypes();
+  EXPECT_TRUE(wrapper.core->saveSnapshot(snapshot));
+}
+
+TEST(SnapshotTest, ReadViewsKeepTheirState)
+{
+  CoreTestWrapper wrapper;
+  auto doc = buildDocument(wrapper);
+
+  auto view = wrapper.core->createReadView();
+  ASSERT_NE(view, nullptr);
+  EXPECT_EQ(view->getClock(), wrapper.core->clock);
+  //shared until the state changes
+  EXPECT_EQ(wrapper.core->createReadView(), view);
+
+  std::string text;
+  view->getCore().getNodeBlockValue(text, doc.stringId);
+  EXPECT_EQ(text, "hello, ld");
+
+  wrapper.builder.insertText(doc.stringId, 0, "abc");
+  wrapper.builder.setValue<int32_t>(doc.valueId, 7);
+
+  text.clear();
+  view->getCore().getNodeBlockValue(text, doc.stringId);
+  EXPECT_EQ(text, "hello, ld");
+  EXPECT_EQ(view->getCore().getNodeValue(doc.valueId), 42);
+  EXPECT_NE(view->getClock(), wrapper.core->clock);
+
+  auto view2 = wrapper.core->createReadView();
+  ASSERT_NE(view2, view);
+  text.clear();
+  view2->getCore().getNodeBlockValue(text, doc.stringId);
+  EXPECT_EQ(text, "abchello, ld");
+  EXPECT_EQ(view2->getCore().getNodeValue(doc.valueId), 7);
+  EXPECT_EQ(view2->getClock(), wrapper.core->clock);
+}
+
+TEST(SnapshotTest, ReadViewsLeaveOutPendingOperations)
+{
+  CoreTestWrapper wrapper;
+  auto doc = buildDocument(wrapper);
+
+  wrapper.types["type1"] = createTypeSpec([](OperationBuilder & builder)
+  {
+    NodeId rootId = builder.createNode(PrimitiveNodeTypes::Map());
+    builder.addChild(rootId, builder.createNode(PrimitiveNodeTypes::StringValue()), "text");
+  }, wrapper.types);
+
+  //waiting on its type, and the edge waiting on the node
+  NodeId pendingId = wrapper.builder.createNode("type1");
+  wrapper.builder.addChild(doc.mapId, pendingId, "pending");
+  wrapper.builder.insertText(doc.stringId, 0, "abc");
+
+  std::basic_string<char> snapshot;
+  ASSERT_FALSE(wrapper.core->saveSnapshot(snapshot));
+
+  auto view = wrapper.core->createReadView();
+  ASSERT_NE(view, nullptr);
+  EXPECT_EQ(view->getCore().getExistingNode(pendingId), nullptr);
+
+  //the clock covers everything applied; the two waiting operations are
+  //  excluded from it, and the insert after them is in the state
+  EXPECT_EQ(view->getClock(), wrapper.core->clock);
+  const auto & excluded = view->getExcludedOperations();
+  ASSERT_EQ(excluded.size(), 2u);
+  EXPECT_EQ(excluded[0].first, pendingId.ts);
+  for (const auto & [first, final] : excluded)
+  {
+    EXPECT_TRUE(view->getClock() >= final);
+  }
+
+  std::string text;
+  view->getCore().getNodeBlockValue(text, doc.stringId);
+  EXPECT_EQ(text, "abchello, ld");
+  EXPECT_EQ(view->getCore().getNodeValue(doc.valueId), 42);
+
+  //a core can't go on from a state with excluded operations
+  wrapper.core->saveReadViewSnapshot(snapshot);
+  CoreTestWrapper wrapper2;
+  EXPECT_FALSE(wrapper2.core->loadSnapshot(snapshot));
+
+  wrapper.resolveTypes();
+
+  auto view2 = wrapper.core->createReadView();
+  ASSERT_NE(view2, nullptr);
+  EXPECT_NE(view2->getCore().getExistingNode(pendingId), nullptr);
+  EXPECT_EQ(view2->getClock(), wrapper.core->clock);
+  EXPECT_TRUE(view2->getExcludedOperations().empty());
+}
+
+TEST(SnapshotTest, ReadViewsCanBeReadWhileApplying)
+{
+  CoreTestWrapper wrapper;
+  auto doc = buildDocument(wrapper);
+
+  auto view = wrapper.core->createReadView();
+  ASSERT_NE(view, nullptr);
+
+  std::string expected;
+  view->getCore().getNodeBlockValue(expected, doc.stringId);
+
+  std::atomic<bool> done = false;
+  std::atomic<size_t> mismatches = 0;
+  std::thread reader([&]()
+  {
+    do
+    {
+      std::string text;
+      view->getCore().getNodeBlockValue(text, doc.stringId);
+      if (text != expected || view->getCore().getNodeValue(doc.valueId) != 42)
+      {
+        mismatches++;
+      }
+    } while (!done);
+  });
+
+  for (int i = 0; i < 200; i++)
+  {
+    wrapper.builder.insertText(doc.stringId, 0, "x");
+    wrapper.builder.setValue<int32_t>(doc.valueId, i);
+  }
+
+  done = true;
+  reader.join();
+
+  EXPECT_EQ(mismatches, 0);
+}
+
+TEST(SnapshotTest, ReadViewsCanBeLoadedWhileApplying)
+{
+  CoreTestWrapper wrapper;
+  auto doc = buildDocument(wrapper);
+
+  //only taking the snapshot needs the core, so it can go on changing while
+  //  the view is loaded
+  auto request = wrapper.core->prepareReadView();
+  ASSERT_EQ(request.view, nullptr);
+  ASSERT_FALSE(request.snapshot.empty());
+
+  std::shared_ptr<const ReadView> view;
+  std::thread loader([&]()
+  {
+    view = wrapper.core->loadReadView(std::move(request));
+  });
+
+  for (int i = 0; i < 200; i++)
+  {
+    wrapper.builder.insertText(doc.stringId, 0, "x");
+  }
+
+  loader.join();
+
+  ASSERT_NE(view, nullptr);
+  std::string text;
+  view->getCore().getNodeBlockValue(text, doc.stringId);
+  EXPECT_EQ(text, "hello, ld");
+  EXPECT_NE(view->getClock(), wrapper.core->clock);
+
+  //the view is of an older state, so it isn't shared from then on
+  auto view2 = wrapper.core->createReadView();
+  ASSERT_NE(view2, view);
+  EXPECT_EQ(view2->getClock(), wrapper.core->clock);
+  EXPECT_EQ(wrapper.core->createReadView(), view2);
+}
+
+TEST(SnapshotTest, ReadViewsLoadedLateDontReplaceNewerViews)
+{
+  CoreTestWrapper wrapper;
+  auto doc = buildDocument(wrapper);
+
+  auto request = wrapper.core->prepareReadView();
+  wrapper.builder.insertText(doc.stringId, 0, "abc");
+  auto request2 = wrapper.core->prepareReadView();
+
+  auto view2 = wrapper.core->loadReadView(std::move(request2));
+  auto view = wrapper.core->loadReadView(std::move(request));
+  ASSERT_NE(view, nullptr);
+  ASSERT_NE(view2, nullptr);
+  ASSERT_NE(view, view2);
+
+  EXPECT_EQ(wrapper.core->createReadView(), view2);
+}
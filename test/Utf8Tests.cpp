@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <Utf8.h>
+
+static std::string generateText(const std::vector<std::string> & characters, size_t count, uint32_t seed)
+{
+  std::mt19937 random(seed);
+  std::string text;
+  for (size_t i = 0; i < count; i++)
+  {
+    text += characters[random() % characters.size()];
+  }
+  return text;
+}
+
+TEST(Utf8Test, VectorKernelsMatchScalar)
+{
+  const std::vector<std::vector<std::string>> corpora = {
+    { "a", "b", " ", "\n" },
+    { "a", "\xE4\xB8\xAD", "\xE6\x96\x87", "\xE3\x80\x82" },
+    { "a", "\xCB\x9F", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xF0\x9F\x91\x8D" },
+    //invalid input: stray continuation bytes, truncated and out of range leads
+    { "a", "\x80", "\xBF", "\xE2\x82", "\xF0\x9F", "\xF8", "\xFF" }
+  };
+
+  uint32_t seed = 1;
+  for (const auto & characters : corpora)
+  {
+    std::string text = generateText(characters, 3000, seed++);
+
+    //every alignment and a range of lengths around the vector widths
+    for (size_t start = 0; start < 40; start++)
+    {
+      for (size_t length : { size_t(0), size_t(1), size_t(15), size_t(16), size_t(17),
+        size_t(31), size_t(32), size_t(33), size_t(100), text.size() - start })
+      {
+        const char * str = text.data() + start;
+        size_t utf16Length = Utf8ToUtf16LengthScalar(str, length);
+        ASSERT_EQ(Utf8ToUtf16Length(str, length), utf16Length);
+
+        std::u16string converted;
+        Utf8AppendUtf16(converted, str, length);
+        ASSERT_EQ(converted.size(), utf16Length);
+
+        for (size_t codeUnits = 0; codeUnits <= utf16Length + 1; codeUnits += 1 + codeUnits / 8)
+        {
+          ASSERT_EQ(Utf8FindUtf16Offset(str, length, codeUnits),
+            Utf8FindUtf16OffsetScalar(str, length, codeUnits));
+        }
+      }
+    }
+  }
+}
+
+TEST(Utf8Test, ConvertsToUtf16)
+{
+  std::u16string converted;
+  Utf8AppendUtf16(converted, "a\xCB\x9F\xE2\x82\xAC\xF0\x9F\x98\x80", 10);
+  EXPECT_EQ(converted, u"a˟€\U0001F600");
+
+  //offsets land after the character holding the code unit, so never inside
+  //  a surrogate pair
+  EXPECT_EQ(Utf8FindUtf16Offset("a\xF0\x9F\x98\x80" "b", 6, 2), 5u);
+  EXPECT_EQ(Utf8FindUtf16Offset("a\xF0\x9F\x98\x80" "b", 6, 3), 5u);
+  EXPECT_EQ(Utf8FindUtf16Offset("a\xF0\x9F\x98\x80" "b", 6, 4), 6u);
+  EXPECT_EQ(Utf8FindUtf16Offset("a\xF0\x9F\x98\x80" "b", 6, 10), 6u);
+
+  converted.clear();
+  Utf8AppendUtf16(converted, "\x80" "a\xE2\x82", 4);
+  EXPECT_EQ(converted, u"a\xFFFD");
+}
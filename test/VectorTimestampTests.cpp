@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include <Core.h>
 #include "helpers.h"
 
@@ -116,4 +118,92 @@ TEST(VectorTimestampTest, MergeWorks)
   ts4.merge(ts1);
   ts4.merge(ts2);
   ASSERT_EQ(ts4.getVector(), expected);
+}
+
+TEST(VectorTimestampTest, SnapshotsWork)
+{
+  VectorTimestamp ts(std::vector<uint32_t>{ 1, 2, 3 });
+
+  auto snapshot0 = ts.getSnapshot();
+  auto snapshot1 = ts.getSnapshot();
+  ASSERT_EQ(&snapshot0.getVector(), &snapshot1.getVector());
+  ASSERT_EQ(snapshot0.getVector(), std::vector<uint32_t>({ 1, 2, 3 }));
+  ASSERT_EQ(snapshot0.getMaxClock(), 3);
+
+  ts.update(Timestamp(5, 4));
+  auto snapshot2 = ts.getSnapshot();
+  ASSERT_EQ(snapshot0.getVector(), std::vector<uint32_t>({ 1, 2, 3 }));
+  ASSERT_EQ(snapshot2.getVector(), std::vector<uint32_t>({ 1, 2, 3, 0, 5 }));
+  ASSERT_EQ(snapshot2.getMaxClock(), 5);
+  ASSERT_TRUE(snapshot2 < Timestamp(6, 4));
+  ASSERT_TRUE(snapshot2 >= Timestamp(5, 4));
+  ASSERT_TRUE(snapshot0 < Timestamp(1, 4));
+
+  VectorTimestamp ts2(snapshot2);
+  ASSERT_EQ(ts2, ts);
+  ASSERT_EQ(ts2.getMaxClock(), 5);
+
+  ASSERT_TRUE(VectorTimestamp().getSnapshot().isEmpty());
+}
+
+TEST(VectorTimestampTest, ConcurrentReadsAreConsistent)
+{
+  VectorTimestamp ts;
+  std::atomic<bool> done = false;
+  std::atomic<int> errors = 0;
+
+  //the writer keeps every site's clock equal, so any consistent read of the
+  //  whole vector sees equal values
+  auto reader = [&]()
+  {
+    uint32_t lastClock = 0;
+    while (!done)
+    {
+      auto vector = ts.getVector();
+      for (auto clock : vector)
+      {
+        if (clock != vector[0])
+        {
+          errors++;
+        }
+      }
+
+      uint32_t clock = ts.getClockAtSite(0);
+      if (clock < lastClock)
+      {
+        errors++;
+      }
+      lastClock = clock;
+
+      auto snapshot = ts.getSnapshot();
+      for (auto clock : snapshot.getVector())
+      {
+        if (clock != snapshot.getVector()[0])
+        {
+          errors++;
+        }
+      }
+    }
+  };
+
+  std::thread reader0(reader);
+  std::thread reader1(reader);
+
+  const uint32_t sites = 64;
+  for (uint32_t clock = 1; clock <= 2000; clock++)
+  {
+    VectorTimestamp next;
+    for (uint32_t site = 0; site < sites; site++)
+    {
+      next.update(Timestamp(clock, site));
+    }
+    ts = next;
+  }
+
+  done = true;
+  reader0.join();
+  reader1.join();
+
+  ASSERT_EQ(errors, 0);
+  ASSERT_EQ(ts.getClockAtSite(sites - 1), 2000);
 }
\ No newline at end of file
@@ -2,7 +2,8 @@
 #include <OperationLog.h>
 #include <stdexcept>
 
-CoreTestWrapper::CoreTestWrapper(std::function<void(const CoreTestWrapper & wrapper, const Event & event)> _eventHandler)
+CoreTestWrapper::CoreTestWrapper(std::function<void(const CoreTestWrapper & wrapper, const Event & event)> _eventHandler,
+  bool enableCompaction)
   :
     eventHandler(_eventHandler),
     coreInit(new CoreInit(
@@ -18,7 +19,7 @@ CoreTestWrapper::CoreTestWrapper(std::function<void(const CoreTestWrapper & wrap
         }
       }
     )),
-    core(new Core(*coreInit)),
+    core(new Core(enableCompaction ? CoreInit(*coreInit).enableCompaction() : *coreInit)),
     builder(
       core,
       1
@@ -431,4 +432,4 @@ void filterOperations(CoreTestWrapper & wrapper, const OperationLogStorage & log
 
     if (it == beforeEnd) break;
   }
-}
\ No newline at end of file
+}
\ No newline at end of file
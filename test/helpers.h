@@ -18,7 +18,8 @@ using EventList = std::vector<Event>;
 
 struct CoreTestWrapper
 {
-  CoreTestWrapper(std::function<void(const CoreTestWrapper & wrapper, const Event & event)> eventHandler = nullptr);
+  CoreTestWrapper(std::function<void(const CoreTestWrapper & wrapper, const Event & event)> eventHandler = nullptr,
+    bool enableCompaction = false);
   ~CoreTestWrapper();
 
   Timestamp group(std::function<void(OperationBuilder & builder)> applyOps);
@@ -80,4 +81,4 @@ void applyOperation(CoreTestWrapper & wrapper, const OperationLogStorage & log,
 void applyOperations(CoreTestWrapper & wrapper, const OperationLogStorage & log, const OperationFilter & filter);
 
 void filterOperations(CoreTestWrapper & wrapper, const OperationLogStorage & log,
-  const OperationFilter & oldFilter, const OperationFilter & newFilter);
\ No newline at end of file
+  const OperationFilter & oldFilter, const OperationFilter & newFilter);
\ No newline at end of file